@@ -209,12 +209,61 @@ extern VOID OsSetVector(UINT32 num, HWI_PROC_FUNC vector, VOID *arg);
 extern VOID OsSetVector(UINT32 num, HWI_PROC_FUNC vector);
 #endif
 
+#if (LOSCFG_IRQ_PROFILE == 1)
+/* *
+ * @ingroup los_arch_interrupt
+ * Number of duration histogram buckets, bucket i counts ISRs running [2^(i-1), 2^i) us, the last one the rest.
+ */
+#define OS_IRQ_PROF_HIST_NUM                  8
+
+/* *
+ * @ingroup los_arch_interrupt
+ * Per CPU interrupt statistics. Durations exclude time spent in nested interrupts.
+ */
+typedef struct {
+    UINT32 count;
+    UINT32 minCycles;
+    UINT32 maxCycles;
+    UINT64 totalCycles;
+    UINT32 hist[OS_IRQ_PROF_HIST_NUM];
+    UINT32 maxNest;                 /* deepest nesting level this interrupt ran at, 1 means not nested */
+    UINT32 maskCount;               /* HalIrqMask/HalIrqUnmask pairs */
+    UINT32 maskMaxCycles;
+    UINT64 maskTotalCycles;
+} IrqProfInfo;
+
+/* *
+ * @ingroup los_arch_interrupt
+ * Get the statistics of CPU interrupt num, cycles are CPU cycles (CCOUNT).
+ */
+UINT32 ArchIrqProfGet(UINT32 num, IrqProfInfo *info);
+
+/* *
+ * @ingroup los_arch_interrupt
+ * Clear all interrupt statistics.
+ */
+VOID ArchIrqProfReset(VOID);
+#endif
+
 VOID HalInterrupt(VOID);
 UINT32 HalIntNumGet(VOID);
 VOID HalHwiDefaultHandler(VOID);
 VOID HalExcHandleEntry(UINTPTR faultAddr, EXC_CONTEXT_S *excBufAddr, UINT32 type);
 VOID HalHwiInit(VOID);
 
+#define OS_PS_INTLEVEL_MASK                   0xFU
+
+/* *
+ * @ingroup los_arch_interrupt
+ * Whether interrupts are masked on the current CPU (PS.INTLEVEL is non-zero), e.g. inside LOS_IntLock.
+ */
+INLINE BOOL ArchIntLocked(VOID)
+{
+    UINT32 ps;
+    __asm__ volatile("rsr %0, ps" : "=a"(ps));
+    return ((ps & OS_PS_INTLEVEL_MASK) != 0) ? TRUE : FALSE;
+}
+
 /**
  * @ingroup los_exc
  * Exception information structure
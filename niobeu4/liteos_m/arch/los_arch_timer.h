@@ -44,6 +44,15 @@ extern "C" {
 
 VOID SysTick_Handler(VOID);
 
+/*
+ * Idle light sleep hook, called from the idle task with the scheduler locked and interrupts enabled.
+ * maxUs is the time left until the next kernel event. Returns the time actually slept in us while the
+ * tick counter was stopped, or 0 if it did not sleep, in which case the idle task falls back to waiti.
+ */
+typedef UINT64 (*ArchIdleSleepHook)(UINT64 maxUs);
+
+VOID ArchSetIdleSleepHook(ArchIdleSleepHook hook);
+
 #define TIM0_GROUP0             0x3FF5F000
 #define TIM0_GROUP1             0x3FF60000
 #define TIM1_GROUP0             0x3FF5F024
@@ -54,12 +63,24 @@ VOID SysTick_Handler(VOID);
 #define TIM0_INT_CLEAR_GROUP0   0x3FF5F0A4
 #define TIM0_INT_CLEAR_GROUP1   0x3FF600A4
 
+#define TIM_CTRL_EN             (1U << 31)
+#define TIM_CTRL_INCREASE       (1U << 30)
+#define TIM_CTRL_DIVIDER_SHIFT  13
+#define TIM_CTRL_LEVEL_INT_EN   (1U << 11)
+#define TIM_CTRL_ALARM_EN       (1U << 10) /* cleared by hardware when the alarm fires */
+#define TIM0_INT_BIT            (1U << 0)
+#define TIM1_INT_BIT            (1U << 1)
+
+/* 64-bit counter registers are split into LO/HI words */
 typedef struct {
     UINT32 CTRL;
-    UINT64 VAL;
+    UINT32 VAL_LO;
+    UINT32 VAL_HI;
     UINT32 UPDATE;
-    UINT64 ALARM;
-    UINT64 LOAD;
+    UINT32 ALARM_LO;
+    UINT32 ALARM_HI;
+    UINT32 LOAD_LO;
+    UINT32 LOAD_HI;
     UINT32 LOAD_TRI;
 } Systick_t;
 
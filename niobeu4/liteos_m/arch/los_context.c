@@ -24,19 +24,43 @@
 #include "los_task.h"
 #include "los_timer.h"
 #include "securec.h"
+#include "esp_attr.h"
+#include "esp_intr_alloc.h"
+#include "soc/soc.h"
+#include "xtensa/xtensa_api.h"
 
-UINT64 OsTickCount = 0;
+#define TICK_TIMER_DIVIDER 2            // APB 80MHz 2 分频, 与 OS_SYS_CLOCK 一致
+#define TICK_TIMER_HI_SHIFT 32
+#define TICK_CYCLES_PER_US (OS_SYS_CLOCK / 1000000UL)
+
+/*
+ * 无节拍调度: 定时器组 0 的 T0 作为 64 位自由运行计数器, 即内核的时间基准 (LOSCFG_BASE_CORE_TICK_WTIMER).
+ * 每次调度只按 nextResponseTime 设置下一次比较值, 空闲时 ArchEnterSleep 一直等到该事件或其他中断.
+ */
+STATIC volatile Systick_t *const g_tickTimer = (volatile Systick_t *)TIM0_GROUP0;
+STATIC intr_handle_t g_tickIntr = NULL;
+STATIC UINT64 g_tickAlarm;             // 最近一次设置的比较值
+STATIC ArchIdleSleepHook g_idleSleepHook = NULL;
+
+UINT64 OsTickCount = 0;                 // 节拍中断次数, 用于观察空闲时的唤醒频率
 
 LITE_OS_SEC_TEXT_INIT VOID ArchInit(VOID)
 {
 }
 
+// 中断使能寄存器与 hr_time 的 T1 共用, 读改写需关中断
 static VOID ArchSysTickLock()
 {
+    UINT32 intSave = LOS_IntLock();
+    *(volatile UINT32 *)TIM0_INT_ENABLE_GROUP0 &= ~TIM0_INT_BIT;
+    LOS_IntRestore(intSave);
 }
 
 static VOID ArchSysTickUnlock()
 {
+    UINT32 intSave = LOS_IntLock();
+    *(volatile UINT32 *)TIM0_INT_ENABLE_GROUP0 |= TIM0_INT_BIT;
+    LOS_IntRestore(intSave);
 }
 
 LITE_OS_SEC_TEXT_MINOR VOID ArchSysExit(VOID)
@@ -64,21 +88,73 @@ LITE_OS_SEC_TEXT_INIT VOID *ArchSignalContextInit(VOID *stackPointer, VOID *stac
     return (void *)stackPointer;
 }
 
+// 移植层启动调度时设置的 CCOMPARE 周期节拍不再使用, 调度由定时器组驱动 (链接时 --wrap 替换)
+void __wrap_vPortSetupTimer(void)
+{
+}
+
+// 移植层节拍中断的回调, 周期节拍未启动, 不会被调用
 void xPortSysTickHandler(void)
 {
+}
+
+STATIC VOID IRAM_ATTR ArchTickIsr(VOID *arg)
+{
+    (VOID)arg;
+    *(volatile UINT32 *)TIM0_INT_CLEAR_GROUP0 = TIM0_INT_BIT;
     OsTickCount++;
     OsTickHandler();
 }
 
+/*
+ * 内核按 irqNum 注册 tickHandler, 因此在返回定时器描述之前分配中断, 得到 T0 实际路由到的 CPU 中断号.
+ * 先保持禁用, 在 ArchTickStart 中打开.
+ */
+STATIC VOID ArchTickIntrAlloc(VOID)
+{
+    if (g_tickIntr != NULL) {
+        return;
+    }
+    if (esp_intr_alloc(ETS_TG0_T0_LEVEL_INTR_SOURCE, ESP_INTR_FLAG_IRAM | ESP_INTR_FLAG_INTRDISABLED,
+                       ArchTickIsr, NULL, &g_tickIntr) != ESP_OK) {
+        PRINT_ERR("tick interrupt alloc failed\n");
+        g_tickIntr = NULL;
+    }
+}
+
 static UINT32 ArchTickStart(void *handler)
 {
+    (VOID)handler;
+    if (g_tickIntr == NULL) {
+        return LOS_NOK;
+    }
     OsTickCount = 0;
+    // 分频只能在计数器停止时修改
+    g_tickTimer->CTRL = TIM_CTRL_INCREASE | (TICK_TIMER_DIVIDER << TIM_CTRL_DIVIDER_SHIFT) | TIM_CTRL_LEVEL_INT_EN;
+    g_tickTimer->LOAD_LO = 0;
+    g_tickTimer->LOAD_HI = 0;
+    g_tickTimer->LOAD_TRI = 1;
+    ArchSysTickUnlock();
+    esp_intr_enable(g_tickIntr);
+    g_tickTimer->CTRL |= TIM_CTRL_EN;
     return LOS_OK;
 }
 
+// 锁存后读取, 调用者可能在任务或中断中, 关中断保证 LO/HI 来自同一次锁存
+STATIC UINT64 IRAM_ATTR ArchTickRead(VOID)
+{
+    UINT32 intSave = LOS_IntLock();
+    UINT64 cycle;
+    g_tickTimer->UPDATE = 1;
+    cycle = ((UINT64)g_tickTimer->VAL_HI << TICK_TIMER_HI_SHIFT) | g_tickTimer->VAL_LO;
+    LOS_IntRestore(intSave);
+    return cycle;
+}
+
 static UINT64 ArchGetTickCycle(UINT32 *period)
 {
-    return (UINT64)OsTickCount * (OS_SYS_CLOCK / LOSCFG_BASE_CORE_TICK_PER_SECOND);
+    (VOID)period;
+    return ArchTickRead();
 }
 
 UINT32 ArchStartSchedule(VOID)
@@ -99,12 +175,69 @@ VOID ArchTaskSchedule(VOID)
     return;
 }
 
+// 比较值已过时硬件立即触发, 不会丢失事件
 static VOID ArchSysTickReload(UINT64 nextResponseTime)
 {
+    UINT32 intSave = LOS_IntLock();
+    UINT64 alarm = ArchTickRead() + nextResponseTime;
+    g_tickAlarm = alarm;
+    g_tickTimer->ALARM_HI = (UINT32)(alarm >> TICK_TIMER_HI_SHIFT);
+    g_tickTimer->ALARM_LO = (UINT32)alarm;
+    g_tickTimer->CTRL |= TIM_CTRL_ALARM_EN;
+    LOS_IntRestore(intSave);
+}
+
+VOID ArchSetIdleSleepHook(ArchIdleSleepHook hook)
+{
+    g_idleSleepHook = hook;
 }
 
+// 浅睡眠期间 APB 时钟关闭, 计数器停止, 唤醒后按实际睡眠时长补齐; 越过的比较值由硬件立即触发
+STATIC VOID ArchTickAdvance(UINT64 cycles)
+{
+    UINT32 intSave = LOS_IntLock();
+    UINT64 cycle = ArchTickRead() + cycles;
+    g_tickTimer->LOAD_HI = (UINT32)(cycle >> TICK_TIMER_HI_SHIFT);
+    g_tickTimer->LOAD_LO = (UINT32)cycle;
+    g_tickTimer->LOAD_TRI = 1;
+    LOS_IntRestore(intSave);
+}
+
+/*
+ * 锁调度后调用钩子, 中断保持打开: esp_light_sleep_start 自行处理临界区, Wi-Fi 等驱动中断照常响应.
+ * 钩子执行期间被中断唤醒的任务在解锁调度后运行.
+ */
+STATIC BOOL ArchIdleSleep(ArchIdleSleepHook hook)
+{
+    UINT32 intSave;
+    UINT64 alarm;
+    UINT64 now;
+    UINT64 sleptUs = 0;
+    LOS_TaskLock();
+    intSave = LOS_IntLock();
+    alarm = g_tickAlarm;
+    now = ArchTickRead();
+    LOS_IntRestore(intSave);
+    if (alarm > now) {
+        sleptUs = hook((alarm - now) / TICK_CYCLES_PER_US);
+        if (sleptUs != 0) {
+            ArchTickAdvance(sleptUs * TICK_CYCLES_PER_US);
+        }
+    }
+    LOS_TaskUnlock();
+    return (sleptUs != 0);
+}
+
+/*
+ * 内核空闲时调用. 注册了浅睡眠钩子且钩子接受时进入浅睡眠, 否则 CPU 停在 waiti
+ * 直到下一次比较中断或其他中断, 定时器组在 APB 时钟下继续计数.
+ */
 UINT32 ArchEnterSleep(VOID)
 {
+    ArchIdleSleepHook hook = g_idleSleepHook;
+    if ((hook != NULL) && ArchIdleSleep(hook)) {
+        return LOS_OK;
+    }
     __asm__ volatile("dsync\n waiti 0"
                      :
                      :
@@ -120,10 +253,14 @@ STATIC ArchTickTimer g_archTickTimer = {
     .reload = ArchSysTickReload,
     .lock = ArchSysTickLock,
     .unlock = ArchSysTickUnlock,
-    .tickHandler = NULL,
+    .tickHandler = (HWI_PROC_FUNC)ArchTickIsr,
 };
 
 ArchTickTimer *ArchSysTickTimerGet(VOID)
 {
+    ArchTickIntrAlloc();
+    if (g_tickIntr != NULL) {
+        g_archTickTimer.irqNum = esp_intr_get_intno(g_tickIntr);
+    }
     return &g_archTickTimer;
 }
@@ -42,15 +42,217 @@
 #include "los_sched.h"
 #include "los_task.h"
 #include "securec.h"
+#include "xtensa/xtensa_api.h"
+#if (LOSCFG_IRQ_PROFILE == 1)
+#include <stdio.h>
+#include <string.h>
+#include "esp32/rom/ets_sys.h"
+#include "ohos_init.h"
+#if (LOSCFG_USE_SHELL == 1)
+#include "shcmd.h"
+#endif
+#endif
 
 #define IRAM_ATTR __attribute__((section(".iram1.__COUNTER__")))
 
 static const char DefVectorName[] = {"LiteosVector"};
 
+#if (LOSCFG_IRQ_PROFILE == 1)
+#define IRQ_PROF_NEST_MAX 8
+
+xt_handler __real_xt_set_interrupt_handler(int n, xt_handler f, void *arg);
+extern VOID xt_unhandled_interrupt(VOID *arg);
+
+typedef struct {
+    xt_handler handler;
+    VOID *arg;
+    UINT32 maskStart;
+    BOOL masked;
+    IrqProfInfo info;
+} IrqProf;
+
+STATIC IrqProf g_irqProf[OS_HWI_MAX_NUM];
+STATIC UINT32 g_irqProfNest;
+/* cycles spent in nested interrupts, indexed by nesting level */
+STATIC UINT32 g_irqProfChild[IRQ_PROF_NEST_MAX + 1];
+STATIC UINT32 g_irqProfCpuMhz;
+
+INLINE UINT32 IrqProfCycle(VOID)
+{
+    UINT32 ccount;
+    __asm__ volatile("rsr %0, ccount" : "=a"(ccount));
+    return ccount;
+}
+
+INLINE VOID IrqProfInfoClear(IrqProfInfo *info)
+{
+    (VOID)memset_s(info, sizeof(*info), 0, sizeof(*info));
+    info->minCycles = UINT32_MAX;
+}
+
+STATIC IRAM_ATTR VOID IrqProfRecord(IrqProfInfo *info, UINT32 cycles, UINT32 depth)
+{
+    UINT32 us = cycles / g_irqProfCpuMhz;
+    UINT32 bucket = (us == 0) ? 0 : (32 - __builtin_clz(us)); /* 32: bits of UINT32 */
+    info->count++;
+    info->totalCycles += cycles;
+    info->minCycles = (cycles < info->minCycles) ? cycles : info->minCycles;
+    info->maxCycles = (cycles > info->maxCycles) ? cycles : info->maxCycles;
+    info->hist[(bucket < OS_IRQ_PROF_HIST_NUM) ? bucket : (OS_IRQ_PROF_HIST_NUM - 1)]++;
+    info->maxNest = (depth > info->maxNest) ? depth : info->maxNest;
+}
+
+/*
+ * Installed in place of every handler. A nested interrupt restores g_irqProfNest before the
+ * interrupted one resumes, so plain increments are safe on this core.
+ */
+STATIC IRAM_ATTR VOID IrqProfEntry(VOID *arg)
+{
+    IrqProf *prof = (IrqProf *)arg;
+    UINT32 start = IrqProfCycle();
+    UINT32 depth = ++g_irqProfNest;
+    UINT32 cycles;
+    UINT32 child = 0;
+    if (depth <= IRQ_PROF_NEST_MAX) {
+        g_irqProfChild[depth] = 0;
+    }
+    prof->handler(prof->arg);
+    cycles = IrqProfCycle() - start;
+    if (depth <= IRQ_PROF_NEST_MAX) {
+        child = g_irqProfChild[depth];
+    }
+    if ((depth > 1) && (depth <= IRQ_PROF_NEST_MAX + 1)) {
+        g_irqProfChild[depth - 1] += cycles;
+    }
+    g_irqProfNest--;
+    IrqProfRecord(&prof->info, cycles - child, depth);
+}
+
+STATIC IRAM_ATTR VOID IrqProfMask(UINT32 num)
+{
+    UINT32 intSave = LOS_IntLock();
+    if ((num < OS_HWI_MAX_NUM) && !g_irqProf[num].masked) {
+        g_irqProf[num].masked = TRUE;
+        g_irqProf[num].maskStart = IrqProfCycle();
+    }
+    LOS_IntRestore(intSave);
+}
+
+STATIC IRAM_ATTR VOID IrqProfUnmask(UINT32 num)
+{
+    UINT32 intSave = LOS_IntLock();
+    UINT32 cycles;
+    if ((num < OS_HWI_MAX_NUM) && g_irqProf[num].masked) {
+        cycles = IrqProfCycle() - g_irqProf[num].maskStart;
+        g_irqProf[num].masked = FALSE;
+        g_irqProf[num].info.maskCount++;
+        g_irqProf[num].info.maskTotalCycles += cycles;
+        if (cycles > g_irqProf[num].info.maskMaxCycles) {
+            g_irqProf[num].info.maskMaxCycles = cycles;
+        }
+    }
+    LOS_IntRestore(intSave);
+}
+
+UINT32 ArchIrqProfGet(UINT32 num, IrqProfInfo *info)
+{
+    UINT32 intSave;
+    if ((num >= OS_HWI_MAX_NUM) || (info == NULL)) {
+        return OS_ERRNO_HWI_NUM_INVALID;
+    }
+    intSave = LOS_IntLock();
+    *info = g_irqProf[num].info;
+    LOS_IntRestore(intSave);
+    return LOS_OK;
+}
+
+VOID ArchIrqProfReset(VOID)
+{
+    UINT32 intSave = LOS_IntLock();
+    for (UINT32 i = 0; i < OS_HWI_MAX_NUM; i++) {
+        IrqProfInfoClear(&g_irqProf[i].info);
+    }
+    LOS_IntRestore(intSave);
+}
+
+/*
+ * ESP-IDF drivers install their handlers with esp_intr_alloc, which does not go through OsSetVector,
+ * so the profiler hooks xt_set_interrupt_handler itself (linked with --wrap when LOSCFG_IRQ_PROFILE is 1).
+ * The default handler installed by esp_intr_free is passed through, xt_int_has_handler relies on it.
+ */
+xt_handler __wrap_xt_set_interrupt_handler(int n, xt_handler f, void *arg)
+{
+    IrqProf *prof = NULL;
+    xt_handler old;
+    xt_handler prev;
+    UINT32 intSave;
+    if ((n < 0) || (n >= OS_HWI_MAX_NUM)) {
+        return __real_xt_set_interrupt_handler(n, f, arg);
+    }
+    if (g_irqProfCpuMhz == 0) {
+        g_irqProfCpuMhz = ets_get_cpu_frequency();
+    }
+    prof = &g_irqProf[n];
+    intSave = LOS_IntLock();
+    old = prof->handler;
+    if ((f == NULL) || (f == xt_unhandled_interrupt)) {
+        prof->handler = NULL;
+        prof->arg = NULL;
+        prev = __real_xt_set_interrupt_handler(n, f, arg);
+        LOS_IntRestore(intSave);
+        return (old != NULL) ? old : prev;
+    }
+    prof->handler = f;
+    prof->arg = arg;
+    IrqProfInfoClear(&prof->info);
+    prev = __real_xt_set_interrupt_handler(n, IrqProfEntry, prof);
+    LOS_IntRestore(intSave);
+    return (old != NULL) ? old : prev;
+}
+
+#if (LOSCFG_USE_SHELL == 1)
+STATIC UINT32 IrqProfShellCmd(UINT32 argc, const CHAR **argv)
+{
+    IrqProfInfo info;
+    if ((argc == 1) && (strcmp(argv[0], "reset") == 0)) {
+        ArchIrqProfReset();
+        return LOS_OK;
+    }
+    if ((argc != 0) || (g_irqProfCpuMhz == 0)) {
+        printf("usage: irqprof [reset]\r\n");
+        return LOS_NOK;
+    }
+    printf("irq    count  min(us)  avg(us)  max(us) nest  masked max(us) total(us) ");
+    printf(" hist(us) <1 <2 <4 <8 <16 <32 <64 >=64\r\n");
+    for (UINT32 i = 0; i < OS_HWI_MAX_NUM; i++) {
+        if ((ArchIrqProfGet(i, &info) != LOS_OK) || ((info.count == 0) && (info.maskCount == 0))) {
+            continue;
+        }
+        printf("%3u %8u %8u %8u %8u %4u %7u %7u %9u ", i, info.count,
+               (info.count == 0) ? 0 : (info.minCycles / g_irqProfCpuMhz),
+               (info.count == 0) ? 0 : (UINT32)(info.totalCycles / info.count / g_irqProfCpuMhz),
+               info.maxCycles / g_irqProfCpuMhz, info.maxNest, info.maskCount,
+               info.maskMaxCycles / g_irqProfCpuMhz, (UINT32)(info.maskTotalCycles / g_irqProfCpuMhz));
+        for (UINT32 j = 0; j < OS_IRQ_PROF_HIST_NUM; j++) {
+            printf(" %u", info.hist[j]);
+        }
+        printf("\r\n");
+    }
+    return LOS_OK;
+}
+
+STATIC VOID IrqProfShellInit(VOID)
+{
+    (VOID)osCmdReg(CMD_TYPE_EX, "irqprof", XARGS, (CmdCallBackFunc)IrqProfShellCmd);
+}
+SYS_RUN(IrqProfShellInit);
+#endif
+#endif
+
 #if (OS_HWI_WITH_ARG == 1)
 VOID OsSetVector(UINT32 num, HWI_PROC_FUNC vector, VOID *arg)
 {
-    xt_set_interrupt_handler(num, (void (*)(void *))vector, arg ? arg : DefVectorName);
+    xt_set_interrupt_handler(num, (void (*)(void *))vector, arg ? arg : (VOID *)DefVectorName);
 }
 #else
 VOID OsSetVector(UINT32 num, HWI_PROC_FUNC vector)
@@ -69,6 +271,9 @@ IRAM_ATTR UINT32 HalIrqUnmask(HWI_HANDLE_T hwiNum)
         return OS_ERRNO_HWI_NUM_INVALID;
     }
     xt_ints_on(1 << hwiNum);
+#if (LOSCFG_IRQ_PROFILE == 1)
+    IrqProfUnmask(hwiNum);
+#endif
     return LOS_OK;
 }
 
@@ -78,5 +283,8 @@ IRAM_ATTR UINT32 HalIrqMask(HWI_HANDLE_T hwiNum)
         return OS_ERRNO_HWI_NUM_INVALID;
     }
     xt_ints_off(1 << hwiNum);
+#if (LOSCFG_IRQ_PROFILE == 1)
+    IrqProfMask(hwiNum);
+#endif
     return LOS_OK;
 }
\ No newline at end of file
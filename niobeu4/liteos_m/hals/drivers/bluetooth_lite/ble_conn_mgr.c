@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "securec.h"
+#include "cmsis_os2.h"
+#include "los_mux.h"
+#include "los_tick.h"
+#include "ohos_init.h"
+#include "ble_gatts_tx.h"
+#include "ble_gattc_bulk.h"
+#include "ble_conn_mgr.h"
+
+#define MS_PER_SECOND 1000
+#define BLE_CONN_PROFILE_NONE BLE_CONN_PROFILE_NUM
+
+typedef struct {
+    bool used;
+    bool queueUsed;             // 曾经过通知队列/批量写发送, 只管理这类连接
+    uint16_t connId;
+    uint8_t addr[OHOS_BD_ADDR_LEN];
+    uint32_t lastActiveMs;
+    uint32_t lastUpdateMs;
+    BleConnState state;
+} BleConnEntry;
+
+typedef struct {
+    const BleConnOps *ops;
+    BleConnOps customOps;
+    BleConnPolicy policy;
+    BleConnProfile profile[BLE_CONN_PROFILE_NUM];
+    BleConnEntry conn[BLE_CONN_MGR_CONN_MAX];
+    UINT32 muxHandle;
+    osTimerId_t timer;
+} BleConnMgr_t;
+
+static int EspUpdateParams(const uint8_t *addr, const BleConnProfile *profile);
+static int EspSetDataLen(const uint8_t *addr, uint16_t txOctets);
+static uint32_t BleConnNowMs(void);
+static uint32_t BleConnQueuedBytes(uint16_t connId);
+
+/* ESP32 控制器为 BLE 4.2, 不支持 2M PHY, 默认 setPhy 为空 */
+static const BleConnOps DefaultOps = {
+    .updateParams = EspUpdateParams,
+    .setDataLen = EspSetDataLen,
+    .setPhy = NULL,
+    .queuedBytes = BleConnQueuedBytes,
+    .nowMs = BleConnNowMs,
+};
+
+static BleConnMgr_t BleConnMgr = {
+    .ops = &DefaultOps,
+    .policy = {
+        .autoSwitch = false,
+        .bulkThreshold = BLE_CONN_MGR_BULK_THRESHOLD,
+        .idleTimeoutMs = BLE_CONN_MGR_IDLE_TIMEOUT_MS,
+    },
+    .profile = {
+        /* 空闲: 间隔 400~500ms, 从机延迟 4, 监督超时 6s */
+        [BLE_CONN_PROFILE_IDLE] = { .minInterval = 320, .maxInterval = 400, .latency = 4, .timeout = 600 },
+        /* 大吞吐: 间隔 7.5~15ms, 无从机延迟, 251 字节 DLE, 优先 2M PHY */
+        [BLE_CONN_PROFILE_BULK] = { .minInterval = 6, .maxInterval = 12, .latency = 0, .timeout = 400,
+                                    .txOctets = 251, .phy = BLE_CONN_PHY_2M },
+    },
+};
+
+static uint32_t BleConnNowMs(void)
+{
+    return (uint32_t)(LOS_TickCountGet() * MS_PER_SECOND / LOSCFG_BASE_CORE_TICK_PER_SECOND);
+}
+
+/* 服务端通知队列与客户端批量写的积压之和 */
+static uint32_t BleConnQueuedBytes(uint16_t connId)
+{
+    return BleGattsTxQueuedBytes(connId) + BleGattcBulkPending(connId);
+}
+
+static int EspUpdateParams(const uint8_t *addr, const BleConnProfile *profile)
+{
+    esp_ble_conn_update_params_t params = {0};
+    (void)memcpy_s(params.bda, sizeof(params.bda), addr, OHOS_BD_ADDR_LEN);
+    params.min_int = profile->minInterval;
+    params.max_int = profile->maxInterval;
+    params.latency = profile->latency;
+    params.timeout = profile->timeout;
+    return esp_ble_gap_update_conn_params(&params);
+}
+
+static int EspSetDataLen(const uint8_t *addr, uint16_t txOctets)
+{
+    esp_bd_addr_t bda;
+    (void)memcpy_s(bda, sizeof(bda), addr, OHOS_BD_ADDR_LEN);
+    return esp_ble_gap_set_pkt_data_len(bda, txOctets);
+}
+
+static void BleConnLock(void)
+{
+    (void)LOS_MuxPend(BleConnMgr.muxHandle, LOS_WAIT_FOREVER);
+}
+
+static void BleConnUnlock(void)
+{
+    (void)LOS_MuxPost(BleConnMgr.muxHandle);
+}
+
+static BleConnEntry *FindConn(uint16_t connId)
+{
+    for (int i = 0; i < BLE_CONN_MGR_CONN_MAX; i++) {
+        if (BleConnMgr.conn[i].used && (BleConnMgr.conn[i].connId == connId)) {
+            return &BleConnMgr.conn[i];
+        }
+    }
+    return NULL;
+}
+
+/* 受最小更新间隔限制, 未下发时返回 -1, 由下一次评估重试 */
+static int ApplyProfile(BleConnEntry *e, BleConnProfileId id, uint32_t now)
+{
+    const BleConnProfile *profile = &BleConnMgr.profile[id];
+    const BleConnOps *ops = BleConnMgr.ops;
+
+    if ((e->state.switchCount > 0) && (now - e->lastUpdateMs < BLE_CONN_MGR_MIN_UPDATE_MS)) {
+        return -1;
+    }
+    if ((ops->updateParams == NULL) || (ops->updateParams(e->addr, profile) != 0)) {
+        e->state.rejectCount++;
+        e->lastUpdateMs = now;
+        return -1;
+    }
+    if ((profile->txOctets != 0) && (ops->setDataLen != NULL)) {
+        (void)ops->setDataLen(e->addr, profile->txOctets);
+    }
+    if ((profile->phy != 0) && (ops->setPhy != NULL)) {
+        (void)ops->setPhy(e->addr, profile->phy);
+    }
+    e->state.profile = id;
+    e->state.switchCount++;
+    e->lastUpdateMs = now;
+    return 0;
+}
+
+static void Evaluate(BleConnEntry *e, uint32_t now)
+{
+    const BleConnPolicy *policy = &BleConnMgr.policy;
+    uint32_t queued = (BleConnMgr.ops->queuedBytes != NULL) ? BleConnMgr.ops->queuedBytes(e->connId) : 0;
+
+    if (queued > 0) {
+        e->lastActiveMs = now;
+        e->queueUsed = true;
+    }
+    /* 直接调用 BleGattsSendIndication 或 GATTC 写的连接不经过队列, 积压恒为 0, 不能据此降为空闲配置 */
+    if (!e->queueUsed) {
+        return;
+    }
+    if (queued >= policy->bulkThreshold) {
+        if (e->state.profile != BLE_CONN_PROFILE_BULK) {
+            (void)ApplyProfile(e, BLE_CONN_PROFILE_BULK, now);
+        }
+    } else if ((e->state.profile != BLE_CONN_PROFILE_IDLE) && (now - e->lastActiveMs >= policy->idleTimeoutMs)) {
+        (void)ApplyProfile(e, BLE_CONN_PROFILE_IDLE, now);
+    }
+}
+
+void BleConnMgrPoll(void)
+{
+    BleConnLock();
+    if (BleConnMgr.policy.autoSwitch) {
+        uint32_t now = BleConnMgr.ops->nowMs();
+        for (int i = 0; i < BLE_CONN_MGR_CONN_MAX; i++) {
+            if (BleConnMgr.conn[i].used) {
+                Evaluate(&BleConnMgr.conn[i], now);
+            }
+        }
+    }
+    BleConnUnlock();
+}
+
+static void BleConnTimerProc(void *arg)
+{
+    (void)arg;
+    BleConnMgrPoll();
+}
+
+BtError BleConnMgrSetProfile(BleConnProfileId id, const BleConnProfile *profile)
+{
+    if ((id >= BLE_CONN_PROFILE_NUM) || (profile == NULL) || (profile->minInterval > profile->maxInterval)) {
+        return BT_PARAMINPUT_ERROR;
+    }
+    BleConnLock();
+    BleConnMgr.profile[id] = *profile;
+    BleConnUnlock();
+    return BT_SUCCESS;
+}
+
+BtError BleConnMgrSetPolicy(const BleConnPolicy *policy)
+{
+    if (policy == NULL) {
+        return BT_PARAMINPUT_ERROR;
+    }
+    BleConnLock();
+    BleConnMgr.policy = *policy;
+    BleConnUnlock();
+    return BT_SUCCESS;
+}
+
+BtError BleConnMgrRequest(uint16_t connId, BleConnProfileId id)
+{
+    BtError ret = BT_PARAMINPUT_ERROR;
+    if (id >= BLE_CONN_PROFILE_NUM) {
+        return ret;
+    }
+    BleConnLock();
+    BleConnEntry *e = FindConn(connId);
+    if (e != NULL) {
+        uint32_t now = BleConnMgr.ops->nowMs();
+        e->lastUpdateMs = now - BLE_CONN_MGR_MIN_UPDATE_MS;
+        e->lastActiveMs = now;
+        ret = (ApplyProfile(e, id, now) == 0) ? BT_SUCCESS : BT_ERROR;
+    }
+    BleConnUnlock();
+    return ret;
+}
+
+BtError BleConnMgrGetState(uint16_t connId, BleConnState *state)
+{
+    BtError ret = BT_PARAMINPUT_ERROR;
+    if (state == NULL) {
+        return ret;
+    }
+    BleConnLock();
+    BleConnEntry *e = FindConn(connId);
+    if (e != NULL) {
+        *state = e->state;
+        ret = BT_SUCCESS;
+    }
+    BleConnUnlock();
+    return ret;
+}
+
+void BleConnMgrSetOps(const BleConnOps *ops)
+{
+    BleConnLock();
+    BleConnMgr.ops = &DefaultOps;
+    if (ops != NULL) {
+        BleConnMgr.customOps = *ops;
+        if (BleConnMgr.customOps.nowMs == NULL) {
+            BleConnMgr.customOps.nowMs = BleConnNowMs;
+        }
+        BleConnMgr.ops = &BleConnMgr.customOps;
+    }
+    BleConnUnlock();
+}
+
+void BleConnMgrAttach(uint16_t connId, const uint8_t *addr)
+{
+    BleConnLock();
+    BleConnEntry *e = FindConn(connId);
+    for (int i = 0; (e == NULL) && (i < BLE_CONN_MGR_CONN_MAX); i++) {
+        if (!BleConnMgr.conn[i].used) {
+            e = &BleConnMgr.conn[i];
+        }
+    }
+    if (e != NULL) {
+        (void)memset_s(e, sizeof(*e), 0, sizeof(*e));
+        e->used = true;
+        e->connId = connId;
+        (void)memcpy_s(e->addr, sizeof(e->addr), addr, OHOS_BD_ADDR_LEN);
+        e->lastActiveMs = BleConnMgr.ops->nowMs();
+        e->state.profile = BLE_CONN_PROFILE_NONE;
+    }
+    BleConnUnlock();
+
+    if ((BleConnMgr.timer != NULL) && !osTimerIsRunning(BleConnMgr.timer)) {
+        (void)osTimerStart(BleConnMgr.timer, BLE_CONN_MGR_POLL_MS * LOSCFG_BASE_CORE_TICK_PER_SECOND / MS_PER_SECOND);
+    }
+}
+
+void BleConnMgrDetach(uint16_t connId)
+{
+    bool any = false;
+    BleConnLock();
+    BleConnEntry *e = FindConn(connId);
+    if (e != NULL) {
+        e->used = false;
+    }
+    for (int i = 0; i < BLE_CONN_MGR_CONN_MAX; i++) {
+        any = any || BleConnMgr.conn[i].used;
+    }
+    BleConnUnlock();
+    if (!any && (BleConnMgr.timer != NULL)) {
+        (void)osTimerStop(BleConnMgr.timer);
+    }
+}
+
+void BleConnMgrOnParamsUpdated(const uint8_t *addr, int status, uint16_t interval, uint16_t latency)
+{
+    BleConnLock();
+    for (int i = 0; i < BLE_CONN_MGR_CONN_MAX; i++) {
+        BleConnEntry *e = &BleConnMgr.conn[i];
+        if (e->used && (memcmp(e->addr, addr, OHOS_BD_ADDR_LEN) == 0)) {
+            if (status != 0) {
+                e->state.rejectCount++;
+            } else {
+                e->state.interval = interval;
+                e->state.latency = latency;
+            }
+            break;
+        }
+    }
+    BleConnUnlock();
+}
+
+static void BleConnMgrInit(void)
+{
+    if (LOS_MuxCreate(&BleConnMgr.muxHandle) != LOS_OK) {
+        BT_LOGE("LOS_MuxCreate fail");
+        return;
+    }
+    BleConnMgr.timer = osTimerNew(BleConnTimerProc, osTimerPeriodic, NULL, NULL);
+    if (BleConnMgr.timer == NULL) {
+        BT_LOGE("osTimerNew fail");
+    }
+}
+SYS_RUN(BleConnMgrInit);
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __BLE_CONN_MGR_H__
+#define __BLE_CONN_MGR_H__
+#include "blegap.h"
+
+#define BLE_CONN_MGR_CONN_MAX 3
+#define BLE_CONN_MGR_POLL_MS 100
+#define BLE_CONN_MGR_BULK_THRESHOLD 512     // 队列积压超过该字节数时切换到大吞吐配置
+#define BLE_CONN_MGR_IDLE_TIMEOUT_MS 2000   // 无积压持续该时间后回到空闲配置
+#define BLE_CONN_MGR_MIN_UPDATE_MS 1000     // 同一连接两次参数更新请求的最小间隔
+
+#define BLE_CONN_PHY_1M (1 << 0)
+#define BLE_CONN_PHY_2M (1 << 1)
+
+typedef enum {
+    BLE_CONN_PROFILE_IDLE = 0,
+    BLE_CONN_PROFILE_BULK,
+    BLE_CONN_PROFILE_NUM,
+} BleConnProfileId;
+
+typedef struct {
+    uint16_t minInterval;       // 连接间隔, 单位 1.25ms
+    uint16_t maxInterval;
+    uint16_t latency;           // 从机延迟, 单位连接事件
+    uint16_t timeout;           // 监督超时, 单位 10ms
+    uint16_t txOctets;          // 数据长度扩展的单包字节数, 0 表示不设置
+    uint8_t phy;                // BLE_CONN_PHY_* 组合, 0 表示不设置
+} BleConnProfile;
+
+typedef struct {
+    bool autoSwitch;            // 默认关闭; 开启后也只调整使用过发送队列的连接
+    uint32_t bulkThreshold;
+    uint32_t idleTimeoutMs;
+} BleConnPolicy;
+
+/**
+ * @brief 控制器操作集, 默认实现调用 ESP 协议栈, 主机侧测试可替换为桩函数
+ */
+typedef struct {
+    int (*updateParams)(const uint8_t *addr, const BleConnProfile *profile);
+    int (*setDataLen)(const uint8_t *addr, uint16_t txOctets);
+    int (*setPhy)(const uint8_t *addr, uint8_t phy);
+    uint32_t (*queuedBytes)(uint16_t connId);
+    uint32_t (*nowMs)(void);
+} BleConnOps;
+
+typedef struct {
+    BleConnProfileId profile;   // 最近一次请求的配置
+    uint16_t interval;          // 协商后的连接间隔, 单位 1.25ms, 0 表示未知
+    uint16_t latency;
+    uint32_t switchCount;
+    uint32_t rejectCount;       // 对端或控制器拒绝的更新次数
+} BleConnState;
+
+/**
+ * @brief 修改命名配置的参数
+ */
+BtError BleConnMgrSetProfile(BleConnProfileId id, const BleConnProfile *profile);
+
+/**
+ * @brief 设置自动切换策略
+ */
+BtError BleConnMgrSetPolicy(const BleConnPolicy *policy);
+
+/**
+ * @brief 手动为连接请求指定配置, 自动切换开启时仍会按积压情况调整
+ */
+BtError BleConnMgrRequest(uint16_t connId, BleConnProfileId id);
+
+/**
+ * @brief 获取连接当前的配置与协商结果
+ */
+BtError BleConnMgrGetState(uint16_t connId, BleConnState *state);
+
+/**
+ * @brief 替换控制器操作集, NULL 恢复默认实现
+ */
+void BleConnMgrSetOps(const BleConnOps *ops);
+
+/**
+ * @brief 按策略评估所有连接, 由内部定时器周期调用, 主机侧测试可直接调用
+ */
+void BleConnMgrPoll(void);
+
+/* 以下供 HAL 内部使用 */
+void BleConnMgrAttach(uint16_t connId, const uint8_t *addr);
+void BleConnMgrDetach(uint16_t connId);
+void BleConnMgrOnParamsUpdated(const uint8_t *addr, int status, uint16_t interval, uint16_t latency);
+
+#endif
@@ -0,0 +1,402 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "securec.h"
+#include "cmsis_os2.h"
+#include "los_mux.h"
+#include "los_tick.h"
+#include "ohos_init.h"
+#include "ble_conn_mgr.h"
+#include "ble_gattc_bulk.h"
+
+#define MS_PER_SECOND 1000
+#define BLE_GATT_MTU_DEFAULT 23
+
+typedef enum {
+    BULK_STATE_IDLE = 0,
+    BULK_STATE_STREAM,          // 无响应写流水发送
+    BULK_STATE_WRITE,           // 单包带响应写
+    BULK_STATE_PREPARE,         // prepare 写进行中
+    BULK_STATE_EXECUTE,         // 等待 execute 完成
+} BleGattcBulkState;
+
+typedef struct {
+    bool used;
+    bool congested;
+    BleGattcBulkState state;
+    esp_gatt_if_t gattcIf;
+    uint16_t connId;
+    uint16_t mtu;
+    uint16_t handle;
+    uint16_t chunk;             // 在途 prepare 写的长度
+    uint8_t inflight;
+    int status;                 // 取消 prepare 队列时记录的失败原因
+    esp_gatt_auth_req_t auth;
+    const uint8_t *data;
+    uint32_t len;
+    uint32_t sent;
+    uint32_t startMs;
+    BleGattcBulkResult result;
+    BleGattcBulkCallback callback;
+} BleGattcBulkConn;
+
+typedef struct {
+    BleGattcBulkCallback callback;
+    uint16_t connId;
+    int status;
+    BleGattcBulkResult result;
+} BleGattcBulkDone;
+
+typedef struct {
+    GattcBleCallback callback;
+    BleGattcBulkConn conn[BLE_GATTC_BULK_CONN_MAX];
+    UINT32 muxHandle;
+    osTimerId_t timer;
+} BleGattcBulk_t;
+
+static BleGattcBulk_t BleGattcBulk;
+
+static void BleGattcBulkLock(void)
+{
+    (void)LOS_MuxPend(BleGattcBulk.muxHandle, LOS_WAIT_FOREVER);
+}
+
+static void BleGattcBulkUnlock(void)
+{
+    (void)LOS_MuxPost(BleGattcBulk.muxHandle);
+}
+
+static uint32_t BleGattcBulkNowMs(void)
+{
+    return (uint32_t)(LOS_TickCountGet() * MS_PER_SECOND / LOSCFG_BASE_CORE_TICK_PER_SECOND);
+}
+
+static BleGattcBulkConn *FindConn(uint16_t connId)
+{
+    for (int i = 0; i < BLE_GATTC_BULK_CONN_MAX; i++) {
+        if (BleGattcBulk.conn[i].used && (BleGattcBulk.conn[i].connId == connId)) {
+            return &BleGattcBulk.conn[i];
+        }
+    }
+    return NULL;
+}
+
+static void StartTimer(void)
+{
+    if ((BleGattcBulk.timer != NULL) && !osTimerIsRunning(BleGattcBulk.timer)) {
+        (void)osTimerStart(BleGattcBulk.timer,
+                           BLE_GATTC_BULK_RETRY_MS * LOSCFG_BASE_CORE_TICK_PER_SECOND / MS_PER_SECOND);
+    }
+}
+
+static void Finish(BleGattcBulkConn *c, int status, BleGattcBulkDone *done)
+{
+    c->result.elapsedMs = BleGattcBulkNowMs() - c->startMs;
+    done->callback = c->callback;
+    done->connId = c->connId;
+    done->status = status;
+    done->result = c->result;
+    c->state = BULK_STATE_IDLE;
+    c->data = NULL;
+}
+
+/* 无响应写按 (MTU - 3) 切分, 除末包外长度一致, 完成事件按顺序累计确认字节数 */
+static void PumpStream(BleGattcBulkConn *c, BleGattcBulkDone *done)
+{
+    uint16_t payload = c->mtu - BLE_ATT_WRITE_HDR_LEN;
+
+    while ((c->sent < c->len) && !c->congested && (c->inflight < BLE_GATTC_BULK_INFLIGHT_MAX)) {
+        uint16_t chunk = (c->len - c->sent < payload) ? (uint16_t)(c->len - c->sent) : payload;
+        if ((esp_ble_get_cur_sendable_packets_num(c->connId) == 0) ||
+            (esp_ble_gattc_write_char(c->gattcIf, c->connId, c->handle, chunk, (uint8_t *)c->data + c->sent,
+                                      ESP_GATT_WRITE_TYPE_NO_RSP, c->auth) != ESP_OK)) {
+            StartTimer();
+            break;
+        }
+        c->sent += chunk;
+        c->inflight++;
+        c->result.packets++;
+    }
+    if ((c->sent == c->len) && (c->inflight == 0)) {
+        Finish(c, ESP_GATT_OK, done);
+    }
+}
+
+static void PrepareNext(BleGattcBulkConn *c, BleGattcBulkDone *done)
+{
+    uint16_t payload = c->mtu - BLE_ATT_PREP_WRITE_HDR_LEN;
+
+    if (c->sent == c->len) {
+        c->state = BULK_STATE_EXECUTE;
+        if (esp_ble_gattc_execute_write(c->gattcIf, c->connId, true) != ESP_OK) {
+            Finish(c, ESP_GATT_ERROR, done);
+        }
+        return;
+    }
+    c->chunk = (c->len - c->sent < payload) ? (uint16_t)(c->len - c->sent) : payload;
+    if (esp_ble_gattc_prepare_write(c->gattcIf, c->connId, c->handle, (uint16_t)c->sent, c->chunk,
+                                    (uint8_t *)c->data + c->sent, c->auth) != ESP_OK) {
+        c->status = ESP_GATT_ERROR;
+        c->state = BULK_STATE_EXECUTE;
+        if (esp_ble_gattc_execute_write(c->gattcIf, c->connId, false) != ESP_OK) {
+            Finish(c, ESP_GATT_ERROR, done);
+        }
+        return;
+    }
+    c->result.packets++;
+}
+
+static void BleGattcBulkTimerProc(void *arg)
+{
+    BleGattcBulkDone done[BLE_GATTC_BULK_CONN_MAX] = {0};
+    (void)arg;
+
+    BleGattcBulkLock();
+    for (int i = 0; i < BLE_GATTC_BULK_CONN_MAX; i++) {
+        if (BleGattcBulk.conn[i].used && (BleGattcBulk.conn[i].state == BULK_STATE_STREAM)) {
+            PumpStream(&BleGattcBulk.conn[i], &done[i]);
+        }
+    }
+    BleGattcBulkUnlock();
+    for (int i = 0; i < BLE_GATTC_BULK_CONN_MAX; i++) {
+        if (done[i].callback != NULL) {
+            done[i].callback(done[i].connId, done[i].status, &done[i].result);
+        }
+    }
+}
+
+BtError BleGattcWriteBulk(GattcWriteChar write_char, const uint8_t *data, uint32_t len, GattBleAuthReq auth_req,
+                          bool reliable, BleGattcBulkCallback callback)
+{
+    BleGattcBulkDone done = {0};
+    BtError ret = BT_SUCCESS;
+
+    if ((data == NULL) || (len == 0) || (reliable && (len > BLE_GATT_ATTR_VALUE_MAX))) {
+        BT_DEBUG("BleGattcWriteBulk param is invalid! \n");
+        return BT_PARAMINPUT_ERROR;
+    }
+    BleGattcBulkLock();
+    BleGattcBulkConn *c = FindConn(write_char.conn_id);
+    if ((c == NULL) || (c->state != BULK_STATE_IDLE)) {
+        BleGattcBulkUnlock();
+        return BT_ERROR;
+    }
+    c->gattcIf = write_char.gattc_if;
+    c->handle = write_char.handle;
+    c->auth = (esp_gatt_auth_req_t)auth_req;
+    c->data = data;
+    c->len = len;
+    c->sent = 0;
+    c->inflight = 0;
+    c->status = ESP_GATT_OK;
+    c->callback = callback;
+    c->startMs = BleGattcBulkNowMs();
+    (void)memset_s(&c->result, sizeof(c->result), 0, sizeof(c->result));
+
+    if (!reliable) {
+        c->state = BULK_STATE_STREAM;
+        PumpStream(c, &done);
+    } else if (len <= (uint32_t)(c->mtu - BLE_ATT_WRITE_HDR_LEN)) {
+        c->state = BULK_STATE_WRITE;
+        if (esp_ble_gattc_write_char(c->gattcIf, c->connId, c->handle, (uint16_t)len, (uint8_t *)data,
+                                     ESP_GATT_WRITE_TYPE_RSP, c->auth) != ESP_OK) {
+            c->state = BULK_STATE_IDLE;
+            ret = BT_ERROR;
+        }
+        c->result.packets++;
+    } else {
+        c->state = BULK_STATE_PREPARE;
+        PrepareNext(c, &done);
+    }
+    BleGattcBulkUnlock();
+    if (done.callback != NULL) {
+        done.callback(done.connId, done.status, &done.result);
+    }
+    return ret;
+}
+
+uint32_t BleGattcBulkPending(uint16_t connId)
+{
+    uint32_t pending = 0;
+    BleGattcBulkLock();
+    BleGattcBulkConn *c = FindConn(connId);
+    if ((c != NULL) && (c->state != BULK_STATE_IDLE)) {
+        pending = c->len - c->sent;
+    }
+    BleGattcBulkUnlock();
+    return pending;
+}
+
+void BleGattcBulkSetCallback(GattcBleCallback callback)
+{
+    BleGattcBulk.callback = callback;
+}
+
+static void OnOpen(esp_gatt_if_t gattcIf, uint16_t connId)
+{
+    BleGattcBulkConn *c = FindConn(connId);
+    for (int i = 0; (c == NULL) && (i < BLE_GATTC_BULK_CONN_MAX); i++) {
+        if (!BleGattcBulk.conn[i].used) {
+            c = &BleGattcBulk.conn[i];
+        }
+    }
+    if (c != NULL) {
+        (void)memset_s(c, sizeof(*c), 0, sizeof(*c));
+        c->used = true;
+        c->gattcIf = gattcIf;
+        c->connId = connId;
+        c->mtu = BLE_GATT_MTU_DEFAULT;
+    }
+}
+
+static void OnClose(uint16_t connId, BleGattcBulkDone *done)
+{
+    BleGattcBulkConn *c = FindConn(connId);
+    if (c != NULL) {
+        if (c->state != BULK_STATE_IDLE) {
+            Finish(c, ESP_GATT_ERROR, done);
+        }
+        c->used = false;
+    }
+}
+
+static void OnWrite(BleGattcBulkConn *c, int status, BleGattcBulkDone *done)
+{
+    if (c->state == BULK_STATE_WRITE) {
+        c->result.written = (status == ESP_GATT_OK) ? c->len : 0;
+        Finish(c, status, done);
+        return;
+    }
+    uint16_t payload = c->mtu - BLE_ATT_WRITE_HDR_LEN;
+    uint32_t unacked = c->sent - c->result.written;
+    c->result.written += (unacked < payload) ? unacked : payload;
+    c->inflight = (c->inflight > 0) ? (c->inflight - 1) : 0;
+    if (status != ESP_GATT_OK) {
+        Finish(c, status, done);
+        return;
+    }
+    PumpStream(c, done);
+}
+
+static void OnPrepare(BleGattcBulkConn *c, int status, BleGattcBulkDone *done)
+{
+    if (status != ESP_GATT_OK) {
+        c->status = status;
+        c->state = BULK_STATE_EXECUTE;
+        if (esp_ble_gattc_execute_write(c->gattcIf, c->connId, false) != ESP_OK) {
+            Finish(c, status, done);
+        }
+        return;
+    }
+    c->sent += c->chunk;
+    PrepareNext(c, done);
+}
+
+/* 返回 false 表示事件属于批量写, 不再转发给应用 */
+static bool OnEvent(esp_gattc_cb_event_t event, esp_gatt_if_t gattcIf, esp_ble_gattc_cb_param_t *param,
+                    BleGattcBulkDone *done)
+{
+    BleGattcBulkConn *c = NULL;
+
+    switch (event) {
+        case ESP_GATTC_OPEN_EVT:
+            if (param->open.status == ESP_GATT_OK) {
+                OnOpen(gattcIf, param->open.conn_id);
+            }
+            break;
+        case ESP_GATTC_CLOSE_EVT:
+            OnClose(param->close.conn_id, done);
+            break;
+        case ESP_GATTC_DISCONNECT_EVT:
+            OnClose(param->disconnect.conn_id, done);
+            break;
+        case ESP_GATTC_CFG_MTU_EVT:
+            c = FindConn(param->cfg_mtu.conn_id);
+            if ((c != NULL) && (param->cfg_mtu.status == ESP_GATT_OK)) {
+                c->mtu = param->cfg_mtu.mtu;
+            }
+            break;
+        case ESP_GATTC_CONGEST_EVT:
+            c = FindConn(param->congest.conn_id);
+            if (c != NULL) {
+                c->congested = param->congest.congested;
+                c->result.congestCount += c->congested ? 1 : 0;
+                if (!c->congested && (c->state == BULK_STATE_STREAM)) {
+                    PumpStream(c, done);
+                }
+            }
+            break;
+        case ESP_GATTC_WRITE_CHAR_EVT:
+            c = FindConn(param->write.conn_id);
+            if ((c != NULL) && ((c->state == BULK_STATE_STREAM) || (c->state == BULK_STATE_WRITE)) &&
+                (param->write.handle == c->handle)) {
+                OnWrite(c, param->write.status, done);
+                return false;
+            }
+            break;
+        case ESP_GATTC_PREP_WRITE_EVT:
+            c = FindConn(param->write.conn_id);
+            if ((c != NULL) && (c->state == BULK_STATE_PREPARE)) {
+                OnPrepare(c, param->write.status, done);
+                return false;
+            }
+            break;
+        case ESP_GATTC_EXEC_EVT:
+            c = FindConn(param->exec_cmpl.conn_id);
+            if ((c != NULL) && (c->state == BULK_STATE_EXECUTE)) {
+                c->result.written = ((c->status == ESP_GATT_OK) && (param->exec_cmpl.status == ESP_GATT_OK)) ?
+                    c->len : 0;
+                Finish(c, (c->status != ESP_GATT_OK) ? c->status : param->exec_cmpl.status, done);
+                return false;
+            }
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+void BleGattcBulkGattcHandler(esp_gattc_cb_event_t event, esp_gatt_if_t gattcIf, esp_ble_gattc_cb_param_t *param)
+{
+    BleGattcBulkDone done = {0};
+
+    BleGattcBulkLock();
+    bool forward = OnEvent(event, gattcIf, param, &done);
+    BleGattcBulkUnlock();
+
+    if (done.callback != NULL) {
+        done.callback(done.connId, done.status, &done.result);
+    }
+    if ((event == ESP_GATTC_OPEN_EVT) && (param->open.status == ESP_GATT_OK)) {
+        BleConnMgrAttach(param->open.conn_id, param->open.remote_bda);
+    } else if (event == ESP_GATTC_DISCONNECT_EVT) {
+        BleConnMgrDetach(param->disconnect.conn_id);
+    }
+    if (forward && (BleGattcBulk.callback != NULL)) {
+        BleGattcBulk.callback((GattcBleCallbackEvent)event, gattcIf, (BleGattcParam *)param);
+    }
+}
+
+static void BleGattcBulkInit(void)
+{
+    if (LOS_MuxCreate(&BleGattcBulk.muxHandle) != LOS_OK) {
+        BT_LOGE("LOS_MuxCreate fail");
+        return;
+    }
+    BleGattcBulk.timer = osTimerNew(BleGattcBulkTimerProc, osTimerOnce, NULL, NULL);
+    if (BleGattcBulk.timer == NULL) {
+        BT_LOGE("osTimerNew fail");
+    }
+}
+SYS_RUN(BleGattcBulkInit);
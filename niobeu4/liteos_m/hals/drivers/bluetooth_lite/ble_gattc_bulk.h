@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __BLE_GATTC_BULK_H__
+#define __BLE_GATTC_BULK_H__
+#include "bluetooth_device.h"
+
+#define BLE_GATTC_BULK_CONN_MAX 3
+#define BLE_GATTC_BULK_INFLIGHT_MAX 8       // 已交给协议栈但未完成的无响应写上限
+#define BLE_GATTC_BULK_RETRY_MS 10          // 无可用发送缓冲时的重试间隔
+#define BLE_GATT_ATTR_VALUE_MAX 512         // 可靠写 (prepare/execute) 的属性值上限
+#define BLE_ATT_WRITE_HDR_LEN 3
+#define BLE_ATT_PREP_WRITE_HDR_LEN 5
+
+typedef struct {
+    uint32_t written;           // 已被协议栈确认的字节数
+    uint32_t elapsedMs;
+    uint32_t packets;
+    uint32_t congestCount;
+} BleGattcBulkResult;
+
+/**
+ * @brief 批量写完成回调, 每次 BleGattcWriteBulk 调用只回调一次
+ *
+ * @param status ESP_GATT_OK 成功, 其余为失败原因
+ */
+typedef void (*BleGattcBulkCallback)(uint16_t connId, int status, const BleGattcBulkResult *result);
+
+/**
+ * @brief 将一段数据批量写入特征值
+ *
+ * reliable 为 false 时, 数据按 (MTU - 3) 切分为无响应写并按协议栈可用缓冲流水发送;
+ * 为 true 时, 不超过一个包的数据使用带响应写, 更长的数据使用 prepare/execute 可靠写,
+ * 长度不超过 BLE_GATT_ATTR_VALUE_MAX. 完成前 data 须保持有效, 同一连接同时只允许一个批量写.
+ *
+ * @param write_char 写参数, 其中 value_len 与 write_type 被忽略
+ * @param data 数据
+ * @param len 数据长度
+ * @param auth_req 鉴权要求
+ * @param reliable 是否使用可靠写
+ * @param callback 完成回调
+ * @return BT_SUCCESS 已开始, BT_PARAMINPUT_ERROR 参数非法, BT_ERROR 连接忙或不存在
+ */
+BtError BleGattcWriteBulk(GattcWriteChar write_char, const uint8_t *data, uint32_t len, GattBleAuthReq auth_req,
+                          bool reliable, BleGattcBulkCallback callback);
+
+/**
+ * @brief 获取连接上尚未发出的批量写字节数, 无批量写时返回 0
+ */
+uint32_t BleGattcBulkPending(uint16_t connId);
+
+/* 以下供 HAL 内部使用 */
+void BleGattcBulkSetCallback(GattcBleCallback callback);
+void BleGattcBulkGattcHandler(esp_gattc_cb_event_t event, esp_gatt_if_t gattcIf, esp_ble_gattc_cb_param_t *param);
+
+#endif
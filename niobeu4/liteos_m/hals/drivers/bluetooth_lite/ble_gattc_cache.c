@@ -0,0 +1,800 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include "fcntl.h"
+#include "sys/stat.h"
+#include "securec.h"
+#include "los_mux.h"
+#include "ohos_init.h"
+#ifdef LOSCFG_FS_LITTLEFS
+#include "littlefs.h"
+#endif
+#include "ble_gattc_cache.h"
+
+#define CACHE_MAGIC 0x47415443      // "GATC"
+#define CACHE_VERSION 2
+#define CACHE_PATH_LEN 64
+#define CACHE_FILE_MODE 0644
+#define GATT_UUID_SRVC_CHG 0x2A05
+#define GATT_UUID_CCCD 0x2902
+#define GATT_CCCD_INDICATE 0x0002
+
+typedef struct {
+    uint16_t startHandle;
+    uint16_t endHandle;
+    uint8_t isPrimary;
+    esp_gatt_id_t id;
+} BleGattcCacheSrvc;
+
+typedef struct {
+    uint16_t charHandle;
+    BleGattcDescrElem elem;
+} BleGattcCacheDescr;
+
+/* 落盘格式, 整体写入 littlefs */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint8_t addr[OHOS_BD_ADDR_LEN];
+    uint8_t hashValid;
+    uint8_t srvcNum;
+    uint8_t charNum;
+    uint8_t descrNum;
+    uint16_t hashHandle;
+    uint16_t srvcChgHandle;     // Service Changed 特征, 回放后由本模块订阅其指示
+    uint16_t srvcChgCccd;
+    uint8_t hash[BLE_GATT_DB_HASH_LEN];
+    BleGattcCacheSrvc srvc[BLE_GATTC_CACHE_SRVC_MAX];
+    BleGattcCharElem chr[BLE_GATTC_CACHE_CHAR_MAX];
+    BleGattcCacheDescr descr[BLE_GATTC_CACHE_DESCR_MAX];
+} BleGattcCacheDb;
+
+typedef struct {
+    bool valid;
+    bool complete;              // 已完成一次完整发现, 可用于回放
+    uint32_t lastUse;
+    BleGattcCacheDb db;
+} BleGattcCachePeer;
+
+typedef struct {
+    bool used;
+    bool fromCache;             // 本次连接的句柄来自缓存, 协议栈内无属性数据库
+    bool regSrvcChg;            // 正在订阅 Service Changed, 对应的协议栈事件不转发
+    bool cfgSrvcChg;
+    bool searching;             // 正在实时发现
+    bool verifying;             // 正在读取 Database Hash 校验缓存
+    bool fetchingHash;          // 实时发现后读取 Database Hash
+    bool hasFilter;
+    esp_gatt_if_t gattcIf;
+    uint16_t connId;
+    esp_bt_uuid_t filter;
+    BleGattcCachePeer *peer;
+} BleGattcCacheConn;
+
+/* 需要调用协议栈接口的后续动作, 在释放模块锁之后执行 */
+typedef enum {
+    CACHE_ACT_NONE = 0,
+    CACHE_ACT_REPLAY,           // 回放缓存, 再订阅 Service Changed
+    CACHE_ACT_SEARCH,           // 缓存失效或对端服务变化, 转为实时发现
+    CACHE_ACT_READ_HASH,        // 实时发现完成, 读取 Database Hash
+} BleGattcCacheActType;
+
+typedef struct {
+    BleGattcCacheActType type;
+    esp_gatt_if_t gattcIf;
+    uint16_t connId;
+    uint16_t hashHandle;
+} BleGattcCacheAct;
+
+typedef struct {
+    GattcBleCallback callback;
+    BleGattcCachePeer peer[BLE_GATTC_CACHE_PEER_MAX];
+    BleGattcCacheConn conn[BLE_GATTC_CACHE_CONN_MAX];
+    BleGattcDescrElem scratch[BLE_GATTC_CACHE_DESCR_MAX];
+    uint32_t useSeq;
+    UINT32 muxHandle;
+} BleGattcCache_t;
+
+static BleGattcCache_t BleGattcCache;
+
+/* 持锁期间只访问本模块数据与文件, 不调用 esp_ble_gattc_* 接口, 避免与协议栈任务互等 */
+static void BleGattcCacheLock(void)
+{
+    (void)LOS_MuxPend(BleGattcCache.muxHandle, LOS_WAIT_FOREVER);
+}
+
+static void BleGattcCacheUnlock(void)
+{
+    (void)LOS_MuxPost(BleGattcCache.muxHandle);
+}
+
+static void BleGattcCacheInit(void)
+{
+    if (LOS_MuxCreate(&BleGattcCache.muxHandle) != LOS_OK) {
+        BT_LOGE("LOS_MuxCreate fail");
+    }
+}
+SYS_RUN(BleGattcCacheInit);
+
+#ifdef LOSCFG_FS_LITTLEFS
+static void CachePath(const uint8_t *addr, char *path, size_t size)
+{
+    (void)snprintf_s(path, size, size - 1, "%s/gattc_%02x%02x%02x%02x%02x%02x.db", GetLittlefsMountPoint(),
+                     addr[0], addr[1], addr[2], addr[3], addr[4], addr[5]);
+}
+
+/* 先写临时文件再改名覆盖, 掉电时保留旧文件或新文件之一 */
+static void CacheSave(const BleGattcCacheDb *db)
+{
+    char path[CACHE_PATH_LEN];
+    char tmp[CACHE_PATH_LEN];
+    CachePath(db->addr, path, sizeof(path));
+    if (snprintf_s(tmp, sizeof(tmp), sizeof(tmp) - 1, "%s.tmp", path) < 0) {
+        return;
+    }
+    int fd = _open(tmp, O_CREAT | O_WRONLY | O_TRUNC, CACHE_FILE_MODE);
+    if (fd < 0) {
+        BT_LOGE("open %s fail", tmp);
+        return;
+    }
+    bool ok = (_write(fd, db, sizeof(*db)) == sizeof(*db));
+    ok = (_close(fd) == 0) && ok;
+    if (!ok || (rename(tmp, path) != 0)) {
+        BT_LOGE("save %s fail", path);
+        (void)_unlink(tmp);
+    }
+}
+
+static bool CacheLoad(const uint8_t *addr, BleGattcCacheDb *db)
+{
+    char path[CACHE_PATH_LEN];
+    CachePath(addr, path, sizeof(path));
+    int fd = _open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    int len = _read(fd, db, sizeof(*db));
+    _close(fd);
+    return (len == sizeof(*db)) && (db->magic == CACHE_MAGIC) && (db->version == CACHE_VERSION) &&
+           (db->size == sizeof(*db)) && (memcmp(db->addr, addr, OHOS_BD_ADDR_LEN) == 0) &&
+           (db->srvcNum <= BLE_GATTC_CACHE_SRVC_MAX) && (db->charNum <= BLE_GATTC_CACHE_CHAR_MAX) &&
+           (db->descrNum <= BLE_GATTC_CACHE_DESCR_MAX);
+}
+
+static void CacheRemove(const uint8_t *addr)
+{
+    char path[CACHE_PATH_LEN];
+    CachePath(addr, path, sizeof(path));
+    (void)_unlink(path);
+}
+#else
+static void CacheSave(const BleGattcCacheDb *db)
+{
+    (void)db;
+}
+
+static bool CacheLoad(const uint8_t *addr, BleGattcCacheDb *db)
+{
+    (void)addr;
+    (void)db;
+    return false;
+}
+
+static void CacheRemove(const uint8_t *addr)
+{
+    (void)addr;
+}
+#endif
+
+static bool UuidEqual(const esp_bt_uuid_t *a, const esp_bt_uuid_t *b)
+{
+    if (a->len != b->len) {
+        return false;
+    }
+    switch (a->len) {
+        case ESP_UUID_LEN_16:
+            return a->uuid.uuid16 == b->uuid.uuid16;
+        case ESP_UUID_LEN_32:
+            return a->uuid.uuid32 == b->uuid.uuid32;
+        default:
+            return memcmp(a->uuid.uuid128, b->uuid.uuid128, ESP_UUID_LEN_128) == 0;
+    }
+}
+
+static BleGattcCacheConn *FindConn(uint16_t connId)
+{
+    for (int i = 0; i < BLE_GATTC_CACHE_CONN_MAX; i++) {
+        if (BleGattcCache.conn[i].used && (BleGattcCache.conn[i].connId == connId)) {
+            return &BleGattcCache.conn[i];
+        }
+    }
+    return NULL;
+}
+
+static BleGattcCachePeer *FindPeer(const uint8_t *addr)
+{
+    for (int i = 0; i < BLE_GATTC_CACHE_PEER_MAX; i++) {
+        BleGattcCachePeer *p = &BleGattcCache.peer[i];
+        if (p->valid && (memcmp(p->db.addr, addr, OHOS_BD_ADDR_LEN) == 0)) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+static bool PeerInUse(const BleGattcCachePeer *p)
+{
+    for (int i = 0; i < BLE_GATTC_CACHE_CONN_MAX; i++) {
+        if (BleGattcCache.conn[i].used && (BleGattcCache.conn[i].peer == p)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void ResetDb(BleGattcCacheDb *db, const uint8_t *addr)
+{
+    (void)memset_s(db, sizeof(*db), 0, sizeof(*db));
+    db->magic = CACHE_MAGIC;
+    db->version = CACHE_VERSION;
+    db->size = sizeof(*db);
+    (void)memcpy_s(db->addr, sizeof(db->addr), addr, OHOS_BD_ADDR_LEN);
+}
+
+/* 内存中按最近使用保留若干对端, 未命中时从 littlefs 加载 */
+static BleGattcCachePeer *AcquirePeer(const uint8_t *addr)
+{
+    BleGattcCachePeer *p = FindPeer(addr);
+    if (p == NULL) {
+        for (int i = 0; i < BLE_GATTC_CACHE_PEER_MAX; i++) {
+            BleGattcCachePeer *e = &BleGattcCache.peer[i];
+            if (PeerInUse(e)) {
+                continue;
+            }
+            if ((p == NULL) || !e->valid || (p->valid && (e->lastUse < p->lastUse))) {
+                p = e;
+            }
+        }
+        if (p == NULL) {
+            return NULL;
+        }
+        p->valid = true;
+        p->complete = CacheLoad(addr, &p->db);
+        if (!p->complete) {
+            ResetDb(&p->db, addr);
+        }
+    }
+    p->lastUse = ++BleGattcCache.useSeq;
+    return p;
+}
+
+static void InvalidatePeer(BleGattcCachePeer *p)
+{
+    CacheRemove(p->db.addr);
+    ResetDb(&p->db, p->db.addr);
+    p->complete = false;
+    for (int i = 0; i < BLE_GATTC_CACHE_CONN_MAX; i++) {
+        if (BleGattcCache.conn[i].used && (BleGattcCache.conn[i].peer == p)) {
+            BleGattcCache.conn[i].fromCache = false;
+        }
+    }
+}
+
+static void StartLiveSearch(BleGattcCacheConn *c)
+{
+    c->fromCache = false;
+    c->verifying = false;
+    c->searching = (c->peer != NULL);
+    if (c->peer != NULL) {
+        ResetDb(&c->peer->db, c->peer->db.addr);
+        c->peer->complete = false;
+    }
+}
+
+/* 实时发现完成后从协议栈数据库读取全部特征与描述符 */
+static void Snapshot(BleGattcCacheConn *c)
+{
+    BleGattcCacheDb *db = &c->peer->db;
+
+    for (uint8_t i = 0; (i < db->srvcNum) && (db->charNum < BLE_GATTC_CACHE_CHAR_MAX); i++) {
+        uint16_t count = BLE_GATTC_CACHE_CHAR_MAX - db->charNum;
+        if (esp_ble_gattc_get_all_char(c->gattcIf, c->connId, db->srvc[i].startHandle, db->srvc[i].endHandle,
+                                       &db->chr[db->charNum], &count, 0) == ESP_GATT_OK) {
+            db->charNum += count;
+        }
+    }
+    for (uint8_t i = 0; i < db->charNum; i++) {
+        uint16_t count = BLE_GATTC_CACHE_DESCR_MAX - db->descrNum;
+        bool srvcChg = (db->chr[i].uuid.len == ESP_UUID_LEN_16) &&
+                       (db->chr[i].uuid.uuid.uuid16 == GATT_UUID_SRVC_CHG);
+        if ((db->chr[i].uuid.len == ESP_UUID_LEN_16) && (db->chr[i].uuid.uuid.uuid16 == BLE_GATT_UUID_DB_HASH)) {
+            db->hashHandle = db->chr[i].char_handle;
+        }
+        if (srvcChg) {
+            db->srvcChgHandle = db->chr[i].char_handle;
+        }
+        if ((count == 0) || (esp_ble_gattc_get_all_descr(c->gattcIf, c->connId, db->chr[i].char_handle,
+                                                         BleGattcCache.scratch, &count, 0) != ESP_GATT_OK)) {
+            continue;
+        }
+        for (uint16_t j = 0; j < count; j++) {
+            if (srvcChg && (BleGattcCache.scratch[j].uuid.len == ESP_UUID_LEN_16) &&
+                (BleGattcCache.scratch[j].uuid.uuid.uuid16 == GATT_UUID_CCCD)) {
+                db->srvcChgCccd = BleGattcCache.scratch[j].handle;
+            }
+            db->descr[db->descrNum].charHandle = db->chr[i].char_handle;
+            db->descr[db->descrNum].elem = BleGattcCache.scratch[j];
+            db->descrNum++;
+        }
+    }
+    c->peer->complete = true;
+}
+
+/* 按应用的过滤 UUID 回放缓存中的服务, 不持锁调用应用回调 */
+static void Replay(esp_gatt_if_t gattcIf, uint16_t connId)
+{
+    BleGattcCacheSrvc srvc[BLE_GATTC_CACHE_SRVC_MAX];
+    esp_ble_gattc_cb_param_t param;
+    uint8_t num = 0;
+
+    BleGattcCacheLock();
+    BleGattcCacheConn *c = FindConn(connId);
+    if ((c != NULL) && (c->peer != NULL)) {
+        for (uint8_t i = 0; i < c->peer->db.srvcNum; i++) {
+            if (!c->hasFilter || UuidEqual(&c->filter, &c->peer->db.srvc[i].id.uuid)) {
+                srvc[num++] = c->peer->db.srvc[i];
+            }
+        }
+    }
+    BleGattcCacheUnlock();
+    if (BleGattcCache.callback == NULL) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < num; i++) {
+        (void)memset_s(&param, sizeof(param), 0, sizeof(param));
+        param.search_res.conn_id = connId;
+        param.search_res.start_handle = srvc[i].startHandle;
+        param.search_res.end_handle = srvc[i].endHandle;
+        param.search_res.srvc_id = srvc[i].id;
+        param.search_res.is_primary = srvc[i].isPrimary;
+        BleGattcCache.callback(OHOS_GATTC_SEARCH_RES_EVT, gattcIf, &param);
+    }
+    (void)memset_s(&param, sizeof(param), 0, sizeof(param));
+    param.search_cmpl.status = ESP_GATT_OK;
+    param.search_cmpl.conn_id = connId;
+    param.search_cmpl.searched_service_source = ESP_GATT_SERVICE_FROM_NVS_FLASH;
+    BleGattcCache.callback(OHOS_GATTC_SEARCH_CMPL_EVT, gattcIf, &param);
+}
+
+/*
+ * 回放只向应用提供句柄, 协议栈内没有属性数据库, 不会识别对端的 Service Changed 指示.
+ * 由本模块订阅该指示, 收到后缓存失效并实时发现; 其余情况整个连接期间由缓存应答查询, 不再做空中发现.
+ */
+static void EnableSrvcChg(esp_gatt_if_t gattcIf, uint16_t connId)
+{
+    uint8_t value[2] = { GATT_CCCD_INDICATE, 0 };     // 2: CCCD 为 16 位小端
+    esp_bd_addr_t addr;
+    uint16_t handle = 0;
+    uint16_t cccd = 0;
+
+    BleGattcCacheLock();
+    BleGattcCacheConn *c = FindConn(connId);
+    if ((c != NULL) && c->fromCache && (c->peer->db.srvcChgHandle != 0) && (c->peer->db.srvcChgCccd != 0)) {
+        handle = c->peer->db.srvcChgHandle;
+        cccd = c->peer->db.srvcChgCccd;
+        (void)memcpy_s(addr, sizeof(addr), c->peer->db.addr, OHOS_BD_ADDR_LEN);
+        c->regSrvcChg = true;
+        c->cfgSrvcChg = true;
+    }
+    BleGattcCacheUnlock();
+    if (handle == 0) {
+        return;
+    }
+    bool regOk = (esp_ble_gattc_register_for_notify(gattcIf, addr, handle) == ESP_OK);
+    bool cfgOk = (esp_ble_gattc_write_char_descr(gattcIf, connId, cccd, sizeof(value), value,
+                                                 ESP_GATT_WRITE_TYPE_RSP, ESP_GATT_AUTH_REQ_NONE) == ESP_OK);
+    if (!regOk || !cfgOk) {
+        BleGattcCacheLock();
+        c = FindConn(connId);
+        if (c != NULL) {
+            c->regSrvcChg = c->regSrvcChg && regOk;
+            c->cfgSrvcChg = c->cfgSrvcChg && cfgOk;
+        }
+        BleGattcCacheUnlock();
+    }
+}
+
+static void RunAction(const BleGattcCacheAct *act)
+{
+    BleGattcCacheConn *c = NULL;
+
+    switch (act->type) {
+        case CACHE_ACT_REPLAY:
+            Replay(act->gattcIf, act->connId);
+            EnableSrvcChg(act->gattcIf, act->connId);
+            break;
+        case CACHE_ACT_SEARCH:
+            if (esp_ble_gattc_search_service(act->gattcIf, act->connId, NULL) != ESP_OK) {
+                BleGattcCacheLock();
+                c = FindConn(act->connId);
+                if (c != NULL) {
+                    c->searching = false;
+                }
+                BleGattcCacheUnlock();
+            }
+            break;
+        case CACHE_ACT_READ_HASH:
+            if (esp_ble_gattc_read_char(act->gattcIf, act->connId, act->hashHandle, ESP_GATT_AUTH_REQ_NONE) != ESP_OK) {
+                BleGattcCacheLock();
+                c = FindConn(act->connId);
+                if ((c != NULL) && c->fetchingHash) {
+                    c->fetchingHash = false;
+                    CacheSave(&c->peer->db);
+                }
+                BleGattcCacheUnlock();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+BtError BleGattcCacheSearch(esp_gatt_if_t gattcIf, uint16_t connId, const BtUuids *filter)
+{
+    uint16_t hashHandle = 0;
+
+    BleGattcCacheLock();
+    BleGattcCacheConn *c = FindConn(connId);
+    if (c == NULL) {
+        BleGattcCacheUnlock();
+        return esp_ble_gattc_search_service(gattcIf, connId, (esp_bt_uuid_t *)filter);
+    }
+    c->hasFilter = (filter != NULL);
+    if (filter != NULL) {
+        c->filter = *filter;
+    }
+    if ((c->peer != NULL) && c->peer->complete) {
+        if (c->peer->db.hashValid) {
+            c->verifying = true;
+            hashHandle = c->peer->db.hashHandle;
+        } else {
+            c->fromCache = true;
+        }
+    } else {
+        StartLiveSearch(c);
+    }
+    bool replay = c->fromCache;
+    BleGattcCacheUnlock();
+
+    if (replay) {
+        Replay(gattcIf, connId);
+        EnableSrvcChg(gattcIf, connId);
+        return BT_SUCCESS;
+    }
+    if ((hashHandle != 0) &&
+        (esp_ble_gattc_read_char(gattcIf, connId, hashHandle, ESP_GATT_AUTH_REQ_NONE) == ESP_OK)) {
+        return BT_SUCCESS;
+    }
+    // 解锁期间连接可能已断开, 重新查找
+    BleGattcCacheLock();
+    c = FindConn(connId);
+    if (c != NULL) {
+        StartLiveSearch(c);
+    }
+    BleGattcCacheUnlock();
+    return esp_ble_gattc_search_service(gattcIf, connId, NULL);
+}
+
+static void OnOpen(esp_gatt_if_t gattcIf, const esp_ble_gattc_cb_param_t *param)
+{
+    BleGattcCacheConn *c = FindConn(param->open.conn_id);
+    for (int i = 0; (c == NULL) && (i < BLE_GATTC_CACHE_CONN_MAX); i++) {
+        if (!BleGattcCache.conn[i].used) {
+            c = &BleGattcCache.conn[i];
+        }
+    }
+    if (c == NULL) {
+        return;
+    }
+    (void)memset_s(c, sizeof(*c), 0, sizeof(*c));
+    c->used = true;
+    c->gattcIf = gattcIf;
+    c->connId = param->open.conn_id;
+    c->peer = AcquirePeer(param->open.remote_bda);
+}
+
+static bool OnSearchRes(BleGattcCacheConn *c, const esp_ble_gattc_cb_param_t *param)
+{
+    BleGattcCacheDb *db = &c->peer->db;
+    if (db->srvcNum < BLE_GATTC_CACHE_SRVC_MAX) {
+        BleGattcCacheSrvc *s = &db->srvc[db->srvcNum++];
+        s->startHandle = param->search_res.start_handle;
+        s->endHandle = param->search_res.end_handle;
+        s->isPrimary = param->search_res.is_primary;
+        s->id = param->search_res.srvc_id;
+    }
+    return !c->hasFilter || UuidEqual(&c->filter, &param->search_res.srvc_id.uuid);
+}
+
+static void OnSearchCmpl(BleGattcCacheConn *c, const esp_ble_gattc_cb_param_t *param, BleGattcCacheAct *act)
+{
+    c->searching = false;
+    if (param->search_cmpl.status != ESP_GATT_OK) {
+        return;
+    }
+    Snapshot(c);
+    if (c->peer->db.hashHandle != 0) {
+        c->fetchingHash = true;
+        act->type = CACHE_ACT_READ_HASH;
+        act->connId = c->connId;
+        act->hashHandle = c->peer->db.hashHandle;
+        return;
+    }
+    CacheSave(&c->peer->db);
+}
+
+static void OnHashRead(BleGattcCacheConn *c, const esp_ble_gattc_cb_param_t *param, BleGattcCacheAct *act)
+{
+    BleGattcCacheDb *db = &c->peer->db;
+    bool ok = (param->read.status == ESP_GATT_OK) && (param->read.value_len == BLE_GATT_DB_HASH_LEN);
+
+    if (c->fetchingHash) {
+        c->fetchingHash = false;
+        if (ok) {
+            (void)memcpy_s(db->hash, sizeof(db->hash), param->read.value, BLE_GATT_DB_HASH_LEN);
+            db->hashValid = 1;
+        }
+        CacheSave(db);
+        return;
+    }
+    c->verifying = false;
+    if (ok && (memcmp(db->hash, param->read.value, BLE_GATT_DB_HASH_LEN) == 0)) {
+        c->fromCache = true;
+        act->type = CACHE_ACT_REPLAY;
+        act->connId = c->connId;
+        return;
+    }
+    InvalidatePeer(c->peer);
+    StartLiveSearch(c);
+    act->type = CACHE_ACT_SEARCH;
+    act->connId = c->connId;
+}
+
+/* 回放的连接收到 Service Changed 指示: 缓存失效, 实时发现并把结果转发给应用 */
+static void OnSrvcChgInd(BleGattcCacheConn *c, BleGattcCacheAct *act)
+{
+    InvalidatePeer(c->peer);
+    StartLiveSearch(c);
+    act->type = CACHE_ACT_SEARCH;
+    act->connId = c->connId;
+}
+
+/* 本模块发起的订阅结果不转发 */
+static bool OnSrvcChgCfg(esp_gattc_cb_event_t event, const esp_ble_gattc_cb_param_t *param)
+{
+    for (int i = 0; i < BLE_GATTC_CACHE_CONN_MAX; i++) {
+        BleGattcCacheConn *c = &BleGattcCache.conn[i];
+        if (!c->used || (c->peer == NULL)) {
+            continue;
+        }
+        if ((event == ESP_GATTC_REG_FOR_NOTIFY_EVT) && c->regSrvcChg &&
+            (param->reg_for_notify.handle == c->peer->db.srvcChgHandle)) {
+            c->regSrvcChg = false;
+            return false;
+        }
+        if ((event == ESP_GATTC_WRITE_DESCR_EVT) && c->cfgSrvcChg && (param->write.conn_id == c->connId) &&
+            (param->write.handle == c->peer->db.srvcChgCccd)) {
+            c->cfgSrvcChg = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool OnEvent(esp_gattc_cb_event_t event, esp_gatt_if_t gattcIf, esp_ble_gattc_cb_param_t *param,
+                    BleGattcCacheAct *act)
+{
+    BleGattcCacheConn *c = NULL;
+    BleGattcCachePeer *p = NULL;
+
+    switch (event) {
+        case ESP_GATTC_OPEN_EVT:
+            if (param->open.status == ESP_GATT_OK) {
+                OnOpen(gattcIf, param);
+            }
+            break;
+        case ESP_GATTC_SEARCH_RES_EVT:
+            c = FindConn(param->search_res.conn_id);
+            if ((c != NULL) && c->searching) {
+                return OnSearchRes(c, param);
+            }
+            break;
+        case ESP_GATTC_SEARCH_CMPL_EVT:
+            c = FindConn(param->search_cmpl.conn_id);
+            if ((c != NULL) && c->searching) {
+                OnSearchCmpl(c, param, act);
+            }
+            break;
+        case ESP_GATTC_READ_CHAR_EVT:
+            c = FindConn(param->read.conn_id);
+            if ((c != NULL) && (c->verifying || c->fetchingHash) && (param->read.handle == c->peer->db.hashHandle)) {
+                OnHashRead(c, param, act);
+                return false;
+            }
+            break;
+        case ESP_GATTC_NOTIFY_EVT:
+            c = FindConn(param->notify.conn_id);
+            if ((c != NULL) && c->fromCache && (c->peer != NULL) && (c->peer->db.srvcChgHandle != 0) &&
+                (param->notify.handle == c->peer->db.srvcChgHandle)) {
+                OnSrvcChgInd(c, act);
+            }
+            break;
+        case ESP_GATTC_REG_FOR_NOTIFY_EVT:
+        case ESP_GATTC_WRITE_DESCR_EVT:
+            return OnSrvcChgCfg(event, param);
+        case ESP_GATTC_SRVC_CHG_EVT:
+            p = FindPeer(param->srvc_chg.remote_bda);
+            if (p != NULL) {
+                InvalidatePeer(p);
+            } else {
+                CacheRemove(param->srvc_chg.remote_bda);
+            }
+            break;
+        case ESP_GATTC_CLOSE_EVT:
+            c = FindConn(param->close.conn_id);
+            if (c != NULL) {
+                c->used = false;
+            }
+            break;
+        case ESP_GATTC_DISCONNECT_EVT:
+            c = FindConn(param->disconnect.conn_id);
+            if (c != NULL) {
+                c->used = false;
+            }
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+void BleGattcCacheGattcHandler(esp_gattc_cb_event_t event, esp_gatt_if_t gattcIf, esp_ble_gattc_cb_param_t *param)
+{
+    BleGattcCacheAct act = { .type = CACHE_ACT_NONE, .gattcIf = gattcIf };
+
+    BleGattcCacheLock();
+    bool forward = OnEvent(event, gattcIf, param, &act);
+    BleGattcCacheUnlock();
+    if (act.type != CACHE_ACT_NONE) {
+        RunAction(&act);
+    }
+    if (forward && (BleGattcCache.callback != NULL)) {
+        BleGattcCache.callback((GattcBleCallbackEvent)event, gattcIf, (BleGattcParam *)param);
+    }
+}
+
+void BleGattcCacheSetCallback(GattcBleCallback callback)
+{
+    BleGattcCache.callback = callback;
+}
+
+void BleGattcCacheClear(const uint8_t *addr)
+{
+    BleGattcCacheLock();
+    for (int i = 0; i < BLE_GATTC_CACHE_PEER_MAX; i++) {
+        BleGattcCachePeer *p = &BleGattcCache.peer[i];
+        if (p->valid && ((addr == NULL) || (memcmp(p->db.addr, addr, OHOS_BD_ADDR_LEN) == 0))) {
+            InvalidatePeer(p);
+            p->valid = PeerInUse(p);
+        }
+    }
+    if (addr != NULL) {
+        CacheRemove(addr);
+    }
+    BleGattcCacheUnlock();
+}
+
+/* 以下查询仅在本次连接使用缓存句柄时接管, 否则返回 false 由协议栈数据库应答 */
+static BleGattcCacheConn *CachedConn(uint16_t connId)
+{
+    BleGattcCacheConn *c = FindConn(connId);
+    return ((c != NULL) && c->fromCache && (c->peer != NULL)) ? c : NULL;
+}
+
+bool BleGattcCacheGetAttrCount(const GattcGetAttr *getAttr, uint16_t charHandle, uint16_t *count,
+                               esp_gatt_status_t *status)
+{
+    uint16_t num = 0;
+    BleGattcCacheLock();
+    BleGattcCacheConn *c = CachedConn(getAttr->conn_id);
+    if (c == NULL) {
+        BleGattcCacheUnlock();
+        return false;
+    }
+    const BleGattcCacheDb *db = &c->peer->db;
+    if ((getAttr->type == ESP_GATT_DB_PRIMARY_SERVICE) || (getAttr->type == ESP_GATT_DB_SECONDARY_SERVICE) ||
+        (getAttr->type == ESP_GATT_DB_ALL)) {
+        for (uint8_t i = 0; i < db->srvcNum; i++) {
+            bool primary = (getAttr->type == ESP_GATT_DB_PRIMARY_SERVICE);
+            if ((db->srvc[i].startHandle >= getAttr->start_handle) && (db->srvc[i].endHandle <= getAttr->end_handle) &&
+                ((getAttr->type == ESP_GATT_DB_ALL) || (db->srvc[i].isPrimary == primary))) {
+                num++;
+            }
+        }
+    }
+    if ((getAttr->type == ESP_GATT_DB_CHARACTERISTIC) || (getAttr->type == ESP_GATT_DB_ALL)) {
+        for (uint8_t i = 0; i < db->charNum; i++) {
+            num += ((db->chr[i].char_handle >= getAttr->start_handle) &&
+                    (db->chr[i].char_handle <= getAttr->end_handle)) ? 1 : 0;
+        }
+    }
+    if ((getAttr->type == ESP_GATT_DB_DESCRIPTOR) || (getAttr->type == ESP_GATT_DB_ALL)) {
+        for (uint8_t i = 0; i < db->descrNum; i++) {
+            num += ((getAttr->type == ESP_GATT_DB_ALL) || (db->descr[i].charHandle == charHandle)) ? 1 : 0;
+        }
+    }
+    BleGattcCacheUnlock();
+    *count = num;
+    *status = (num > 0) ? ESP_GATT_OK : ESP_GATT_NOT_FOUND;
+    return true;
+}
+
+bool BleGattcCacheGetChar(const GattcGetChar *getChar, const BtUuids *uuid, BleGattcCharElem *result,
+                          uint16_t *count, esp_gatt_status_t *status)
+{
+    uint16_t num = 0;
+    BleGattcCacheLock();
+    BleGattcCacheConn *c = CachedConn(getChar->conn_id);
+    if (c == NULL) {
+        BleGattcCacheUnlock();
+        return false;
+    }
+    const BleGattcCacheDb *db = &c->peer->db;
+    for (uint8_t i = 0; (i < db->charNum) && (num < *count); i++) {
+        if ((db->chr[i].char_handle >= getChar->start_handle) && (db->chr[i].char_handle <= getChar->end_handle) &&
+            UuidEqual(&db->chr[i].uuid, uuid)) {
+            result[num++] = db->chr[i];
+        }
+    }
+    BleGattcCacheUnlock();
+    *count = num;
+    *status = (num > 0) ? ESP_GATT_OK : ESP_GATT_NOT_FOUND;
+    return true;
+}
+
+bool BleGattcCacheGetDescr(const GattcGetDescr *getDescr, BleGattcDescrElem *result, uint16_t *count,
+                           esp_gatt_status_t *status)
+{
+    uint16_t num = 0;
+    BleGattcCacheLock();
+    BleGattcCacheConn *c = CachedConn(getDescr->conn_id);
+    if (c == NULL) {
+        BleGattcCacheUnlock();
+        return false;
+    }
+    const BleGattcCacheDb *db = &c->peer->db;
+    for (uint8_t i = 0; (i < db->descrNum) && (num < *count); i++) {
+        if ((db->descr[i].charHandle == getDescr->char_handle) &&
+            UuidEqual(&db->descr[i].elem.uuid, &getDescr->descr_uuid)) {
+            result[num++] = db->descr[i].elem;
+        }
+    }
+    BleGattcCacheUnlock();
+    *count = num;
+    *status = (num > 0) ? ESP_GATT_OK : ESP_GATT_NOT_FOUND;
+    return true;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __BLE_GATTC_CACHE_H__
+#define __BLE_GATTC_CACHE_H__
+#include "bluetooth_device.h"
+
+#define BLE_GATTC_CACHE_PEER_MAX 3
+#define BLE_GATTC_CACHE_CONN_MAX 3
+#define BLE_GATTC_CACHE_SRVC_MAX 12
+#define BLE_GATTC_CACHE_CHAR_MAX 32
+#define BLE_GATTC_CACHE_DESCR_MAX 32
+#define BLE_GATT_DB_HASH_LEN 16
+#define BLE_GATT_UUID_DB_HASH 0x2B2A
+
+/**
+ * @brief 清除指定对端的属性缓存, addr 为 NULL 时清除全部
+ */
+void BleGattcCacheClear(const uint8_t *addr);
+
+/*
+ * 以下供 HAL 内部使用.
+ * 首次连接时完整发现服务, 并把服务/特征/描述符句柄保存到 littlefs;
+ * 再次连接同一对端时直接回放缓存并订阅 Service Changed 指示, 整个连接期间由缓存应答查询, 不做空中发现.
+ * 对端提供 Database Hash 特征时先读取并比较, 不一致或收到 Service Changed 指示时缓存失效并实时发现.
+ */
+void BleGattcCacheSetCallback(GattcBleCallback callback);
+void BleGattcCacheGattcHandler(esp_gattc_cb_event_t event, esp_gatt_if_t gattcIf, esp_ble_gattc_cb_param_t *param);
+BtError BleGattcCacheSearch(esp_gatt_if_t gattcIf, uint16_t connId, const BtUuids *filter);
+bool BleGattcCacheGetAttrCount(const GattcGetAttr *getAttr, uint16_t charHandle, uint16_t *count,
+                               esp_gatt_status_t *status);
+bool BleGattcCacheGetChar(const GattcGetChar *getChar, const BtUuids *uuid, BleGattcCharElem *result,
+                          uint16_t *count, esp_gatt_status_t *status);
+bool BleGattcCacheGetDescr(const GattcGetDescr *getDescr, BleGattcDescrElem *result, uint16_t *count,
+                           esp_gatt_status_t *status);
+
+#endif
@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "securec.h"
+#include "cmsis_os2.h"
+#include "los_mux.h"
+#include "los_tick.h"
+#include "ohos_init.h"
+#include "ble_gatts_tx.h"
+#include "ble_conn_mgr.h"
+
+#define MS_PER_SECOND 1000
+#define REC_HDR_LEN 4
+#define REC_CONFIRM_BIT 0x8000
+#define REC_LEN_MASK 0x7FFF
+#define BYTE_BITS 8
+#define BYTE_MASK 0xFF
+#define RING_MASK (BLE_GATTS_TX_QUEUE_SIZE - 1)
+
+/* 队列中每段数据以 4 字节头开始: 句柄(2) + 长度(2, 最高位为指示标志) */
+typedef struct {
+    uint16_t handle;
+    uint16_t len;
+    bool confirm;
+} BleGattsTxRec;
+
+typedef struct {
+    bool used;
+    bool congested;
+    bool indicating;            // 有指示在途, 等待对端确认
+    uint8_t inflight;           // 在途通知包数
+    GattInterfaceType gattsIf;
+    uint16_t connId;
+    uint16_t mtu;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t queuedBytes;
+    uint32_t startMs;
+    BleGattsTxStats stats;
+    uint8_t ring[BLE_GATTS_TX_QUEUE_SIZE];
+} BleGattsTxConn;
+
+typedef struct {
+    GattsBleCallback callback;
+    BleGattsTxConn conn[BLE_GATTS_TX_CONN_MAX];
+    uint8_t pkt[BLE_GATT_MTU_MAX - BLE_ATT_NOTIFY_HDR_LEN];
+    UINT32 muxHandle;
+    osTimerId_t timer;
+} BleGattsTx_t;
+
+static BleGattsTx_t BleGattsTx;
+
+static void BleGattsTxLock(void)
+{
+    (void)LOS_MuxPend(BleGattsTx.muxHandle, LOS_WAIT_FOREVER);
+}
+
+static void BleGattsTxUnlock(void)
+{
+    (void)LOS_MuxPost(BleGattsTx.muxHandle);
+}
+
+static uint32_t BleGattsTxNowMs(void)
+{
+    return (uint32_t)(LOS_TickCountGet() * MS_PER_SECOND / LOSCFG_BASE_CORE_TICK_PER_SECOND);
+}
+
+static BleGattsTxConn *FindConn(uint16_t connId)
+{
+    for (int i = 0; i < BLE_GATTS_TX_CONN_MAX; i++) {
+        if (BleGattsTx.conn[i].used && (BleGattsTx.conn[i].connId == connId)) {
+            return &BleGattsTx.conn[i];
+        }
+    }
+    return NULL;
+}
+
+static void RingWrite(BleGattsTxConn *c, const uint8_t *data, uint32_t len)
+{
+    uint32_t pos = c->tail & RING_MASK;
+    uint32_t first = BLE_GATTS_TX_QUEUE_SIZE - pos;
+
+    first = (first < len) ? first : len;
+    (void)memcpy_s(&c->ring[pos], BLE_GATTS_TX_QUEUE_SIZE - pos, data, first);
+    if (len > first) {
+        (void)memcpy_s(c->ring, BLE_GATTS_TX_QUEUE_SIZE, data + first, len - first);
+    }
+    c->tail += len;
+}
+
+static void RingRead(const BleGattsTxConn *c, uint32_t offset, uint8_t *out, uint32_t len)
+{
+    uint32_t pos = (c->head + offset) & RING_MASK;
+    uint32_t first = BLE_GATTS_TX_QUEUE_SIZE - pos;
+
+    first = (first < len) ? first : len;
+    (void)memcpy_s(out, len, &c->ring[pos], first);
+    if (len > first) {
+        (void)memcpy_s(out + first, len - first, c->ring, len - first);
+    }
+}
+
+static bool PeekRec(const BleGattsTxConn *c, uint32_t offset, BleGattsTxRec *rec)
+{
+    uint8_t hdr[REC_HDR_LEN];
+    if (c->head + offset == c->tail) {
+        return false;
+    }
+    RingRead(c, offset, hdr, sizeof(hdr));
+    rec->handle = (uint16_t)(hdr[0] | (hdr[1] << BYTE_BITS));
+    rec->len = (uint16_t)(hdr[2] | (hdr[3] << BYTE_BITS));
+    rec->confirm = (rec->len & REC_CONFIRM_BIT) != 0;
+    rec->len &= REC_LEN_MASK;
+    return true;
+}
+
+/* 毫秒向上取整为 tick, 攒包时间短于一个 tick 时至少等待一个 tick */
+static void StartTimer(uint32_t ms)
+{
+    uint32_t ticks = (ms * LOSCFG_BASE_CORE_TICK_PER_SECOND + MS_PER_SECOND - 1) / MS_PER_SECOND;
+    if ((BleGattsTx.timer != NULL) && !osTimerIsRunning(BleGattsTx.timer)) {
+        (void)osTimerStart(BleGattsTx.timer, (ticks == 0) ? 1 : ticks);
+    }
+}
+
+/*
+ * 从队首拼包并发送, 直到队列为空, 链路拥塞, 指示在途或协议栈无可用缓冲.
+ * force 为 false 时, 队尾不足一个 MTU 的通知数据留待攒包定时器发送.
+ */
+static void Pump(BleGattsTxConn *c, bool force)
+{
+    uint16_t payload = c->mtu - BLE_ATT_NOTIFY_HDR_LEN;
+    BleGattsTxRec first;
+    BleGattsTxRec rec;
+
+    while (!c->congested && !c->indicating && PeekRec(c, 0, &first)) {
+        if (first.confirm ? (c->inflight > 0) : (c->inflight >= BLE_GATTS_TX_INFLIGHT_MAX)) {
+            return;
+        }
+        if (!first.confirm && (esp_ble_get_cur_sendable_packets_num(c->connId) == 0)) {
+            StartTimer(BLE_GATTS_TX_RETRY_MS);
+            return;
+        }
+
+        uint32_t offset = 0;
+        uint16_t pktLen = 0;
+        bool closed = false;
+        while (PeekRec(c, offset, &rec)) {
+            if ((rec.handle != first.handle) || (rec.confirm != first.confirm) || (pktLen + rec.len > payload)) {
+                closed = true;
+                break;
+            }
+            RingRead(c, offset + REC_HDR_LEN, &BleGattsTx.pkt[pktLen], rec.len);
+            pktLen += rec.len;
+            offset += REC_HDR_LEN + rec.len;
+        }
+        if (!closed && !force && !first.confirm && (pktLen < payload)) {
+            StartTimer(BLE_GATTS_TX_COALESCE_MS);
+            return;
+        }
+
+        if (esp_ble_gatts_send_indicate(c->gattsIf, c->connId, first.handle, pktLen, BleGattsTx.pkt,
+                                        first.confirm) != ESP_OK) {
+            StartTimer(BLE_GATTS_TX_RETRY_MS);
+            return;
+        }
+        if (c->stats.sentPackets == 0) {
+            c->startMs = BleGattsTxNowMs();
+        }
+        c->head += offset;
+        c->queuedBytes -= pktLen;
+        c->stats.sentBytes += pktLen;
+        c->stats.sentPackets++;
+        if (first.confirm) {
+            c->indicating = true;
+        } else {
+            c->inflight++;
+        }
+    }
+}
+
+static void BleGattsTxTimerProc(void *arg)
+{
+    (void)arg;
+    BleGattsTxLock();
+    for (int i = 0; i < BLE_GATTS_TX_CONN_MAX; i++) {
+        if (BleGattsTx.conn[i].used) {
+            Pump(&BleGattsTx.conn[i], true);
+        }
+    }
+    BleGattsTxUnlock();
+}
+
+BtError BleGattsTxEnqueue(uint16_t connId, uint16_t attrHandle, const uint8_t *data, uint16_t len,
+                          bool needConfirm)
+{
+    uint8_t hdr[REC_HDR_LEN];
+    uint16_t lenField = len | (needConfirm ? REC_CONFIRM_BIT : 0);
+    BtError ret = BT_SUCCESS;
+
+    if ((data == NULL) || (len == 0) || (len > REC_LEN_MASK)) {
+        return BT_PARAMINPUT_ERROR;
+    }
+    hdr[0] = attrHandle & BYTE_MASK;
+    hdr[1] = attrHandle >> BYTE_BITS;
+    hdr[2] = lenField & BYTE_MASK;
+    hdr[3] = lenField >> BYTE_BITS;
+
+    BleGattsTxLock();
+    BleGattsTxConn *c = FindConn(connId);
+    if ((c == NULL) || (len > c->mtu - BLE_ATT_NOTIFY_HDR_LEN)) {
+        ret = BT_PARAMINPUT_ERROR;
+    } else if (BLE_GATTS_TX_QUEUE_SIZE - (c->tail - c->head) < (uint32_t)len + REC_HDR_LEN) {
+        c->stats.droppedBytes += len;
+        ret = BT_ERROR;
+    } else {
+        RingWrite(c, hdr, sizeof(hdr));
+        RingWrite(c, data, len);
+        c->queuedBytes += len;
+        Pump(c, false);
+    }
+    BleGattsTxUnlock();
+    return ret;
+}
+
+BtError BleGattsTxFlush(uint16_t connId)
+{
+    BtError ret = BT_SUCCESS;
+    BleGattsTxLock();
+    BleGattsTxConn *c = FindConn(connId);
+    if (c == NULL) {
+        ret = BT_PARAMINPUT_ERROR;
+    } else {
+        Pump(c, true);
+    }
+    BleGattsTxUnlock();
+    return ret;
+}
+
+BtError BleGattsTxGetStats(uint16_t connId, BleGattsTxStats *stats)
+{
+    BtError ret = BT_SUCCESS;
+    if (stats == NULL) {
+        return BT_PARAMINPUT_ERROR;
+    }
+    BleGattsTxLock();
+    BleGattsTxConn *c = FindConn(connId);
+    if (c == NULL) {
+        ret = BT_PARAMINPUT_ERROR;
+    } else {
+        uint32_t elapsed = BleGattsTxNowMs() - c->startMs;
+        *stats = c->stats;
+        stats->mtu = c->mtu;
+        stats->congested = c->congested;
+        stats->queuedBytes = c->queuedBytes;
+        stats->throughput = ((c->stats.sentPackets > 0) && (elapsed > 0)) ?
+            (uint32_t)((uint64_t)c->stats.sentBytes * MS_PER_SECOND / elapsed) : 0;
+    }
+    BleGattsTxUnlock();
+    return ret;
+}
+
+uint32_t BleGattsTxQueuedBytes(uint16_t connId)
+{
+    uint32_t bytes = 0;
+    BleGattsTxLock();
+    BleGattsTxConn *c = FindConn(connId);
+    if (c != NULL) {
+        bytes = c->queuedBytes;
+    }
+    BleGattsTxUnlock();
+    return bytes;
+}
+
+void BleGattsTxSetCallback(GattsBleCallback callback)
+{
+    BleGattsTx.callback = callback;
+}
+
+static void BleGattsTxOnConnect(esp_gatt_if_t gattsIf, uint16_t connId)
+{
+    for (int i = 0; i < BLE_GATTS_TX_CONN_MAX; i++) {
+        BleGattsTxConn *c = &BleGattsTx.conn[i];
+        if (!c->used) {
+            (void)memset_s(c, sizeof(*c), 0, sizeof(*c));
+            c->used = true;
+            c->gattsIf = gattsIf;
+            c->connId = connId;
+            c->mtu = BLE_GATT_MTU_DEFAULT;
+            return;
+        }
+    }
+    BT_LOGE("no tx slot for conn %u", connId);
+}
+
+static void BleGattsTxOnEvent(esp_gatts_cb_event_t event, esp_gatt_if_t gattsIf, esp_ble_gatts_cb_param_t *param)
+{
+    BleGattsTxConn *c = NULL;
+    switch (event) {
+        case ESP_GATTS_CONNECT_EVT:
+            BleGattsTxOnConnect(gattsIf, param->connect.conn_id);
+            break;
+        case ESP_GATTS_DISCONNECT_EVT:
+            c = FindConn(param->disconnect.conn_id);
+            if (c != NULL) {
+                c->used = false;
+            }
+            break;
+        case ESP_GATTS_MTU_EVT:
+            c = FindConn(param->mtu.conn_id);
+            if (c != NULL) {
+                c->mtu = (param->mtu.mtu > BLE_GATT_MTU_MAX) ? BLE_GATT_MTU_MAX : param->mtu.mtu;
+                Pump(c, false);
+            }
+            break;
+        case ESP_GATTS_CONF_EVT:
+            c = FindConn(param->conf.conn_id);
+            if (c != NULL) {
+                if (c->indicating) {
+                    c->indicating = false;
+                } else if (c->inflight > 0) {
+                    c->inflight--;
+                }
+                Pump(c, false);
+            }
+            break;
+        case ESP_GATTS_CONGEST_EVT:
+            c = FindConn(param->congest.conn_id);
+            if (c != NULL) {
+                c->congested = param->congest.congested;
+                c->stats.congestCount += c->congested ? 1 : 0;
+                Pump(c, false);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void BleGattsTxGattsHandler(esp_gatts_cb_event_t event, esp_gatt_if_t gattsIf, esp_ble_gatts_cb_param_t *param)
+{
+    BleGattsTxLock();
+    BleGattsTxOnEvent(event, gattsIf, param);
+    BleGattsTxUnlock();
+    if (event == ESP_GATTS_CONNECT_EVT) {
+        BleConnMgrAttach(param->connect.conn_id, param->connect.remote_bda);
+    } else if (event == ESP_GATTS_DISCONNECT_EVT) {
+        BleConnMgrDetach(param->disconnect.conn_id);
+    }
+    if (BleGattsTx.callback != NULL) {
+        BleGattsTx.callback((GattsBleCallbackEvent)event, gattsIf, (BleGattsParam *)param);
+    }
+}
+
+static void BleGattsTxInit(void)
+{
+    if (LOS_MuxCreate(&BleGattsTx.muxHandle) != LOS_OK) {
+        BT_LOGE("LOS_MuxCreate fail");
+        return;
+    }
+    BleGattsTx.timer = osTimerNew(BleGattsTxTimerProc, osTimerOnce, NULL, NULL);
+    if (BleGattsTx.timer == NULL) {
+        BT_LOGE("osTimerNew fail");
+    }
+}
+SYS_RUN(BleGattsTxInit);
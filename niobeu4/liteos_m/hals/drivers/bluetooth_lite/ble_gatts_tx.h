@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __BLE_GATTS_TX_H__
+#define __BLE_GATTS_TX_H__
+#include "bluetooth_service.h"
+
+#define BLE_GATTS_TX_CONN_MAX 3
+#define BLE_GATTS_TX_QUEUE_SIZE 2048        // 每个连接的发送队列字节数, 需为 2 的幂
+#define BLE_GATTS_TX_INFLIGHT_MAX 8         // 已交给协议栈但未完成的通知包上限
+#define BLE_GATTS_TX_COALESCE_MS 5          // 不足一个 MTU 时的最长攒包时间
+#define BLE_GATTS_TX_RETRY_MS 10            // 无可用发送缓冲时的重试间隔
+#define BLE_GATT_MTU_DEFAULT 23
+#define BLE_GATT_MTU_MAX 517
+#define BLE_ATT_NOTIFY_HDR_LEN 3
+
+typedef struct {
+    uint16_t mtu;
+    bool congested;
+    uint32_t queuedBytes;       // 队列中尚未发送的字节数
+    uint32_t sentBytes;
+    uint32_t sentPackets;
+    uint32_t droppedBytes;      // 队列满被拒绝的字节数
+    uint32_t congestCount;
+    uint32_t throughput;        // 自首包发送以来的平均吞吐, 字节/秒
+} BleGattsTxStats;
+
+/**
+ * @brief 将一段数据加入连接的发送队列
+ *
+ * 同一属性句柄, 同一确认方式的相邻数据会被拼接到一个 (MTU - 3) 字节的包中发出,
+ * 单段数据不会跨包拆分, 因此数据本身需自带帧格式. needConfirm 为 false 时使用通知,
+ * 多个通知包按协议栈可用缓冲流水发送; 为 true 时使用指示, 同一时刻只有一个在途.
+ *
+ * @param connId 连接 ID
+ * @param attrHandle 特征值句柄
+ * @param data 数据
+ * @param len 数据长度, 不超过当前 MTU - 3
+ * @param needConfirm 是否使用指示
+ * @return BT_SUCCESS 成功, BT_PARAMINPUT_ERROR 参数非法或连接不存在, BT_ERROR 队列已满
+ */
+BtError BleGattsTxEnqueue(uint16_t connId, uint16_t attrHandle, const uint8_t *data, uint16_t len,
+                          bool needConfirm);
+
+/**
+ * @brief 立即发送队列中已攒的数据, 不再等待攒满一个 MTU
+ */
+BtError BleGattsTxFlush(uint16_t connId);
+
+/**
+ * @brief 获取连接的发送统计
+ */
+BtError BleGattsTxGetStats(uint16_t connId, BleGattsTxStats *stats);
+
+/**
+ * @brief 获取连接队列中尚未发送的字节数, 连接不存在时返回 0
+ */
+uint32_t BleGattsTxQueuedBytes(uint16_t connId);
+
+/* 以下供 HAL 内部使用 */
+void BleGattsTxSetCallback(GattsBleCallback callback);
+void BleGattsTxGattsHandler(esp_gatts_cb_event_t event, esp_gatt_if_t gattsIf, esp_ble_gatts_cb_param_t *param);
+
+#endif
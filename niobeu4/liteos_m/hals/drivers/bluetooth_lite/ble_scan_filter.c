@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdlib.h>
+#include "securec.h"
+#include "cmsis_os2.h"
+#include "los_mux.h"
+#include "los_tick.h"
+#include "ohos_init.h"
+#include "ble_scan_filter.h"
+#include "ble_conn_mgr.h"
+
+#define MS_PER_SECOND 1000
+#define AD_HDR_LEN 2
+#define UUID16_LEN 2
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+#define BATCH_BUF_NUM 2
+
+typedef struct {
+    uint8_t valid;
+    uint8_t addrType;
+    uint8_t addr[OHOS_BD_ADDR_LEN];
+    int8_t rssi;                // 上次上报时的 RSSI
+    uint32_t hash;              // 上次上报时的广播内容摘要
+    uint32_t lastSeenMs;
+    uint32_t lastReportMs;
+} BleScanDedupEntry;
+
+typedef struct {
+    volatile bool enable;
+    BleScanFilter filter;
+    BleScanBatchCallback batchCb;
+    GapBleCallback gapCb;
+    BleScanDedupEntry cache[BLE_SCAN_DEDUP_MAX];
+    BleScanReport batch[BATCH_BUF_NUM][BLE_SCAN_BATCH_MAX];     // 一份填充, 一份交付回调
+    uint8_t active;
+    unsigned int batchNum;
+    BleScanFilterStats stats;
+    UINT32 muxHandle;
+    UINT32 deliverMux;          // 串行化批量回调, 回调期间不持有 muxHandle
+    osTimerId_t timer;
+} BleScanFilter_t;
+
+static BleScanFilter_t BleScanCtx;
+
+static void BleScanLock(void)
+{
+    (void)LOS_MuxPend(BleScanCtx.muxHandle, LOS_WAIT_FOREVER);
+}
+
+static void BleScanUnlock(void)
+{
+    (void)LOS_MuxPost(BleScanCtx.muxHandle);
+}
+
+static uint32_t BleScanNowMs(void)
+{
+    return (uint32_t)(LOS_TickCountGet() * MS_PER_SECOND / LOSCFG_BASE_CORE_TICK_PER_SECOND);
+}
+
+/* 向上取整, 不足一个 tick 时按一个 tick 计 */
+static uint32_t BleScanMsToTicks(uint32_t ms)
+{
+    uint32_t ticks = (uint32_t)(((uint64_t)ms * LOSCFG_BASE_CORE_TICK_PER_SECOND + MS_PER_SECOND - 1) / MS_PER_SECOND);
+    return (ticks == 0) ? 1 : ticks;
+}
+
+static uint32_t AdvHash(const uint8_t *data, unsigned int len, uint8_t evtType)
+{
+    uint32_t hash = FNV_OFFSET_BASIS ^ evtType;
+    for (unsigned int i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+static bool MatchUuid16(const BleScanFilter *filter, uint16_t uuid)
+{
+    for (uint8_t i = 0; i < filter->uuidNum; i++) {
+        if (filter->uuid16[i] == uuid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool MatchManuId(const BleScanFilter *filter, uint16_t id)
+{
+    for (uint8_t i = 0; i < filter->manuNum; i++) {
+        if (filter->manuId[i] == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* 遍历 AD 结构, 匹配 16 位服务 UUID 列表/服务数据 UUID 与厂商 ID */
+static bool MatchContent(const BleScanFilter *filter, const uint8_t *data, unsigned int len)
+{
+    unsigned int pos = 0;
+    while (pos + AD_HDR_LEN <= len) {
+        uint8_t fieldLen = data[pos];
+        if ((fieldLen == 0) || (pos + 1 + fieldLen > len)) {
+            break;
+        }
+        uint8_t type = data[pos + 1];
+        const uint8_t *field = &data[pos + AD_HDR_LEN];
+        unsigned int n = fieldLen - 1;
+        if ((type == OHOS_BLE_AD_TYPE_16SRV_PART) || (type == OHOS_BLE_AD_TYPE_16SRV_CMPL)) {
+            for (unsigned int i = 0; i + UUID16_LEN <= n; i += UUID16_LEN) {
+                if (MatchUuid16(filter, (uint16_t)(field[i] | (field[i + 1] << 8)))) {
+                    return true;
+                }
+            }
+        } else if ((type == OHOS_BLE_AD_TYPE_SERVICE_DATA) && (n >= UUID16_LEN)) {
+            if (MatchUuid16(filter, (uint16_t)(field[0] | (field[1] << 8)))) {
+                return true;
+            }
+        } else if ((type == OHOS_BLE_AD_MANUFACTURER_SPECIFIC_TYPE) && (n >= UUID16_LEN)) {
+            if (MatchManuId(filter, (uint16_t)(field[0] | (field[1] << 8)))) {
+                return true;
+            }
+        }
+        pos += fieldLen + 1;
+    }
+    return false;
+}
+
+static bool MatchFilter(const BleScanFilter *filter, const struct ble_scan_result_evt_param *rst, unsigned int len)
+{
+    if (rst->rssi < filter->minRssi) {
+        return false;
+    }
+    if ((filter->addrNum == 0) && (filter->uuidNum == 0) && (filter->manuNum == 0)) {
+        return true;
+    }
+    for (uint8_t i = 0; i < filter->addrNum; i++) {
+        if (memcmp(filter->addr[i], rst->bda, OHOS_BD_ADDR_LEN) == 0) {
+            return true;
+        }
+    }
+    return MatchContent(filter, rst->ble_adv, len);
+}
+
+/* 新设备, 内容变化, RSSI 变化超限或超过重报窗口时返回 true */
+static bool DedupShouldReport(const struct ble_scan_result_evt_param *rst, uint32_t hash, uint32_t now)
+{
+    const BleScanFilter *filter = &BleScanCtx.filter;
+    BleScanDedupEntry *victim = &BleScanCtx.cache[0];
+    BleScanDedupEntry *entry = NULL;
+
+    for (int i = 0; i < BLE_SCAN_DEDUP_MAX; i++) {
+        BleScanDedupEntry *e = &BleScanCtx.cache[i];
+        if (!e->valid) {
+            victim = (victim->valid) ? e : victim;
+            continue;
+        }
+        if ((e->addrType == rst->ble_addr_type) && (memcmp(e->addr, rst->bda, OHOS_BD_ADDR_LEN) == 0)) {
+            entry = e;
+            break;
+        }
+        if (victim->valid && ((int32_t)(e->lastSeenMs - victim->lastSeenMs) < 0)) {
+            victim = e;
+        }
+    }
+
+    if (entry != NULL) {
+        int rssiDiff = rst->rssi - entry->rssi;
+        entry->lastSeenMs = now;
+        if ((entry->hash == hash) &&
+            ((filter->rssiDelta == 0) || (abs(rssiDiff) < filter->rssiDelta)) &&
+            ((filter->reportWindowMs == 0) || (now - entry->lastReportMs < filter->reportWindowMs))) {
+            return false;
+        }
+    } else {
+        entry = victim;
+        entry->valid = 1;
+        entry->addrType = rst->ble_addr_type;
+        (void)memcpy_s(entry->addr, sizeof(entry->addr), rst->bda, OHOS_BD_ADDR_LEN);
+        entry->lastSeenMs = now;
+    }
+    entry->hash = hash;
+    entry->rssi = rst->rssi;
+    entry->lastReportMs = now;
+    return true;
+}
+
+static void BatchAppend(const struct ble_scan_result_evt_param *rst, unsigned int len)
+{
+    BleScanReport *report = &BleScanCtx.batch[BleScanCtx.active][BleScanCtx.batchNum];
+
+    report->addrType = rst->ble_addr_type;
+    report->evtType = rst->ble_evt_type;
+    report->rssi = rst->rssi;
+    report->advLen = rst->adv_data_len;
+    report->scanRspLen = rst->scan_rsp_len;
+    (void)memcpy_s(report->addr, sizeof(report->addr), rst->bda, OHOS_BD_ADDR_LEN);
+    (void)memcpy_s(report->data, sizeof(report->data), rst->ble_adv, len);
+    BleScanCtx.batchNum++;
+}
+
+/* 不得持有 muxHandle 调用: 在锁内取走当前批次并切换填充缓冲, 释放锁后再回调 */
+static void BatchDeliver(void)
+{
+    const BleScanReport *reports = NULL;
+    BleScanBatchCallback cb;
+    unsigned int num;
+
+    (void)LOS_MuxPend(BleScanCtx.deliverMux, LOS_WAIT_FOREVER);
+    BleScanLock();
+    cb = BleScanCtx.batchCb;
+    num = BleScanCtx.batchNum;
+    if (num > 0) {
+        reports = BleScanCtx.batch[BleScanCtx.active];
+        BleScanCtx.active ^= 1;
+        BleScanCtx.batchNum = 0;
+        if (cb != NULL) {
+            BleScanCtx.stats.batches++;
+        }
+    }
+    BleScanUnlock();
+    if ((num > 0) && (cb != NULL)) {
+        cb(reports, num);
+    }
+    (void)LOS_MuxPost(BleScanCtx.deliverMux);
+}
+
+/* 返回 true 表示扫描结果需逐条交给 GAP 回调 */
+static bool BleScanAccept(const struct ble_scan_result_evt_param *rst)
+{
+    unsigned int len = rst->adv_data_len + rst->scan_rsp_len;
+    bool direct = false;
+    bool full = false;
+
+    if (len > BLE_SCAN_ADV_MAX) {
+        len = BLE_SCAN_ADV_MAX;
+    }
+    BleScanLock();
+    BleScanCtx.stats.received++;
+    if (!MatchFilter(&BleScanCtx.filter, rst, len)) {
+        BleScanCtx.stats.filtered++;
+    } else if (!DedupShouldReport(rst, AdvHash(rst->ble_adv, len, rst->ble_evt_type), BleScanNowMs())) {
+        BleScanCtx.stats.suppressed++;
+    } else {
+        BleScanCtx.stats.delivered++;
+        if (BleScanCtx.batchCb == NULL) {
+            direct = true;
+        } else {
+            BatchAppend(rst, len);
+            if (BleScanCtx.batchNum >= BleScanCtx.filter.batchNum) {
+                full = true;
+            } else if ((BleScanCtx.batchNum == 1) && (BleScanCtx.timer != NULL)) {
+                (void)osTimerStart(BleScanCtx.timer, BleScanMsToTicks(BleScanCtx.filter.batchTimeoutMs));
+            }
+        }
+    }
+    BleScanUnlock();
+    if (full) {
+        BatchDeliver();
+    }
+    return direct;
+}
+
+static void BleScanTimerProc(void *arg)
+{
+    (void)arg;
+    BleScanFilterFlush();
+}
+
+BtError BleSetScanFilter(const BleScanFilter *filter, BleScanBatchCallback batch)
+{
+    if ((filter != NULL) && ((filter->addrNum > BLE_SCAN_FILTER_ADDR_MAX) ||
+        (filter->uuidNum > BLE_SCAN_FILTER_UUID_MAX) || (filter->manuNum > BLE_SCAN_FILTER_MANU_MAX) ||
+        ((batch != NULL) && ((filter->batchNum == 0) || (filter->batchNum > BLE_SCAN_BATCH_MAX))))) {
+        BT_DEBUG("BleSetScanFilter param is invalid! \n");
+        return BT_PARAMINPUT_ERROR;
+    }
+    if ((filter != NULL) && (batch != NULL) && (BleScanCtx.timer == NULL)) {
+        BT_LOGE("scan filter timer not created");
+        return BT_ERROR;
+    }
+
+    BatchDeliver();
+    BleScanLock();
+    BleScanCtx.enable = false;
+    BleScanCtx.batchNum = 0;
+    if (filter != NULL) {
+        BleScanCtx.filter = *filter;
+        BleScanCtx.batchCb = batch;
+        (void)memset_s(BleScanCtx.cache, sizeof(BleScanCtx.cache), 0, sizeof(BleScanCtx.cache));
+        (void)memset_s(&BleScanCtx.stats, sizeof(BleScanCtx.stats), 0, sizeof(BleScanCtx.stats));
+        BleScanCtx.enable = true;
+    } else {
+        BleScanCtx.batchCb = NULL;
+    }
+    BleScanUnlock();
+    return BT_SUCCESS;
+}
+
+void BleScanFilterReset(void)
+{
+    BleScanLock();
+    (void)memset_s(BleScanCtx.cache, sizeof(BleScanCtx.cache), 0, sizeof(BleScanCtx.cache));
+    BleScanUnlock();
+}
+
+void BleGetScanFilterStats(BleScanFilterStats *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    BleScanLock();
+    *stats = BleScanCtx.stats;
+    BleScanUnlock();
+}
+
+void BleScanFilterFlush(void)
+{
+    if (!BleScanCtx.enable) {
+        return;
+    }
+    BatchDeliver();
+}
+
+void BleScanFilterSetGapCallback(GapBleCallback callback)
+{
+    BleScanCtx.gapCb = callback;
+}
+
+void BleScanFilterGapHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param)
+{
+    if ((event == ESP_GAP_BLE_SCAN_RESULT_EVT) && BleScanCtx.enable) {
+        if (param->scan_rst.search_evt == ESP_GAP_SEARCH_INQ_RES_EVT) {
+            if (!BleScanAccept(&param->scan_rst)) {
+                return;
+            }
+        } else if (param->scan_rst.search_evt == ESP_GAP_SEARCH_INQ_CMPL_EVT) {
+            BleScanFilterFlush();
+        }
+    } else if (event == ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT) {
+        BleConnMgrOnParamsUpdated(param->update_conn_params.bda, param->update_conn_params.status,
+                                  param->update_conn_params.conn_int, param->update_conn_params.latency);
+    }
+    if (BleScanCtx.gapCb != NULL) {
+        BleScanCtx.gapCb((GapBleCallbackEvent)event, (BleGapParam *)param);
+    }
+}
+
+static void BleScanFilterInit(void)
+{
+    if ((LOS_MuxCreate(&BleScanCtx.muxHandle) != LOS_OK) || (LOS_MuxCreate(&BleScanCtx.deliverMux) != LOS_OK)) {
+        BT_LOGE("LOS_MuxCreate fail");
+        return;
+    }
+    BleScanCtx.timer = osTimerNew(BleScanTimerProc, osTimerOnce, NULL, NULL);
+    if (BleScanCtx.timer == NULL) {
+        BT_LOGE("osTimerNew fail");
+    }
+}
+SYS_RUN(BleScanFilterInit);
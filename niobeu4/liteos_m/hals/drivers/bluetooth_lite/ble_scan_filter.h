@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __BLE_SCAN_FILTER_H__
+#define __BLE_SCAN_FILTER_H__
+#include "blegap.h"
+
+#define BLE_SCAN_FILTER_ADDR_MAX 8
+#define BLE_SCAN_FILTER_UUID_MAX 8
+#define BLE_SCAN_FILTER_MANU_MAX 4
+#define BLE_SCAN_DEDUP_MAX 32
+#define BLE_SCAN_BATCH_MAX 16
+#define BLE_SCAN_RSSI_NO_LIMIT (-128)
+#define BLE_SCAN_ADV_MAX (ESP_BLE_ADV_DATA_LEN_MAX + ESP_BLE_SCAN_RSP_DATA_LEN_MAX)
+
+/**
+ * @brief 扫描过滤配置
+ *
+ * 地址/UUID/厂商 ID 三个允许列表为"或"关系, 全部为空时不按内容过滤.
+ * 去重缓存中已有的设备仅在广播内容变化, RSSI 变化超过 rssiDelta
+ * 或距上次上报超过 reportWindowMs 时再次上报.
+ */
+typedef struct {
+    uint8_t addrNum;
+    uint8_t addr[BLE_SCAN_FILTER_ADDR_MAX][OHOS_BD_ADDR_LEN];
+    uint8_t uuidNum;
+    uint16_t uuid16[BLE_SCAN_FILTER_UUID_MAX];      // 16 位服务 UUID
+    uint8_t manuNum;
+    uint16_t manuId[BLE_SCAN_FILTER_MANU_MAX];      // 厂商数据中的 Company ID
+    int8_t minRssi;
+    uint8_t rssiDelta;                              // 0 表示不因 RSSI 变化重新上报
+    uint32_t reportWindowMs;                        // 0 表示仅在内容变化时重新上报
+    uint8_t batchNum;                               // 批量上报条数, 不超过 BLE_SCAN_BATCH_MAX
+    uint32_t batchTimeoutMs;                        // 未攒满时的最长等待时间
+} BleScanFilter;
+
+typedef struct {
+    uint8_t addr[OHOS_BD_ADDR_LEN];
+    uint8_t addrType;
+    uint8_t evtType;
+    int8_t rssi;
+    uint8_t advLen;
+    uint8_t scanRspLen;
+    uint8_t data[BLE_SCAN_ADV_MAX];                 // 广播数据后接扫描响应数据
+} BleScanReport;
+
+typedef struct {
+    uint32_t received;
+    uint32_t filtered;                              // 未通过允许列表或 RSSI 门限
+    uint32_t suppressed;                            // 被去重缓存抑制
+    uint32_t delivered;
+    uint32_t batches;
+} BleScanFilterStats;
+
+/**
+ * @brief 批量上报回调, 在蓝牙协议栈任务或定时器任务中执行, 不可在回调中修改过滤配置
+ */
+typedef void (*BleScanBatchCallback)(const BleScanReport *reports, unsigned int num);
+
+/**
+ * @brief 设置扫描过滤配置
+ *
+ * @param filter 过滤配置, NULL 表示关闭过滤, 所有扫描结果原样交给 GAP 回调
+ * @param batch 批量上报回调, NULL 时通过过滤的结果逐条交给 GAP 回调
+ * @return BT_SUCCESS 成功, BT_PARAMINPUT_ERROR 参数非法
+ */
+BtError BleSetScanFilter(const BleScanFilter *filter, BleScanBatchCallback batch);
+
+/**
+ * @brief 清空去重缓存, 之后每个设备会被重新上报一次
+ */
+void BleScanFilterReset(void);
+
+/**
+ * @brief 获取过滤统计
+ */
+void BleGetScanFilterStats(BleScanFilterStats *stats);
+
+/* 以下供 HAL 内部使用 */
+void BleScanFilterSetGapCallback(GapBleCallback callback);
+void BleScanFilterGapHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param);
+void BleScanFilterFlush(void);
+
+#endif
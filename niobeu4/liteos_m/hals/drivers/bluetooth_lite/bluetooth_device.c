@@ -15,6 +15,9 @@
 #include "ohos_run.h"
 #include "blegap.h"
 #include "bluetooth_device.h"
+#include "ble_scan_filter.h"
+#include "ble_gattc_cache.h"
+#include "ble_gattc_bulk.h"
 #define NULL 0L
 
 BtError EnableBle(void)
@@ -89,6 +92,7 @@ BtError BleStartScan(void)
     if (esp_bluedroid_get_status() != ESP_BLUEDROID_STATUS_ENABLED) {
         return ESP_ERR_INVALID_STATE;
     }
+    BleScanFilterReset();
     return esp_ble_gap_start_scanning(ScanTime);
 }
 
@@ -97,6 +101,7 @@ BtError BleStopScan2(void)
     if (esp_bluedroid_get_status() != ESP_BLUEDROID_STATUS_ENABLED) {
         return ESP_ERR_INVALID_STATE;
     }
+    BleScanFilterFlush();
     return esp_ble_gap_stop_scanning();
 }
 
@@ -145,13 +150,16 @@ BtError BleGattcConfigureMtuSize(int mtuSize)
 BtError BleGattcRegister(BtGattClientCallbacks func)
 {
     esp_err_t ret;
-    ret = esp_ble_gap_register_callback(func.gap_callback);
+    BleScanFilterSetGapCallback(func.gap_callback);
+    ret = esp_ble_gap_register_callback(BleScanFilterGapHandler);
     if (ret) {
         ESP_LOGE(GATTC_TAG, "%s gap register failed, error code = %x\n", __func__, ret);
         return ret;
     }
 
-    ret = esp_ble_gattc_register_callback(func.gattc_callback);
+    BleGattcCacheSetCallback(func.gattc_callback);
+    BleGattcBulkSetCallback((GattcBleCallback)BleGattcCacheGattcHandler);
+    ret = esp_ble_gattc_register_callback(BleGattcBulkGattcHandler);
     if (ret) {
         ESP_LOGE(GATTC_TAG, "%s gattc register failed, error code = %x\n", __func__, ret);
         return ret;
@@ -179,7 +187,7 @@ BtError BleGattcSearchServices(int clientId, int conn_id, BtUuid *filter_uuid)
         .len = filter_uuid->uuidLen,
         .uuid = {.uuid16 = (uint16_t)filter_uuid->uuid, },
     };
-    esp_ble_gattc_search_service(clientId, conn_id, &remote_filter_service_uuid);
+    return BleGattcCacheSearch(clientId, conn_id, &remote_filter_service_uuid);
 }
 
 BtError BleGattcWriteCharacteristic(GattcWriteChar write_char, uint8_t *value,
@@ -216,6 +224,10 @@ BtError BleGattcGetAttrCount(GattcGetAttr get_attr,
         BT_DEBUG("BleGattcGetAttrCount param is NULL! \n");
         return BT_PARAMINPUT_ERROR;
     }
+    esp_gatt_status_t status;
+    if (BleGattcCacheGetAttrCount(&get_attr, char_handle, count, &status)) {
+        return status;
+    }
     return esp_ble_gattc_get_attr_count(get_attr.gattc_if, get_attr.conn_id,
                                         get_attr.type, get_attr.start_handle,
                                         get_attr.end_handle, char_handle, count);
@@ -228,6 +240,10 @@ GattStatus BleGattcGetCharByUuid(GattcGetChar get_char, BtUuids char_uuid,
         BT_DEBUG("BleGattcGetCharByUuid param is NULL! \n");
         return BT_PARAMINPUT_ERROR;
     }
+    esp_gatt_status_t status;
+    if (BleGattcCacheGetChar(&get_char, &char_uuid, result, count, &status)) {
+        return status;
+    }
     return esp_ble_gattc_get_char_by_uuid(get_char.gattc_if, get_char.conn_id,
                                           get_char.start_handle, get_char.end_handle,
                                           char_uuid, result, count);
@@ -254,6 +270,10 @@ GattStatus BleGattcGetDescrByCharHandle(GattcGetDescr get_descr, BleGattcDescrEl
         BT_DEBUG("BleGattcGetCharByUuid param is NULL! \n");
         return BT_PARAMINPUT_ERROR;
     }
+    esp_gatt_status_t status;
+    if (BleGattcCacheGetDescr(&get_descr, result, count, &status)) {
+        return status;
+    }
     return esp_ble_gattc_get_descr_by_char_handle(get_descr.gattc_if, get_descr.conn_id,
                                                   get_descr.char_handle, get_descr.descr_uuid,
                                                   result, count);
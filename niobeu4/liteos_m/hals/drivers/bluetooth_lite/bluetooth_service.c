@@ -16,6 +16,8 @@
 #include "bluetooth_service.h"
 #include "ohos_run.h"
 #include "blegap.h"
+#include "ble_scan_filter.h"
+#include "ble_gatts_tx.h"
 #define GATTS_TAG "BLUETOOTH_SERVICE"
 
 /**
@@ -29,12 +31,14 @@
 BtError BleGattsRegisterCallbacks(BtGattServerCallbacks func)
 {
     esp_err_t ret;
-    ret = esp_ble_gatts_register_callback(func.gattsCallback);
+    BleGattsTxSetCallback(func.gattsCallback);
+    ret = esp_ble_gatts_register_callback(BleGattsTxGattsHandler);
     if (ret) {
         ESP_LOGE(GATTS_TAG, "gatts register error, error code = %x", ret);
         return;
     }
-    ret = esp_ble_gap_register_callback(func.gapCallback);
+    BleScanFilterSetGapCallback(func.gapCallback);
+    ret = esp_ble_gap_register_callback(BleScanFilterGapHandler);
     if (ret) {
         ESP_LOGE(GATTS_TAG, "gap register error, error code = %x", ret);
         return;
@@ -88,7 +92,7 @@ BtError BleGattsStopService(int serverId, int srvcHandle)
  */
 BtError BleGattsSendIndication(GattsSendParam *param)
 {
-    if (param == NULL && param->value == NULL) {
+    if ((param == NULL) || (param->value == NULL)) {
         return BT_PARAMINPUT_ERROR;
     }
     return esp_ble_gatts_send_indicate(param->gattsIf, param->connId, param->attrHandle, param->valueLen, param->value,
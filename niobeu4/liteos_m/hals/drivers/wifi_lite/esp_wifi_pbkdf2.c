@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * PBKDF2-HMAC-SHA1 专用实现.
+ * HMAC 的 ipad/opad 压缩状态只计算一次, 之后每轮迭代的内/外层哈希输入都恰好是
+ * 一个 64 字节分组 (20 字节摘要 + 填充), 因此每轮仅需两次 SHA1 压缩,
+ * 而通用 HMAC 每轮需要四次压缩并伴随上下文初始化开销.
+ * ESP32 的 SHA 外设无法从中间状态继续运算, 故压缩函数使用展开的软件实现.
+ */
+
+#include <string.h>
+#include "securec.h"
+#include "esp_wifi_wpa.h"
+
+#define SHA1_BLOCK_LEN 64
+#define SHA1_BLOCK_WORDS 16
+#define SHA1_STATE_WORDS 5
+#define SHA1_MAC_LEN 20
+#define SHA1_PAD_LEN_WORD 15
+#define SHA1_LEN_FIELD 8
+#define HMAC_IPAD 0x36
+#define HMAC_OPAD 0x5c
+#define PBKDF2_INDEX_LEN 4
+#define BITS_PER_BYTE 8
+#define WORD_BYTES 4
+
+#define ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define BLK(i) (w[(i) & 15] = ROL(w[((i) + 13) & 15] ^ w[((i) + 8) & 15] ^ w[((i) + 2) & 15] ^ w[(i) & 15], 1))
+
+#define R0(v, x, y, z, u, i) do { \
+    (u) += (((x) & ((y) ^ (z))) ^ (z)) + w[i] + 0x5A827999 + ROL(v, 5); \
+    (x) = ROL(x, 30); \
+} while (0)
+#define R1(v, x, y, z, u, i) do { \
+    (u) += (((x) & ((y) ^ (z))) ^ (z)) + BLK(i) + 0x5A827999 + ROL(v, 5); \
+    (x) = ROL(x, 30); \
+} while (0)
+#define R2(v, x, y, z, u, i) do { \
+    (u) += ((x) ^ (y) ^ (z)) + BLK(i) + 0x6ED9EBA1 + ROL(v, 5); \
+    (x) = ROL(x, 30); \
+} while (0)
+#define R3(v, x, y, z, u, i) do { \
+    (u) += ((((x) | (y)) & (z)) | ((x) & (y))) + BLK(i) + 0x8F1BBCDC + ROL(v, 5); \
+    (x) = ROL(x, 30); \
+} while (0)
+#define R4(v, x, y, z, u, i) do { \
+    (u) += ((x) ^ (y) ^ (z)) + BLK(i) + 0xCA62C1D6 + ROL(v, 5); \
+    (x) = ROL(x, 30); \
+} while (0)
+
+/* 5 轮一组, 变量轮换后回到原位 */
+#define ROUND5(R, i) do { \
+    R(a, b, c, d, e, (i)); \
+    R(e, a, b, c, d, (i) + 1); \
+    R(d, e, a, b, c, (i) + 2); \
+    R(c, d, e, a, b, (i) + 3); \
+    R(b, c, d, e, a, (i) + 4); \
+} while (0)
+
+static const uint32_t Sha1Iv[SHA1_STATE_WORDS] = {
+    0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0
+};
+
+/* w 为大端解码后的分组, 运算中被改写 */
+static void Sha1Compress(uint32_t *state, uint32_t *w)
+{
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+
+    ROUND5(R0, 0);
+    ROUND5(R0, 5);
+    ROUND5(R0, 10);
+    R0(a, b, c, d, e, 15);
+    R1(e, a, b, c, d, 16);
+    R1(d, e, a, b, c, 17);
+    R1(c, d, e, a, b, 18);
+    R1(b, c, d, e, a, 19);
+    ROUND5(R2, 20);
+    ROUND5(R2, 25);
+    ROUND5(R2, 30);
+    ROUND5(R2, 35);
+    ROUND5(R3, 40);
+    ROUND5(R3, 45);
+    ROUND5(R3, 50);
+    ROUND5(R3, 55);
+    ROUND5(R4, 60);
+    ROUND5(R4, 65);
+    ROUND5(R4, 70);
+    ROUND5(R4, 75);
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+static void BlockToWords(const uint8_t *block, uint32_t *w)
+{
+    for (int i = 0; i < SHA1_BLOCK_WORDS; i++, block += WORD_BYTES) {
+        w[i] = ((uint32_t)block[0] << 24) | ((uint32_t)block[1] << 16) | ((uint32_t)block[2] << 8) | block[3];
+    }
+}
+
+static void PadState(const uint8_t *key, size_t keyLen, uint8_t pad, uint32_t *state)
+{
+    uint8_t block[SHA1_BLOCK_LEN];
+    uint32_t w[SHA1_BLOCK_WORDS];
+
+    for (size_t i = 0; i < SHA1_BLOCK_LEN; i++) {
+        block[i] = ((i < keyLen) ? key[i] : 0) ^ pad;
+    }
+    BlockToWords(block, w);
+    (void)memcpy_s(state, SHA1_STATE_WORDS * sizeof(uint32_t), Sha1Iv, sizeof(Sha1Iv));
+    Sha1Compress(state, w);
+    (void)memset_s(block, sizeof(block), 0, sizeof(block));
+    (void)memset_s(w, sizeof(w), 0, sizeof(w));
+}
+
+/* 已知前缀为一个分组时, 对 20 字节摘要做单分组压缩 */
+static void HashDigestBlock(const uint32_t *padState, const uint32_t *digest, uint32_t *out)
+{
+    uint32_t w[SHA1_BLOCK_WORDS] = {0};
+
+    (void)memcpy_s(w, sizeof(w), digest, SHA1_MAC_LEN);
+    w[SHA1_STATE_WORDS] = 0x80000000;
+    w[SHA1_PAD_LEN_WORD] = (SHA1_BLOCK_LEN + SHA1_MAC_LEN) * BITS_PER_BYTE;
+    (void)memcpy_s(out, SHA1_MAC_LEN, padState, SHA1_MAC_LEN);
+    Sha1Compress(out, w);
+}
+
+/* U1 = HMAC(P, salt || INT(index)), salt 与填充需放入一个分组 */
+static void HmacFirst(const uint32_t *ipad, const uint32_t *opad, const uint8_t *salt, size_t saltLen,
+                      uint32_t index, uint32_t *u)
+{
+    uint8_t block[SHA1_BLOCK_LEN] = {0};
+    uint32_t w[SHA1_BLOCK_WORDS];
+    uint32_t inner[SHA1_STATE_WORDS];
+    size_t pos = saltLen;
+    uint64_t bits = (uint64_t)(SHA1_BLOCK_LEN + saltLen + PBKDF2_INDEX_LEN) * BITS_PER_BYTE;
+
+    (void)memcpy_s(block, sizeof(block), salt, saltLen);
+    block[pos++] = (uint8_t)(index >> 24);
+    block[pos++] = (uint8_t)(index >> 16);
+    block[pos++] = (uint8_t)(index >> 8);
+    block[pos++] = (uint8_t)index;
+    block[pos] = 0x80;
+    for (int i = 0; i < SHA1_LEN_FIELD; i++) {
+        block[SHA1_BLOCK_LEN - 1 - i] = (uint8_t)(bits >> (i * BITS_PER_BYTE));
+    }
+    BlockToWords(block, w);
+    (void)memcpy_s(inner, sizeof(inner), ipad, sizeof(inner));
+    Sha1Compress(inner, w);
+    HashDigestBlock(opad, inner, u);
+}
+
+int WpaFastPbkdf2Sha1(const char *passphrase, const uint8_t *ssid, size_t ssidLen, int iterations,
+                      uint8_t *buf, size_t buflen)
+{
+    uint32_t ipad[SHA1_STATE_WORDS];
+    uint32_t opad[SHA1_STATE_WORDS];
+    uint32_t u[SHA1_STATE_WORDS];
+    uint32_t t[SHA1_STATE_WORDS];
+    size_t passLen = strlen(passphrase);
+    size_t pos = 0;
+
+    if ((passLen > SHA1_BLOCK_LEN) || (iterations <= 0) ||
+        (ssidLen + PBKDF2_INDEX_LEN + 1 + SHA1_LEN_FIELD > SHA1_BLOCK_LEN)) {
+        return -1;
+    }
+    PadState((const uint8_t *)passphrase, passLen, HMAC_IPAD, ipad);
+    PadState((const uint8_t *)passphrase, passLen, HMAC_OPAD, opad);
+
+    for (uint32_t index = 1; pos < buflen; index++) {
+        HmacFirst(ipad, opad, ssid, ssidLen, index, u);
+        (void)memcpy_s(t, sizeof(t), u, sizeof(u));
+        for (int i = 1; i < iterations; i++) {
+            uint32_t inner[SHA1_STATE_WORDS];
+            HashDigestBlock(ipad, u, inner);
+            HashDigestBlock(opad, inner, u);
+            t[0] ^= u[0];
+            t[1] ^= u[1];
+            t[2] ^= u[2];
+            t[3] ^= u[3];
+            t[4] ^= u[4];
+        }
+        for (int i = 0; (i < SHA1_MAC_LEN) && (pos < buflen); i++, pos++) {
+            buf[pos] = (uint8_t)(t[i / WORD_BYTES] >> (24 - (i % WORD_BYTES) * BITS_PER_BYTE));
+        }
+    }
+    (void)memset_s(ipad, sizeof(ipad), 0, sizeof(ipad));
+    (void)memset_s(opad, sizeof(opad), 0, sizeof(opad));
+    (void)memset_s(u, sizeof(u), 0, sizeof(u));
+    (void)memset_s(t, sizeof(t), 0, sizeof(t));
+    return 0;
+}
@@ -0,0 +1,614 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * WPA3-SAE (IEEE 802.11-2016 12.4), 仅支持 group 19 (NIST P-256),
+ * PWE 采用 hunting-and-pecking, 固定迭代 SAE_HNP_ROUNDS 次, 逐轮无分支合并并使用盲化的二次剩余判定.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_system.h"
+#include "mbedtls/bignum.h"
+#include "mbedtls/ecp.h"
+#include "securec.h"
+#include "esp_wifi_wpa.h"
+
+#define SAE_GROUP_P256 19
+#define SAE_PRIME_LEN 32
+#define SAE_POINT_LEN (SAE_PRIME_LEN * 2)
+#define SAE_KCK_LEN 32
+#define SAE_CONFIRM_LEN 32
+#define SAE_HNP_ROUNDS 40
+#define SAE_MAX_PASSWORD 64
+#define SAE_MSG_COMMIT 1
+#define SAE_MSG_CONFIRM 2
+#define SAE_STATUS_ANTI_CLOGGING 76
+#define SAE_TOKEN_MAX 64
+#define SAE_COMMIT_MAX (2 + SAE_TOKEN_MAX + SAE_PRIME_LEN + SAE_POINT_LEN)
+#define BITS_PER_BYTE 8
+#define ECP_UNCOMPRESSED 0x04
+
+typedef enum {
+    SAE_IDLE = 0,
+    SAE_COMMITTED,
+    SAE_CONFIRMED,
+    SAE_ACCEPTED,
+} SaeState;
+
+typedef struct {
+    SaeState state;
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point pwe;
+    mbedtls_ecp_point ownElement;
+    mbedtls_ecp_point peerElement;
+    mbedtls_mpi rand;
+    mbedtls_mpi ownScalar;
+    mbedtls_mpi peerScalar;
+    uint16_t sendConfirm;
+    uint8_t kck[SAE_KCK_LEN];
+    uint8_t pmk[WPA_PMK_LEN];
+    uint8_t pmkid[WPA_PMKID_LEN];
+    uint8_t token[SAE_TOKEN_MAX];
+    size_t tokenLen;
+    uint8_t msg[SAE_COMMIT_MAX];
+} WpaSae_t;
+
+static WpaSae_t *WpaSae = NULL;
+
+extern uint8_t *esp_wifi_sta_get_prof_password_internal(void);
+
+static int SaeRng(void *ctx, unsigned char *buf, size_t len)
+{
+    (void)ctx;
+    esp_fill_random(buf, len);
+    return 0;
+}
+
+static void SaeFree(WpaSae_t *sae)
+{
+    mbedtls_ecp_group_free(&sae->grp);
+    mbedtls_ecp_point_free(&sae->pwe);
+    mbedtls_ecp_point_free(&sae->ownElement);
+    mbedtls_ecp_point_free(&sae->peerElement);
+    mbedtls_mpi_free(&sae->rand);
+    mbedtls_mpi_free(&sae->ownScalar);
+    mbedtls_mpi_free(&sae->peerScalar);
+    (void)memset_s(sae, sizeof(*sae), 0, sizeof(*sae));
+    free(sae);
+}
+
+static WpaSae_t *SaeAlloc(void)
+{
+    WpaSae_t *sae = (WpaSae_t *)malloc(sizeof(WpaSae_t));
+    if (sae == NULL) {
+        return NULL;
+    }
+    (void)memset_s(sae, sizeof(*sae), 0, sizeof(*sae));
+    mbedtls_ecp_group_init(&sae->grp);
+    mbedtls_ecp_point_init(&sae->pwe);
+    mbedtls_ecp_point_init(&sae->ownElement);
+    mbedtls_ecp_point_init(&sae->peerElement);
+    mbedtls_mpi_init(&sae->rand);
+    mbedtls_mpi_init(&sae->ownScalar);
+    mbedtls_mpi_init(&sae->peerScalar);
+    if (mbedtls_ecp_group_load(&sae->grp, MBEDTLS_ECP_DP_SECP256R1) != 0) {
+        SaeFree(sae);
+        return NULL;
+    }
+    return sae;
+}
+
+/* 点的 x||y 定长大端编码; 点坐标只经 write/read_binary 存取, 曲线参数 grp.P/A/B/N 直接读取 (mbedtls 2.x 公开成员) */
+static int SaePointWrite(const mbedtls_ecp_group *grp, const mbedtls_ecp_point *pt, uint8_t *xy)
+{
+    uint8_t buf[1 + SAE_POINT_LEN];
+    size_t olen = 0;
+    if ((mbedtls_ecp_point_write_binary(grp, pt, MBEDTLS_ECP_PF_UNCOMPRESSED, &olen, buf, sizeof(buf)) != 0) ||
+        (olen != sizeof(buf))) {
+        return -1;
+    }
+    return memcpy_s(xy, SAE_POINT_LEN, buf + 1, SAE_POINT_LEN);
+}
+
+static int SaePointRead(const mbedtls_ecp_group *grp, mbedtls_ecp_point *pt, const uint8_t *xy)
+{
+    uint8_t buf[1 + SAE_POINT_LEN];
+    buf[0] = ECP_UNCOMPRESSED;
+    (void)memcpy_s(buf + 1, SAE_POINT_LEN, xy, SAE_POINT_LEN);
+    if (mbedtls_ecp_point_read_binary(grp, pt, buf, sizeof(buf)) != 0) {
+        return -1;
+    }
+    return mbedtls_ecp_check_pubkey(grp, pt);
+}
+
+/* y^2 = x^3 + ax + b, P-256 的 a 在 mbedtls 中以空值表示 -3 */
+static int SaeCurveRhs(const mbedtls_ecp_group *grp, const mbedtls_mpi *x, mbedtls_mpi *rhs)
+{
+    mbedtls_mpi t;
+    int ret;
+    mbedtls_mpi_init(&t);
+    ret = mbedtls_mpi_mul_mpi(rhs, x, x);
+    ret = ret ? ret : mbedtls_mpi_mod_mpi(rhs, rhs, &grp->P);
+    ret = ret ? ret : mbedtls_mpi_mul_mpi(rhs, rhs, x);
+    if (mbedtls_mpi_cmp_int(&grp->A, 0) == 0) {
+        ret = ret ? ret : mbedtls_mpi_mul_int(&t, x, 3);
+        ret = ret ? ret : mbedtls_mpi_sub_mpi(rhs, rhs, &t);
+    } else {
+        ret = ret ? ret : mbedtls_mpi_mul_mpi(&t, &grp->A, x);
+        ret = ret ? ret : mbedtls_mpi_add_mpi(rhs, rhs, &t);
+    }
+    ret = ret ? ret : mbedtls_mpi_add_mpi(rhs, rhs, &grp->B);
+    ret = ret ? ret : mbedtls_mpi_mod_mpi(rhs, rhs, &grp->P);
+    mbedtls_mpi_free(&t);
+    return ret;
+}
+
+/* 常数时间 a < b (大端定长) */
+static uint8_t SaeCtLess(const uint8_t *a, const uint8_t *b, size_t len)
+{
+    uint32_t borrow = 0;
+    for (size_t i = len; i > 0; i--) {
+        uint32_t d = (uint32_t)a[i - 1] - b[i - 1] - borrow;
+        borrow = (d >> BITS_PER_BYTE) & 1;
+    }
+    return (uint8_t)borrow;
+}
+
+/* sel 为 1 时 dst = src, 不产生分支 */
+static void SaeCtSelect(uint8_t *dst, const uint8_t *src, size_t len, uint8_t sel)
+{
+    uint8_t m = (uint8_t)(0 - sel);
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = (uint8_t)((dst[i] & (uint8_t)~m) | (src[i] & m));
+    }
+}
+
+/* 随机取 [1, p-1] 内的二次剩余 (qr) 与非剩余 (qnr), 供盲化判定使用 */
+static int SaeGetRandomQrQnr(const mbedtls_ecp_group *grp, mbedtls_mpi *qr, mbedtls_mpi *qnr)
+{
+    mbedtls_mpi t;
+    mbedtls_mpi e;
+    mbedtls_mpi r;
+    int haveQr = 0;
+    int haveQnr = 0;
+    int ret;
+
+    mbedtls_mpi_init(&t);
+    mbedtls_mpi_init(&e);
+    mbedtls_mpi_init(&r);
+    ret = mbedtls_mpi_sub_int(&e, &grp->P, 1);
+    ret = ret ? ret : mbedtls_mpi_shift_r(&e, 1);
+    while ((ret == 0) && (!haveQr || !haveQnr)) {
+        ret = mbedtls_mpi_fill_random(&t, SAE_PRIME_LEN, SaeRng, NULL);
+        ret = ret ? ret : mbedtls_mpi_mod_mpi(&t, &t, &grp->P);
+        ret = ret ? ret : mbedtls_mpi_exp_mod(&r, &t, &e, &grp->P, NULL);
+        if ((ret != 0) || (mbedtls_mpi_cmp_int(&t, 0) == 0)) {
+            continue;
+        }
+        if (!haveQr && (mbedtls_mpi_cmp_int(&r, 1) == 0)) {
+            ret = mbedtls_mpi_copy(qr, &t);
+            haveQr = 1;
+        } else if (!haveQnr && (mbedtls_mpi_cmp_int(&r, 1) != 0)) {
+            ret = mbedtls_mpi_copy(qnr, &t);
+            haveQnr = 1;
+        }
+    }
+    mbedtls_mpi_free(&t);
+    mbedtls_mpi_free(&e);
+    mbedtls_mpi_free(&r);
+    return ret;
+}
+
+/*
+ * 盲化的二次剩余判定: num = rhs * r^2 * (qr 或 qnr, 随机选取), 再求 Legendre 符号,
+ * 幂运算的输入与 rhs 无关, 结果按所乘因子翻转后才得到 rhs 的判定.
+ * 返回 1 为二次剩余, 0 为非剩余, 负值为错误.
+ */
+static int SaeIsQuadraticResidueBlind(const mbedtls_ecp_group *grp, const mbedtls_mpi *qr, const mbedtls_mpi *qnr,
+                                      const mbedtls_mpi *rhs)
+{
+    mbedtls_mpi r;
+    mbedtls_mpi num;
+    mbedtls_mpi e;
+    uint8_t mask = 0;
+    int res = -1;
+    int ret;
+
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&num);
+    mbedtls_mpi_init(&e);
+    do {
+        ret = mbedtls_mpi_fill_random(&r, SAE_PRIME_LEN, SaeRng, NULL);
+        ret = ret ? ret : mbedtls_mpi_mod_mpi(&r, &r, &grp->P);
+    } while ((ret == 0) && (mbedtls_mpi_cmp_int(&r, 0) == 0));
+    esp_fill_random(&mask, sizeof(mask));
+    mask &= 1;
+
+    ret = ret ? ret : mbedtls_mpi_mul_mpi(&num, rhs, &r);
+    ret = ret ? ret : mbedtls_mpi_mod_mpi(&num, &num, &grp->P);
+    ret = ret ? ret : mbedtls_mpi_mul_mpi(&num, &num, &r);
+    ret = ret ? ret : mbedtls_mpi_mod_mpi(&num, &num, &grp->P);
+    ret = ret ? ret : mbedtls_mpi_mul_mpi(&num, &num, mask ? qr : qnr);
+    ret = ret ? ret : mbedtls_mpi_mod_mpi(&num, &num, &grp->P);
+    ret = ret ? ret : mbedtls_mpi_sub_int(&e, &grp->P, 1);
+    ret = ret ? ret : mbedtls_mpi_shift_r(&e, 1);
+    ret = ret ? ret : mbedtls_mpi_exp_mod(&num, &num, &e, &grp->P, NULL);
+    if (ret == 0) {
+        /* 乘 qr 时符号不变, 乘 qnr 时符号翻转 */
+        uint8_t isOne = (uint8_t)(mbedtls_mpi_cmp_int(&num, 1) == 0);
+        res = (int)(isOne ^ (uint8_t)(mask ^ 1));
+    }
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&num);
+    mbedtls_mpi_free(&e);
+    return res;
+}
+
+/*
+ * 每轮都完整执行 PRF、曲线方程与盲化判定; value >= p 的轮次改用随机占位值参与运算,
+ * 结果以掩码合并, 轮次与分支均与口令无关.
+ */
+static int SaeDerivePwe(WpaSae_t *sae, const uint8_t *addr1, const uint8_t *addr2, const uint8_t *password,
+                        size_t passwordLen)
+{
+    uint8_t addrs[WPA_ETH_ALEN * 2];
+    uint8_t seed[SAE_PRIME_LEN];
+    uint8_t value[SAE_PRIME_LEN];
+    uint8_t dummy[SAE_PRIME_LEN];
+    uint8_t primeBin[SAE_PRIME_LEN];
+    uint8_t foundX[SAE_PRIME_LEN] = {0};
+    uint8_t foundSeedLsb = 0;
+    uint8_t found = 0;
+    uint8_t counter;
+    int ret = -1;
+    mbedtls_mpi x;
+    mbedtls_mpi rhs;
+    mbedtls_mpi y;
+    mbedtls_mpi e;
+    mbedtls_mpi qr;
+    mbedtls_mpi qnr;
+
+    /* max(addr1, addr2) || min(addr1, addr2) */
+    int cmp = memcmp(addr1, addr2, WPA_ETH_ALEN);
+    (void)memcpy_s(addrs, sizeof(addrs), (cmp > 0) ? addr1 : addr2, WPA_ETH_ALEN);
+    (void)memcpy_s(addrs + WPA_ETH_ALEN, WPA_ETH_ALEN, (cmp > 0) ? addr2 : addr1, WPA_ETH_ALEN);
+    if (mbedtls_mpi_write_binary(&sae->grp.P, primeBin, sizeof(primeBin)) != 0) {
+        return -1;
+    }
+
+    mbedtls_mpi_init(&x);
+    mbedtls_mpi_init(&rhs);
+    mbedtls_mpi_init(&y);
+    mbedtls_mpi_init(&e);
+    mbedtls_mpi_init(&qr);
+    mbedtls_mpi_init(&qnr);
+    if ((SaeGetRandomQrQnr(&sae->grp, &qr, &qnr) != 0) ||
+        (mbedtls_mpi_fill_random(&x, SAE_PRIME_LEN, SaeRng, NULL) != 0) ||
+        (mbedtls_mpi_mod_mpi(&x, &x, &sae->grp.P) != 0) ||
+        (mbedtls_mpi_write_binary(&x, dummy, sizeof(dummy)) != 0)) {
+        goto out;
+    }
+    for (counter = 1; counter <= SAE_HNP_ROUNDS; counter++) {
+        const unsigned char *addr[] = { password, &counter };
+        int len[] = { passwordLen, 1 };
+        if ((WpaHmacSha256Vector(addrs, sizeof(addrs), 2, addr, len, seed) != 0) ||
+            (WpaSha256PrfBits(seed, sizeof(seed), "SAE Hunting and Pecking", primeBin, sizeof(primeBin),
+                              value, SAE_PRIME_LEN * BITS_PER_BYTE) != 0)) {
+            goto out;
+        }
+        uint8_t inRange = SaeCtLess(value, primeBin, SAE_PRIME_LEN);
+        SaeCtSelect(value, dummy, sizeof(value), (uint8_t)(inRange ^ 1));
+        if ((mbedtls_mpi_read_binary(&x, value, sizeof(value)) != 0) || (SaeCurveRhs(&sae->grp, &x, &rhs) != 0)) {
+            goto out;
+        }
+        int isQr = SaeIsQuadraticResidueBlind(&sae->grp, &qr, &qnr, &rhs);
+        if (isQr < 0) {
+            goto out;
+        }
+        /* 首个有效轮次的结果保留, 其后轮次照常计算但不覆盖 */
+        uint8_t take = (uint8_t)isQr & inRange & (uint8_t)(found ^ 1);
+        uint8_t lsb = seed[SAE_PRIME_LEN - 1] & 1;
+        SaeCtSelect(foundX, value, sizeof(foundX), take);
+        SaeCtSelect(&foundSeedLsb, &lsb, 1, take);
+        found |= take;
+    }
+    if (!found) {
+        goto out;
+    }
+
+    /* p = 3 mod 4, y = rhs^((p+1)/4) */
+    uint8_t pt[SAE_POINT_LEN];
+    if ((mbedtls_mpi_read_binary(&x, foundX, sizeof(foundX)) != 0) || (SaeCurveRhs(&sae->grp, &x, &rhs) != 0) ||
+        (mbedtls_mpi_add_int(&e, &sae->grp.P, 1) != 0) || (mbedtls_mpi_shift_r(&e, 2) != 0) ||
+        (mbedtls_mpi_exp_mod(&y, &rhs, &e, &sae->grp.P, NULL) != 0)) {
+        goto out;
+    }
+    if ((uint8_t)mbedtls_mpi_get_bit(&y, 0) != foundSeedLsb) {
+        if (mbedtls_mpi_sub_mpi(&y, &sae->grp.P, &y) != 0) {
+            goto out;
+        }
+    }
+    if ((mbedtls_mpi_write_binary(&x, pt, SAE_PRIME_LEN) != 0) ||
+        (mbedtls_mpi_write_binary(&y, pt + SAE_PRIME_LEN, SAE_PRIME_LEN) != 0)) {
+        goto out;
+    }
+    ret = SaePointRead(&sae->grp, &sae->pwe, pt);
+out:
+    (void)memset_s(seed, sizeof(seed), 0, sizeof(seed));
+    (void)memset_s(value, sizeof(value), 0, sizeof(value));
+    (void)memset_s(foundX, sizeof(foundX), 0, sizeof(foundX));
+    mbedtls_mpi_free(&x);
+    mbedtls_mpi_free(&rhs);
+    mbedtls_mpi_free(&y);
+    mbedtls_mpi_free(&e);
+    mbedtls_mpi_free(&qr);
+    mbedtls_mpi_free(&qnr);
+    return ret;
+}
+
+/* 随机 rand/mask in [2, r-1], scalar = (rand + mask) mod r, element = -(mask * PWE) */
+static int SaeDeriveCommit(WpaSae_t *sae)
+{
+    mbedtls_mpi mask;
+    mbedtls_ecp_point tmp;
+    uint8_t xy[SAE_POINT_LEN];
+    int ret;
+
+    mbedtls_mpi_init(&mask);
+    mbedtls_ecp_point_init(&tmp);
+    do {
+        ret = mbedtls_ecp_gen_privkey(&sae->grp, &sae->rand, SaeRng, NULL);
+        ret = ret ? ret : mbedtls_ecp_gen_privkey(&sae->grp, &mask, SaeRng, NULL);
+        ret = ret ? ret : mbedtls_mpi_add_mpi(&sae->ownScalar, &sae->rand, &mask);
+        ret = ret ? ret : mbedtls_mpi_mod_mpi(&sae->ownScalar, &sae->ownScalar, &sae->grp.N);
+    } while ((ret == 0) && (mbedtls_mpi_cmp_int(&sae->ownScalar, 1) <= 0));
+
+    ret = ret ? ret : mbedtls_ecp_mul(&sae->grp, &tmp, &mask, &sae->pwe, SaeRng, NULL);
+    ret = ret ? ret : SaePointWrite(&sae->grp, &tmp, xy);
+    if (ret == 0) {
+        mbedtls_mpi y;
+        mbedtls_mpi_init(&y);
+        ret = mbedtls_mpi_read_binary(&y, xy + SAE_PRIME_LEN, SAE_PRIME_LEN);
+        ret = ret ? ret : mbedtls_mpi_sub_mpi(&y, &sae->grp.P, &y);
+        ret = ret ? ret : mbedtls_mpi_write_binary(&y, xy + SAE_PRIME_LEN, SAE_PRIME_LEN);
+        ret = ret ? ret : SaePointRead(&sae->grp, &sae->ownElement, xy);
+        mbedtls_mpi_free(&y);
+    }
+    mbedtls_mpi_free(&mask);
+    mbedtls_ecp_point_free(&tmp);
+    return ret;
+}
+
+/* K = rand * (peer-scalar * PWE + peer-element), keyseed = HMAC(0, x(K)) */
+static int SaeDeriveKeys(WpaSae_t *sae)
+{
+    mbedtls_ecp_point k;
+    mbedtls_mpi one;
+    mbedtls_mpi sum;
+    uint8_t xy[SAE_POINT_LEN];
+    uint8_t zero[SAE_PRIME_LEN] = {0};
+    uint8_t keyseed[SAE_PRIME_LEN];
+    uint8_t ctx[SAE_PRIME_LEN];
+    uint8_t keys[SAE_KCK_LEN + WPA_PMK_LEN];
+    int ret;
+
+    mbedtls_ecp_point_init(&k);
+    mbedtls_mpi_init(&one);
+    mbedtls_mpi_init(&sum);
+    ret = mbedtls_mpi_lset(&one, 1);
+    ret = ret ? ret : mbedtls_ecp_muladd(&sae->grp, &k, &sae->peerScalar, &sae->pwe, &one, &sae->peerElement);
+    ret = ret ? ret : mbedtls_ecp_mul(&sae->grp, &k, &sae->rand, &k, SaeRng, NULL);
+    ret = ret ? ret : SaePointWrite(&sae->grp, &k, xy);
+    if (ret == 0) {
+        const unsigned char *addr[] = { xy };
+        int len[] = { SAE_PRIME_LEN };
+        ret = WpaHmacSha256Vector(zero, sizeof(zero), 1, addr, len, keyseed);
+    }
+    ret = ret ? ret : mbedtls_mpi_add_mpi(&sum, &sae->ownScalar, &sae->peerScalar);
+    ret = ret ? ret : mbedtls_mpi_mod_mpi(&sum, &sum, &sae->grp.N);
+    ret = ret ? ret : mbedtls_mpi_write_binary(&sum, ctx, sizeof(ctx));
+    ret = ret ? ret : WpaSha256PrfBits(keyseed, sizeof(keyseed), "SAE KCK and PMK", ctx, sizeof(ctx),
+                                       keys, sizeof(keys) * BITS_PER_BYTE);
+    if (ret == 0) {
+        (void)memcpy_s(sae->kck, sizeof(sae->kck), keys, SAE_KCK_LEN);
+        (void)memcpy_s(sae->pmk, sizeof(sae->pmk), keys + SAE_KCK_LEN, WPA_PMK_LEN);
+        (void)memcpy_s(sae->pmkid, sizeof(sae->pmkid), ctx, WPA_PMKID_LEN);
+    }
+    (void)memset_s(keyseed, sizeof(keyseed), 0, sizeof(keyseed));
+    (void)memset_s(keys, sizeof(keys), 0, sizeof(keys));
+    mbedtls_ecp_point_free(&k);
+    mbedtls_mpi_free(&one);
+    mbedtls_mpi_free(&sum);
+    return ret;
+}
+
+/* confirm = HMAC-SHA256(KCK, send-confirm || scalar1 || element1 || scalar2 || element2) */
+static int SaeComputeConfirm(WpaSae_t *sae, uint16_t sc, int own, uint8_t *confirm)
+{
+    uint8_t data[sizeof(uint16_t) + (SAE_PRIME_LEN + SAE_POINT_LEN) * 2];
+    uint8_t *pos = data;
+    mbedtls_mpi *scalar1 = own ? &sae->ownScalar : &sae->peerScalar;
+    mbedtls_mpi *scalar2 = own ? &sae->peerScalar : &sae->ownScalar;
+    mbedtls_ecp_point *element1 = own ? &sae->ownElement : &sae->peerElement;
+    mbedtls_ecp_point *element2 = own ? &sae->peerElement : &sae->ownElement;
+
+    *pos++ = sc & 0xff;
+    *pos++ = sc >> BITS_PER_BYTE;
+    if ((mbedtls_mpi_write_binary(scalar1, pos, SAE_PRIME_LEN) != 0) ||
+        (SaePointWrite(&sae->grp, element1, pos + SAE_PRIME_LEN) != 0)) {
+        return -1;
+    }
+    pos += SAE_PRIME_LEN + SAE_POINT_LEN;
+    if ((mbedtls_mpi_write_binary(scalar2, pos, SAE_PRIME_LEN) != 0) ||
+        (SaePointWrite(&sae->grp, element2, pos + SAE_PRIME_LEN) != 0)) {
+        return -1;
+    }
+    const unsigned char *addr[] = { data };
+    int len[] = { sizeof(data) };
+    return WpaHmacSha256Vector(sae->kck, sizeof(sae->kck), 1, addr, len, confirm);
+}
+
+uint8_t *WpaSaeBuildMsg(const uint8_t *ownAddr, const uint8_t *bssid, uint32_t type, size_t *len)
+{
+    uint8_t *pos = NULL;
+
+    if (len == NULL) {
+        return NULL;
+    }
+    if (type == SAE_MSG_COMMIT) {
+        if (WpaSae == NULL) {
+            const uint8_t *password = esp_wifi_sta_get_prof_password_internal();
+            size_t passwordLen = (password != NULL) ? strnlen((const char *)password, SAE_MAX_PASSWORD) : 0;
+            WpaSae = SaeAlloc();
+            if ((WpaSae == NULL) || (passwordLen == 0) ||
+                (SaeDerivePwe(WpaSae, ownAddr, bssid, password, passwordLen) != 0) ||
+                (SaeDeriveCommit(WpaSae) != 0)) {
+                printf("WpaSae commit derive fail\r\n");
+                WpaSaeClear();
+                return NULL;
+            }
+        }
+        pos = WpaSae->msg;
+        *pos++ = SAE_GROUP_P256 & 0xff;
+        *pos++ = SAE_GROUP_P256 >> BITS_PER_BYTE;
+        if (WpaSae->tokenLen) {
+            (void)memcpy_s(pos, SAE_TOKEN_MAX, WpaSae->token, WpaSae->tokenLen);
+            pos += WpaSae->tokenLen;
+        }
+        if ((mbedtls_mpi_write_binary(&WpaSae->ownScalar, pos, SAE_PRIME_LEN) != 0) ||
+            (SaePointWrite(&WpaSae->grp, &WpaSae->ownElement, pos + SAE_PRIME_LEN) != 0)) {
+            return NULL;
+        }
+        pos += SAE_PRIME_LEN + SAE_POINT_LEN;
+        WpaSae->state = SAE_COMMITTED;
+    } else if ((type == SAE_MSG_CONFIRM) && (WpaSae != NULL) && (WpaSae->state >= SAE_CONFIRMED)) {
+        pos = WpaSae->msg;
+        WpaSae->sendConfirm++;
+        *pos++ = WpaSae->sendConfirm & 0xff;
+        *pos++ = WpaSae->sendConfirm >> BITS_PER_BYTE;
+        if (SaeComputeConfirm(WpaSae, WpaSae->sendConfirm, 1, pos) != 0) {
+            return NULL;
+        }
+        pos += SAE_CONFIRM_LEN;
+    } else {
+        return NULL;
+    }
+    *len = (size_t)(pos - WpaSae->msg);
+    return WpaSae->msg;
+}
+
+static int SaeParseCommit(const uint8_t *buf, size_t len, uint16_t status)
+{
+    uint16_t group;
+
+    if (len < sizeof(group)) {
+        return -1;
+    }
+    group = buf[0] | (buf[1] << BITS_PER_BYTE);
+    if (group != SAE_GROUP_P256) {
+        return -1;
+    }
+    /* 反阻塞: 保存 token, 由驱动重发 commit */
+    if (status == SAE_STATUS_ANTI_CLOGGING) {
+        if (len - sizeof(group) > SAE_TOKEN_MAX) {
+            return -1;
+        }
+        WpaSae->tokenLen = len - sizeof(group);
+        return memcpy_s(WpaSae->token, sizeof(WpaSae->token), buf + sizeof(group), WpaSae->tokenLen);
+    }
+    if (len != sizeof(group) + SAE_PRIME_LEN + SAE_POINT_LEN) {
+        return -1;
+    }
+    buf += sizeof(group);
+    if ((mbedtls_mpi_read_binary(&WpaSae->peerScalar, buf, SAE_PRIME_LEN) != 0) ||
+        (mbedtls_mpi_cmp_int(&WpaSae->peerScalar, 1) <= 0) ||
+        (mbedtls_mpi_cmp_mpi(&WpaSae->peerScalar, &WpaSae->grp.N) >= 0) ||
+        (SaePointRead(&WpaSae->grp, &WpaSae->peerElement, buf + SAE_PRIME_LEN) != 0)) {
+        return -1;
+    }
+    /* 对端回放本端 commit 视为反射攻击 */
+    if ((mbedtls_mpi_cmp_mpi(&WpaSae->peerScalar, &WpaSae->ownScalar) == 0) &&
+        (mbedtls_ecp_point_cmp(&WpaSae->peerElement, &WpaSae->ownElement) == 0)) {
+        return -1;
+    }
+    if (SaeDeriveKeys(WpaSae) != 0) {
+        return -1;
+    }
+    WpaSae->state = SAE_CONFIRMED;
+    return 0;
+}
+
+static int SaeParseConfirm(const uint8_t *buf, size_t len)
+{
+    uint8_t expect[SAE_CONFIRM_LEN];
+    uint8_t diff = 0;
+
+    if ((WpaSae->state != SAE_CONFIRMED) || (len != sizeof(uint16_t) + SAE_CONFIRM_LEN)) {
+        return -1;
+    }
+    uint16_t sc = buf[0] | (buf[1] << BITS_PER_BYTE);
+    if (SaeComputeConfirm(WpaSae, sc, 0, expect) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < SAE_CONFIRM_LEN; i++) {
+        diff |= expect[i] ^ buf[sizeof(uint16_t) + i];
+    }
+    if (diff != 0) {
+        printf("WpaSae confirm mismatch\r\n");
+        return -1;
+    }
+    WpaSae->state = SAE_ACCEPTED;
+    return 0;
+}
+
+int WpaSaeParseMsg(const uint8_t *buf, size_t len, uint32_t type, uint16_t status)
+{
+    if ((buf == NULL) || (WpaSae == NULL)) {
+        return -1;
+    }
+    if ((status != 0) && (status != SAE_STATUS_ANTI_CLOGGING)) {
+        printf("WpaSae status=%u\r\n", status);
+        return -1;
+    }
+    if (type == SAE_MSG_COMMIT) {
+        return SaeParseCommit(buf, len, status);
+    }
+    if (type == SAE_MSG_CONFIRM) {
+        return SaeParseConfirm(buf, len);
+    }
+    return -1;
+}
+
+int WpaSaeGetPmk(uint8_t *pmk, uint8_t *pmkid)
+{
+    if ((WpaSae == NULL) || (WpaSae->state != SAE_ACCEPTED)) {
+        return -1;
+    }
+    (void)memcpy_s(pmk, WPA_PMK_LEN, WpaSae->pmk, WPA_PMK_LEN);
+    if (pmkid != NULL) {
+        (void)memcpy_s(pmkid, WPA_PMKID_LEN, WpaSae->pmkid, WPA_PMKID_LEN);
+    }
+    return 0;
+}
+
+void WpaSaeClear(void)
+{
+    if (WpaSae != NULL) {
+        SaeFree(WpaSae);
+        WpaSae = NULL;
+    }
+}
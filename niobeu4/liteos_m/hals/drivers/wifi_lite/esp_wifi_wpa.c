@@ -13,9 +13,96 @@
  * limitations under the License.
  */
 
+#include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
+#include "esp_system.h"
+#include "esp_wifi.h"
+#include "securec.h"
+#include "esp_wifi_wpa.h"
+
+#define ETH_HDR_LEN 14
+#define ETH_P_EAPOL 0x888E
+#define EAPOL_VERSION 1
+#define EAPOL_TYPE_KEY 3
+#define EAPOL_HDR_LEN 4
+#define EAPOL_KEY_DESC_RSN 2
+#define EAPOL_KEY_DESC_WPA 254
+#define EAPOL_KEY_HDR_LEN 95
+#define EAPOL_KEY_IV_LEN 16
+#define EAPOL_KEY_MIC_LEN 16
+#define EAPOL_KEY_RSC_LEN 8
+#define WPA_RSC_LEN 6
+#define EAPOL_KEY_REPLAY_LEN 8
+#define EAPOL_KEY_DATA_MAX 256
+#define EAPOL_FRAME_MAX (ETH_HDR_LEN + EAPOL_HDR_LEN + EAPOL_KEY_HDR_LEN + EAPOL_KEY_DATA_MAX)
+
+/* EAPOL-Key 描述符字段偏移 */
+#define KEY_OFF_INFO 1
+#define KEY_OFF_LEN 3
+#define KEY_OFF_REPLAY 5
+#define KEY_OFF_NONCE 13
+#define KEY_OFF_IV 45
+#define KEY_OFF_RSC 61
+#define KEY_OFF_MIC 77
+#define KEY_OFF_DATA_LEN 93
+
+#define KEY_INFO_VER_MASK 0x0007
+#define KEY_INFO_VER_AKM 0
+#define KEY_INFO_VER_HMAC_MD5 1
+#define KEY_INFO_VER_HMAC_SHA1 2
+#define KEY_INFO_VER_AES_CMAC 3
+#define KEY_INFO_PAIRWISE 0x0008
+#define KEY_INFO_KEY_IDX_MASK 0x0030
+#define KEY_INFO_KEY_IDX_SHIFT 4
+#define KEY_INFO_INSTALL 0x0040
+#define KEY_INFO_ACK 0x0080
+#define KEY_INFO_MIC 0x0100
+#define KEY_INFO_SECURE 0x0200
+#define KEY_INFO_ENCR_DATA 0x1000
+
+#define PTK_KCK_LEN 16
+#define PTK_KEK_LEN 16
+#define PTK_TK_LEN 16
+#define PTK_TK_TKIP_LEN 32              // TK || Tx MIC 密钥 || Rx MIC 密钥
+#define PTK_MAX_LEN (PTK_KCK_LEN + PTK_KEK_LEN + PTK_TK_TKIP_LEN)
+#define TKIP_MIC_KEY_LEN 8
+#define GTK_MAX_LEN 32
+#define IGTK_LEN 16
+#define IGTK_KDE_LEN (2 + WPA_RSC_LEN + IGTK_LEN)      // KeyID || IPN || IGTK
+#define MD5_MAC_LEN 16
+#define SHA1_MAC_LEN 20
+#define KEYWRAP_BLOCK 8
+#define RC4_SKIP_LEN 256
+
+#define IE_RSN 0x30
+#define IE_VENDOR 0xdd
+#define RSN_SELECTOR_LEN 4
+#define RSN_IE_LEN 20
+#define WPA_IE_LEN 22
+#define ASSOC_IE_MAX (WPA_IE_LEN + 2)
+#define RSN_IE_MAX (2 + UINT8_MAX)
+#define RSN_CAP_MFPR 0x0040
+#define RSN_CAP_MFPC 0x0080
+#define RSN_AKM_PSK 2
+#define RSN_AKM_PSK_SHA256 6
+#define RSN_AKM_SAE 8
+#define RSN_CIPHER_TKIP 2
+#define RSN_CIPHER_CCMP 4
+#define RSN_CIPHER_BIP 6
+#define KDE_GTK 1
+#define KDE_GTK_HDR_LEN 2
+#define KDE_IGTK 9
+
+#define WPA_ALG_TKIP 2
+#define WPA_ALG_CCMP 3
+#define WIFI_APPIE_WPA 3
+#define WIFI_APPIE_RSN 4
+#define WLAN_REASON_IE_IN_4WAY_DIFFERS 17
+#define BITS_PER_BYTE 8
 
 struct wpa_funcs {
     bool (*wpa_sta_init)(void);
@@ -41,43 +128,786 @@ struct wpa_funcs {
     void (*wpa_config_done)(void);
 };
 
-struct {
-    uint32_t size;
-    uint32_t version;
-    char *func[24];
-}const g_wifi_default_wpa_crypto_funcs = {
-    .size = sizeof(g_wifi_default_wpa_crypto_funcs),
-    .version = 1,
-    {NULL}
-};
+typedef enum {
+    WPA_SM_IDLE = 0,
+    WPA_SM_ASSOCIATED,
+    WPA_SM_4WAY_PTK,        // 已发送 message 2, 等待 message 3
+    WPA_SM_GROUP,           // WPA: 已安装 PTK, 等待组密钥握手
+    WPA_SM_COMPLETED,
+} WpaSmState;
+
+/* 与驱动 wifi_wpa_igtk_t 布局一致 */
+typedef struct {
+    uint8_t keyId[2];
+    uint8_t ipn[WPA_RSC_LEN];
+    uint8_t igtk[IGTK_LEN];
+} WpaIgtk_t;
+
+/* Key Data 中解析出的内容, 指针指向调用者的明文缓冲 */
+typedef struct {
+    const uint8_t *ie;              // AP 的 RSN/WPA IE
+    size_t ieLen;
+    const uint8_t *gtk;
+    size_t gtkLen;
+    int gtkIdx;
+    const uint8_t *igtk;            // KeyID || IPN || IGTK
+} WpaKde_t;
+
+typedef struct {
+    WpaSmState state;
+    int proto;
+    int akm;
+    int pairwise;
+    int group;
+    uint8_t ownAddr[WPA_ETH_ALEN];
+    uint8_t bssid[WPA_ETH_ALEN];
+    uint8_t pmk[WPA_PMK_LEN];
+    uint8_t ptk[PTK_MAX_LEN];       // KCK || KEK || TK
+    uint8_t anonce[WPA_NONCE_LEN];
+    uint8_t snonce[WPA_NONCE_LEN];
+    uint8_t replay[EAPOL_KEY_REPLAY_LEN];
+    uint8_t replayValid;
+    uint8_t ptkValid;               // 当前 PTK 已安装, 重传的 message 3 不再安装
+    uint8_t gtk[GTK_MAX_LEN];       // 已安装的 GTK, 相同时不重装
+    uint8_t gtkLen;
+    uint8_t gtkIdx;
+    uint8_t igtk[IGTK_KDE_LEN];
+    uint8_t igtkValid;
+    uint8_t assocIe[ASSOC_IE_MAX];
+    uint8_t assocIeLen;
+    uint8_t apIe[RSN_IE_MAX];       // 信标/探测响应中的 RSN IE, 长度 0 表示未取到
+    uint16_t apIeLen;
+    uint8_t frame[EAPOL_FRAME_MAX];
+} WpaSm_t;
+
+static WpaSm_t *WpaSm = NULL;
+
+static const uint8_t RsnOui[] = { 0x00, 0x0f, 0xac };
+static const uint8_t WpaOui[] = { 0x00, 0x50, 0xf2 };
+static const uint8_t WpaIeType[] = { 0x00, 0x50, 0xf2, 0x01 };
 
 const char *g_wifi_default_mesh_crypto_funcs[2] = { NULL, NULL};
 int esp_wifi_register_wpa_cb_internal(struct wpa_funcs *cb);
 int esp_wifi_unregister_wpa_cb_internal(void);
+uint8_t *esp_wifi_sta_get_prof_pmk_internal(void);
+uint8_t esp_wifi_sta_get_prof_authmode_internal(void);
+bool esp_wifi_sta_prof_is_wpa_internal(void);
+uint8_t esp_wifi_sta_get_pairwise_cipher_internal(void);
+uint8_t esp_wifi_sta_get_group_cipher_internal(void);
+int esp_wifi_set_appie_internal(uint8_t type, uint8_t *ie, uint16_t len, uint8_t flag);
+int esp_wifi_set_sta_key_internal(int alg, uint8_t *addr, int key_idx, int set_tx, uint8_t *seq, size_t seq_len,
+                                  uint8_t *key, size_t key_len, int key_entry_valid);
+int esp_wifi_auth_done_internal(void);
+int esp_wifi_deauthenticate_internal(uint8_t reason_code);
+esp_err_t esp_wifi_internal_tx(wifi_interface_t ifx, void *buffer, uint16_t len);
+/* 按 BSSID 取扫描缓存中的 IE, 部分驱动版本未导出, 以弱引用判断 */
+uint8_t *esp_wifi_sta_get_ie(uint8_t *bssid, int elemId) __attribute__((weak));
+/* 不支持 PMF 的驱动版本没有该接口, 此时不声明 MFPC */
+int esp_wifi_set_igtk_internal(uint8_t ifx, const WpaIgtk_t *igtk) __attribute__((weak));
+
+static inline uint16_t GetBe16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << BITS_PER_BYTE) | p[1]);
+}
+
+static inline void PutBe16(uint8_t *p, uint16_t v)
+{
+    p[0] = v >> BITS_PER_BYTE;
+    p[1] = v & 0xff;
+}
+
+static inline uint16_t GetLe16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << BITS_PER_BYTE));
+}
+
+/* WPA IE 与 RSN IE 的套件编号相同, 只是 OUI 不同 */
+static int SelectorToCipher(const uint8_t *oui, const uint8_t *sel)
+{
+    if (memcmp(sel, oui, sizeof(RsnOui)) != 0) {
+        return 0;
+    }
+    switch (sel[3]) {
+        case RSN_CIPHER_TKIP:
+            return WPA_CIPHER_TKIP;
+        case RSN_CIPHER_CCMP:
+            return WPA_CIPHER_CCMP;
+        case RSN_CIPHER_BIP:
+            return WPA_CIPHER_AES_128_CMAC;
+        default:
+            return 0;
+    }
+}
+
+static int SelectorToAkm(const uint8_t *oui, const uint8_t *sel)
+{
+    if (memcmp(sel, oui, sizeof(RsnOui)) != 0) {
+        return 0;
+    }
+    switch (sel[3]) {
+        case RSN_AKM_PSK:
+            return WPA_KEY_MGMT_PSK;
+        case RSN_AKM_PSK_SHA256:
+            return WPA_KEY_MGMT_PSK_SHA256;
+        case RSN_AKM_SAE:
+            return WPA_KEY_MGMT_SAE;
+        default:
+            return 0;
+    }
+}
+
+static int ParseSuiteList(const uint8_t *oui, const uint8_t **pos, size_t *left, int akm, int *out)
+{
+    size_t count;
+
+    if (*left < sizeof(uint16_t)) {
+        return 0;
+    }
+    count = GetLe16(*pos);
+    *pos += sizeof(uint16_t);
+    *left -= sizeof(uint16_t);
+    if (count * RSN_SELECTOR_LEN > *left) {
+        return -1;
+    }
+    *out = 0;
+    for (size_t i = 0; i < count; i++, *pos += RSN_SELECTOR_LEN) {
+        *out |= akm ? SelectorToAkm(oui, *pos) : SelectorToCipher(oui, *pos);
+    }
+    *left -= count * RSN_SELECTOR_LEN;
+    return 0;
+}
+
+/* 解析 AP 的 RSN IE 或 WPA IE (00:50:f2:01), 驱动据此选择加密套件 */
+static int wpa_parse_wpa_ie(const uint8_t *wpa_ie, size_t wpa_ie_len, char *data)
+{
+    struct wpa_ie_data *ie = (struct wpa_ie_data *)data;
+    const uint8_t *oui = RsnOui;
+    const uint8_t *pos = wpa_ie + 2;
+    size_t left;
+
+    if ((wpa_ie == NULL) || (ie == NULL) || (wpa_ie_len < 2) || (wpa_ie[1] + 2 > wpa_ie_len)) {
+        return -1;
+    }
+    (void)memset_s(ie, sizeof(*ie), 0, sizeof(*ie));
+    left = wpa_ie[1];
+    if (wpa_ie[0] == IE_VENDOR) {
+        if ((left < sizeof(WpaIeType)) || (memcmp(pos, WpaIeType, sizeof(WpaIeType)) != 0)) {
+            return -1;
+        }
+        pos += sizeof(WpaIeType);
+        left -= sizeof(WpaIeType);
+        oui = WpaOui;
+        ie->proto = WPA_PROTO_WPA;
+        ie->pairwise_cipher = WPA_CIPHER_TKIP;
+        ie->group_cipher = WPA_CIPHER_TKIP;
+    } else if (wpa_ie[0] == IE_RSN) {
+        ie->proto = WPA_PROTO_RSN;
+        ie->pairwise_cipher = WPA_CIPHER_CCMP;
+        ie->group_cipher = WPA_CIPHER_CCMP;
+    } else {
+        return -1;
+    }
+    ie->key_mgmt = WPA_KEY_MGMT_PSK;
+    if (left < sizeof(uint16_t)) {
+        return -1;
+    }
+    left -= sizeof(uint16_t);      // 跳过 version
+    pos += sizeof(uint16_t);
+    if (left >= RSN_SELECTOR_LEN) {
+        ie->group_cipher = SelectorToCipher(oui, pos);
+        pos += RSN_SELECTOR_LEN;
+        left -= RSN_SELECTOR_LEN;
+    }
+    if ((ParseSuiteList(oui, &pos, &left, 0, &ie->pairwise_cipher) != 0) ||
+        (ParseSuiteList(oui, &pos, &left, 1, &ie->key_mgmt) != 0)) {
+        return -1;
+    }
+    if (left >= sizeof(uint16_t)) {
+        ie->capabilities = GetLe16(pos);
+        pos += sizeof(uint16_t);
+        left -= sizeof(uint16_t);
+    }
+    if (ie->proto == WPA_PROTO_WPA) {
+        return 0;
+    }
+    if (left >= sizeof(uint16_t)) {
+        ie->num_pmkid = GetLe16(pos);
+        pos += sizeof(uint16_t);
+        left -= sizeof(uint16_t);
+        if (ie->num_pmkid * WPA_PMKID_LEN > left) {
+            ie->num_pmkid = 0;
+            return -1;
+        }
+        ie->pmkid = pos;
+        pos += ie->num_pmkid * WPA_PMKID_LEN;
+        left -= ie->num_pmkid * WPA_PMKID_LEN;
+    }
+    if (left >= RSN_SELECTOR_LEN) {
+        ie->mgmt_group_cipher = SelectorToCipher(oui, pos);
+    }
+    return 0;
+}
+
+static inline int WpaCipherAlg(int cipher)
+{
+    return (cipher == WPA_CIPHER_TKIP) ? WPA_ALG_TKIP : WPA_ALG_CCMP;
+}
+
+static inline size_t WpaTkLen(const WpaSm_t *sm)
+{
+    return (sm->pairwise == WPA_CIPHER_TKIP) ? PTK_TK_TKIP_LEN : PTK_TK_LEN;
+}
+
+static int WpaDriverCipher(uint8_t type)
+{
+    return (type == WIFI_CIPHER_TYPE_TKIP) ? WPA_CIPHER_TKIP : WPA_CIPHER_CCMP;
+}
+
+static uint8_t *PutSelector(uint8_t *pos, const uint8_t *oui, uint8_t type)
+{
+    (void)memcpy_s(pos, RSN_SELECTOR_LEN, oui, sizeof(RsnOui));
+    pos[sizeof(RsnOui)] = type;
+    return pos + RSN_SELECTOR_LEN;
+}
+
+/* 关联请求中的 RSN IE 或 WPA IE, 各只列出一个选定的套件 */
+static void WpaBuildIe(WpaSm_t *sm)
+{
+    const uint8_t *oui = (sm->proto == WPA_PROTO_WPA) ? WpaOui : RsnOui;
+    uint8_t *pos = sm->assocIe;
+    uint8_t akm = (sm->akm == WPA_KEY_MGMT_SAE) ? RSN_AKM_SAE : RSN_AKM_PSK;
+    uint16_t cap = 0;
+
+    *pos++ = (sm->proto == WPA_PROTO_WPA) ? IE_VENDOR : IE_RSN;
+    pos++;                                  // 长度最后回填
+    if (sm->proto == WPA_PROTO_WPA) {
+        (void)memcpy_s(pos, sizeof(WpaIeType), WpaIeType, sizeof(WpaIeType));
+        pos += sizeof(WpaIeType);
+    }
+    *pos++ = 1;                             // version 1
+    *pos++ = 0;
+    pos = PutSelector(pos, oui, (sm->group == WPA_CIPHER_TKIP) ? RSN_CIPHER_TKIP : RSN_CIPHER_CCMP);
+    *pos++ = 1;
+    *pos++ = 0;
+    pos = PutSelector(pos, oui, (sm->pairwise == WPA_CIPHER_TKIP) ? RSN_CIPHER_TKIP : RSN_CIPHER_CCMP);
+    *pos++ = 1;
+    *pos++ = 0;
+    pos = PutSelector(pos, oui, akm);
+    if (sm->proto == WPA_PROTO_RSN) {
+        if (esp_wifi_set_igtk_internal != NULL) {
+            cap |= RSN_CAP_MFPC;
+            if (sm->akm == WPA_KEY_MGMT_SAE) {
+                cap |= RSN_CAP_MFPR;        // WPA3 要求 PMF
+            }
+        }
+        *pos++ = cap & 0xff;
+        *pos++ = cap >> BITS_PER_BYTE;
+    }
+    sm->assocIe[1] = (uint8_t)(pos - sm->assocIe - 2);
+    sm->assocIeLen = (uint8_t)(pos - sm->assocIe);
+}
+
+static int wpa_config_bss(uint8_t *bssid)
+{
+    uint8_t authmode = esp_wifi_sta_get_prof_authmode_internal();
+
+    if (WpaSm == NULL) {
+        return -1;
+    }
+    WpaSm->proto = esp_wifi_sta_prof_is_wpa_internal() ? WPA_PROTO_WPA : WPA_PROTO_RSN;
+    WpaSm->akm = ((WpaSm->proto == WPA_PROTO_RSN) &&
+                  ((authmode == WIFI_AUTH_WPA3_PSK) || (authmode == WIFI_AUTH_WPA2_WPA3_PSK))) ?
+                 WPA_KEY_MGMT_SAE : WPA_KEY_MGMT_PSK;
+    WpaSm->pairwise = WpaDriverCipher(esp_wifi_sta_get_pairwise_cipher_internal());
+    WpaSm->group = WpaDriverCipher(esp_wifi_sta_get_group_cipher_internal());
+    (void)memcpy_s(WpaSm->bssid, sizeof(WpaSm->bssid), bssid, WPA_ETH_ALEN);
+    (void)esp_wifi_get_mac(WIFI_IF_STA, WpaSm->ownAddr);
+    WpaSm->apIeLen = 0;
+    if ((WpaSm->proto == WPA_PROTO_RSN) && (esp_wifi_sta_get_ie != NULL)) {
+        const uint8_t *apIe = esp_wifi_sta_get_ie(bssid, IE_RSN);
+        if ((apIe != NULL) && (apIe[0] == IE_RSN)) {
+            WpaSm->apIeLen = apIe[1] + 2;
+            (void)memcpy_s(WpaSm->apIe, sizeof(WpaSm->apIe), apIe, WpaSm->apIeLen);
+        }
+    }
+    WpaBuildIe(WpaSm);
+    return esp_wifi_set_appie_internal((WpaSm->proto == WPA_PROTO_WPA) ? WIFI_APPIE_WPA : WIFI_APPIE_RSN,
+                                       WpaSm->assocIe, WpaSm->assocIeLen, 0);
+}
+
+static void WpaSmReset(WpaSm_t *sm)
+{
+    sm->state = WPA_SM_IDLE;
+    sm->replayValid = 0;
+    sm->ptkValid = 0;
+    sm->gtkLen = 0;
+    sm->igtkValid = 0;
+    (void)memset_s(sm->pmk, sizeof(sm->pmk), 0, sizeof(sm->pmk));
+    (void)memset_s(sm->ptk, sizeof(sm->ptk), 0, sizeof(sm->ptk));
+    (void)memset_s(sm->gtk, sizeof(sm->gtk), 0, sizeof(sm->gtk));
+    (void)memset_s(sm->igtk, sizeof(sm->igtk), 0, sizeof(sm->igtk));
+}
+
+static int WpaDerivePtk(WpaSm_t *sm)
+{
+    uint8_t data[WPA_ETH_ALEN * 2 + WPA_NONCE_LEN * 2];
+    uint8_t *pos = data;
+    size_t ptkLen = PTK_KCK_LEN + PTK_KEK_LEN + WpaTkLen(sm);
+    int addrCmp = memcmp(sm->ownAddr, sm->bssid, WPA_ETH_ALEN);
+    int nonceCmp = memcmp(sm->snonce, sm->anonce, WPA_NONCE_LEN);
+
+    (void)memcpy_s(pos, WPA_ETH_ALEN, (addrCmp < 0) ? sm->ownAddr : sm->bssid, WPA_ETH_ALEN);
+    pos += WPA_ETH_ALEN;
+    (void)memcpy_s(pos, WPA_ETH_ALEN, (addrCmp < 0) ? sm->bssid : sm->ownAddr, WPA_ETH_ALEN);
+    pos += WPA_ETH_ALEN;
+    (void)memcpy_s(pos, WPA_NONCE_LEN, (nonceCmp < 0) ? sm->snonce : sm->anonce, WPA_NONCE_LEN);
+    pos += WPA_NONCE_LEN;
+    (void)memcpy_s(pos, WPA_NONCE_LEN, (nonceCmp < 0) ? sm->anonce : sm->snonce, WPA_NONCE_LEN);
+
+    if (sm->akm == WPA_KEY_MGMT_PSK) {
+        return WpaSha1Prf(sm->pmk, WPA_PMK_LEN, "Pairwise key expansion", data, sizeof(data), sm->ptk, ptkLen);
+    }
+    return WpaSha256PrfBits(sm->pmk, WPA_PMK_LEN, "Pairwise key expansion", data, sizeof(data),
+                            sm->ptk, ptkLen * BITS_PER_BYTE);
+}
+
+/* MIC 覆盖整个 EAPOL 帧(MIC 字段置零) */
+static int WpaKeyMic(const WpaSm_t *sm, uint16_t ver, const uint8_t *eapol, size_t len, uint8_t *mic)
+{
+    if (ver == KEY_INFO_VER_HMAC_MD5) {
+        return WpaHmacMd5(sm->ptk, PTK_KCK_LEN, eapol, len, mic);
+    }
+    if (ver == KEY_INFO_VER_HMAC_SHA1) {
+        uint8_t hash[SHA1_MAC_LEN];
+        const unsigned char *addr[] = { eapol };
+        unsigned int alen[] = { len };
+        if (WpaHmacSha1Vector(sm->ptk, PTK_KCK_LEN, 1, addr, alen, hash) != 0) {
+            return -1;
+        }
+        return memcpy_s(mic, EAPOL_KEY_MIC_LEN, hash, EAPOL_KEY_MIC_LEN);
+    }
+    if ((ver == KEY_INFO_VER_AES_CMAC) || (ver == KEY_INFO_VER_AKM)) {
+        return WpaOmac1Aes128(sm->ptk, eapol, len, mic);
+    }
+    return -1;
+}
+
+static int WpaVerifyMic(const WpaSm_t *sm, uint16_t ver, uint8_t *eapol, size_t len)
+{
+    uint8_t *key = eapol + EAPOL_HDR_LEN;
+    uint8_t rxMic[EAPOL_KEY_MIC_LEN];
+    uint8_t mic[EAPOL_KEY_MIC_LEN];
+    uint8_t diff = 0;
+
+    (void)memcpy_s(rxMic, sizeof(rxMic), key + KEY_OFF_MIC, EAPOL_KEY_MIC_LEN);
+    (void)memset_s(key + KEY_OFF_MIC, EAPOL_KEY_MIC_LEN, 0, EAPOL_KEY_MIC_LEN);
+    int ret = WpaKeyMic(sm, ver, eapol, len, mic);
+    (void)memcpy_s(key + KEY_OFF_MIC, EAPOL_KEY_MIC_LEN, rxMic, EAPOL_KEY_MIC_LEN);
+    if (ret != 0) {
+        return -1;
+    }
+    for (int i = 0; i < EAPOL_KEY_MIC_LEN; i++) {
+        diff |= rxMic[i] ^ mic[i];
+    }
+    return (diff == 0) ? 0 : -1;
+}
+
+/* keyLen 仅 WPA 的 message 2 需要, 回填 message 1 中的密钥长度 */
+static int WpaSendKey(WpaSm_t *sm, uint16_t keyInfo, uint16_t keyLen, const uint8_t *nonce, const uint8_t *data,
+                      size_t dataLen)
+{
+    uint8_t *frame = sm->frame;
+    uint8_t *eapol = frame + ETH_HDR_LEN;
+    uint8_t *key = eapol + EAPOL_HDR_LEN;
+    size_t bodyLen = EAPOL_KEY_HDR_LEN + dataLen;
+
+    if (dataLen > EAPOL_KEY_DATA_MAX) {
+        return -1;
+    }
+    (void)memset_s(frame, sizeof(sm->frame), 0, ETH_HDR_LEN + EAPOL_HDR_LEN + bodyLen);
+    (void)memcpy_s(frame, WPA_ETH_ALEN, sm->bssid, WPA_ETH_ALEN);
+    (void)memcpy_s(frame + WPA_ETH_ALEN, WPA_ETH_ALEN, sm->ownAddr, WPA_ETH_ALEN);
+    PutBe16(frame + WPA_ETH_ALEN * 2, ETH_P_EAPOL);
+    eapol[0] = EAPOL_VERSION;
+    eapol[1] = EAPOL_TYPE_KEY;
+    PutBe16(eapol + 2, (uint16_t)bodyLen);
+    key[0] = (sm->proto == WPA_PROTO_WPA) ? EAPOL_KEY_DESC_WPA : EAPOL_KEY_DESC_RSN;
+    PutBe16(key + KEY_OFF_INFO, keyInfo);
+    PutBe16(key + KEY_OFF_LEN, keyLen);
+    (void)memcpy_s(key + KEY_OFF_REPLAY, EAPOL_KEY_REPLAY_LEN, sm->replay, EAPOL_KEY_REPLAY_LEN);
+    if (nonce != NULL) {
+        (void)memcpy_s(key + KEY_OFF_NONCE, WPA_NONCE_LEN, nonce, WPA_NONCE_LEN);
+    }
+    PutBe16(key + KEY_OFF_DATA_LEN, (uint16_t)dataLen);
+    if (dataLen) {
+        (void)memcpy_s(key + EAPOL_KEY_HDR_LEN, EAPOL_KEY_DATA_MAX, data, dataLen);
+    }
+    if (WpaKeyMic(sm, keyInfo & KEY_INFO_VER_MASK, eapol, EAPOL_HDR_LEN + bodyLen, key + KEY_OFF_MIC) != 0) {
+        return -1;
+    }
+    return (esp_wifi_internal_tx(WIFI_IF_STA, frame, ETH_HDR_LEN + EAPOL_HDR_LEN + bodyLen) == ESP_OK) ? 0 : -1;
+}
+
+/* 解密 Key Data: 版本 1 (TKIP) 为 RC4(IV || KEK) 丢弃前 256 字节, 其余为 AES Key Wrap */
+static int WpaDecryptKeyData(const WpaSm_t *sm, uint16_t ver, const uint8_t *key, uint8_t *plain, size_t *plainLen)
+{
+    const uint8_t *data = key + EAPOL_KEY_HDR_LEN;
+    size_t len = GetBe16(key + KEY_OFF_DATA_LEN);
+
+    if (ver == KEY_INFO_VER_HMAC_MD5) {
+        uint8_t rc4Key[EAPOL_KEY_IV_LEN + PTK_KEK_LEN];
+        if (len > EAPOL_KEY_DATA_MAX) {
+            return -1;
+        }
+        (void)memcpy_s(rc4Key, sizeof(rc4Key), key + KEY_OFF_IV, EAPOL_KEY_IV_LEN);
+        (void)memcpy_s(rc4Key + EAPOL_KEY_IV_LEN, PTK_KEK_LEN, sm->ptk + PTK_KCK_LEN, PTK_KEK_LEN);
+        (void)memcpy_s(plain, EAPOL_KEY_DATA_MAX, data, len);
+        (void)WpaRc4Skip(rc4Key, sizeof(rc4Key), RC4_SKIP_LEN, plain, len);
+        (void)memset_s(rc4Key, sizeof(rc4Key), 0, sizeof(rc4Key));
+        *plainLen = len;
+        return 0;
+    }
+    if ((len < KEYWRAP_BLOCK * 2) || (len % KEYWRAP_BLOCK) || (len > EAPOL_KEY_DATA_MAX + KEYWRAP_BLOCK)) {
+        return -1;
+    }
+    *plainLen = len - KEYWRAP_BLOCK;
+    return WpaAesUnwrap(sm->ptk + PTK_KCK_LEN, (int)(*plainLen / KEYWRAP_BLOCK), data, plain);
+}
+
+/* 查找 RSN IE 与 GTK/IGTK KDE, 必须带 GTK */
+static int WpaParseKde(const uint8_t *buf, size_t len, WpaKde_t *kde)
+{
+    const uint8_t *pos = buf;
+    const uint8_t *end = buf + len;
+
+    while (pos + 2 <= end) {
+        size_t eLen = pos[1];
+        if ((pos[0] == 0) || (pos + 2 + eLen > end)) {
+            break;          // 0xdd 0x00 之后为填充
+        }
+        if ((pos[0] == IE_RSN) && (kde->ie == NULL)) {
+            kde->ie = pos;
+            kde->ieLen = eLen + 2;
+        } else if ((pos[0] == IE_VENDOR) && (eLen > RSN_SELECTOR_LEN) &&
+                   (memcmp(pos + 2, RsnOui, sizeof(RsnOui)) == 0)) {
+            const uint8_t *body = pos + 2 + RSN_SELECTOR_LEN;
+            size_t bodyLen = eLen - RSN_SELECTOR_LEN;
+            uint8_t type = pos[2 + sizeof(RsnOui)];
+            if ((type == KDE_GTK) && (bodyLen > KDE_GTK_HDR_LEN) && (bodyLen - KDE_GTK_HDR_LEN <= GTK_MAX_LEN)) {
+                kde->gtkIdx = body[0] & 0x03;
+                kde->gtk = body + KDE_GTK_HDR_LEN;
+                kde->gtkLen = bodyLen - KDE_GTK_HDR_LEN;
+            } else if ((type == KDE_IGTK) && (bodyLen == IGTK_KDE_LEN)) {
+                kde->igtk = body;
+            }
+        }
+        pos += 2 + eLen;
+    }
+    return (kde->gtk != NULL) ? 0 : -1;
+}
+
+/*
+ * message 3 中 AP 的 RSN/WPA IE 受 MIC 保护, 须与关联前信标/探测响应中的逐字节一致,
+ * 否则视为降级攻击. 驱动未提供信标 IE 时, 至少校验所选 AKM 与加密套件确为 AP 所支持.
+ */
+static int WpaCheckApIe(const WpaSm_t *sm, const uint8_t *ie, size_t ieLen)
+{
+    struct wpa_ie_data data;
+
+    if ((ie == NULL) || (ieLen < 2) || (wpa_parse_wpa_ie(ie, ieLen, (char *)&data) != 0)) {
+        return -1;
+    }
+    ieLen = ie[1] + 2;
+    if (sm->apIeLen != 0) {
+        return ((ieLen == sm->apIeLen) && (memcmp(ie, sm->apIe, ieLen) == 0)) ? 0 : -1;
+    }
+    return ((data.proto == sm->proto) && (data.pairwise_cipher & sm->pairwise) && (data.key_mgmt & sm->akm)) ?
+           0 : -1;
+}
+
+/* 与已安装的 IGTK 相同 (KeyID 与密钥) 时不重装, IPN 不回退 */
+static int WpaInstallIgtk(WpaSm_t *sm, const uint8_t *igtk)
+{
+    const size_t keyOff = IGTK_KDE_LEN - IGTK_LEN;
+    WpaIgtk_t conf;
+    int ret;
+
+    if (esp_wifi_set_igtk_internal == NULL) {
+        return 0;
+    }
+    if (sm->igtkValid && (memcmp(sm->igtk, igtk, sizeof(conf.keyId)) == 0) &&
+        (memcmp(sm->igtk + keyOff, igtk + keyOff, IGTK_LEN) == 0)) {
+        return 0;
+    }
+    (void)memcpy_s(&conf, sizeof(conf), igtk, IGTK_KDE_LEN);
+    ret = esp_wifi_set_igtk_internal(WIFI_IF_STA, &conf);
+    (void)memset_s(&conf, sizeof(conf), 0, sizeof(conf));
+    if (ret == 0) {
+        (void)memcpy_s(sm->igtk, sizeof(sm->igtk), igtk, IGTK_KDE_LEN);
+        sm->igtkValid = 1;
+    }
+    return ret;
+}
+
+/*
+ * 与已安装的 GTK 索引和内容都相同时不重装, 否则驱动会重置接收序号, 重放的组播帧将被接受
+ * (CVE-2017-13080). TKIP 组密钥交给驱动前须交换 Tx/Rx MIC 密钥.
+ */
+static int WpaInstallGroupKeys(WpaSm_t *sm, uint8_t *key, const WpaKde_t *kde)
+{
+    uint8_t broadcast[WPA_ETH_ALEN] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+    uint8_t gtk[GTK_MAX_LEN];
+    int ret = 0;
+
+    if ((kde->gtkLen != sm->gtkLen) || (kde->gtkIdx != sm->gtkIdx) ||
+        (memcmp(kde->gtk, sm->gtk, kde->gtkLen) != 0)) {
+        (void)memcpy_s(gtk, sizeof(gtk), kde->gtk, kde->gtkLen);
+        if ((sm->group == WPA_CIPHER_TKIP) && (kde->gtkLen == PTK_TK_TKIP_LEN)) {
+            (void)memcpy_s(gtk + PTK_TK_LEN, TKIP_MIC_KEY_LEN, kde->gtk + PTK_TK_LEN + TKIP_MIC_KEY_LEN,
+                           TKIP_MIC_KEY_LEN);
+            (void)memcpy_s(gtk + PTK_TK_LEN + TKIP_MIC_KEY_LEN, TKIP_MIC_KEY_LEN, kde->gtk + PTK_TK_LEN,
+                           TKIP_MIC_KEY_LEN);
+        }
+        ret = esp_wifi_set_sta_key_internal(WpaCipherAlg(sm->group), broadcast, kde->gtkIdx, 0, key + KEY_OFF_RSC,
+                                            WPA_RSC_LEN, gtk, kde->gtkLen, 0);
+        (void)memset_s(gtk, sizeof(gtk), 0, sizeof(gtk));
+        if (ret == 0) {
+            (void)memcpy_s(sm->gtk, sizeof(sm->gtk), kde->gtk, kde->gtkLen);
+            sm->gtkLen = (uint8_t)kde->gtkLen;
+            sm->gtkIdx = (uint8_t)kde->gtkIdx;
+        }
+    }
+    if ((ret == 0) && (kde->igtk != NULL)) {
+        ret = WpaInstallIgtk(sm, kde->igtk);
+    }
+    return ret;
+}
+
+static int WpaProcessMsg1(WpaSm_t *sm, uint16_t ver, const uint8_t *key)
+{
+    if (sm->akm == WPA_KEY_MGMT_SAE) {
+        if (WpaSaeGetPmk(sm->pmk, NULL) != 0) {
+            return -1;
+        }
+    } else {
+        const uint8_t *pmk = esp_wifi_sta_get_prof_pmk_internal();
+        if (pmk == NULL) {
+            return -1;
+        }
+        (void)memcpy_s(sm->pmk, sizeof(sm->pmk), pmk, WPA_PMK_LEN);
+    }
+    (void)memcpy_s(sm->anonce, sizeof(sm->anonce), key + KEY_OFF_NONCE, WPA_NONCE_LEN);
+    esp_fill_random(sm->snonce, sizeof(sm->snonce));
+    if (WpaDerivePtk(sm) != 0) {
+        return -1;
+    }
+    sm->ptkValid = 0;
+    sm->state = WPA_SM_4WAY_PTK;
+    return WpaSendKey(sm, ver | KEY_INFO_PAIRWISE | KEY_INFO_MIC,
+                      (sm->proto == WPA_PROTO_WPA) ? GetBe16(key + KEY_OFF_LEN) : 0,
+                      sm->snonce, sm->assocIe, sm->assocIeLen);
+}
+
+static int WpaProcessMsg3(WpaSm_t *sm, uint16_t ver, uint16_t keyInfo, uint8_t *key)
+{
+    uint8_t plain[EAPOL_KEY_DATA_MAX];
+    size_t plainLen = 0;
+    WpaKde_t kde;
+    int ret = -1;
+
+    if ((sm->state < WPA_SM_4WAY_PTK) || (memcmp(sm->anonce, key + KEY_OFF_NONCE, WPA_NONCE_LEN) != 0)) {
+        return -1;
+    }
+    (void)memset_s(&kde, sizeof(kde), 0, sizeof(kde));
+    if (sm->proto == WPA_PROTO_WPA) {
+        /* WPA 的 message 3 只携带明文 WPA IE, GTK 由随后的组密钥握手下发 */
+        kde.ie = key + EAPOL_KEY_HDR_LEN;
+        kde.ieLen = GetBe16(key + KEY_OFF_DATA_LEN);
+        ret = 0;
+    } else if ((keyInfo & KEY_INFO_ENCR_DATA) && (WpaDecryptKeyData(sm, ver, key, plain, &plainLen) == 0)) {
+        ret = WpaParseKde(plain, plainLen, &kde);
+    }
+    if (ret != 0) {
+        printf("WpaSm msg3 no GTK\r\n");
+    } else if (WpaCheckApIe(sm, kde.ie, kde.ieLen) != 0) {
+        printf("WpaSm msg3 RSN IE mismatch\r\n");
+        esp_wifi_deauthenticate_internal(WLAN_REASON_IE_IN_4WAY_DIFFERS);
+        ret = -1;
+    } else {
+        /*
+         * 先以明文发送 message 4, 再安装 PTK. AP 未收到 message 4 时会重传 message 3,
+         * 此时只回复 message 4, 不重装同一 PTK, 否则 nonce 与重放计数被重置 (CVE-2017-13077).
+         */
+        ret = WpaSendKey(sm, ver | KEY_INFO_PAIRWISE | KEY_INFO_MIC | (keyInfo & KEY_INFO_SECURE), 0,
+                         NULL, NULL, 0);
+        if ((ret == 0) && (keyInfo & KEY_INFO_INSTALL) && !sm->ptkValid) {
+            ret = esp_wifi_set_sta_key_internal(WpaCipherAlg(sm->pairwise), sm->bssid, 0, 1, NULL, 0,
+                                                sm->ptk + PTK_KCK_LEN + PTK_KEK_LEN, WpaTkLen(sm), 0);
+            sm->ptkValid = (ret == 0);
+        }
+        if ((ret == 0) && (kde.gtk != NULL)) {
+            ret = WpaInstallGroupKeys(sm, key, &kde);
+        }
+    }
+    (void)memset_s(plain, sizeof(plain), 0, sizeof(plain));
+    if ((ret == 0) && (sm->state == WPA_SM_4WAY_PTK)) {
+        sm->state = (sm->proto == WPA_PROTO_WPA) ? WPA_SM_GROUP : WPA_SM_COMPLETED;
+        if (sm->state == WPA_SM_COMPLETED) {
+            esp_wifi_auth_done_internal();
+        }
+    }
+    return ret;
+}
+
+static int WpaProcessGroupMsg1(WpaSm_t *sm, uint16_t ver, uint16_t keyInfo, uint8_t *key)
+{
+    uint8_t plain[EAPOL_KEY_DATA_MAX];
+    size_t plainLen = 0;
+    WpaKde_t kde;
+    int ret = -1;
+
+    if ((sm->state < WPA_SM_GROUP) || !(keyInfo & KEY_INFO_SECURE) ||
+        (WpaDecryptKeyData(sm, ver, key, plain, &plainLen) != 0)) {
+        return -1;
+    }
+    (void)memset_s(&kde, sizeof(kde), 0, sizeof(kde));
+    if (sm->proto == WPA_PROTO_WPA) {
+        /* WPA 的组密钥直接放在 Key Data 中, 长度与索引取自描述符 */
+        kde.gtk = plain;
+        kde.gtkLen = GetBe16(key + KEY_OFF_LEN);
+        kde.gtkIdx = (keyInfo & KEY_INFO_KEY_IDX_MASK) >> KEY_INFO_KEY_IDX_SHIFT;
+        ret = ((kde.gtkLen != 0) && (kde.gtkLen <= plainLen) && (kde.gtkLen <= GTK_MAX_LEN)) ? 0 : -1;
+    } else {
+        ret = WpaParseKde(plain, plainLen, &kde);
+    }
+    if (ret == 0) {
+        ret = WpaInstallGroupKeys(sm, key, &kde);
+    }
+    (void)memset_s(plain, sizeof(plain), 0, sizeof(plain));
+    if (ret == 0) {
+        ret = WpaSendKey(sm, ver | KEY_INFO_MIC | KEY_INFO_SECURE | (keyInfo & KEY_INFO_KEY_IDX_MASK), 0,
+                         NULL, NULL, 0);
+    }
+    if ((ret == 0) && (sm->state == WPA_SM_GROUP)) {
+        sm->state = WPA_SM_COMPLETED;
+        esp_wifi_auth_done_internal();
+    }
+    return ret;
+}
+
+static int wpa_sta_rx_eapol(uint8_t *src_addr, uint8_t *buf, uint32_t len)
+{
+    WpaSm_t *sm = WpaSm;
+    uint8_t *key = buf + EAPOL_HDR_LEN;
+
+    if ((sm == NULL) || (buf == NULL) || (len < EAPOL_HDR_LEN + EAPOL_KEY_HDR_LEN) ||
+        (buf[1] != EAPOL_TYPE_KEY) ||
+        (key[0] != ((sm->proto == WPA_PROTO_WPA) ? EAPOL_KEY_DESC_WPA : EAPOL_KEY_DESC_RSN))) {
+        return -1;
+    }
+    size_t bodyLen = GetBe16(buf + 2);
+    if ((bodyLen + EAPOL_HDR_LEN > len) ||
+        (EAPOL_KEY_HDR_LEN + GetBe16(key + KEY_OFF_DATA_LEN) > bodyLen)) {
+        return -1;
+    }
+    if ((src_addr != NULL) && (memcmp(src_addr, sm->bssid, WPA_ETH_ALEN) != 0)) {
+        return -1;
+    }
+    /* 重放计数必须单调递增 */
+    if (sm->replayValid && (memcmp(key + KEY_OFF_REPLAY, sm->replay, EAPOL_KEY_REPLAY_LEN) <= 0)) {
+        return -1;
+    }
+
+    uint16_t keyInfo = GetBe16(key + KEY_OFF_INFO);
+    uint16_t ver = keyInfo & KEY_INFO_VER_MASK;
+    /* 只有 message 1 不带 MIC; 不带 MIC 的组密钥消息未经认证, 直接丢弃 */
+    if (!(keyInfo & (KEY_INFO_PAIRWISE | KEY_INFO_MIC))) {
+        return -1;
+    }
+    if ((keyInfo & KEY_INFO_MIC) && ((sm->state < WPA_SM_4WAY_PTK) ||
+        (WpaVerifyMic(sm, ver, buf, EAPOL_HDR_LEN + bodyLen) != 0))) {
+        printf("WpaSm MIC fail\r\n");
+        return -1;
+    }
+    (void)memcpy_s(sm->replay, sizeof(sm->replay), key + KEY_OFF_REPLAY, EAPOL_KEY_REPLAY_LEN);
+    sm->replayValid = 1;
+
+    int ret;
+    if (!(keyInfo & KEY_INFO_PAIRWISE)) {
+        ret = WpaProcessGroupMsg1(sm, ver, keyInfo, key);
+    } else if (keyInfo & KEY_INFO_MIC) {
+        ret = WpaProcessMsg3(sm, ver, keyInfo, key);
+    } else {
+        ret = WpaProcessMsg1(sm, ver, key);
+    }
+    if (ret != 0) {
+        printf("WpaSm handshake fail info=0x%04X state=%d\r\n", keyInfo, sm->state);
+    }
+    return ret;
+}
+
+static bool wpa_sta_in_4way_handshake(void)
+{
+    return (WpaSm != NULL) && ((WpaSm->state == WPA_SM_4WAY_PTK) || (WpaSm->state == WPA_SM_GROUP));
+}
 
 static bool wpa_attach(void)
 {
+    if (WpaSm == NULL) {
+        WpaSm = (WpaSm_t *)malloc(sizeof(WpaSm_t));
+        if (WpaSm == NULL) {
+            return false;
+        }
+    }
+    (void)memset_s(WpaSm, sizeof(WpaSm_t), 0, sizeof(WpaSm_t));
     return true;
 }
 
 static bool wpa_deattach(void)
 {
+    WpaSaeClear();
+    if (WpaSm != NULL) {
+        (void)memset_s(WpaSm, sizeof(WpaSm_t), 0, sizeof(WpaSm_t));
+        free(WpaSm);
+        WpaSm = NULL;
+    }
     return true;
 }
 
 static void wpa_sta_connect(uint8_t *bssid)
 {
+    if ((WpaSm == NULL) || (wpa_config_bss(bssid) != 0)) {
+        return;
+    }
+    WpaSmReset(WpaSm);
+    WpaSm->state = WPA_SM_ASSOCIATED;
 }
 
 static void wpa_sta_disconnected_cb(uint8_t reason_code)
 {
+    if (WpaSm != NULL) {
+        WpaSmReset(WpaSm);
+    }
+    WpaSaeClear();
 }
 
-static int wpa_parse_wpa_ie(const uint8_t *wpa_ie, size_t wpa_ie_len, char *data)
+static int wpa_michael_mic_failure(uint16_t is_unicast)
 {
     return 0;
 }
 
+static uint8_t *wpa3_build_sae_msg(uint8_t *bssid, uint32_t type, size_t *len)
+{
+    uint8_t ownAddr[WPA_ETH_ALEN] = {0};
+    (void)esp_wifi_get_mac(WIFI_IF_STA, ownAddr);
+    return WpaSaeBuildMsg(ownAddr, bssid, type, len);
+}
+
+static int wpa3_parse_sae_msg(uint8_t *buf, size_t len, uint32_t type, uint16_t status)
+{
+    return WpaSaeParseMsg(buf, len, type, status);
+}
+
 static void wpa_config_done(void)
 {
 }
@@ -95,8 +925,14 @@ int esp_supplicant_init(void)
     wpa_cb->wpa_sta_deinit     = wpa_deattach;
     wpa_cb->wpa_sta_connect    = wpa_sta_connect;
     wpa_cb->wpa_sta_disconnected_cb = wpa_sta_disconnected_cb;
+    wpa_cb->wpa_sta_rx_eapol   = wpa_sta_rx_eapol;
+    wpa_cb->wpa_sta_in_4way_handshake = wpa_sta_in_4way_handshake;
 
     wpa_cb->wpa_parse_wpa_ie  = wpa_parse_wpa_ie;
+    wpa_cb->wpa_config_bss    = wpa_config_bss;
+    wpa_cb->wpa_michael_mic_failure = wpa_michael_mic_failure;
+    wpa_cb->wpa3_build_sae_msg = wpa3_build_sae_msg;
+    wpa_cb->wpa3_parse_sae_msg = wpa3_parse_sae_msg;
     wpa_cb->wpa_config_done = wpa_config_done;
     esp_wifi_register_wpa_cb_internal(wpa_cb);
     return 0;
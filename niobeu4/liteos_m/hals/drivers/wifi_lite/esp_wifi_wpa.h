@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __ESP_WIFI_WPA_H__
+#define __ESP_WIFI_WPA_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#define WPA_ETH_ALEN 6
+#define WPA_PMK_LEN 32
+#define WPA_PMKID_LEN 16
+#define WPA_NONCE_LEN 32
+#define WPA_SSID_MAX_LEN 32
+#define WPA_PASSPHRASE_MAX_LEN 64
+#define WPA_PBKDF2_ITERATIONS 4096
+#define WPA_PMK_CACHE_NUM 4
+
+/* 与 ESP 驱动(hostap)保持一致的 cipher/key_mgmt 位定义 */
+#define WPA_CIPHER_NONE (1 << 0)
+#define WPA_CIPHER_TKIP (1 << 3)
+#define WPA_CIPHER_CCMP (1 << 4)
+#define WPA_CIPHER_AES_128_CMAC (1 << 5)
+#define WPA_KEY_MGMT_PSK (1 << 1)
+#define WPA_KEY_MGMT_PSK_SHA256 (1 << 8)
+#define WPA_KEY_MGMT_SAE (1 << 10)
+#define WPA_PROTO_WPA (1 << 0)
+#define WPA_PROTO_RSN (1 << 1)
+
+/* 与驱动 struct wpa_ie_data 布局一致 */
+struct wpa_ie_data {
+    int proto;
+    int pairwise_cipher;
+    int group_cipher;
+    int key_mgmt;
+    int capabilities;
+    size_t num_pmkid;
+    const uint8_t *pmkid;
+    int mgmt_group_cipher;
+};
+
+/* mbedTLS 实现的密码学原语, 供 4-way 握手与 SAE 使用, 成功返回 0 */
+int WpaHmacSha1Vector(const unsigned char *key, unsigned int key_len, unsigned int num_elem,
+                      const unsigned char *addr[], const unsigned int *len, unsigned char *mac);
+int WpaHmacSha256Vector(const unsigned char *key, int key_len, int num_elem,
+                        const unsigned char *addr[], const int *len, unsigned char *mac);
+int WpaSha1Prf(const unsigned char *key, unsigned int key_len, const char *label,
+               const unsigned char *data, unsigned int data_len, unsigned char *buf, unsigned int buf_len);
+int WpaSha256PrfBits(const uint8_t *key, size_t key_len, const char *label,
+                     const uint8_t *data, size_t data_len, uint8_t *buf, size_t buf_len_bits);
+int WpaAesWrap(const unsigned char *kek, int n, const unsigned char *plain, unsigned char *cipher);
+int WpaAesUnwrap(const unsigned char *kek, int n, const unsigned char *cipher, unsigned char *plain);
+int WpaOmac1Aes128(const uint8_t *key, const uint8_t *data, size_t data_len, uint8_t *mic);
+int WpaHmacMd5(const unsigned char *key, unsigned int key_len, const unsigned char *data,
+               unsigned int data_len, unsigned char *mac);
+int WpaRc4Skip(const unsigned char *key, unsigned int keylen, unsigned int skip, unsigned char *data,
+               unsigned int data_len);
+int WpaPbkdf2Sha1(const char *passphrase, const char *ssid, unsigned int ssid_len,
+                  int iterations, unsigned char *buf, unsigned int buflen);
+int WpaPassphraseHash(const char *passphrase, uint8_t *hash);
+
+/**
+ * @brief PBKDF2-HMAC-SHA1 快速实现, 预计算 ipad/opad 状态, 每轮两次压缩
+ *
+ * @return 0 成功, -1 参数超出单分组优化范围(口令 > 64 字节或 salt > 51 字节)
+ */
+int WpaFastPbkdf2Sha1(const char *passphrase, const uint8_t *ssid, size_t ssidLen, int iterations,
+                      uint8_t *buf, size_t buflen);
+
+/**
+ * @brief PMK 缓存, 以 (SSID, 口令 SHA-256) 为键, 不保存明文口令
+ *
+ * @return 0 命中, -1 未命中
+ */
+int WpaPmkCacheGet(const uint8_t *ssid, size_t ssidLen, const char *passphrase, uint8_t *pmk);
+void WpaPmkCachePut(const uint8_t *ssid, size_t ssidLen, const char *passphrase, const uint8_t *pmk);
+void WpaPmkCacheFlush(void);
+
+/* WPA3-SAE (group 19) */
+uint8_t *WpaSaeBuildMsg(const uint8_t *ownAddr, const uint8_t *bssid, uint32_t type, size_t *len);
+int WpaSaeParseMsg(const uint8_t *buf, size_t len, uint32_t type, uint16_t status);
+int WpaSaeGetPmk(uint8_t *pmk, uint8_t *pmkid);
+void WpaSaeClear(void);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* __ESP_WIFI_WPA_H__ */
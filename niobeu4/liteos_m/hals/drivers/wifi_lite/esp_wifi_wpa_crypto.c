@@ -0,0 +1,555 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_wifi_crypto_types.h"
+#include "los_interrupt.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/md.h"
+#include "mbedtls/pkcs5.h"
+#include "securec.h"
+#include "esp_wifi_wpa.h"
+
+#define AES_BLOCK_SIZE 16
+#define AES_128_KEY_BITS 128
+#define KEYWRAP_BLOCK 8
+#define KEYWRAP_ROUNDS 6
+#define KEYWRAP_IV 0xA6
+#define SHA1_MAC_LEN 20
+#define SHA256_MAC_LEN 32
+#define PRF_MAX_VECTOR 4
+#define CMAC_RB 0x87
+#define RC4_STATE_SIZE 256
+#define BITS_PER_BYTE 8
+
+typedef struct {
+    uint8_t valid;
+    uint8_t ssidLen;
+    uint8_t age;
+    uint8_t ssid[WPA_SSID_MAX_LEN];
+    uint8_t passHash[SHA256_MAC_LEN];
+    uint8_t pmk[WPA_PMK_LEN];
+} WpaPmkCacheEntry;
+
+static WpaPmkCacheEntry WpaPmkCache[WPA_PMK_CACHE_NUM];
+
+static int MdVector(mbedtls_md_type_t type, const unsigned char *key, size_t keyLen, size_t num,
+                    const unsigned char *addr[], const size_t *len, unsigned char *mac)
+{
+    mbedtls_md_context_t ctx;
+    const mbedtls_md_info_t *info = mbedtls_md_info_from_type(type);
+    int hmac = (key != NULL);
+    int ret;
+
+    if (info == NULL) {
+        return -1;
+    }
+    mbedtls_md_init(&ctx);
+    ret = mbedtls_md_setup(&ctx, info, hmac);
+    if (ret == 0) {
+        ret = hmac ? mbedtls_md_hmac_starts(&ctx, key, keyLen) : mbedtls_md_starts(&ctx);
+    }
+    for (size_t i = 0; (ret == 0) && (i < num); i++) {
+        ret = hmac ? mbedtls_md_hmac_update(&ctx, addr[i], len[i]) : mbedtls_md_update(&ctx, addr[i], len[i]);
+    }
+    if (ret == 0) {
+        ret = hmac ? mbedtls_md_hmac_finish(&ctx, mac) : mbedtls_md_finish(&ctx, mac);
+    }
+    mbedtls_md_free(&ctx);
+    return (ret == 0) ? 0 : -1;
+}
+
+/* 驱动接口中长度类型不一, 统一转换为 size_t 后调用 MdVector */
+#define MD_VECTOR(type, key, keyLen, num, addr, len, mac) do { \
+    size_t _len[PRF_MAX_VECTOR]; \
+    if ((num) > PRF_MAX_VECTOR) { \
+        return -1; \
+    } \
+    for (size_t _i = 0; _i < (size_t)(num); _i++) { \
+        _len[_i] = (size_t)(len)[_i]; \
+    } \
+    return MdVector(type, key, keyLen, num, addr, _len, mac); \
+} while (0)
+
+int WpaHmacSha1Vector(const unsigned char *key, unsigned int key_len, unsigned int num_elem,
+                      const unsigned char *addr[], const unsigned int *len, unsigned char *mac)
+{
+    MD_VECTOR(MBEDTLS_MD_SHA1, key, key_len, num_elem, addr, len, mac);
+}
+
+static int WpaHmacSha1(const unsigned char *key, unsigned int key_len, const unsigned char *data,
+                       unsigned int data_len, unsigned char *mac)
+{
+    return WpaHmacSha1Vector(key, key_len, 1, &data, &data_len, mac);
+}
+
+int WpaHmacSha256Vector(const unsigned char *key, int key_len, int num_elem,
+                        const unsigned char *addr[], const int *len, unsigned char *mac)
+{
+    MD_VECTOR(MBEDTLS_MD_SHA256, key, key_len, num_elem, addr, len, mac);
+}
+
+static int WpaHmacMd5Vector(const unsigned char *key, unsigned int key_len, unsigned int num_elem,
+                            const unsigned char *addr[], const unsigned int *len, unsigned char *mac)
+{
+    MD_VECTOR(MBEDTLS_MD_MD5, key, key_len, num_elem, addr, len, mac);
+}
+
+int WpaHmacMd5(const unsigned char *key, unsigned int key_len, const unsigned char *data,
+               unsigned int data_len, unsigned char *mac)
+{
+    return WpaHmacMd5Vector(key, key_len, 1, &data, &data_len, mac);
+}
+
+static int WpaSha1Vector(unsigned int num_elem, const unsigned char *addr[], const unsigned int *len,
+                         unsigned char *mac)
+{
+    MD_VECTOR(MBEDTLS_MD_SHA1, NULL, 0, num_elem, addr, len, mac);
+}
+
+static int WpaMd5Vector(unsigned int num_elem, const unsigned char *addr[], const unsigned int *len,
+                        unsigned char *mac)
+{
+    MD_VECTOR(MBEDTLS_MD_MD5, NULL, 0, num_elem, addr, len, mac);
+}
+
+/* IEEE 802.11 PRF-SHA1: HMAC-SHA1(K, label || 0 || data || counter) */
+int WpaSha1Prf(const unsigned char *key, unsigned int key_len, const char *label,
+               const unsigned char *data, unsigned int data_len, unsigned char *buf, unsigned int buf_len)
+{
+    uint8_t counter = 0;
+    uint8_t zero = 0;
+    uint8_t hash[SHA1_MAC_LEN];
+    const unsigned char *addr[] = { (const unsigned char *)label, &zero, data, &counter };
+    unsigned int len[] = { strlen(label), 1, data_len, 1 };
+    unsigned int pos = 0;
+
+    while (pos < buf_len) {
+        unsigned int plen = buf_len - pos;
+        if (WpaHmacSha1Vector(key, key_len, PRF_MAX_VECTOR, addr, len, hash) != 0) {
+            return -1;
+        }
+        (void)memcpy_s(&buf[pos], buf_len - pos, hash, (plen < SHA1_MAC_LEN) ? plen : SHA1_MAC_LEN);
+        pos += (plen < SHA1_MAC_LEN) ? plen : SHA1_MAC_LEN;
+        counter++;
+    }
+    (void)memset_s(hash, sizeof(hash), 0, sizeof(hash));
+    return 0;
+}
+
+/* IEEE 802.11 KDF-SHA256: HMAC-SHA256(K, i || label || data || L), i 与 L 为 16 位小端 */
+int WpaSha256PrfBits(const uint8_t *key, size_t key_len, const char *label,
+                     const uint8_t *data, size_t data_len, uint8_t *buf, size_t buf_len_bits)
+{
+    uint16_t counter = 1;
+    uint8_t counterLe[2];
+    uint8_t lengthLe[2] = { buf_len_bits & 0xff, (buf_len_bits >> BITS_PER_BYTE) & 0xff };
+    uint8_t hash[SHA256_MAC_LEN];
+    const unsigned char *addr[] = { counterLe, (const unsigned char *)label, data, lengthLe };
+    int len[] = { sizeof(counterLe), strlen(label), data_len, sizeof(lengthLe) };
+    size_t bufLen = (buf_len_bits + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+    size_t pos = 0;
+
+    while (pos < bufLen) {
+        size_t plen = bufLen - pos;
+        counterLe[0] = counter & 0xff;
+        counterLe[1] = (counter >> BITS_PER_BYTE) & 0xff;
+        if (WpaHmacSha256Vector(key, key_len, PRF_MAX_VECTOR, addr, len, hash) != 0) {
+            return -1;
+        }
+        (void)memcpy_s(&buf[pos], bufLen - pos, hash, (plen < SHA256_MAC_LEN) ? plen : SHA256_MAC_LEN);
+        pos += (plen < SHA256_MAC_LEN) ? plen : SHA256_MAC_LEN;
+        counter++;
+    }
+    /* 输出位数不是 8 的整数倍时屏蔽多余低位 */
+    if (buf_len_bits % BITS_PER_BYTE) {
+        buf[bufLen - 1] &= (uint8_t)(0xff << (BITS_PER_BYTE - buf_len_bits % BITS_PER_BYTE));
+    }
+    (void)memset_s(hash, sizeof(hash), 0, sizeof(hash));
+    return 0;
+}
+
+static int WpaSha256Prf(const unsigned char *key, int key_len, const char *label, const unsigned char *data,
+                        int data_len, unsigned char *buf, int buf_len)
+{
+    return WpaSha256PrfBits(key, key_len, label, data, data_len, buf, (size_t)buf_len * BITS_PER_BYTE);
+}
+
+static void *WpaAesEncryptInit(const unsigned char *key, unsigned int len)
+{
+    mbedtls_aes_context *ctx = (mbedtls_aes_context *)malloc(sizeof(mbedtls_aes_context));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    mbedtls_aes_init(ctx);
+    if (mbedtls_aes_setkey_enc(ctx, key, len * BITS_PER_BYTE) != 0) {
+        mbedtls_aes_free(ctx);
+        free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+static void *WpaAesDecryptInit(const unsigned char *key, unsigned int len)
+{
+    mbedtls_aes_context *ctx = (mbedtls_aes_context *)malloc(sizeof(mbedtls_aes_context));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    mbedtls_aes_init(ctx);
+    if (mbedtls_aes_setkey_dec(ctx, key, len * BITS_PER_BYTE) != 0) {
+        mbedtls_aes_free(ctx);
+        free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+static void WpaAesEncrypt(void *ctx, const unsigned char *plain, unsigned char *crypt)
+{
+    (void)mbedtls_aes_crypt_ecb((mbedtls_aes_context *)ctx, MBEDTLS_AES_ENCRYPT, plain, crypt);
+}
+
+static void WpaAesDecrypt(void *ctx, const unsigned char *crypt, unsigned char *plain)
+{
+    (void)mbedtls_aes_crypt_ecb((mbedtls_aes_context *)ctx, MBEDTLS_AES_DECRYPT, crypt, plain);
+}
+
+static void WpaAesDeinit(void *ctx)
+{
+    if (ctx != NULL) {
+        mbedtls_aes_free((mbedtls_aes_context *)ctx);
+        free(ctx);
+    }
+}
+
+static int WpaAes128Cbc(const unsigned char *key, const unsigned char *iv, unsigned char *data, int data_len,
+                        int mode)
+{
+    mbedtls_aes_context ctx;
+    unsigned char ivBuf[AES_BLOCK_SIZE];
+    int ret;
+
+    (void)memcpy_s(ivBuf, sizeof(ivBuf), iv, AES_BLOCK_SIZE);
+    mbedtls_aes_init(&ctx);
+    if (mode == MBEDTLS_AES_ENCRYPT) {
+        ret = mbedtls_aes_setkey_enc(&ctx, key, AES_128_KEY_BITS);
+    } else {
+        ret = mbedtls_aes_setkey_dec(&ctx, key, AES_128_KEY_BITS);
+    }
+    if (ret == 0) {
+        ret = mbedtls_aes_crypt_cbc(&ctx, mode, data_len, ivBuf, data, data);
+    }
+    mbedtls_aes_free(&ctx);
+    return (ret == 0) ? 0 : -1;
+}
+
+static int WpaAes128Encrypt(const unsigned char *key, const unsigned char *iv, unsigned char *data, int data_len)
+{
+    return WpaAes128Cbc(key, iv, data, data_len, MBEDTLS_AES_ENCRYPT);
+}
+
+static int WpaAes128Decrypt(const unsigned char *key, const unsigned char *iv, unsigned char *data, int data_len)
+{
+    return WpaAes128Cbc(key, iv, data, data_len, MBEDTLS_AES_DECRYPT);
+}
+
+/* RFC 3394 AES Key Wrap, n 为 64 位数据块个数 */
+int WpaAesWrap(const unsigned char *kek, int n, const unsigned char *plain, unsigned char *cipher)
+{
+    uint8_t b[AES_BLOCK_SIZE];
+    uint8_t *a = cipher;
+    uint8_t *r = cipher + KEYWRAP_BLOCK;
+    mbedtls_aes_context ctx;
+
+    (void)memset_s(a, KEYWRAP_BLOCK, KEYWRAP_IV, KEYWRAP_BLOCK);
+    (void)memcpy_s(r, n * KEYWRAP_BLOCK, plain, n * KEYWRAP_BLOCK);
+    mbedtls_aes_init(&ctx);
+    if (mbedtls_aes_setkey_enc(&ctx, kek, AES_128_KEY_BITS) != 0) {
+        mbedtls_aes_free(&ctx);
+        return -1;
+    }
+    for (int j = 0; j < KEYWRAP_ROUNDS; j++) {
+        r = cipher + KEYWRAP_BLOCK;
+        for (int i = 1; i <= n; i++) {
+            uint32_t t = (uint32_t)(n * j + i);
+            (void)memcpy_s(b, sizeof(b), a, KEYWRAP_BLOCK);
+            (void)memcpy_s(b + KEYWRAP_BLOCK, KEYWRAP_BLOCK, r, KEYWRAP_BLOCK);
+            (void)mbedtls_aes_crypt_ecb(&ctx, MBEDTLS_AES_ENCRYPT, b, b);
+            (void)memcpy_s(a, KEYWRAP_BLOCK, b, KEYWRAP_BLOCK);
+            a[7] ^= t & 0xff;           // 计数器以大端异或到 A 的低位
+            a[6] ^= (t >> 8) & 0xff;
+            a[5] ^= (t >> 16) & 0xff;
+            a[4] ^= (t >> 24) & 0xff;
+            (void)memcpy_s(r, KEYWRAP_BLOCK, b + KEYWRAP_BLOCK, KEYWRAP_BLOCK);
+            r += KEYWRAP_BLOCK;
+        }
+    }
+    mbedtls_aes_free(&ctx);
+    return 0;
+}
+
+int WpaAesUnwrap(const unsigned char *kek, int n, const unsigned char *cipher, unsigned char *plain)
+{
+    uint8_t a[KEYWRAP_BLOCK];
+    uint8_t b[AES_BLOCK_SIZE];
+    uint8_t *r = NULL;
+    mbedtls_aes_context ctx;
+
+    (void)memcpy_s(a, sizeof(a), cipher, KEYWRAP_BLOCK);
+    (void)memcpy_s(plain, n * KEYWRAP_BLOCK, cipher + KEYWRAP_BLOCK, n * KEYWRAP_BLOCK);
+    mbedtls_aes_init(&ctx);
+    if (mbedtls_aes_setkey_dec(&ctx, kek, AES_128_KEY_BITS) != 0) {
+        mbedtls_aes_free(&ctx);
+        return -1;
+    }
+    for (int j = KEYWRAP_ROUNDS - 1; j >= 0; j--) {
+        r = plain + (n - 1) * KEYWRAP_BLOCK;
+        for (int i = n; i >= 1; i--) {
+            uint32_t t = (uint32_t)(n * j + i);
+            (void)memcpy_s(b, sizeof(b), a, KEYWRAP_BLOCK);
+            b[7] ^= t & 0xff;
+            b[6] ^= (t >> 8) & 0xff;
+            b[5] ^= (t >> 16) & 0xff;
+            b[4] ^= (t >> 24) & 0xff;
+            (void)memcpy_s(b + KEYWRAP_BLOCK, KEYWRAP_BLOCK, r, KEYWRAP_BLOCK);
+            (void)mbedtls_aes_crypt_ecb(&ctx, MBEDTLS_AES_DECRYPT, b, b);
+            (void)memcpy_s(a, sizeof(a), b, KEYWRAP_BLOCK);
+            (void)memcpy_s(r, KEYWRAP_BLOCK, b + KEYWRAP_BLOCK, KEYWRAP_BLOCK);
+            r -= KEYWRAP_BLOCK;
+        }
+    }
+    mbedtls_aes_free(&ctx);
+    for (int i = 0; i < KEYWRAP_BLOCK; i++) {
+        if (a[i] != KEYWRAP_IV) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void CmacShift(uint8_t *block)
+{
+    uint8_t carry = block[0] & 0x80;
+    for (int i = 0; i < AES_BLOCK_SIZE - 1; i++) {
+        block[i] = (uint8_t)((block[i] << 1) | (block[i + 1] >> 7));
+    }
+    block[AES_BLOCK_SIZE - 1] = (uint8_t)(block[AES_BLOCK_SIZE - 1] << 1);
+    if (carry) {
+        block[AES_BLOCK_SIZE - 1] ^= CMAC_RB;
+    }
+}
+
+/* AES-128-CMAC (OMAC1), 用于 AKM 8(SAE)/6(PSK-SHA256) 的 EAPOL-Key MIC */
+int WpaOmac1Aes128(const uint8_t *key, const uint8_t *data, size_t data_len, uint8_t *mic)
+{
+    uint8_t cbc[AES_BLOCK_SIZE] = {0};
+    uint8_t pad[AES_BLOCK_SIZE] = {0};
+    mbedtls_aes_context ctx;
+    size_t left = data_len;
+    const uint8_t *pos = data;
+
+    mbedtls_aes_init(&ctx);
+    if (mbedtls_aes_setkey_enc(&ctx, key, AES_128_KEY_BITS) != 0) {
+        mbedtls_aes_free(&ctx);
+        return -1;
+    }
+    while (left > AES_BLOCK_SIZE) {
+        for (int i = 0; i < AES_BLOCK_SIZE; i++) {
+            cbc[i] ^= *pos++;
+        }
+        (void)mbedtls_aes_crypt_ecb(&ctx, MBEDTLS_AES_ENCRYPT, cbc, cbc);
+        left -= AES_BLOCK_SIZE;
+    }
+    (void)mbedtls_aes_crypt_ecb(&ctx, MBEDTLS_AES_ENCRYPT, pad, pad);
+    CmacShift(pad);                     // K1
+    if (left < AES_BLOCK_SIZE) {
+        CmacShift(pad);                 // K2
+    }
+    for (size_t i = 0; i < left; i++) {
+        cbc[i] ^= *pos++;
+    }
+    if (left < AES_BLOCK_SIZE) {
+        cbc[left] ^= 0x80;
+    }
+    for (int i = 0; i < AES_BLOCK_SIZE; i++) {
+        pad[i] ^= cbc[i];
+    }
+    (void)mbedtls_aes_crypt_ecb(&ctx, MBEDTLS_AES_ENCRYPT, pad, mic);
+    mbedtls_aes_free(&ctx);
+    return 0;
+}
+
+/* 仅 WPA/TKIP 与 WEP 使用, 不依赖 mbedTLS 的 ARC4 配置 */
+int WpaRc4Skip(const unsigned char *key, unsigned int keylen, unsigned int skip, unsigned char *data,
+               unsigned int data_len)
+{
+    uint8_t s[RC4_STATE_SIZE];
+    uint8_t i = 0;
+    uint8_t j = 0;
+    uint8_t tmp;
+
+    for (unsigned int k = 0; k < RC4_STATE_SIZE; k++) {
+        s[k] = (uint8_t)k;
+    }
+    for (unsigned int k = 0; k < RC4_STATE_SIZE; k++) {
+        j = (uint8_t)(j + s[k] + key[k % keylen]);
+        tmp = s[k];
+        s[k] = s[j];
+        s[j] = tmp;
+    }
+    j = 0;
+    for (unsigned int k = 0; k < skip + data_len; k++) {
+        i++;
+        j = (uint8_t)(j + s[i]);
+        tmp = s[i];
+        s[i] = s[j];
+        s[j] = tmp;
+        if (k >= skip) {
+            data[k - skip] ^= s[(uint8_t)(s[i] + s[j])];
+        }
+    }
+    return 0;
+}
+
+int WpaPassphraseHash(const char *passphrase, uint8_t *hash)
+{
+    const unsigned char *addr[] = { (const unsigned char *)passphrase };
+    size_t len[] = { strlen(passphrase) };
+    return MdVector(MBEDTLS_MD_SHA256, NULL, 0, 1, addr, len, hash);
+}
+
+int WpaPmkCacheGet(const uint8_t *ssid, size_t ssidLen, const char *passphrase, uint8_t *pmk)
+{
+    uint8_t hash[SHA256_MAC_LEN];
+    int ret = -1;
+
+    if ((ssidLen > WPA_SSID_MAX_LEN) || (WpaPassphraseHash(passphrase, hash) != 0)) {
+        return -1;
+    }
+    UINT32 intSave = LOS_IntLock();
+    for (int i = 0; i < WPA_PMK_CACHE_NUM; i++) {
+        WpaPmkCacheEntry *entry = &WpaPmkCache[i];
+        if (entry->valid && (entry->ssidLen == ssidLen) && (memcmp(entry->ssid, ssid, ssidLen) == 0) &&
+            (memcmp(entry->passHash, hash, sizeof(hash)) == 0)) {
+            (void)memcpy_s(pmk, WPA_PMK_LEN, entry->pmk, WPA_PMK_LEN);
+            entry->age = 0;
+            ret = 0;
+        } else if (entry->valid && (entry->age < UINT8_MAX)) {
+            entry->age++;
+        }
+    }
+    LOS_IntRestore(intSave);
+    return ret;
+}
+
+void WpaPmkCachePut(const uint8_t *ssid, size_t ssidLen, const char *passphrase, const uint8_t *pmk)
+{
+    uint8_t hash[SHA256_MAC_LEN];
+    WpaPmkCacheEntry *victim = &WpaPmkCache[0];
+
+    if ((ssidLen > WPA_SSID_MAX_LEN) || (WpaPassphraseHash(passphrase, hash) != 0)) {
+        return;
+    }
+    UINT32 intSave = LOS_IntLock();
+    for (int i = 0; i < WPA_PMK_CACHE_NUM; i++) {
+        WpaPmkCacheEntry *entry = &WpaPmkCache[i];
+        if (!entry->valid) {
+            victim = entry;
+            break;
+        }
+        if (entry->age > victim->age) {
+            victim = entry;
+        }
+    }
+    victim->valid = 1;
+    victim->age = 0;
+    victim->ssidLen = (uint8_t)ssidLen;
+    (void)memcpy_s(victim->ssid, sizeof(victim->ssid), ssid, ssidLen);
+    (void)memcpy_s(victim->passHash, sizeof(victim->passHash), hash, sizeof(hash));
+    (void)memcpy_s(victim->pmk, sizeof(victim->pmk), pmk, WPA_PMK_LEN);
+    LOS_IntRestore(intSave);
+}
+
+void WpaPmkCacheFlush(void)
+{
+    UINT32 intSave = LOS_IntLock();
+    (void)memset_s(WpaPmkCache, sizeof(WpaPmkCache), 0, sizeof(WpaPmkCache));
+    LOS_IntRestore(intSave);
+}
+
+int WpaPbkdf2Sha1(const char *passphrase, const char *ssid, unsigned int ssid_len,
+                  int iterations, unsigned char *buf, unsigned int buflen)
+{
+    mbedtls_md_context_t ctx;
+    int ret;
+    int cacheable = (buflen == WPA_PMK_LEN) && (iterations == WPA_PBKDF2_ITERATIONS);
+
+    /* 重连同一网络时直接命中缓存, 跳过 4096 轮 HMAC-SHA1 */
+    if (cacheable && (WpaPmkCacheGet((const uint8_t *)ssid, ssid_len, passphrase, buf) == 0)) {
+        return 0;
+    }
+    ret = WpaFastPbkdf2Sha1(passphrase, (const uint8_t *)ssid, ssid_len, iterations, buf, buflen);
+    if (ret != 0) {
+        mbedtls_md_init(&ctx);
+        ret = mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA1), 1);
+        if (ret == 0) {
+            ret = mbedtls_pkcs5_pbkdf2_hmac(&ctx, (const unsigned char *)passphrase, strlen(passphrase),
+                                            (const unsigned char *)ssid, ssid_len, iterations, buflen, buf);
+        }
+        mbedtls_md_free(&ctx);
+        if (ret != 0) {
+            return -1;
+        }
+    }
+    if (cacheable) {
+        WpaPmkCachePut((const uint8_t *)ssid, ssid_len, passphrase, buf);
+    }
+    return 0;
+}
+
+/*
+ * 驱动回调的密码学函数表, 顺序与 esp_wifi_crypto_types.h 中 wpa_crypto_funcs_t 一致.
+ * CCMP 由硬件完成, 软件 ccmp_encrypt/ccmp_decrypt 仅用于 ESP-NOW, 此处不提供.
+ */
+const wpa_crypto_funcs_t g_wifi_default_wpa_crypto_funcs = {
+    .size = sizeof(wpa_crypto_funcs_t),
+    .version = ESP_WIFI_CRYPTO_VERSION,
+    .aes_wrap = (esp_aes_wrap_t)WpaAesWrap,
+    .aes_unwrap = (esp_aes_unwrap_t)WpaAesUnwrap,
+    .hmac_sha256_vector = (esp_hmac_sha256_vector_t)WpaHmacSha256Vector,
+    .sha256_prf = (esp_sha256_prf_t)WpaSha256Prf,
+    .hmac_md5 = (esp_hmac_md5_t)WpaHmacMd5,
+    .hamc_md5_vector = (esp_hmac_md5_vector_t)WpaHmacMd5Vector,
+    .hmac_sha1 = (esp_hmac_sha1_t)WpaHmacSha1,
+    .hmac_sha1_vector = (esp_hmac_sha1_vector_t)WpaHmacSha1Vector,
+    .sha1_prf = (esp_sha1_prf_t)WpaSha1Prf,
+    .sha1_vector = (esp_sha1_vector_t)WpaSha1Vector,
+    .pbkdf2_sha1 = (esp_pbkdf2_sha1_t)WpaPbkdf2Sha1,
+    .rc4_skip = (esp_rc4_skip_t)WpaRc4Skip,
+    .md5_vector = (esp_md5_vector_t)WpaMd5Vector,
+    .aes_encrypt = (esp_aes_encrypt_t)WpaAesEncrypt,
+    .aes_encrypt_init = (esp_aes_encrypt_init_t)WpaAesEncryptInit,
+    .aes_encrypt_deinit = (esp_aes_encrypt_deinit_t)WpaAesDeinit,
+    .aes_decrypt = (esp_aes_decrypt_t)WpaAesDecrypt,
+    .aes_decrypt_init = (esp_aes_decrypt_init_t)WpaAesDecryptInit,
+    .aes_decrypt_deinit = (esp_aes_decrypt_deinit_t)WpaAesDeinit,
+    .aes_128_encrypt = (esp_aes_128_encrypt_t)WpaAes128Encrypt,
+    .aes_128_decrypt = (esp_aes_128_decrypt_t)WpaAes128Decrypt,
+    .omac1_aes_128 = (esp_omac1_aes_128_t)WpaOmac1Aes128,
+    .ccmp_decrypt = NULL,
+    .ccmp_encrypt = NULL,
+};
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "esp_netif_net_stack.h"
+#include "cmsis_os2.h"
+#include "los_interrupt.h"
+#include "los_tick.h"
+#include "lwip/netif.h"
+#include "lwip/prot/ethernet.h"
+#include "securec.h"
+#include "wifi_ap_sta.h"
+
+#define MS_PER_SECOND 1000
+
+typedef struct {
+    WifiApStaEntry sta[WIFI_AP_STA_MAX];    // 紧凑数组, 删除时以末尾元素填补
+    volatile unsigned int num;
+    WifiApAdmission admission;
+    struct netif *netif;
+    netif_input_fn input;
+    netif_linkoutput_fn linkoutput;
+    osTimerId_t timer;
+} WifiApSta_t;
+
+static WifiApSta_t WifiApSta = {
+    .admission = { .maxConn = WIFI_AP_STA_CONN_DEFAULT, .minRssi = WIFI_AP_RSSI_NO_LIMIT },
+};
+
+static uint32_t WifiApNowMs(void)
+{
+    return (uint32_t)(LOS_TickCountGet() * MS_PER_SECOND / LOSCFG_BASE_CORE_TICK_PER_SECOND);
+}
+
+static WifiApStaEntry *FindSta(const unsigned char *mac)
+{
+    for (unsigned int i = 0; i < WifiApSta.num; i++) {
+        if (memcmp(WifiApSta.sta[i].mac, mac, WIFI_MAC_LEN) == 0) {
+            return &WifiApSta.sta[i];
+        }
+    }
+    return NULL;
+}
+
+// 查询失败或终端不在驱动列表中返回 -1
+static int QueryStaRssi(const unsigned char *mac, int8_t *rssi)
+{
+    wifi_sta_list_t list = {0};
+    if (esp_wifi_ap_get_sta_list(&list) != ESP_OK) {
+        return -1;
+    }
+    for (int i = 0; i < list.num; i++) {
+        if (memcmp(list.sta[i].mac, mac, WIFI_MAC_LEN) == 0) {
+            *rssi = list.sta[i].rssi;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/*
+ * 收发钩子运行在 wifi/tcpip 任务中, 终端表最多 WIFI_AP_STA_MAX 项, 线性查找.
+ * 离开时末尾元素会移入空位, 查找与计数须在同一临界区内完成.
+ */
+static void WifiApStaCount(const uint8_t *mac, uint16_t len, bool rx)
+{
+    UINT32 intSave = LOS_IntLock();
+    WifiApStaEntry *sta = FindSta(mac);
+    if (sta != NULL) {
+        if (rx) {
+            sta->rxBytes += len;
+        } else {
+            sta->txBytes += len;
+        }
+    }
+    LOS_IntRestore(intSave);
+}
+
+static err_t WifiApStaInput(struct pbuf *p, struct netif *netif)
+{
+    if (p->len >= SIZEOF_ETH_HDR) {
+        WifiApStaCount(((struct eth_hdr *)p->payload)->src.addr, p->tot_len, true);
+    }
+    return WifiApSta.input(p, netif);
+}
+
+static err_t WifiApStaLinkOutput(struct netif *netif, struct pbuf *p)
+{
+    if (p->len >= SIZEOF_ETH_HDR) {
+        WifiApStaCount(((struct eth_hdr *)p->payload)->dest.addr, p->tot_len, false);
+    }
+    return WifiApSta.linkoutput(netif, p);
+}
+
+static void WifiApStaRssiProc(void *arg)
+{
+    wifi_sta_list_t list = {0};
+    (void)arg;
+    if ((WifiApSta.num == 0) || (esp_wifi_ap_get_sta_list(&list) != ESP_OK)) {
+        return;
+    }
+    UINT32 intSave = LOS_IntLock();
+    for (int i = 0; i < list.num; i++) {
+        WifiApStaEntry *sta = FindSta(list.sta[i].mac);
+        if (sta != NULL) {
+            sta->rssi = list.sta[i].rssi;
+        }
+    }
+    LOS_IntRestore(intSave);
+}
+
+WifiErrorCode SetHotspotAdmission(const WifiApAdmission *admission)
+{
+    if ((admission == NULL) || (admission->maxConn == 0) || (admission->maxConn > WIFI_AP_STA_MAX)) {
+        return ERROR_WIFI_INVALID_ARGS;
+    }
+    WifiApSta.admission = *admission;
+    return WIFI_SUCCESS;
+}
+
+WifiErrorCode GetHotspotAdmission(WifiApAdmission *admission)
+{
+    if (admission == NULL) {
+        return ERROR_WIFI_INVALID_ARGS;
+    }
+    *admission = WifiApSta.admission;
+    return WIFI_SUCCESS;
+}
+
+WifiErrorCode GetHotspotStaEntries(WifiApStaEntry *result, unsigned int *size)
+{
+    if ((result == NULL) || (size == NULL) || (*size == 0)) {
+        return ERROR_WIFI_INVALID_ARGS;
+    }
+    UINT32 intSave = LOS_IntLock();
+    unsigned int num = (WifiApSta.num < *size) ? WifiApSta.num : *size;
+    (void)memcpy_s(result, sizeof(WifiApStaEntry) * (*size), WifiApSta.sta, sizeof(WifiApStaEntry) * num);
+    LOS_IntRestore(intSave);
+    *size = num;
+    return WIFI_SUCCESS;
+}
+
+unsigned int GetHotspotStaNum(void)
+{
+    return WifiApSta.num;
+}
+
+unsigned int WifiApStaGetList(StationInfo *result, unsigned int size)
+{
+    UINT32 intSave = LOS_IntLock();
+    unsigned int num = (WifiApSta.num < size) ? WifiApSta.num : size;
+    for (unsigned int i = 0; i < num; i++) {
+        (void)memset_s(&result[i], sizeof(result[i]), 0, sizeof(result[i]));
+        (void)memcpy_s(result[i].macAddress, sizeof(result[i].macAddress), WifiApSta.sta[i].mac, WIFI_MAC_LEN);
+        result[i].ipAddress = WifiApSta.sta[i].ipAddress;
+    }
+    LOS_IntRestore(intSave);
+    return num;
+}
+
+uint8_t WifiApStaMaxConn(void)
+{
+    return WifiApSta.admission.maxConn;
+}
+
+int WifiApStaJoin(const unsigned char *mac, uint8_t aid)
+{
+    int8_t rssi = WIFI_AP_RSSI_NO_LIMIT;
+    unsigned int num;
+    // 设置了信号门限时, 查询不到信号强度按不满足处理
+    bool rssiOk = (QueryStaRssi(mac, &rssi) == 0) ? (rssi >= WifiApSta.admission.minRssi)
+                                                    : (WifiApSta.admission.minRssi == WIFI_AP_RSSI_NO_LIMIT);
+
+    UINT32 intSave = LOS_IntLock();
+    WifiApStaEntry *sta = FindSta(mac);
+    num = WifiApSta.num;
+    if (!rssiOk || ((sta == NULL) && (num >= WifiApSta.admission.maxConn))) {
+        LOS_IntRestore(intSave);
+        printf("WifiApSta reject %02X:%02X:%02X:%02X:%02X:%02X rssi=%d num=%u\r\n",
+               mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], rssi, num);
+        return -1;
+    }
+    if (sta == NULL) {
+        sta = &WifiApSta.sta[WifiApSta.num];
+        (void)memset_s(sta, sizeof(*sta), 0, sizeof(*sta));
+        (void)memcpy_s(sta->mac, sizeof(sta->mac), mac, WIFI_MAC_LEN);
+        WifiApSta.num++;
+    }
+    sta->aid = aid;
+    sta->rssi = rssi;
+    sta->joinMs = WifiApNowMs();
+    LOS_IntRestore(intSave);
+    return 0;
+}
+
+int WifiApStaLeave(const unsigned char *mac)
+{
+    int ret = -1;
+    UINT32 intSave = LOS_IntLock();
+    WifiApStaEntry *sta = FindSta(mac);
+    if (sta != NULL) {
+        WifiApSta.num--;
+        *sta = WifiApSta.sta[WifiApSta.num];
+        ret = 0;
+    }
+    LOS_IntRestore(intSave);
+    return ret;
+}
+
+void WifiApStaUpdateIp(void *netif)
+{
+    esp_netif_pair_mac_ip_t pair[WIFI_AP_STA_MAX] = {0};
+    unsigned int num = 0;
+
+    UINT32 intSave = LOS_IntLock();
+    for (unsigned int i = 0; i < WifiApSta.num; i++) {
+        if (WifiApSta.sta[i].ipAddress == 0) {
+            (void)memcpy_s(pair[num].mac, sizeof(pair[num].mac), WifiApSta.sta[i].mac, WIFI_MAC_LEN);
+            num++;
+        }
+    }
+    LOS_IntRestore(intSave);
+    if ((num == 0) || (esp_netif_dhcps_get_clients_by_mac((esp_netif_t *)netif, num, pair) != ESP_OK)) {
+        return;
+    }
+
+    intSave = LOS_IntLock();
+    for (unsigned int i = 0; i < num; i++) {
+        WifiApStaEntry *sta = FindSta(pair[i].mac);
+        if (sta != NULL) {
+            sta->ipAddress = pair[i].ip.addr;
+        }
+    }
+    LOS_IntRestore(intSave);
+}
+
+void WifiApStaAttach(void *netif)
+{
+    struct netif *lwip = (struct netif *)esp_netif_get_netif_impl((esp_netif_t *)netif);
+    WifiApStaDetach();
+    WifiApSta.num = 0;
+    if (lwip == NULL) {
+        return;
+    }
+
+    UINT32 intSave = LOS_IntLock();
+    WifiApSta.input = lwip->input;
+    WifiApSta.linkoutput = lwip->linkoutput;
+    lwip->input = WifiApStaInput;
+    lwip->linkoutput = WifiApStaLinkOutput;
+    WifiApSta.netif = lwip;
+    LOS_IntRestore(intSave);
+
+    if (WifiApSta.timer == NULL) {
+        WifiApSta.timer = osTimerNew(WifiApStaRssiProc, osTimerPeriodic, NULL, NULL);
+    }
+    if (WifiApSta.timer != NULL) {
+        (void)osTimerStart(WifiApSta.timer, WIFI_AP_RSSI_REFRESH_MS * LOSCFG_BASE_CORE_TICK_PER_SECOND / MS_PER_SECOND);
+    }
+}
+
+void WifiApStaDetach(void)
+{
+    if (WifiApSta.timer != NULL) {
+        (void)osTimerStop(WifiApSta.timer);
+    }
+    UINT32 intSave = LOS_IntLock();
+    if (WifiApSta.netif != NULL) {
+        WifiApSta.netif->input = WifiApSta.input;
+        WifiApSta.netif->linkoutput = WifiApSta.linkoutput;
+        WifiApSta.netif = NULL;
+    }
+    WifiApSta.num = 0;
+    LOS_IntRestore(intSave);
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WIFI_AP_STA_H__
+#define __WIFI_AP_STA_H__
+
+#include <stdint.h>
+#include "station_info.h"
+#include "wifi_error_code.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#define WIFI_AP_STA_MAX 10              // ESP32 SoftAP 驱动支持的最大接入数
+#define WIFI_AP_STA_CONN_DEFAULT 4
+#define WIFI_AP_RSSI_NO_LIMIT (-128)
+#define WIFI_AP_RSSI_REFRESH_MS 2000
+
+typedef struct {
+    unsigned char mac[WIFI_MAC_LEN];
+    uint8_t aid;
+    int8_t rssi;
+    uint32_t ipAddress;     // 网络字节序, 未分配为 0
+    uint32_t joinMs;        // 接入时刻(系统启动后 ms)
+    uint32_t txBytes;       // 发往该终端的字节数
+    uint32_t rxBytes;       // 从该终端收到的字节数
+} WifiApStaEntry;
+
+/* 接入控制策略, 在 EnableHotspot 之前设置 */
+typedef struct {
+    uint8_t maxConn;        // 1 ~ WIFI_AP_STA_MAX
+    int8_t minRssi;         // 低于该信号强度的终端将被拒绝, WIFI_AP_RSSI_NO_LIMIT 不限制
+} WifiApAdmission;
+
+/**
+ * @brief 设置 SoftAP 接入控制策略
+ *
+ * @param admission 接入策略
+ * @return WIFI_SUCCESS 成功, 其他失败
+ */
+WifiErrorCode SetHotspotAdmission(const WifiApAdmission *admission);
+
+/**
+ * @brief 获取 SoftAP 接入控制策略
+ */
+WifiErrorCode GetHotspotAdmission(WifiApAdmission *admission);
+
+/**
+ * @brief 获取已接入终端的详细信息, 直接读取本地维护的终端表
+ *
+ * @param result 输出数组
+ * @param size   输入为数组长度, 输出为实际个数
+ * @return WIFI_SUCCESS 成功, 其他失败
+ */
+WifiErrorCode GetHotspotStaEntries(WifiApStaEntry *result, unsigned int *size);
+
+/**
+ * @brief 获取已接入终端个数
+ */
+unsigned int GetHotspotStaNum(void);
+
+unsigned int WifiApStaGetList(StationInfo *result, unsigned int size);
+uint8_t WifiApStaMaxConn(void);
+int WifiApStaJoin(const unsigned char *mac, uint8_t aid);
+int WifiApStaLeave(const unsigned char *mac);
+void WifiApStaUpdateIp(void *netif);
+void WifiApStaAttach(void *netif);
+void WifiApStaDetach(void);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* __WIFI_AP_STA_H__ */
@@ -16,18 +16,25 @@
 #include "cmsis_os2.h"
 #include "esp_event.h"
 #include "esp_event_legacy.h"
+#include "esp_netif_net_stack.h"
 #include "los_memory.h"
 #include "los_mux.h"
 #include "los_task.h"
 #include "lwip/err.h"
 #include "lwip/sockets.h"
 #include "lwip/tcpip.h"
+#include "mem_reclaim.h"
+#include "mem_trace.h"
 #include "station_info.h"
 #include "wifi_error_code.h"
 #include "wifi_event.h"
 #include "wifi_hotspot.h"
 #include "wifi_linked_info.h"
 #include "wifi_device.h"
+#include "wifi_link_stats.h"
+#include "wifi_power.h"
+#include "wifi_ap_sta.h"
+#include "esp_wifi_wpa.h"
 
 #undef LOG
 #undef LOGE
@@ -40,7 +47,6 @@
 #define FREQ_OF_CHANNEL_80211B_ONLY 2484
 #define WIFI_MIN_CHANNEL 1
 #define WIFI_FREQ_INTERVAL 5
-#define ESP_EXAMPLE_MAX_STA_CONN 4
 
 #define RSSI_LEVEL_4_2_G (-65)
 #define RSSI_LEVEL_3_2_G (-75)
@@ -60,10 +66,22 @@
 #define DELAY_LOOP_TIMES 50
 #define MAX_INDEX 60
 #define MUX_HANDLE_OFFSET 8
+#define WIFI_LOCK_NO_OWNER 0xFFFFFFFFU
 #define ERROR_ESP_WIFI_START (-103)
 #define ERROR_NETIF_NULL (-8)
 #define ERROR_REGISTER_FAIL (-9)
 #define SCANING 0x50
+#define WIFI_PASSPHRASE_MIN_LEN 8
+#define WIFI_PASSPHRASE_MAX_LEN 63
+#define WPA_PSK_HEX_LEN (WPA_PMK_LEN * 2)
+#define WIFI_SCAN_AUTH_NUM 16
+
+/* 最近一次扫描结果中各 BSS 的认证方式, 连接时据此判断能否直接下发 PMK */
+typedef struct {
+    char ssid[WIFI_MAX_SSID_LEN];
+    uint8_t bssid[WIFI_MAC_LEN];
+    uint8_t authmode;
+} WifiScanAuth_t;
 
 typedef struct {
     volatile uint8_t ip_ok;
@@ -75,12 +93,17 @@ typedef struct {
     WifiEvent *event[WIFI_MAX_EVENT_SIZE];
     esp_netif_t *netif;
     WifiDeviceConfig config[WIFI_MAX_CONFIG_SIZE];
+    char configPsk[WIFI_MAX_CONFIG_SIZE][WPA_PSK_HEX_LEN + 1];  // 保存配置时派生的 PSK, 空串表示未派生
+    WifiScanAuth_t scanAuth[WIFI_SCAN_AUTH_NUM];
+    uint8_t scanAuthNum;
     HotspotConfig hotConfig[1];
     UINT32 muxHandle;
-    esp_event_handler_instance_t eventHandle[2];
+    UINT32 muxOwner;                    // 持有 WifiLock 的任务, 供低内存回收判断
+    UINT32 muxDepth;
+    esp_event_handler_instance_t eventHandle[4];
 } DevWifiInfo_t;
 
-static DevWifiInfo_t DevWifiInfo = {0};
+static DevWifiInfo_t DevWifiInfo = { .muxOwner = WIFI_LOCK_NO_OWNER };
 static const char TAG[] = {"WifiLite."};
 static const char NullBssid[WIFI_MAC_LEN] = {0, 0, 0, 0, 0, 0};
 
@@ -106,13 +129,19 @@ static void WifiLock(void)
         }
         DevWifiInfo.muxHandle = muxHandle + MUX_HANDLE_OFFSET;
     }
-    LOS_MuxPend(DevWifiInfo.muxHandle - MUX_HANDLE_OFFSET, LOS_WAIT_FOREVER);
+    if (LOS_MuxPend(DevWifiInfo.muxHandle - MUX_HANDLE_OFFSET, LOS_WAIT_FOREVER) == LOS_OK) {
+        DevWifiInfo.muxOwner = LOS_CurTaskIDGet();
+        DevWifiInfo.muxDepth++;
+    }
 }
 
 static void WifiUnlock(void)
 {
     if (!DevWifiInfo.muxHandle)
         return;
+    if ((DevWifiInfo.muxDepth > 0) && (--DevWifiInfo.muxDepth == 0)) {
+        DevWifiInfo.muxOwner = WIFI_LOCK_NO_OWNER;
+    }
     LOS_MuxPost(DevWifiInfo.muxHandle - MUX_HANDLE_OFFSET);
 }
 
@@ -265,6 +294,23 @@ static void event_got_ip_handler(VOID *arg, esp_event_base_t event_base,
                                  int32_t event_id, VOID *event_data)
 {
     DevWifiInfo.ip_ok = 1;
+    WifiLinkStatsGotIp();
+}
+
+static void event_ap_ip_assigned_handler(VOID *arg, esp_event_base_t event_base,
+                                         int32_t event_id, VOID *event_data)
+{
+    WifiApStaUpdateIp(DevWifiInfo.netif);
+}
+
+/*
+ * esp_netif 在自身的 AP_START 处理中才执行 netif_add, 会覆盖 input/linkoutput, 因此在其之后挂接.
+ * 同一事件中 ANY_ID 的处理先于指定 ID 执行, 所以单独按 WIFI_EVENT_AP_START 注册, 且注册晚于 esp_netif.
+ */
+static void event_ap_start_handler(VOID *arg, esp_event_base_t event_base,
+                                   int32_t event_id, VOID *event_data)
+{
+    WifiApStaAttach(DevWifiInfo.netif);
 }
 
 static void wifi_event_scan_down_proc(VOID *event_data)
@@ -285,6 +331,8 @@ static void wifi_event_sta_connected_proc(VOID *event_data)
     linkInfo.rssi = ap_info.rssi;
     linkInfo.connState = WIFI_CONNECTED;
     linkInfo.frequency = ChannelToFrequency(ap_info.primary);
+    WifiLinkStatsAssociated();
+    WifiPowerOnConnected();
     SendOnWifiConnectionChanged(&DevWifiInfo, WIFI_STATE_AVAILABLE, &linkInfo);
 }
 
@@ -296,6 +344,8 @@ static void wifi_event_sta_disconnected_proc(VOID *event_data)
     MEMCPY_S(&linkInfo.bssid, sizeof(linkInfo.bssid), disconnected->bssid, sizeof(disconnected->bssid));
     linkInfo.disconnectedReason = disconnected->reason;
     linkInfo.connState = WIFI_DISCONNECTED;
+    WifiLinkStatsDisconnected(disconnected->reason);
+    WifiPowerOnDisconnected();
     SendOnWifiConnectionChanged(&DevWifiInfo, WIFI_STATE_NOT_AVAILABLE, &linkInfo);
 }
 
@@ -303,6 +353,10 @@ static void wifi_event_ap_connected_proc(VOID *event_data)
 {
     StationInfo staInfo = {0};
     wifi_event_ap_staconnected_t *connect_event = (wifi_event_ap_staconnected_t *)event_data;
+    if (WifiApStaJoin(connect_event->mac, connect_event->aid) != 0) {
+        esp_wifi_deauth_sta(connect_event->aid);
+        return;
+    }
     MEMCPY_S(&staInfo.macAddress, sizeof(staInfo.macAddress), connect_event->mac, sizeof(connect_event->mac));
     SendOnHotspotStaJoin(&DevWifiInfo, &staInfo);
 }
@@ -311,6 +365,9 @@ static void wifi_event_ap_disconnected_proc(VOID *event_data)
 {
     StationInfo staInfo = {0};
     wifi_event_ap_stadisconnected_t *disconnect_event = (wifi_event_ap_stadisconnected_t *)event_data;
+    if (WifiApStaLeave(disconnect_event->mac) != 0) {
+        return;     // 被接入控制拒绝的终端, 未上报过加入
+    }
     MEMCPY_S(&staInfo.macAddress, sizeof(staInfo.macAddress),
         disconnect_event->mac, sizeof(disconnect_event->mac));
     staInfo.disconnectedReason = WIFI_REASON_UNSPECIFIED;
@@ -345,11 +402,43 @@ static void event_handler(VOID *arg, esp_event_base_t event_base,
         case WIFI_EVENT_AP_START:
             wifi_event_ap_start_proc(event_data);
             break;
+        case WIFI_EVENT_AP_STOP:
+            WifiApStaDetach();
+            break;
         default:
             break;
     }
 }
 
+/*
+ * 低内存回收: 丢弃驱动中尚未取走的扫描结果, 取走记录时驱动会释放整个缓存.
+ * 本模块对 esp_wifi 的调用都在 WifiLock 内, 锁空闲时驱动中没有本模块发起的 API 调用,
+ * 此时在分配者的任务中直接释放不会与驱动的 API 锁互相等待; 锁被占用 (包括本任务在
+ * WifiLock 内经驱动分配失败) 时跳过.
+ */
+static uint32_t WifiScanCacheReclaim(uint32_t need)
+{
+    DevWifiInfo_t *info = &DevWifiInfo;
+    wifi_ap_record_t record[1];
+    uint16_t apNum = 0;
+    uint16_t recordNum = 1;
+    uint32_t freed = 0;
+    (void)need;
+    if ((info->scan_ok != 1) || !info->muxHandle || (info->muxOwner == LOS_CurTaskIDGet())) {
+        return 0;
+    }
+    if (LOS_MuxPend(info->muxHandle - MUX_HANDLE_OFFSET, LOS_NO_WAIT) != LOS_OK) {
+        return 0;
+    }
+    if ((info->scan_ok == 1) && (esp_wifi_scan_get_ap_num(&apNum) == ESP_OK) && (apNum > 0) &&
+        (esp_wifi_scan_get_ap_records(&recordNum, record) == ESP_OK)) {
+        info->scan_ok = 0;
+        freed = (uint32_t)apNum * sizeof(wifi_ap_record_t);
+    }
+    LOS_MuxPost(info->muxHandle - MUX_HANDLE_OFFSET);
+    return freed;
+}
+
 int DeviceWifiStart(void)
 {
     esp_err_t err;
@@ -377,6 +466,8 @@ int DeviceWifiStart(void)
     }
 
     esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    WifiLinkStatsInit();
+    (void)MemReclaimRegister(WifiScanCacheReclaim);
 
     return 0;
 }
@@ -395,7 +486,17 @@ static void UnregisterEspEvent(void)
         esp_event_handler_instance_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, info->eventHandle[1]);
         info->eventHandle[1] = NULL;
     }
+    if (info->eventHandle[2] != NULL) {
+        esp_event_handler_instance_unregister(IP_EVENT, IP_EVENT_AP_STAIPASSIGNED, info->eventHandle[2]);
+        info->eventHandle[2] = NULL;
+    }
+    if (info->eventHandle[3] != NULL) {
+        esp_event_handler_instance_unregister(WIFI_EVENT, WIFI_EVENT_AP_START, info->eventHandle[3]);
+        info->eventHandle[3] = NULL;
+    }
     if (info->netif != NULL) {
+        WifiLinkStatsSetNetif(NULL);
+        WifiApStaDetach();
         esp_netif_destroy(info->netif);
         info->netif = NULL;
     }
@@ -411,6 +512,9 @@ static int RegisterEspEvent(int apMode)
         info->netif = esp_netif_create_default_wifi_ap();
     } else {
         info->netif = esp_netif_create_default_wifi_sta();
+        if (info->netif != NULL) {
+            WifiLinkStatsSetNetif(esp_netif_get_netif_impl(info->netif));
+        }
     }
     err = esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, event_handler,
                                               NULL, &info->eventHandle[0]);
@@ -422,6 +526,18 @@ static int RegisterEspEvent(int apMode)
     if (err != ESP_OK) {
         LOGE("IP_EVENT err=0x%X", err);
     }
+    if (apMode) {
+        err = esp_event_handler_instance_register(IP_EVENT, IP_EVENT_AP_STAIPASSIGNED, event_ap_ip_assigned_handler,
+                                                  NULL, &info->eventHandle[2]);
+        if (err != ESP_OK) {
+            LOGE("AP IP_EVENT err=0x%X", err);
+        }
+        err = esp_event_handler_instance_register(WIFI_EVENT, WIFI_EVENT_AP_START, event_ap_start_handler,
+                                                  NULL, &info->eventHandle[3]);
+        if (err != ESP_OK) {
+            LOGE("AP_START err=0x%X", err);
+        }
+    }
     err = esp_wifi_set_storage(WIFI_STORAGE_RAM);
     if (err != ESP_OK) {
         LOGE("set_storage err=0x%X", err);
@@ -452,6 +568,8 @@ WifiErrorCode EnableWifi(void)
                 break;
             }
             info->staStatus = WIFI_ACTIVE;
+            WifiPowerOnStarted(0);
+            WifiPowerApply();
             break;
         }
         WifiUnlock();
@@ -472,6 +590,7 @@ WifiErrorCode DisableWifi(void)
     WifiLock();
     info->staStatus = WIFI_NOT_ACTIVE;
     esp_wifi_disconnect();
+    WifiPowerOnStopped();
     UnregisterEspEvent();
     esp_wifi_stop();
     WifiUnlock();
@@ -496,9 +615,47 @@ WifiErrorCode Scan(void)
     return WIFI_SUCCESS;
 }
 
+/* PMK 经 WpaPbkdf2Sha1 派生, 与驱动内部派生共用同一份 PMK 缓存, 在保存配置时调用 */
+static int GetConfigPsk(const WifiDeviceConfig *config, char *psk, size_t pskSize)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    uint8_t pmk[WPA_PMK_LEN];
+    size_t passLen = strnlen(config->preSharedKey, sizeof(config->preSharedKey));
+    size_t ssidLen = strnlen(config->ssid, sizeof(config->ssid));
+
+    /* 64 位十六进制 PSK 由驱动直接使用, 无需派生 */
+    if ((passLen < WIFI_PASSPHRASE_MIN_LEN) || (passLen > WIFI_PASSPHRASE_MAX_LEN) || (pskSize <= WPA_PSK_HEX_LEN)) {
+        return -1;
+    }
+    if (WpaPbkdf2Sha1(config->preSharedKey, config->ssid, ssidLen, WPA_PBKDF2_ITERATIONS, pmk, sizeof(pmk)) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < WPA_PMK_LEN; i++) {
+        psk[i * 2] = hexDigits[pmk[i] >> 4];
+        psk[i * 2 + 1] = hexDigits[pmk[i] & 0x0f];
+    }
+    psk[WPA_PSK_HEX_LEN] = '\0';
+    (void)memset_s(pmk, sizeof(pmk), 0, sizeof(pmk));
+    return 0;
+}
+
+/* 派生期间配置可能已被删除或替换, 仍为同一网络与口令时才保存 */
+static void SaveConfigPsk(unsigned netId, const WifiDeviceConfig *config, const char *psk)
+{
+    DevWifiInfo_t *info = &DevWifiInfo;
+    WifiLock();
+    if ((info->config[netId].netId == netId) &&
+        (memcmp(info->config[netId].ssid, config->ssid, sizeof(config->ssid)) == 0) &&
+        (memcmp(info->config[netId].preSharedKey, config->preSharedKey, sizeof(config->preSharedKey)) == 0)) {
+        MEMCPY_S(info->configPsk[netId], sizeof(info->configPsk[netId]), (VOID *)psk, WPA_PSK_HEX_LEN + 1);
+    }
+    WifiUnlock();
+}
+
 WifiErrorCode AddDeviceConfig(const WifiDeviceConfig *config, int *result)
 {
     DevWifiInfo_t *info = &DevWifiInfo;
+    char psk[WPA_PSK_HEX_LEN + 1];
     if (!config)
         return ERROR_WIFI_INVALID_ARGS;
     WifiLock();
@@ -506,7 +663,14 @@ WifiErrorCode AddDeviceConfig(const WifiDeviceConfig *config, int *result)
         if (info->config[i].netId != i) {
             MEMCPY_S(&info->config[i], sizeof(WifiDeviceConfig), config, sizeof(WifiDeviceConfig));
             info->config[i].netId = i;
+            info->configPsk[i][0] = '\0';
             WifiUnlock();
+            WpaPmkCacheFlush();
+            /* 4096 轮 PBKDF2 在保存配置时完成, 连接时不再阻塞 */
+            if ((config->securityType == WIFI_SEC_TYPE_PSK) && (GetConfigPsk(config, psk, sizeof(psk)) == 0)) {
+                SaveConfigPsk(i, config, psk);
+                (void)memset_s(psk, sizeof(psk), 0, sizeof(psk));
+            }
             if (result) {
                 *result = i;
             }
@@ -559,7 +723,10 @@ WifiErrorCode RemoveDevice(int networkId)
     WifiLock();
     MEMCPY_S(&info->config[networkId], sizeof(WifiDeviceConfig), 0, sizeof(WifiDeviceConfig));
     info->config[networkId].netId = WIFI_CONFIG_INVALID;
+    (void)memset_s(info->configPsk[networkId], sizeof(info->configPsk[networkId]), 0,
+                   sizeof(info->configPsk[networkId]));
     WifiUnlock();
+    WpaPmkCacheFlush();
     return WIFI_SUCCESS;
 }
 
@@ -623,10 +790,25 @@ static int GetScanInfoListNext(WifiScanInfo *result, uint16_t ap_count, unsigned
     if (maxi == 0) {
         return WIFI_SUCCESS;
     }
-    ap_info = (wifi_ap_record_t *)LOS_MemAlloc(OS_SYS_MEM_ADDR, sizeof(wifi_ap_record_t) * maxi);
+    ap_info = (wifi_ap_record_t *)MemTraceLosAlloc(OS_SYS_MEM_ADDR, sizeof(wifi_ap_record_t) * maxi,
+                                                  MEM_TRACE_MOD_WIFI);
     if (!ap_info) {
         return ERROR_WIFI_UNKNOWN;
     }
+    uint16_t recordNum = (uint16_t)maxi;
+    (void)esp_wifi_scan_get_ap_records(&recordNum, ap_info);
+    if (maxi > recordNum) {
+        *size = maxi = recordNum;
+    }
+    WifiLock();
+    info->scanAuthNum = 0;
+    for (int i = 0; (i < maxi) && (i < WIFI_SCAN_AUTH_NUM); ++i) {
+        WifiScanAuth_t *auth = &info->scanAuth[info->scanAuthNum++];
+        MEMCPY_S(auth->ssid, sizeof(auth->ssid), ap_info[i].ssid, sizeof(ap_info[i].ssid));
+        MEMCPY_S(auth->bssid, sizeof(auth->bssid), ap_info[i].bssid, sizeof(ap_info[i].bssid));
+        auth->authmode = (uint8_t)ap_info[i].authmode;
+    }
+    WifiUnlock();
     for (int i = 0; i < maxi; ++i) {
         MEMCPY_S(result[i].ssid, sizeof(result[i].ssid), ap_info[i].ssid, sizeof(ap_info[i].ssid));
         MEMCPY_S(result[i].bssid, sizeof(result[i].bssid), ap_info[i].bssid, sizeof(ap_info[i].bssid));
@@ -635,7 +817,7 @@ static int GetScanInfoListNext(WifiScanInfo *result, uint16_t ap_count, unsigned
         result[i].band = 0;
         result[i].frequency = ChannelToFrequency(ap_info[i].primary);
     }
-    LOS_MemFree(OS_SYS_MEM_ADDR, ap_info);
+    MemTraceLosFree(OS_SYS_MEM_ADDR, ap_info);
     return WIFI_SUCCESS;
 }
 
@@ -669,10 +851,39 @@ WifiErrorCode GetScanInfoList(WifiScanInfo *result, unsigned int *size)
     return GetScanInfoListNext(result, ap_count, size);
 }
 
+/*
+ * 目标 BSS 仅支持 WPA/WPA2-PSK 时才可用 PMK 替换口令: 过渡模式 (WPA2/WPA3) 下
+ * 握手会选 SAE, 而 SAE 需要原始口令. 扫描结果中找不到目标时保守处理.
+ */
+static int WifiBssIsPskOnly(const WifiDeviceConfig *config)
+{
+    DevWifiInfo_t *info = &DevWifiInfo;
+    int anyBssid = (memcmp(config->bssid, NullBssid, sizeof(NullBssid)) == 0);
+    int found = 0;
+    int pskOnly = 1;
+
+    WifiLock();
+    for (int i = 0; i < info->scanAuthNum; i++) {
+        const WifiScanAuth_t *auth = &info->scanAuth[i];
+        if ((strncmp(auth->ssid, config->ssid, sizeof(auth->ssid)) != 0) ||
+            (!anyBssid && (memcmp(auth->bssid, config->bssid, sizeof(auth->bssid)) != 0))) {
+            continue;
+        }
+        found = 1;
+        if ((auth->authmode != WIFI_AUTH_WPA_PSK) && (auth->authmode != WIFI_AUTH_WPA2_PSK) &&
+            (auth->authmode != WIFI_AUTH_WPA_WPA2_PSK)) {
+            pskOnly = 0;
+        }
+    }
+    WifiUnlock();
+    return found && pskOnly;
+}
+
 WifiErrorCode ConnectTo(int networkId)
 {
     WifiDeviceConfig *pconfig;
     DevWifiInfo_t *info = &DevWifiInfo;
+    char psk[WPA_PSK_HEX_LEN + 1];
     if ((networkId >= WIFI_MAX_CONFIG_SIZE) || (networkId < 0)) {
         return ERROR_WIFI_INVALID_ARGS;
     }
@@ -687,6 +898,7 @@ WifiErrorCode ConnectTo(int networkId)
     }
 
     info->ip_ok = 0;
+    MEMCPY_S(psk, sizeof(psk), info->configPsk[networkId], sizeof(info->configPsk[networkId]));
     WifiUnlock();
 
     wifi_config_t assocReq = {0};
@@ -694,11 +906,18 @@ WifiErrorCode ConnectTo(int networkId)
     MEMCPY_S(assocReq.sta.ssid, sizeof(assocReq.sta.ssid), pconfig->ssid, sizeof(pconfig->ssid));
     MEMCPY_S(assocReq.sta.password, sizeof(assocReq.sta.password),
             pconfig->preSharedKey, sizeof(pconfig->preSharedKey));
+    /* 未派生出 PSK 时传口令, 由驱动经 WpaPbkdf2Sha1 派生 */
+    if ((psk[0] != '\0') && (pconfig->securityType == WIFI_SEC_TYPE_PSK) && WifiBssIsPskOnly(pconfig)) {
+        MEMCPY_S(assocReq.sta.password, sizeof(assocReq.sta.password), psk, WPA_PSK_HEX_LEN);
+    }
+    (void)memset_s(psk, sizeof(psk), 0, sizeof(psk));
     MEMCPY_S(assocReq.sta.bssid, sizeof(assocReq.sta.bssid), pconfig->bssid, sizeof(pconfig->bssid));
     assocReq.sta.channel = FrequencyToChannel(pconfig->freq);
     assocReq.sta.pmf_cfg.capable = true;
     assocReq.sta.pmf_cfg.required = false;
+    assocReq.sta.listen_interval = WifiPowerListenInterval();
     esp_wifi_set_config(WIFI_IF_STA, &assocReq);
+    WifiLinkStatsConnectStart();
     if (esp_wifi_connect() != ESP_OK) {
         return ERROR_WIFI_UNKNOWN;
     }
@@ -769,22 +988,8 @@ WifiErrorCode GetStationList(StationInfo *result, unsigned int *size)
     if (!*size)
         return ERROR_WIFI_INVALID_ARGS;
 
-    wifi_sta_list_t wifi_sta_list = {0};
-    unsigned int staNum = 0;
-    esp_err_t ret = esp_wifi_ap_get_sta_list(&wifi_sta_list);
-    if (ret != ESP_OK) {
-        LOGE("esp_wifi_ap_get_sta_list.err=0x%X", ret);
-        return ERROR_WIFI_NOT_AVAILABLE;
-    }
-    staNum = wifi_sta_list.num;
-    if (*size < staNum) {
-        staNum = *size;
-    }
-    MEMCPY_S(result, (sizeof(result[0]) * staNum), 0, sizeof(result[0]) * staNum);
-    for (unsigned int i = 0; i < staNum; i++) {
-        MEMCPY_S(result[i].macAddress, sizeof(result[i].macAddress),
-                 wifi_sta_list.sta[i].mac, sizeof(wifi_sta_list.sta[i].mac));
-    }
+    /* 终端表由 AP 接入/断开事件维护, 无需查询驱动 */
+    *size = WifiApStaGetList(result, *size);
     return WIFI_SUCCESS;
 }
 
@@ -892,7 +1097,7 @@ WifiErrorCode EnableHotspot(void)
         wifi_config.ap.channel = hotConfig->channelNum;
     }
     wifi_config.ap.authmode = HoSecToESPSec(hotConfig->securityType);
-    wifi_config.ap.max_connection = ESP_EXAMPLE_MAX_STA_CONN;
+    wifi_config.ap.max_connection = WifiApStaMaxConn();
     MEMCPY_S(wifi_config.ap.ssid, sizeof(wifi_config.ap.ssid), hotConfig->ssid, sizeof(hotConfig->ssid));
     MEMCPY_S(wifi_config.ap.password, sizeof(wifi_config.ap.password),
             hotConfig->preSharedKey, sizeof(hotConfig->preSharedKey));
@@ -912,6 +1117,7 @@ WifiErrorCode EnableHotspot(void)
     }
 
     info->staStatus = WIFI_ACTIVE;
+    WifiPowerOnStarted(1);
     WifiUnlock();
     LOS_Msleep(DELAY_10_TICK);
     for (int i = 0; i < DELAY_LOOP_TIMES; ++i) {
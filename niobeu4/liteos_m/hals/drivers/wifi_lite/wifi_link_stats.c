@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "cmsis_os2.h"
+#include "los_interrupt.h"
+#include "los_tick.h"
+#include "lwip/netif.h"
+#include "lwip/stats.h"
+#include "securec.h"
+#if (LOSCFG_USE_SHELL == 1)
+#include "shcmd.h"
+#endif
+#include "wifi_link_stats.h"
+
+#define MS_PER_SECOND 1000
+#define REASON_ESP_BASE 200
+#define REASON_IEEE_NUM 68
+#define REASON_BUCKET_OTHER (WIFI_STATS_REASON_NUM - 1)
+#define SHELL_SAMPLE_SHOW_NUM 8
+
+typedef struct {
+    WifiLinkSample sample[WIFI_STATS_SAMPLE_NUM];
+    WifiConnAttempt attempt[WIFI_STATS_ATTEMPT_NUM];
+    uint16_t reason[WIFI_STATS_REASON_NUM];
+    uint16_t sampleHead;
+    uint16_t sampleNum;
+    uint16_t attemptHead;
+    uint16_t attemptNum;
+    WifiConnAttempt *current;
+    uint32_t assocDoneMs;
+    struct netif *netif;
+    osTimerId_t timer;
+} WifiLinkStats_t;
+
+static WifiLinkStats_t WifiLinkStats = {0};
+
+static uint32_t WifiStatsNowMs(void)
+{
+    return (uint32_t)(LOS_TickCountGet() * MS_PER_SECOND / LOSCFG_BASE_CORE_TICK_PER_SECOND);
+}
+
+static uint16_t WifiStatsElapsed(uint32_t from, uint32_t to)
+{
+    uint32_t diff = to - from;
+    return (diff >= WIFI_STATS_TIME_INVALID) ? (WIFI_STATS_TIME_INVALID - 1) : (uint16_t)diff;
+}
+
+/* IEEE 原因码 0-67 直接映射, ESP 私有原因码 200+ 映射到其后, 其余计入最后的 "其他" 桶 */
+static unsigned int ReasonToBucket(uint8_t reason)
+{
+    if (reason < REASON_IEEE_NUM) {
+        return reason;
+    }
+    if ((reason >= REASON_ESP_BASE) && (reason - REASON_ESP_BASE < REASON_BUCKET_OTHER - REASON_IEEE_NUM)) {
+        return REASON_IEEE_NUM + reason - REASON_ESP_BASE;
+    }
+    return REASON_BUCKET_OTHER;
+}
+
+static uint8_t BucketToReason(unsigned int bucket)
+{
+    if (bucket == REASON_BUCKET_OTHER) {
+        return WIFI_STATS_REASON_OTHER;
+    }
+    return (bucket < REASON_IEEE_NUM) ? (uint8_t)bucket : (uint8_t)(bucket - REASON_IEEE_NUM + REASON_ESP_BASE);
+}
+
+static void WifiStatsReadNetif(WifiLinkSample *sample)
+{
+    struct netif *netif = WifiLinkStats.netif;
+    if (netif == NULL) {
+        return;
+    }
+#if MIB2_STATS
+    sample->txBytes = netif->mib2_counters.ifoutoctets;
+    sample->rxBytes = netif->mib2_counters.ifinoctets;
+    sample->txPackets = netif->mib2_counters.ifoutucastpkts + netif->mib2_counters.ifoutnucastpkts;
+    sample->rxPackets = netif->mib2_counters.ifinucastpkts + netif->mib2_counters.ifinnucastpkts;
+#elif LWIP_STATS && LINK_STATS
+    sample->txPackets = lwip_stats.link.xmit;
+    sample->rxPackets = lwip_stats.link.recv;
+#endif
+}
+
+static void WifiStatsSampleProc(void *arg)
+{
+    WifiLinkSample sample = {0};
+    wifi_ap_record_t ap_info = {0};
+    wifi_bandwidth_t bw = WIFI_BW_HT20;
+    (void)arg;
+
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+        return;
+    }
+    sample.timeMs = WifiStatsNowMs();
+    sample.rssi = ap_info.rssi;
+    sample.channel = ap_info.primary;
+    sample.phyMode = (ap_info.phy_11b ? WIFI_STATS_PHY_11B : 0) | (ap_info.phy_11g ? WIFI_STATS_PHY_11G : 0) |
+                     (ap_info.phy_11n ? WIFI_STATS_PHY_11N : 0) | (ap_info.phy_lr ? WIFI_STATS_PHY_LR : 0);
+    if ((esp_wifi_get_bandwidth(WIFI_IF_STA, &bw) == ESP_OK) && (bw == WIFI_BW_HT40)) {
+        sample.phyMode |= WIFI_STATS_PHY_HT40;
+    }
+    WifiStatsReadNetif(&sample);
+
+    UINT32 intSave = LOS_IntLock();
+    WifiLinkStats.sample[WifiLinkStats.sampleHead] = sample;
+    WifiLinkStats.sampleHead = (WifiLinkStats.sampleHead + 1) % WIFI_STATS_SAMPLE_NUM;
+    if (WifiLinkStats.sampleNum < WIFI_STATS_SAMPLE_NUM) {
+        WifiLinkStats.sampleNum++;
+    }
+    LOS_IntRestore(intSave);
+}
+
+static void WifiStatsTimerStart(void)
+{
+    if (WifiLinkStats.timer == NULL) {
+        WifiLinkStats.timer = osTimerNew(WifiStatsSampleProc, osTimerPeriodic, NULL, NULL);
+        if (WifiLinkStats.timer == NULL) {
+            return;
+        }
+    }
+    (void)osTimerStart(WifiLinkStats.timer,
+                       WIFI_STATS_SAMPLE_PERIOD_MS * LOSCFG_BASE_CORE_TICK_PER_SECOND / MS_PER_SECOND);
+}
+
+static void WifiStatsTimerStop(void)
+{
+    if (WifiLinkStats.timer != NULL) {
+        (void)osTimerStop(WifiLinkStats.timer);
+    }
+}
+
+void WifiLinkStatsSetNetif(void *netif)
+{
+    WifiLinkStats.netif = (struct netif *)netif;
+}
+
+void WifiLinkStatsConnectStart(void)
+{
+    UINT32 intSave = LOS_IntLock();
+    WifiConnAttempt *attempt = &WifiLinkStats.attempt[WifiLinkStats.attemptHead];
+    WifiLinkStats.attemptHead = (WifiLinkStats.attemptHead + 1) % WIFI_STATS_ATTEMPT_NUM;
+    if (WifiLinkStats.attemptNum < WIFI_STATS_ATTEMPT_NUM) {
+        WifiLinkStats.attemptNum++;
+    }
+    (void)memset_s(attempt, sizeof(*attempt), 0, sizeof(*attempt));
+    attempt->startMs = WifiStatsNowMs();
+    attempt->assocMs = WIFI_STATS_TIME_INVALID;
+    attempt->dhcpMs = WIFI_STATS_TIME_INVALID;
+    attempt->result = WIFI_ATTEMPT_PENDING;
+    WifiLinkStats.current = attempt;
+    LOS_IntRestore(intSave);
+}
+
+void WifiLinkStatsAssociated(void)
+{
+    uint32_t now = WifiStatsNowMs();
+    UINT32 intSave = LOS_IntLock();
+    WifiConnAttempt *attempt = WifiLinkStats.current;
+    if ((attempt != NULL) && (attempt->result == WIFI_ATTEMPT_PENDING)) {
+        attempt->assocMs = WifiStatsElapsed(attempt->startMs, now);
+        attempt->result = WIFI_ATTEMPT_ASSOCIATED;
+    }
+    WifiLinkStats.assocDoneMs = now;
+    LOS_IntRestore(intSave);
+    WifiStatsTimerStart();
+}
+
+void WifiLinkStatsGotIp(void)
+{
+    uint32_t now = WifiStatsNowMs();
+    UINT32 intSave = LOS_IntLock();
+    WifiConnAttempt *attempt = WifiLinkStats.current;
+    if ((attempt != NULL) && (attempt->result == WIFI_ATTEMPT_ASSOCIATED)) {
+        attempt->dhcpMs = WifiStatsElapsed(WifiLinkStats.assocDoneMs, now);
+        attempt->result = WIFI_ATTEMPT_GOT_IP;
+    }
+    LOS_IntRestore(intSave);
+}
+
+void WifiLinkStatsDisconnected(uint8_t reason)
+{
+    UINT32 intSave = LOS_IntLock();
+    WifiConnAttempt *attempt = WifiLinkStats.current;
+    if ((attempt != NULL) && (attempt->result != WIFI_ATTEMPT_GOT_IP)) {
+        attempt->result = WIFI_ATTEMPT_FAILED;
+        attempt->reason = reason;
+    }
+    WifiLinkStats.current = NULL;
+    unsigned int bucket = ReasonToBucket(reason);
+    if (WifiLinkStats.reason[bucket] != UINT16_MAX) {
+        WifiLinkStats.reason[bucket]++;
+    }
+    LOS_IntRestore(intSave);
+    WifiStatsTimerStop();
+}
+
+void WifiLinkStatsReset(void)
+{
+    UINT32 intSave = LOS_IntLock();
+    (void)memset_s(WifiLinkStats.sample, sizeof(WifiLinkStats.sample), 0, sizeof(WifiLinkStats.sample));
+    (void)memset_s(WifiLinkStats.attempt, sizeof(WifiLinkStats.attempt), 0, sizeof(WifiLinkStats.attempt));
+    (void)memset_s(WifiLinkStats.reason, sizeof(WifiLinkStats.reason), 0, sizeof(WifiLinkStats.reason));
+    WifiLinkStats.sampleHead = 0;
+    WifiLinkStats.sampleNum = 0;
+    WifiLinkStats.attemptHead = 0;
+    WifiLinkStats.attemptNum = 0;
+    WifiLinkStats.current = NULL;
+    LOS_IntRestore(intSave);
+}
+
+static uint16_t WifiStatsReasonNum(void)
+{
+    uint16_t num = 0;
+    for (unsigned int i = 0; i < WIFI_STATS_REASON_NUM; i++) {
+        if (WifiLinkStats.reason[i] != 0) {
+            num++;
+        }
+    }
+    return num;
+}
+
+int WifiLinkStatsSnapshot(uint8_t *buf, uint32_t size)
+{
+    WifiStatsSnapshotHead head = {0};
+    uint32_t need, pos;
+
+    UINT32 intSave = LOS_IntLock();
+    head.magic = WIFI_STATS_MAGIC;
+    head.version = WIFI_STATS_VERSION;
+    head.headSize = sizeof(head);
+    head.timeMs = WifiStatsNowMs();
+    head.sampleNum = WifiLinkStats.sampleNum;
+    head.attemptNum = WifiLinkStats.attemptNum;
+    head.reasonNum = WifiStatsReasonNum();
+    need = sizeof(head) + head.sampleNum * sizeof(WifiLinkSample) + head.attemptNum * sizeof(WifiConnAttempt) +
+           head.reasonNum * sizeof(WifiReasonCount);
+    if ((buf == NULL) || (size < need)) {
+        LOS_IntRestore(intSave);
+        return (buf == NULL) ? (int)need : -1;
+    }
+
+    (void)memcpy_s(buf, size, &head, sizeof(head));
+    pos = sizeof(head);
+    unsigned int start = (WifiLinkStats.sampleHead + WIFI_STATS_SAMPLE_NUM - head.sampleNum) % WIFI_STATS_SAMPLE_NUM;
+    for (unsigned int i = 0; i < head.sampleNum; i++) {
+        (void)memcpy_s(buf + pos, size - pos, &WifiLinkStats.sample[(start + i) % WIFI_STATS_SAMPLE_NUM],
+                       sizeof(WifiLinkSample));
+        pos += sizeof(WifiLinkSample);
+    }
+    start = (WifiLinkStats.attemptHead + WIFI_STATS_ATTEMPT_NUM - head.attemptNum) % WIFI_STATS_ATTEMPT_NUM;
+    for (unsigned int i = 0; i < head.attemptNum; i++) {
+        (void)memcpy_s(buf + pos, size - pos, &WifiLinkStats.attempt[(start + i) % WIFI_STATS_ATTEMPT_NUM],
+                       sizeof(WifiConnAttempt));
+        pos += sizeof(WifiConnAttempt);
+    }
+    for (unsigned int i = 0; i < WIFI_STATS_REASON_NUM; i++) {
+        if (WifiLinkStats.reason[i] == 0) {
+            continue;
+        }
+        WifiReasonCount item = { .reason = BucketToReason(i), .count = WifiLinkStats.reason[i] };
+        (void)memcpy_s(buf + pos, size - pos, &item, sizeof(item));
+        pos += sizeof(item);
+    }
+    LOS_IntRestore(intSave);
+    return (int)pos;
+}
+
+#if (LOSCFG_USE_SHELL == 1)
+static void WifiStatsShowSnapshot(const uint8_t *buf)
+{
+    const WifiStatsSnapshotHead *head = (const WifiStatsSnapshotHead *)buf;
+    const WifiLinkSample *sample = (const WifiLinkSample *)(buf + head->headSize);
+    const WifiConnAttempt *attempt = (const WifiConnAttempt *)(sample + head->sampleNum);
+    const WifiReasonCount *reason = (const WifiReasonCount *)(attempt + head->attemptNum);
+    unsigned int first = (head->sampleNum > SHELL_SAMPLE_SHOW_NUM) ? (head->sampleNum - SHELL_SAMPLE_SHOW_NUM) : 0;
+
+    printf("samples=%u attempts=%u reasons=%u\r\n", head->sampleNum, head->attemptNum, head->reasonNum);
+    printf("%10s %5s %3s %4s %10s %10s %8s %8s\r\n", "time(ms)", "rssi", "ch", "phy", "txBytes", "rxBytes",
+           "txPkts", "rxPkts");
+    for (unsigned int i = first; i < head->sampleNum; i++) {
+        printf("%10u %5d %3u 0x%02X %10u %10u %8u %8u\r\n", sample[i].timeMs, sample[i].rssi, sample[i].channel,
+               sample[i].phyMode, sample[i].txBytes, sample[i].rxBytes, sample[i].txPackets, sample[i].rxPackets);
+    }
+    for (unsigned int i = 0; i < head->attemptNum; i++) {
+        printf("attempt@%u result=%u assoc=%ums dhcp=%ums reason=%u\r\n", attempt[i].startMs, attempt[i].result,
+               attempt[i].assocMs, attempt[i].dhcpMs, attempt[i].reason);
+    }
+    for (unsigned int i = 0; i < head->reasonNum; i++) {
+        printf("reason %3u: %u\r\n", reason[i].reason, reason[i].count);
+    }
+}
+
+static UINT32 WifiStatsShellCmd(UINT32 argc, const CHAR **argv)
+{
+    if ((argc > 0) && (strcmp(argv[0], "reset") == 0)) {
+        WifiLinkStatsReset();
+        return LOS_OK;
+    }
+    // 按最大容量分配, 两次调用之间新增的采样不会导致快照失败
+    uint8_t *buf = (uint8_t *)malloc(WIFI_STATS_SNAPSHOT_MAX);
+    if (buf == NULL) {
+        printf("wifistats: no memory\r\n");
+        return LOS_NOK;
+    }
+    if (WifiLinkStatsSnapshot(buf, WIFI_STATS_SNAPSHOT_MAX) > 0) {
+        WifiStatsShowSnapshot(buf);
+    }
+    free(buf);
+    return LOS_OK;
+}
+#endif
+
+void WifiLinkStatsInit(void)
+{
+#if (LOSCFG_USE_SHELL == 1)
+    static uint8_t registered = 0;
+    if (!registered) {
+        (void)osCmdReg(CMD_TYPE_EX, "wifistats", XARGS, (CmdCallBackFunc)WifiStatsShellCmd);
+        registered = 1;
+    }
+#endif
+}
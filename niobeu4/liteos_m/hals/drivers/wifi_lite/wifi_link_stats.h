@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WIFI_LINK_STATS_H__
+#define __WIFI_LINK_STATS_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#define WIFI_STATS_SAMPLE_NUM 64        // 链路采样环形缓冲深度
+#define WIFI_STATS_ATTEMPT_NUM 16       // 连接尝试记录环形缓冲深度
+#define WIFI_STATS_REASON_NUM 96        // 断开原因统计桶个数, 最后一个为 "其他"
+#define WIFI_STATS_REASON_OTHER 0xFF    // 快照中无法单独统计的原因码合并为该值
+#define WIFI_STATS_SAMPLE_PERIOD_MS 1000
+
+#define WIFI_STATS_MAGIC 0x31534C57     // "WLS1"
+#define WIFI_STATS_VERSION 1
+#define WIFI_STATS_TIME_INVALID 0xFFFF
+
+/* phyMode 位定义 */
+#define WIFI_STATS_PHY_11B (1 << 0)
+#define WIFI_STATS_PHY_11G (1 << 1)
+#define WIFI_STATS_PHY_11N (1 << 2)
+#define WIFI_STATS_PHY_LR (1 << 3)
+#define WIFI_STATS_PHY_HT40 (1 << 4)
+
+typedef enum {
+    WIFI_ATTEMPT_PENDING = 0,
+    WIFI_ATTEMPT_ASSOCIATED,
+    WIFI_ATTEMPT_GOT_IP,
+    WIFI_ATTEMPT_FAILED,
+} WifiAttemptResult;
+
+/*
+ * 单次链路采样, 网络计数为累计值. lwIP 开启 MIB2_STATS 时取 STA netif 的计数;
+ * 否则字节数恒为 0, 包数取全局 lwip_stats.link, 包含所有 netif (如 SoftAP) 的流量.
+ */
+typedef struct {
+    uint32_t timeMs;
+    int8_t rssi;
+    uint8_t phyMode;
+    uint8_t channel;
+    uint8_t reserved;
+    uint32_t txBytes;
+    uint32_t rxBytes;
+    uint32_t txPackets;
+    uint32_t rxPackets;
+} WifiLinkSample;
+
+/* 单次连接尝试, 耗时单位 ms, 未完成为 WIFI_STATS_TIME_INVALID */
+typedef struct {
+    uint32_t startMs;
+    uint16_t assocMs;
+    uint16_t dhcpMs;
+    uint8_t result;
+    uint8_t reason;
+    uint16_t reserved;
+} WifiConnAttempt;
+
+typedef struct {
+    uint8_t reason;
+    uint8_t reserved;
+    uint16_t count;
+} WifiReasonCount;
+
+/*
+ * 快照二进制格式(小端):
+ * WifiStatsSnapshotHead + WifiLinkSample[sampleNum] + WifiConnAttempt[attemptNum] + WifiReasonCount[reasonNum]
+ * 采样与尝试记录均按时间从旧到新排列.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headSize;
+    uint32_t timeMs;
+    uint16_t sampleNum;
+    uint16_t attemptNum;
+    uint16_t reasonNum;
+    uint16_t reserved;
+} WifiStatsSnapshotHead;
+
+/* 环形缓冲全满时快照的最大长度 */
+#define WIFI_STATS_SNAPSHOT_MAX (sizeof(WifiStatsSnapshotHead) + WIFI_STATS_SAMPLE_NUM * sizeof(WifiLinkSample) + \
+                                 WIFI_STATS_ATTEMPT_NUM * sizeof(WifiConnAttempt) +                            \
+                                 WIFI_STATS_REASON_NUM * sizeof(WifiReasonCount))
+
+/**
+ * @brief 获取链路统计快照
+ *
+ * @param buf  输出缓冲, 为 NULL 时仅返回所需长度
+ * @param size 输出缓冲长度
+ * @return 写入(或所需)字节数, 缓冲不足返回 -1
+ */
+int WifiLinkStatsSnapshot(uint8_t *buf, uint32_t size);
+
+/**
+ * @brief 清空链路统计
+ */
+void WifiLinkStatsReset(void);
+
+void WifiLinkStatsInit(void);
+void WifiLinkStatsConnectStart(void);
+void WifiLinkStatsAssociated(void);
+void WifiLinkStatsGotIp(void);
+void WifiLinkStatsDisconnected(uint8_t reason);
+void WifiLinkStatsSetNetif(void *netif);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* __WIFI_LINK_STATS_H__ */
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include "esp_wifi.h"
+#include "wifi_power.h"
+
+#define WIFI_POWER_RADIO_OFF 0
+#define WIFI_POWER_RADIO_STA 1
+#define WIFI_POWER_RADIO_AP 2
+
+typedef struct {
+    WifiPowerPolicy policy;
+    volatile uint8_t connected;
+    volatile uint8_t radio;     // WIFI_POWER_RADIO_*, 由 EnableWifi/EnableHotspot/DisableWifi 更新
+} WifiPower_t;
+
+static WifiPower_t WifiPower = {
+    .policy = { .mode = WIFI_POWER_NONE, .listenInterval = WIFI_POWER_LISTEN_INTERVAL_DEFAULT },
+};
+
+static wifi_ps_type_t PolicyToEspPs(WifiPowerMode mode)
+{
+    switch (mode) {
+        case WIFI_POWER_MIN_MODEM:
+            return WIFI_PS_MIN_MODEM;
+        case WIFI_POWER_MAX_MODEM:
+            return WIFI_PS_MAX_MODEM;
+        default:
+            return WIFI_PS_NONE;
+    }
+}
+
+WifiErrorCode SetWifiPowerPolicy(const WifiPowerPolicy *policy)
+{
+    if ((policy == NULL) || (policy->mode > WIFI_POWER_MAX_MODEM) ||
+        (policy->listenInterval > WIFI_POWER_LISTEN_INTERVAL_MAX)) {
+        return ERROR_WIFI_INVALID_ARGS;
+    }
+    WifiPower.policy = *policy;
+    if (WifiPower.policy.listenInterval == 0) {
+        WifiPower.policy.listenInterval = WIFI_POWER_LISTEN_INTERVAL_DEFAULT;
+    }
+    WifiPowerApply();
+    return WIFI_SUCCESS;
+}
+
+WifiErrorCode GetWifiPowerPolicy(WifiPowerPolicy *policy)
+{
+    if (policy == NULL) {
+        return ERROR_WIFI_INVALID_ARGS;
+    }
+    *policy = WifiPower.policy;
+    return WIFI_SUCCESS;
+}
+
+uint32_t GetWifiPowerWakePeriod(void)
+{
+    switch (WifiPower.policy.mode) {
+        case WIFI_POWER_MIN_MODEM:
+            return WIFI_POWER_BEACON_US * WIFI_POWER_DTIM_DEFAULT;
+        case WIFI_POWER_MAX_MODEM:
+            return WIFI_POWER_BEACON_US * WifiPower.policy.listenInterval;
+        default:
+            return 0;
+    }
+}
+
+uint32_t GetWifiPowerRxLatency(void)
+{
+    return GetWifiPowerWakePeriod();
+}
+
+int WifiPowerLightSleepAllowed(void)
+{
+    if (WifiPower.radio == WIFI_POWER_RADIO_OFF) {
+        return 1;
+    }
+    /* 射频已开启时只有关联中的 STA 且启用省电才能在信标之间睡眠, AP 与连接过程中保持清醒 */
+    return (WifiPower.radio == WIFI_POWER_RADIO_STA) && WifiPower.connected &&
+           (WifiPower.policy.mode != WIFI_POWER_NONE);
+}
+
+void WifiPowerApply(void)
+{
+    /* Wi-Fi 未初始化时返回错误, 策略在 EnableWifi 后重新下发 */
+    esp_err_t err = esp_wifi_set_ps(PolicyToEspPs(WifiPower.policy.mode));
+    if ((err != ESP_OK) && (err != ESP_ERR_WIFI_NOT_INIT)) {
+        printf("WifiPower set_ps(%d) err=0x%X\r\n", WifiPower.policy.mode, err);
+    }
+}
+
+uint16_t WifiPowerListenInterval(void)
+{
+    return (WifiPower.policy.mode == WIFI_POWER_MAX_MODEM) ? WifiPower.policy.listenInterval : 0;
+}
+
+void WifiPowerOnStarted(int apMode)
+{
+    WifiPower.radio = apMode ? WIFI_POWER_RADIO_AP : WIFI_POWER_RADIO_STA;
+}
+
+void WifiPowerOnStopped(void)
+{
+    WifiPower.connected = 0;
+    WifiPower.radio = WIFI_POWER_RADIO_OFF;
+}
+
+void WifiPowerOnConnected(void)
+{
+    WifiPower.connected = 1;
+}
+
+void WifiPowerOnDisconnected(void)
+{
+    WifiPower.connected = 0;
+}
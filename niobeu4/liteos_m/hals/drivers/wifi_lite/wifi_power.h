@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WIFI_POWER_H__
+#define __WIFI_POWER_H__
+
+#include <stdint.h>
+#include "wifi_error_code.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#define WIFI_POWER_BEACON_US 102400         // 默认信标间隔 100 TU, 仅用于估算接收延迟
+#define WIFI_POWER_DTIM_DEFAULT 1           // 驱动不上报 DTIM 周期, 按 1 计算
+#define WIFI_POWER_LISTEN_INTERVAL_DEFAULT 3
+#define WIFI_POWER_LISTEN_INTERVAL_MAX 100
+
+typedef enum {
+    WIFI_POWER_NONE = 0,    // 射频常开
+    WIFI_POWER_MIN_MODEM,   // 每个 DTIM 信标唤醒
+    WIFI_POWER_MAX_MODEM,   // 每 listenInterval 个信标唤醒
+} WifiPowerMode;
+
+typedef struct {
+    WifiPowerMode mode;
+    uint16_t listenInterval;    // 单位: 信标间隔, 仅 MAX_MODEM 有效, 0 取默认值
+} WifiPowerPolicy;
+
+/**
+ * @brief 设置 Wi-Fi 省电策略
+ *
+ * 省电模式立即生效, listenInterval 在下一次 ConnectTo 时生效.
+ *
+ * @param policy 省电策略
+ * @return WIFI_SUCCESS 成功, 其他失败
+ */
+WifiErrorCode SetWifiPowerPolicy(const WifiPowerPolicy *policy);
+
+/**
+ * @brief 获取当前 Wi-Fi 省电策略
+ */
+WifiErrorCode GetWifiPowerPolicy(WifiPowerPolicy *policy);
+
+/**
+ * @brief 获取当前策略下射频唤醒周期(us), WIFI_POWER_NONE 返回 0
+ */
+uint32_t GetWifiPowerWakePeriod(void);
+
+/**
+ * @brief 获取当前策略引入的最大下行接收延迟(us)
+ *
+ * AP 缓存的单播帧最迟在下一个唤醒点被取回, 因此等于唤醒周期.
+ */
+uint32_t GetWifiPowerRxLatency(void);
+
+/**
+ * @brief 当前 Wi-Fi 状态是否允许空闲浅睡眠, 只读取缓存的状态, 可在空闲任务中调用
+ *
+ * 信标唤醒由 Wi-Fi 驱动通过 esp_timer 安排, 空闲浅睡眠不越过下一个 esp_timer 即可.
+ *
+ * @return 非 0 允许: Wi-Fi 未启动, 或 STA 已关联且启用了省电模式
+ */
+int WifiPowerLightSleepAllowed(void);
+
+void WifiPowerApply(void);
+uint16_t WifiPowerListenInterval(void);
+void WifiPowerOnStarted(int apMode);
+void WifiPowerOnStopped(void);
+void WifiPowerOnConnected(void);
+void WifiPowerOnDisconnected(void);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* __cplusplus */
+
+#endif /* __WIFI_POWER_H__ */
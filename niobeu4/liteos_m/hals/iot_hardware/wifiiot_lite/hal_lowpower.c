@@ -13,13 +13,21 @@
  * limitations under the License.
  */
 
+#include <stdbool.h>
 #include "iot_errno.h"
 #include "lowpower.h"
 
 #include "esp_err.h"
+#include "esp_pm.h"
 #include "esp_sleep.h"
+#include "esp_timer.h"
+#include "los_arch_timer.h"
+#include "hr_time.h"
+#include "wifi_power.h"
 
 #define WAKE_TIME_DEFAULT 20
+#define US_PER_SECOND 1000000
+#define LIGHT_SLEEP_MIN_US 5000     // 进出浅睡眠约需 1ms, 更短的空闲仍用 waiti
 
 static uint32_t ESPErrToHoErr(esp_err_t ret)
 {
@@ -35,19 +43,73 @@ unsigned int LpcInit(void)
     return IOT_SUCCESS;
 }
 
-unsigned int LpcSetType(LpcType type)
+/*
+ * 内核空闲钩子, 锁调度后调用. 唤醒时刻取下一个内核事件与下一个需要唤醒的 esp_timer 中较早者:
+ * 启用 esp_pm 浅睡眠后, Wi-Fi 驱动自行用 esp_timer 安排 DTIM 信标唤醒, 由此保持与 AP 的关联.
+ * 返回实际睡眠时长, 由 esp_timer 计量 (睡眠期间已由 RTC 补偿).
+ */
+static uint64_t LpcIdleLightSleep(uint64_t maxUs)
 {
-    esp_err_t ret = esp_sleep_enable_timer_wakeup(WAKE_TIME_DEFAULT * 1000000);
-    if (ret != ESP_OK) {
-        return IOT_FAILURE;
+    uint64_t sleepUs = maxUs;
+    int64_t now;
+    int64_t alarm;
+    int64_t start;
+    if (!WifiPowerLightSleepAllowed() || HrTimerPending()) {
+        return 0;
+    }
+    now = esp_timer_get_time();
+    alarm = esp_timer_get_next_alarm_for_wake_up();
+    if (alarm <= now) {
+        return 0;
     }
+    if ((uint64_t)(alarm - now) < sleepUs) {
+        sleepUs = (uint64_t)(alarm - now);
+    }
+    if ((sleepUs < LIGHT_SLEEP_MIN_US) || (esp_sleep_enable_timer_wakeup(sleepUs) != ESP_OK)) {
+        return 0;
+    }
+    start = esp_timer_get_time();
+    if (esp_light_sleep_start() != ESP_OK) {
+        return 0;
+    }
+    return (uint64_t)(esp_timer_get_time() - start);
+}
+
+// 内核节拍由 APB 时钟计数, 不允许动态调频, 只打开浅睡眠
+static esp_err_t LpcPmConfigure(bool lightSleep)
+{
+    esp_pm_config_esp32_t config = {
+        .max_freq_mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ,
+        .light_sleep_enable = lightSleep,
+    };
+    return esp_pm_configure(&config);
+}
 
+/*
+ * 与早期实现不同, LIGHT_SLEEP 与 NO_SLEEP 不再立即睡眠 WAKE_TIME_DEFAULT 秒, 而是设置空闲时的睡眠方式:
+ * LIGHT_SLEEP 打开 esp_pm 浅睡眠, 内核空闲且下一个事件足够远时进入浅睡眠; NO_SLEEP 关闭.
+ * DEEP_SLEEP 仍立即进入深睡眠, WAKE_TIME_DEFAULT 秒后复位唤醒.
+ */
+unsigned int LpcSetType(LpcType type)
+{
+    esp_err_t ret;
+    if (type == NO_SLEEP) {
+        ArchSetIdleSleepHook(NULL);
+        return ESPErrToHoErr(LpcPmConfigure(false));
+    }
     if (type == LIGHT_SLEEP) {
-        ret = esp_light_sleep_start();
+        ret = LpcPmConfigure(true);
+        if (ret != ESP_OK) {
+            return ESPErrToHoErr(ret);
+        }
+        ArchSetIdleSleepHook(LpcIdleLightSleep);
+        return IOT_SUCCESS;
+    }
+    ret = esp_sleep_enable_timer_wakeup((uint64_t)WAKE_TIME_DEFAULT * US_PER_SECOND);
+    if (ret != ESP_OK) {
         return ESPErrToHoErr(ret);
-    } else if (type == DEEP_SLEEP) {
-        esp_deep_sleep_start();
     }
-
+    esp_deep_sleep_start();
     return IOT_SUCCESS;
 }
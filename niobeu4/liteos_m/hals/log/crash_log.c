@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fcntl.h"
+#include "sys/stat.h"
+#include "securec.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "los_interrupt.h"
+#include "los_task.h"
+#include "los_tick.h"
+#include "ohos_init.h"
+#if (LOSCFG_USE_SHELL == 1)
+#include "shcmd.h"
+#endif
+#ifdef LOSCFG_FS_LITTLEFS
+#include "littlefs.h"
+#endif
+#include "log_ring.h"
+#include "mem_reclaim.h"
+#include "crash_log.h"
+
+#define CRASH_LOG_MAGIC 0x43524C47      // "CRLG"
+#define CRASH_TASK_NAME_LEN 16
+#define CRASH_LOG_TEXT_MAX (CRASH_LOG_SIZE + CRASH_LOG_TASK_MAX * 64 + 256)
+#define CRASH_LOG_PATH_LEN 64
+#define CRASH_LOG_FILE_MODE 0644
+#define FNV_OFFSET_BASIS 0x811C9DC5U
+#define FNV_PRIME 0x01000193U
+
+typedef struct {
+    char name[CRASH_TASK_NAME_LEN];
+    uint16_t taskId;
+    uint16_t status;
+    uint16_t prio;
+    uint16_t reserved;
+    uint32_t stackSize;
+    uint32_t stackPeak;
+} CrashTaskInfo;
+
+// 受校验保护的头部
+typedef struct {
+    uint32_t reason;
+    uint32_t timeMs;
+    uint32_t taskId;
+    uint32_t taskNum;
+    CrashTaskInfo task[CRASH_LOG_TASK_MAX];
+} CrashLogHead;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t checksum;
+    CrashLogHead head;
+    uint32_t written;                   // 累计写入字节数, 按 CRASH_LOG_SIZE 取模定位
+    char buf[CRASH_LOG_SIZE];
+} CrashLogArea;
+
+typedef struct {
+    char *pending;                      // 上次复位前的崩溃日志文本, 保存到 littlefs 后释放
+    uint32_t pendingLen;
+    uint8_t ready;
+} CrashLog_t;
+
+static RTC_NOINIT_ATTR CrashLogArea CrashLogRtc;
+static CrashLog_t CrashLog;
+
+// 取走待保存的崩溃日志, 之后由调用者独占使用并释放; 锁调度与读取者、低内存回收互斥
+static char *CrashLogTakePending(uint32_t *len)
+{
+    char *pending;
+    LOS_TaskLock();
+    pending = CrashLog.pending;
+    *len = CrashLog.pendingLen;
+    CrashLog.pending = NULL;
+    CrashLog.pendingLen = 0;
+    LOS_TaskUnlock();
+    return pending;
+}
+
+/* 低内存回收: 尚未落盘的崩溃日志文本是日志模块唯一的堆缓存, 内存不足时丢弃 */
+static uint32_t CrashLogReclaim(uint32_t need)
+{
+    uint32_t len;
+    char *pending = CrashLogTakePending(&len);
+    (void)need;
+    if (pending == NULL) {
+        return 0;
+    }
+    free(pending);
+    printf("crash log dropped: low memory\r\n");
+    return CRASH_LOG_TEXT_MAX;
+}
+
+static const char *const CRASH_REASON_STR[] = { "none", "abort", "user" };
+
+static uint32_t CrashLogChecksum(const CrashLogHead *head)
+{
+    const uint8_t *p = (const uint8_t *)head;
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (uint32_t i = 0; i < sizeof(*head); i++) {
+        hash = (hash ^ p[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+static void CrashLogReset(void)
+{
+    (void)memset_s(&CrashLogRtc.head, sizeof(CrashLogRtc.head), 0, sizeof(CrashLogRtc.head));
+    CrashLogRtc.written = 0;
+    CrashLogRtc.checksum = CrashLogChecksum(&CrashLogRtc.head);
+    CrashLogRtc.magic = CRASH_LOG_MAGIC;
+}
+
+void CrashLogAppend(const char *data, uint32_t len)
+{
+    uint32_t pos;
+    uint32_t n;
+    if (!CrashLog.ready || (data == NULL)) {
+        return;
+    }
+    if (len > CRASH_LOG_SIZE) {
+        data += len - CRASH_LOG_SIZE;
+        len = CRASH_LOG_SIZE;
+    }
+    while (len > 0) {
+        pos = CrashLogRtc.written % CRASH_LOG_SIZE;
+        n = (len < CRASH_LOG_SIZE - pos) ? len : (CRASH_LOG_SIZE - pos);
+        (void)memcpy_s(&CrashLogRtc.buf[pos], CRASH_LOG_SIZE - pos, data, n);
+        CrashLogRtc.written += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static void CrashLogSnapshotTasks(CrashLogHead *head)
+{
+    TSK_INFO_S info;
+    CrashTaskInfo *t = NULL;
+    head->taskNum = 0;
+    for (UINT32 id = 0; (id < LOSCFG_BASE_CORE_TSK_LIMIT) && (head->taskNum < CRASH_LOG_TASK_MAX); id++) {
+        if (LOS_TaskInfoGet(id, &info) != LOS_OK) {
+            continue;
+        }
+        t = &head->task[head->taskNum++];
+        (void)strncpy_s(t->name, sizeof(t->name), info.acName, sizeof(t->name) - 1);
+        t->taskId = (uint16_t)info.uwTaskID;
+        t->status = info.usTaskStatus;
+        t->prio = info.usTaskPrio;
+        t->stackSize = info.uwStackSize;
+        t->stackPeak = info.uwPeakUsed;
+    }
+}
+
+void CrashLogCapture(CrashReason reason)
+{
+    CrashLogHead head = { 0 };
+    UINT32 intSave;
+    if (!CrashLog.ready) {
+        return;
+    }
+    head.reason = (uint32_t)reason;
+    head.timeMs = LOS_Tick2MS((UINT32)LOS_TickCountGet());
+    head.taskId = LOS_CurTaskIDGet();
+    CrashLogSnapshotTasks(&head);
+    intSave = LOS_IntLock();
+    CrashLogRtc.head = head;
+    CrashLogRtc.checksum = CrashLogChecksum(&CrashLogRtc.head);
+    LOS_IntRestore(intSave);
+    // 把尚在队列中的日志写出, 同时进入保留区
+    LogRingFlush();
+}
+
+static bool CrashLogAbnormalReset(esp_reset_reason_t rst)
+{
+    return (rst == ESP_RST_PANIC) || (rst == ESP_RST_INT_WDT) || (rst == ESP_RST_TASK_WDT) ||
+           (rst == ESP_RST_WDT) || (rst == ESP_RST_BROWNOUT);
+}
+
+static uint32_t CrashLogFormat(char *out, uint32_t size, esp_reset_reason_t rst)
+{
+    const CrashLogHead *head = &CrashLogRtc.head;
+    uint32_t reason = (head->reason < sizeof(CRASH_REASON_STR) / sizeof(CRASH_REASON_STR[0])) ? head->reason : 0;
+    uint32_t written = CrashLogRtc.written;
+    uint32_t start = (written > CRASH_LOG_SIZE) ? (written % CRASH_LOG_SIZE) : 0;
+    uint32_t logLen = (written > CRASH_LOG_SIZE) ? CRASH_LOG_SIZE : written;
+    uint32_t pos = 0;
+    int n;
+    n = snprintf_s(out, size, size - 1, "reason=%s reset=%d task=%u time=%ums\n", CRASH_REASON_STR[reason],
+                   (int)rst, head->taskId, head->timeMs);
+    pos += (n > 0) ? (uint32_t)n : 0;
+    for (uint32_t i = 0; (i < head->taskNum) && (i < CRASH_LOG_TASK_MAX); i++) {
+        const CrashTaskInfo *t = &head->task[i];
+        n = snprintf_s(out + pos, size - pos, size - pos - 1, "%-16.16s id=%u status=0x%x prio=%u stack=%u/%u\n",
+                       t->name, t->taskId, t->status, t->prio, t->stackPeak, t->stackSize);
+        pos += (n > 0) ? (uint32_t)n : 0;
+    }
+    n = snprintf_s(out + pos, size - pos, size - pos - 1, "---- last %u bytes of log ----\n", logLen);
+    pos += (n > 0) ? (uint32_t)n : 0;
+    if ((pos + logLen <= size) && (logLen > 0)) {
+        (void)memcpy_s(out + pos, size - pos, &CrashLogRtc.buf[start], logLen - start);
+        if (start > 0) {
+            (void)memcpy_s(out + pos + logLen - start, size - pos - (logLen - start), CrashLogRtc.buf, start);
+        }
+        pos += logLen;
+    }
+    return pos;
+}
+
+#ifdef LOSCFG_FS_LITTLEFS
+static void CrashLogPath(char *path, uint32_t size)
+{
+    (void)snprintf_s(path, size, size - 1, "%s/%s", GetLittlefsMountPoint(), CRASH_LOG_FILE);
+}
+
+// littlefs 在 SYS_FEATURE 阶段挂载, 之后把崩溃日志落盘
+static void CrashLogPersist(void)
+{
+    char path[CRASH_LOG_PATH_LEN];
+    uint32_t len;
+    int fd;
+    char *pending = CrashLogTakePending(&len);
+    if (pending == NULL) {
+        return;
+    }
+    CrashLogPath(path, sizeof(path));
+    fd = _open(path, O_CREAT | O_WRONLY | O_TRUNC, CRASH_LOG_FILE_MODE);
+    if (fd >= 0) {
+        if (_write(fd, pending, len) == (int)len) {
+            free(pending);
+            pending = NULL;
+        }
+        _close(fd);
+    }
+    if (pending != NULL) {
+        // 写入失败时放回, 仍可通过 CrashLogRead 读取
+        LOS_TaskLock();
+        CrashLog.pending = pending;
+        CrashLog.pendingLen = len;
+        LOS_TaskUnlock();
+    }
+}
+SYS_RUN(CrashLogPersist);
+#endif
+
+uint32_t CrashLogRead(char *buf, uint32_t size)
+{
+    uint32_t len = 0;
+    if ((buf == NULL) || (size == 0)) {
+        return 0;
+    }
+    LOS_TaskLock();
+    if (CrashLog.pending != NULL) {
+        len = (CrashLog.pendingLen < size) ? CrashLog.pendingLen : size;
+        (void)memcpy_s(buf, size, CrashLog.pending, len);
+        LOS_TaskUnlock();
+        return len;
+    }
+    LOS_TaskUnlock();
+#ifdef LOSCFG_FS_LITTLEFS
+    char path[CRASH_LOG_PATH_LEN];
+    CrashLogPath(path, sizeof(path));
+    int fd = _open(path, O_RDONLY);
+    if (fd >= 0) {
+        int n = _read(fd, buf, size);
+        len = (n > 0) ? (uint32_t)n : 0;
+        _close(fd);
+    }
+#endif
+    return len;
+}
+
+void CrashLogClear(void)
+{
+    uint32_t len;
+    free(CrashLogTakePending(&len));
+#ifdef LOSCFG_FS_LITTLEFS
+    char path[CRASH_LOG_PATH_LEN];
+    CrashLogPath(path, sizeof(path));
+    (void)_unlink(path);
+#endif
+}
+
+#if (LOSCFG_USE_SHELL == 1)
+static UINT32 CrashLogShellCmd(UINT32 argc, const CHAR **argv)
+{
+    if ((argc > 0) && (strcmp(argv[0], "clear") == 0)) {
+        CrashLogClear();
+        return LOS_OK;
+    }
+    char *buf = (char *)malloc(CRASH_LOG_TEXT_MAX);
+    if (buf == NULL) {
+        printf("crashlog: no memory\r\n");
+        return LOS_NOK;
+    }
+    uint32_t len = CrashLogRead(buf, CRASH_LOG_TEXT_MAX);
+    if (len == 0) {
+        printf("crashlog: empty\r\n");
+    }
+    // 按记录大小分段输出, 避免单条超出日志队列的槽位长度
+    for (uint32_t pos = 0; pos < len; pos += LOG_RING_SLOT_SIZE / 2) {
+        uint32_t n = ((len - pos) < (LOG_RING_SLOT_SIZE / 2)) ? (len - pos) : (LOG_RING_SLOT_SIZE / 2);
+        printf("%.*s", (int)n, buf + pos);
+    }
+    free(buf);
+    return LOS_OK;
+}
+#endif
+
+void CrashLogInit(void)
+{
+    esp_reset_reason_t rst = esp_reset_reason();
+    bool valid = (CrashLogRtc.magic == CRASH_LOG_MAGIC) &&
+                 (CrashLogRtc.checksum == CrashLogChecksum(&CrashLogRtc.head));
+    if (CrashLog.ready) {
+        return;
+    }
+    if (valid && ((CrashLogRtc.head.reason != CRASH_REASON_NONE) || CrashLogAbnormalReset(rst))) {
+        CrashLog.pending = (char *)malloc(CRASH_LOG_TEXT_MAX);
+        if (CrashLog.pending != NULL) {
+            CrashLog.pendingLen = CrashLogFormat(CrashLog.pending, CRASH_LOG_TEXT_MAX, rst);
+            printf("crash log from last boot: %u bytes\r\n", CrashLog.pendingLen);
+            (void)MemReclaimRegister(CrashLogReclaim);
+        }
+    }
+    CrashLogReset();
+    CrashLog.ready = 1;
+#if (LOSCFG_USE_SHELL == 1)
+    (void)osCmdReg(CMD_TYPE_EX, "crashlog", XARGS, (CmdCallBackFunc)CrashLogShellCmd);
+#endif
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __CRASH_LOG_H__
+#define __CRASH_LOG_H__
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 最近输出的日志同时写入 RTC 慢速内存中的环形区, 该区域在软件复位/看门狗/异常复位后保持.
+ * 启动时若上次为异常复位或调用过 CrashLogCapture, 则把日志与任务快照整理为文本,
+ * 保存到 littlefs 的 crash.log, 并可通过 CrashLogRead 读取.
+ */
+#define CRASH_LOG_SIZE 3072
+#define CRASH_LOG_TASK_MAX 16
+#define CRASH_LOG_FILE "crash.log"
+
+typedef enum {
+    CRASH_REASON_NONE = 0,
+    CRASH_REASON_ABORT,         // abort()/raise(SIGABRT)
+    CRASH_REASON_USER,
+} CrashReason;
+
+/**
+ * @brief 记录致命错误原因与当前任务快照, 并把日志队列同步写出, 在致命路径上调用
+ */
+void CrashLogCapture(CrashReason reason);
+
+/**
+ * @brief 追加已输出的日志文本, 由日志输出任务调用
+ */
+void CrashLogAppend(const char *data, uint32_t len);
+
+/**
+ * @brief 读取上次复位前保存的崩溃日志
+ *
+ * @return 实际读取的字节数, 没有崩溃日志时返回 0
+ */
+uint32_t CrashLogRead(char *buf, uint32_t size);
+
+/**
+ * @brief 删除已保存的崩溃日志
+ */
+void CrashLogClear(void);
+
+/**
+ * @brief 检查保留区, 整理上次的崩溃日志并重新开始记录, 在日志输出任务启动前调用
+ */
+void CrashLogInit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
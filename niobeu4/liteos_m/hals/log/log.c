@@ -27,12 +27,20 @@
 #include "hal/uart_ll.h"
 #include "hiview_def.h"
 #include "hiview_output_log.h"
+#include "crash_log.h"
+#include "log_level.h"
+#include "log_ring.h"
 
 #define NUM_2 2
 #define SAFE_OFFSET 4
 #define BUFF_MAX_LEN 512
+#define HILOG_LEVEL_BASE 8 // HiLog 级别 DEBUG(3)..ERROR(6) 对应 LOG_DEBUG_LEVEL(5)..LOG_ERR_LEVEL(2)
 
-static void s_vprintf(const char *fmt, va_list ap)
+LOG_MODULE_DEFINE(KernelLog, "kernel");
+LOG_MODULE_DEFINE(HiLog, "hilog");
+
+// 日志输出任务启动前的同步输出
+static void s_vprintf_sync(const char *fmt, va_list ap)
 {
     int len;
     static char buf[NUM_2][BUFF_MAX_LEN];
@@ -71,6 +79,13 @@ static void s_vprintf(const char *fmt, va_list ap)
     }
 }
 
+static void s_vprintf(const char *fmt, va_list ap)
+{
+    if (LogRingVprintf(fmt, ap) != 0) {
+        s_vprintf_sync(fmt, ap);
+    }
+}
+
 // Liteos_m的打印
 int printf(const char *__restrict __format, ...)
 {
@@ -83,7 +98,7 @@ int printf(const char *__restrict __format, ...)
 
 int hal_trace_printf(int level, const char *fmt, ...)
 {
-    if (level <= PRINT_LEVEL) {
+    if (LOG_ENABLED(KernelLog, level)) {
         va_list ap;
         va_start(ap, fmt);
         s_vprintf(fmt, ap);
@@ -95,6 +110,17 @@ int hal_trace_printf(int level, const char *fmt, ...)
 bool HilogProc_Impl(const HiLogContent *hilogContent, uint32_t len)
 {
     char tempOutStr[LOG_FMT_MAX_LEN];
+    const HiLogCommon *common = &hilogContent->commonContent;
+    uint8_t level = (common->level < HILOG_LEVEL_BASE) ? (HILOG_LEVEL_BASE - common->level) : LOG_EMG_LEVEL;
+    if (!LOG_ENABLED(HiLog, level)) {
+        return true;
+    }
+    // 二进制输出模式下跳过 LogContentFmt, 只记录格式串地址与参数
+    if ((LogRingGetOutputMode() == LOG_RING_OUTPUT_BINARY) &&
+        (LogRingWriteBinValues(common->fmt, common->level, common->module, hilogContent->values,
+                               common->valueNumber) == 0)) {
+        return true;
+    }
     tempOutStr[0] = 0, tempOutStr[1] = 0;
     if (LogContentFmt(tempOutStr, sizeof(tempOutStr), hilogContent) > 0) {
         printf("%s", tempOutStr);
@@ -107,7 +133,7 @@ int HiLogWriteInternal(const char *buffer, size_t bufLen)
     if (!buffer) {
         return -1;
     }
-    if (bufLen < NUM_2) {
+    if ((bufLen < NUM_2) || !LOG_ENABLED(HiLog, LOG_INFO_LEVEL)) {
         return 0;
     }
     if (buffer[bufLen - NUM_2] != '\n') {
@@ -121,5 +147,10 @@ int init_trace_system(void)
 {
     int ret = 1;
     HiviewRegisterHilogProc(HilogProc_Impl);
+    LogLevelInit();
+    CrashLogInit();
+    if (LogRingInit() != 0) {
+        printf("log ring init failed, using synchronous output\n");
+    }
     return ret;
 }
@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdbool.h>
+#include <string.h>
+#include "securec.h"
+#include "log_bin.h"
+
+// 本文件不依赖内核, 可直接在主机上编译验证编解码
+
+#define LOG_BIN_SPEC_MAX 48
+#define LOG_BIN_INT_LEN 4
+#define LOG_BIN_WIDE_LEN 8
+
+typedef enum {
+    LOG_ARG_NONE,
+    LOG_ARG_INT,
+    LOG_ARG_LONG_LONG,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_PTR,
+    LOG_ARG_STR,
+} LogArgType;
+
+typedef struct {
+    const char *start;      // '%'
+    const char *flags;      // 跳过 {public}/{private} 后的标志/宽度/精度
+    const char *length;     // 长度修饰符
+    const char *end;        // 转换字符之后
+    char conv;
+    uint8_t stars;          // '*' 宽度/精度个数, 各占一个 int 参数
+    LogArgType type;
+} LogBinSpec_t;
+
+typedef struct {
+    uint8_t *out;
+    uint32_t size;
+    uint32_t pos;
+} LogBinWriter_t;
+
+typedef struct {
+    va_list *ap;
+    const uint32_t *values;
+    uint32_t count;
+    uint32_t index;
+} LogBinArgs_t;
+
+static const char *LogBinSkipTag(const char *p)
+{
+    static const char *const tags[] = { "{public}", "{private}" };
+    uint32_t i;
+    for (i = 0; i < sizeof(tags) / sizeof(tags[0]); i++) {
+        if (strncmp(p, tags[i], strlen(tags[i])) == 0) {
+            return p + strlen(tags[i]);
+        }
+    }
+    return p;
+}
+
+static LogArgType LogBinArgType(char conv, uint32_t longs)
+{
+    switch (conv) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            return (longs >= 2) ? LOG_ARG_LONG_LONG : LOG_ARG_INT; // 2: ll/j 为 64 位
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            return LOG_ARG_DOUBLE;
+        case 'p':
+            return LOG_ARG_PTR;
+        case 's':
+            return LOG_ARG_STR;
+        default:
+            return LOG_ARG_NONE;
+    }
+}
+
+// 查找 p 之后的下一个转换说明, 没有时返回 false
+static bool LogBinNextSpec(const char *p, LogBinSpec_t *spec)
+{
+    const char *q = NULL;
+    uint32_t longs = 0;
+    p = strchr(p, '%');
+    if (p == NULL) {
+        return false;
+    }
+    spec->start = p;
+    spec->stars = 0;
+    q = LogBinSkipTag(p + 1);
+    spec->flags = q;
+    while ((*q != '\0') && (strchr("-+ #0", *q) != NULL)) {
+        q++;
+    }
+    while (((*q >= '0') && (*q <= '9')) || (*q == '.') || (*q == '*')) {
+        spec->stars += (*q == '*') ? 1 : 0;
+        q++;
+    }
+    spec->length = q;
+    while ((*q != '\0') && (strchr("hljztL", *q) != NULL)) {
+        longs += (*q == 'l') ? 1 : ((*q == 'j') ? 2 : 0); // 2: intmax_t 按 64 位处理
+        q++;
+    }
+    spec->conv = *q;
+    spec->type = LogBinArgType(*q, longs);
+    spec->end = (*q != '\0') ? (q + 1) : q;
+    return true;
+}
+
+static bool LogBinPut(LogBinWriter_t *w, const void *data, uint32_t len)
+{
+    if ((w->pos + len > w->size) || (memcpy_s(w->out + w->pos, w->size - w->pos, data, len) != EOK)) {
+        return false;
+    }
+    w->pos += len;
+    return true;
+}
+
+static bool LogBinPutStr(LogBinWriter_t *w, const char *s)
+{
+    uint8_t len;
+    if (s == NULL) {
+        s = "(null)";
+    }
+    len = (uint8_t)strnlen(s, LOG_BIN_STR_MAX);
+    if (w->pos + 1 + len > w->size) {
+        return false;
+    }
+    return LogBinPut(w, &len, 1) && LogBinPut(w, s, len);
+}
+
+// 64 位整数与浮点数占两个 32 位值, 低位在前, 浮点数按原始位模式拷贝
+static bool LogBinPutValue(LogBinWriter_t *w, LogArgType type, LogBinArgs_t *args)
+{
+    uint32_t v32;
+    if (args->index >= args->count) {
+        return false;
+    }
+    if ((type == LOG_ARG_LONG_LONG) || (type == LOG_ARG_DOUBLE)) {
+        if (args->count - args->index < 2) { // 2: 64 位参数的值个数
+            return false;
+        }
+        args->index += 2;                    // 2: 64 位参数的值个数
+        return LogBinPut(w, &args->values[args->index - 2], LOG_BIN_WIDE_LEN);
+    }
+    v32 = args->values[args->index++];
+    if (type == LOG_ARG_STR) {
+        return LogBinPutStr(w, (const char *)(uintptr_t)v32);
+    }
+    return LogBinPut(w, &v32, LOG_BIN_INT_LEN);
+}
+
+static bool LogBinPutVaArg(LogBinWriter_t *w, LogArgType type, va_list *ap)
+{
+    uint32_t v32;
+    uint64_t v64;
+    double d;
+    switch (type) {
+        case LOG_ARG_LONG_LONG:
+            v64 = (uint64_t)va_arg(*ap, long long);
+            return LogBinPut(w, &v64, LOG_BIN_WIDE_LEN);
+        case LOG_ARG_DOUBLE:
+            d = va_arg(*ap, double);
+            return LogBinPut(w, &d, LOG_BIN_WIDE_LEN);
+        case LOG_ARG_PTR:
+            v32 = (uint32_t)(uintptr_t)va_arg(*ap, void *);
+            return LogBinPut(w, &v32, LOG_BIN_INT_LEN);
+        case LOG_ARG_STR:
+            return LogBinPutStr(w, va_arg(*ap, const char *));
+        default:
+            v32 = (uint32_t)va_arg(*ap, int);
+            return LogBinPut(w, &v32, LOG_BIN_INT_LEN);
+    }
+}
+
+static bool LogBinPutArg(LogBinWriter_t *w, LogArgType type, LogBinArgs_t *args)
+{
+    return (args->ap != NULL) ? LogBinPutVaArg(w, type, args->ap) : LogBinPutValue(w, type, args);
+}
+
+static uint32_t LogBinEncodeArgs(uint8_t *out, uint32_t size, const char *fmt, uint8_t level, uint8_t module,
+                                 LogBinArgs_t *args)
+{
+    LogBinWriter_t w = { out, size, 0 };
+    LogBinSpec_t spec;
+    uint32_t addr = (uint32_t)(uintptr_t)fmt;
+    uint8_t hdr[LOG_BIN_HDR_LEN] = { 0 };
+    uint32_t last;
+    uint8_t i;
+    bool ok = true;
+    if ((fmt == NULL) || (memcpy_s(hdr, sizeof(hdr), &addr, sizeof(addr)) != EOK)) {
+        return 0;
+    }
+    hdr[4] = level;     // 4: level 偏移
+    hdr[5] = module;    // 5: module 偏移
+    if (!LogBinPut(&w, hdr, sizeof(hdr))) {
+        return 0;
+    }
+    while (LogBinNextSpec(fmt, &spec)) {
+        fmt = spec.end;
+        if (spec.type == LOG_ARG_NONE) {
+            continue;
+        }
+        last = w.pos;
+        // '*' 宽度/精度按出现顺序编码在参数之前
+        for (i = 0; ok && (i < spec.stars); i++) {
+            ok = LogBinPutArg(&w, LOG_ARG_INT, args);
+        }
+        if (!ok || !LogBinPutArg(&w, spec.type, args)) {
+            w.pos = last;
+            break;
+        }
+    }
+    return w.pos;
+}
+
+uint32_t LogBinEncode(uint8_t *out, uint32_t size, const char *fmt, uint8_t level, uint8_t module, va_list ap)
+{
+    va_list copy;
+    uint32_t len;
+    LogBinArgs_t args = { 0 };
+    va_copy(copy, ap);
+    args.ap = &copy;
+    len = LogBinEncodeArgs(out, size, fmt, level, module, &args);
+    va_end(copy);
+    return len;
+}
+
+uint32_t LogBinEncodeValues(uint8_t *out, uint32_t size, const char *fmt, uint8_t level, uint8_t module,
+                            const uint32_t *values, uint32_t count)
+{
+    LogBinArgs_t args = { NULL, values, count, 0 };
+    return LogBinEncodeArgs(out, size, fmt, level, module, &args);
+}
+
+static uint32_t LogBinCopy(char *out, uint32_t room, const char *src, uint32_t len)
+{
+    if (room <= 1) {
+        return 0;
+    }
+    if (len > room - 1) {
+        len = room - 1;
+    }
+    if ((len > 0) && (memcpy_s(out, room, src, len) != EOK)) {
+        return 0;
+    }
+    return len;
+}
+
+// 复制标志/宽度/精度, '*' 替换为记录中的值: 负宽度即左对齐, 负精度等同未指定
+static bool LogBinExpandFlags(char *one, uint32_t size, uint32_t *n, const LogBinSpec_t *spec, const uint8_t **arg)
+{
+    const char *p = spec->flags;
+    int32_t v = 0;
+    int len;
+    for (; p < spec->length; p++) {
+        if (*p != '*') {
+            if (*n + 1 >= size) {
+                return false;
+            }
+            one[(*n)++] = *p;
+            continue;
+        }
+        (void)memcpy_s(&v, sizeof(v), *arg, LOG_BIN_INT_LEN);
+        *arg += LOG_BIN_INT_LEN;
+        if ((v < 0) && (one[*n - 1] == '.')) {
+            (*n)--;
+            continue;
+        }
+        len = snprintf_s(one + *n, size - *n, size - *n - 1, "%s%u", (v < 0) ? "-" : "",
+                         (v < 0) ? (0U - (uint32_t)v) : (uint32_t)v);
+        if (len < 0) {
+            return false;
+        }
+        *n += (uint32_t)len;
+    }
+    return true;
+}
+
+// 按单个转换说明格式化一个参数, 长度修饰符按编码宽度重写, 使设备与主机结果一致
+static int LogBinFormatOne(char *out, uint32_t room, const LogBinSpec_t *spec, const uint8_t *arg, uint32_t *used)
+{
+    char one[LOG_BIN_SPEC_MAX];
+    char str[LOG_BIN_STR_MAX + 1];
+    uint32_t v32 = 0;
+    uint64_t v64 = 0;
+    double d = 0;
+    uint32_t n = 0;
+    one[n++] = '%';
+    if (!LogBinExpandFlags(one, sizeof(one), &n, spec, &arg) || (n + sizeof("llX") > sizeof(one))) {
+        return -1;
+    }
+    *used = spec->stars * LOG_BIN_INT_LEN;
+    if (spec->type == LOG_ARG_LONG_LONG) {
+        one[n++] = 'l';
+        one[n++] = 'l';
+    }
+    one[n++] = spec->conv;
+    one[n] = '\0';
+    switch (spec->type) {
+        case LOG_ARG_LONG_LONG:
+            (void)memcpy_s(&v64, sizeof(v64), arg, LOG_BIN_WIDE_LEN);
+            *used += LOG_BIN_WIDE_LEN;
+            return snprintf_s(out, room, room - 1, one, (unsigned long long)v64);
+        case LOG_ARG_DOUBLE:
+            (void)memcpy_s(&d, sizeof(d), arg, LOG_BIN_WIDE_LEN);
+            *used += LOG_BIN_WIDE_LEN;
+            return snprintf_s(out, room, room - 1, one, d);
+        case LOG_ARG_STR:
+            *used += 1U + arg[0];
+            (void)memcpy_s(str, sizeof(str), arg + 1, arg[0]);
+            str[arg[0]] = '\0';
+            return snprintf_s(out, room, room - 1, one, str);
+        case LOG_ARG_PTR:
+            (void)memcpy_s(&v32, sizeof(v32), arg, LOG_BIN_INT_LEN);
+            *used += LOG_BIN_INT_LEN;
+            return snprintf_s(out, room, room - 1, one, (void *)(uintptr_t)v32);
+        default:
+            (void)memcpy_s(&v32, sizeof(v32), arg, LOG_BIN_INT_LEN);
+            *used += LOG_BIN_INT_LEN;
+            return snprintf_s(out, room, room - 1, one, v32);
+    }
+}
+
+// 参数 (含之前的 '*' 值) 的编码长度, 字符串长度字节超出 argsLen 时返回 0
+static uint32_t LogBinArgLen(const LogBinSpec_t *spec, const uint8_t *arg, uint32_t argsLen)
+{
+    uint32_t len = spec->stars * LOG_BIN_INT_LEN;
+    if (spec->type == LOG_ARG_STR) {
+        return (len < argsLen) ? (len + 1U + arg[len]) : 0;
+    }
+    return len + (((spec->type == LOG_ARG_LONG_LONG) || (spec->type == LOG_ARG_DOUBLE)) ?
+        LOG_BIN_WIDE_LEN : LOG_BIN_INT_LEN);
+}
+
+uint32_t LogBinFormat(char *out, uint32_t size, const char *fmt, const uint8_t *args, uint32_t argsLen)
+{
+    LogBinSpec_t spec;
+    uint32_t pos = 0;
+    uint32_t rd = 0;
+    uint32_t used = 0;
+    uint32_t len;
+    int n;
+    if ((out == NULL) || (size == 0) || (fmt == NULL)) {
+        return 0;
+    }
+    while ((pos + 1 < size) && LogBinNextSpec(fmt, &spec)) {
+        pos += LogBinCopy(out + pos, size - pos, fmt, (uint32_t)(spec.start - fmt));
+        fmt = spec.end;
+        if (spec.type == LOG_ARG_NONE) {
+            if (spec.conv == '%') {
+                pos += LogBinCopy(out + pos, size - pos, "%", 1);
+            } else {
+                pos += LogBinCopy(out + pos, size - pos, spec.start, (uint32_t)(spec.end - spec.start));
+            }
+            continue;
+        }
+        len = (rd < argsLen) ? LogBinArgLen(&spec, args + rd, argsLen - rd) : 0;
+        if ((len == 0) || (len > argsLen - rd)) {
+            fmt = spec.start;   // 参数被截断, 余下部分按原文输出
+            break;
+        }
+        n = LogBinFormatOne(out + pos, size - pos, &spec, args + rd, &used);
+        if (n < 0) {
+            pos = (uint32_t)strnlen(out, size - 1);
+            break;
+        }
+        pos += (uint32_t)n;
+        rd += used;
+    }
+    pos += LogBinCopy(out + pos, size - pos, fmt, (uint32_t)strlen(fmt));
+    out[pos] = '\0';
+    return pos;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __LOG_BIN_H__
+#define __LOG_BIN_H__
+#include <stdarg.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 二进制日志记录只保存格式串地址与原始参数, 格式化推迟到输出任务或主机端 (log_decode.py).
+ * 记录: fmt(4) level(1) module(1) rsv(2) 参数...
+ * 参数按格式串中的转换说明依次编码, 小端:
+ *   整数/字符/指针 4 字节; %ll/%j 与浮点数 8 字节; %s 为 1 字节长度加不含结尾 0 的内容.
+ *   '*' 宽度/精度各为 4 字节整数, 位于所修饰的参数之前.
+ * 串口帧 (仅二进制输出模式): A5 5A len(2) timeMs(4) 记录 sum(1), sum 为 len 到记录末尾的字节和.
+ */
+#define LOG_BIN_MAGIC0 0xA5
+#define LOG_BIN_MAGIC1 0x5A
+#define LOG_BIN_HDR_LEN 8
+#define LOG_BIN_FRAME_HDR_LEN 8
+#define LOG_BIN_STR_MAX 32
+#define LOG_BIN_MODULE_NONE 0xFF
+#define LOG_BIN_LEVEL_NONE 0xFF
+
+/**
+ * @brief 按格式串从 va_list 取参数并编码为二进制记录
+ *
+ * @return 记录长度, 空间不足时参数被截断到最后一个完整参数
+ */
+uint32_t LogBinEncode(uint8_t *out, uint32_t size, const char *fmt, uint8_t level, uint8_t module, va_list ap);
+
+/**
+ * @brief 同 LogBinEncode, 参数来自 32 位数组 (HiLog 记录), %s 对应的值视为字符串指针,
+ *        %ll/%j 与浮点数各占两个值, 低 32 位在前
+ */
+uint32_t LogBinEncodeValues(uint8_t *out, uint32_t size, const char *fmt, uint8_t level, uint8_t module,
+                            const uint32_t *values, uint32_t count);
+
+/**
+ * @brief 按格式串把记录中的参数部分格式化为文本
+ *
+ * @param fmt 格式串, 设备上即记录头中的地址
+ * @param args 记录中 LOG_BIN_HDR_LEN 之后的参数
+ * @return 文本长度
+ */
+uint32_t LogBinFormat(char *out, uint32_t size, const char *fmt, const uint8_t *args, uint32_t argsLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
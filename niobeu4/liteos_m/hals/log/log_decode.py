@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Decode binary log frames (log_bin.h) captured from UART0.
+
+Usage: log_decode.py --elf OHOS_Image.elf [capture.bin]
+Text outside frames is passed through unchanged. Without a capture file the
+stream is read from stdin, e.g. a serial port dumped with `cat /dev/ttyUSB0`.
+"""
+
+import argparse
+import codecs
+import re
+import struct
+import sys
+
+MAGIC = b'\xa5\x5a'
+FRAME_HDR_LEN = 8
+REC_HDR_LEN = 8
+LEVEL_NONE = 0xFF
+MODULE_NONE = 0xFF
+HILOG_LEVELS = {3: 'D', 4: 'I', 5: 'W', 6: 'E', 7: 'F'}
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+SPEC_RE = re.compile(r'%(?:\{(?:public|private)\})?([-+ #0]*[0-9.*]*)([hljztL]*)(.|$)')
+INT_CONVS = 'diuxXoc'
+FLOAT_CONVS = 'fFeEgGaA'
+
+
+class ElfStrings:
+    """Reads NUL terminated strings by load address from an ELF32 image."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF' or self.data[4] != 1:
+            raise ValueError('%s is not an ELF32 file' % path)
+        endian = '<' if self.data[5] == 1 else '>'
+        shoff, = struct.unpack_from(endian + 'I', self.data, 0x20)
+        shentsize, shnum = struct.unpack_from(endian + 'HH', self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            fields = struct.unpack_from(endian + 'IIIIIIIIII', self.data, shoff + i * shentsize)
+            sh_type, sh_flags, sh_addr, sh_offset, sh_size = fields[1:6]
+            if (sh_flags & SHF_ALLOC) and sh_type != SHT_NOBITS and sh_size:
+                self.sections.append((sh_addr, sh_size, sh_offset))
+
+    def string(self, addr):
+        for sh_addr, sh_size, sh_offset in self.sections:
+            if sh_addr <= addr < sh_addr + sh_size:
+                start = sh_offset + addr - sh_addr
+                end = self.data.find(b'\0', start, sh_offset + sh_size)
+                return self.data[start:end if end >= 0 else sh_offset + sh_size].decode('utf-8', 'replace')
+        return None
+
+
+def expand_flags(flags, widths):
+    """Substitute '*' widths/precisions; a negative precision counts as omitted."""
+    out = ''
+    for ch in flags:
+        if ch != '*':
+            out += ch
+            continue
+        value = widths.pop(0)
+        if value < 0 and out.endswith('.'):
+            out = out[:-1]
+        else:
+            out += str(value)
+    return out
+
+
+def value_size(conv, length, args, rd):
+    """Encoded size of the value at args[rd:], None when the record ends first."""
+    if conv in INT_CONVS:
+        return 8 if length.count('l') + 2 * length.count('j') >= 2 else 4
+    if conv in FLOAT_CONVS:
+        return 8
+    if conv == 'p':
+        return 4
+    return 1 + args[rd] if rd < len(args) else None
+
+
+def format_record(fmt, args):
+    """Mirror of LogBinFormat in log_bin.c."""
+    out = []
+    pos = 0
+    rd = 0
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, length, conv = m.group(1), m.group(2), m.group(3)
+        if conv == '%':
+            out.append('%')
+            continue
+        if not conv or conv not in INT_CONVS + FLOAT_CONVS + 'ps':
+            out.append(m.group(0))
+            continue
+        stars = flags.count('*')
+        size = value_size(conv, length, args, rd + 4 * stars)
+        if size is None or rd + 4 * stars + size > len(args):
+            pos = m.start()
+            break
+        widths = list(struct.unpack_from('<%di' % stars, args, rd))
+        flags = expand_flags(flags, widths)
+        rd += 4 * stars
+        if conv in INT_CONVS:
+            value, = struct.unpack_from('<q' if size == 8 else '<i', args, rd)
+            if conv not in 'di':
+                value &= (1 << (size * 8)) - 1
+            if conv == 'c':
+                out.append(('%' + flags + 'c') % chr(value & 0xFF))
+            else:
+                out.append(('%' + flags + ('d' if conv in 'iu' else conv)) % value)
+        elif conv in FLOAT_CONVS:
+            value, = struct.unpack_from('<d', args, rd)
+            out.append(('%' + flags + ('f' if conv in 'aA' else conv)) % value)
+        elif conv == 'p':
+            value, = struct.unpack_from('<I', args, rd)
+            out.append('0x%x' % value)
+        else:
+            text = args[rd + 1:rd + size].decode('utf-8', 'replace')
+            out.append(('%' + flags + 's') % text)
+        rd += size
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+def decode_frame(strings, time_ms, record):
+    if len(record) < REC_HDR_LEN:
+        return '<short record>\n'
+    addr, level, module = struct.unpack_from('<IBB', record, 0)
+    fmt = strings.string(addr)
+    if fmt is None:
+        return '<unknown format 0x%08x>\n' % addr
+    text = format_record(fmt, record[REC_HDR_LEN:])
+    if level == LEVEL_NONE and module == MODULE_NONE:
+        return text
+    prefix = '%u.%03u %s/%u: ' % (time_ms // 1000, time_ms % 1000, HILOG_LEVELS.get(level, '?'), module)
+    return prefix + text + ('' if text.endswith('\n') else '\n')
+
+
+class StreamDecoder:
+    """Splits a UART byte stream into text and frames as it arrives in arbitrary chunks.
+
+    Text goes through an incremental UTF-8 decoder so a character split across
+    two reads is not replaced, and a frame still being received stays pending.
+    """
+
+    def __init__(self, strings, write):
+        self.strings = strings
+        self.write = write
+        self.text = codecs.getincrementaldecoder('utf-8')('replace')
+        self.pending = b''
+
+    def feed(self, chunk, final=False):
+        data = self.pending + chunk
+        pos = 0
+        while True:
+            start = data.find(MAGIC, pos)
+            if start < 0:
+                # 末尾单独的 MAGIC[0] 可能是下一个帧头的开始
+                end = len(data) - 1 if not final and data[pos:].endswith(MAGIC[:1]) else len(data)
+                self.write(self.text.decode(data[pos:end], final))
+                self.pending = data[end:]
+                return
+            self.write(self.text.decode(data[pos:start]))
+            if start + FRAME_HDR_LEN > len(data):
+                break
+            length, time_ms = struct.unpack_from('<HI', data, start + 2)
+            end = start + FRAME_HDR_LEN + length + 1
+            if end > len(data):
+                break
+            if sum(data[start + 2:end - 1]) & 0xFF != data[end - 1]:
+                self.write(self.text.decode(data[start:start + 1]))
+                pos = start + 1
+                continue
+            # 帧打断的不完整字符不会再补齐
+            self.write(self.text.decode(b'', True))
+            self.write(decode_frame(self.strings, time_ms, data[start + FRAME_HDR_LEN:end - 1]))
+            pos = end
+        if final:
+            self.write(self.text.decode(data[start:], True))
+            self.pending = b''
+        else:
+            self.pending = data[start:]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--elf', required=True, help='image the device is running')
+    parser.add_argument('capture', nargs='?', help='raw UART capture, stdin if omitted')
+    args = parser.parse_args()
+    strings = ElfStrings(args.elf)
+    stream = open(args.capture, 'rb') if args.capture else sys.stdin.buffer
+    decoder = StreamDecoder(strings, sys.stdout.write)
+    with stream:
+        while True:
+            chunk = stream.read1(4096) if hasattr(stream, 'read1') else stream.read(4096)
+            if not chunk:
+                break
+            decoder.feed(chunk)
+            sys.stdout.flush()
+        decoder.feed(b'', True)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "securec.h"
+#include "los_interrupt.h"
+#include "nvs.h"
+#if (LOSCFG_USE_SHELL == 1)
+#include "shcmd.h"
+#endif
+#include "log_level.h"
+
+#define LOG_NVS_NAMESPACE "log"
+#define LOG_NVS_KEY "levels"
+#define LOG_LEVEL_VERSION 1
+#define LOG_TAG_ALL "*"
+
+typedef struct {
+    char tag[LOG_TAG_MAX_LEN];
+    uint8_t level;
+} LogLevelEntry;
+
+// 保存到 NVS 的内容
+typedef struct {
+    uint8_t version;
+    uint8_t defaultLevel;
+    uint8_t entryNum;
+    uint8_t reserved;
+    LogLevelEntry entry[LOG_LEVEL_OVERRIDE_MAX];
+} LogLevelSaved;
+
+typedef struct {
+    LogModule *modules;
+    LogLevelSaved saved;
+} LogLevelTable_t;
+
+static LogLevelTable_t LogLevelTable = {
+    .modules = NULL,
+    .saved = { .version = LOG_LEVEL_VERSION, .defaultLevel = LOG_LEVEL_DEFAULT },
+};
+
+static LogLevelEntry *LogLevelFind(const char *tag)
+{
+    for (uint8_t i = 0; i < LogLevelTable.saved.entryNum; i++) {
+        if (strncmp(LogLevelTable.saved.entry[i].tag, tag, LOG_TAG_MAX_LEN) == 0) {
+            return &LogLevelTable.saved.entry[i];
+        }
+    }
+    return NULL;
+}
+
+// 调用者持有中断锁
+static uint8_t LogLevelResolve(const char *tag)
+{
+    LogLevelEntry *entry = LogLevelFind(tag);
+    return (entry != NULL) ? entry->level : LogLevelTable.saved.defaultLevel;
+}
+
+void LogModuleRegister(LogModule *module)
+{
+    UINT32 intSave = LOS_IntLock();
+    if (!module->registered) {
+        module->level = LogLevelResolve(module->tag);
+        module->next = LogLevelTable.modules;
+        LogLevelTable.modules = module;
+        module->registered = 1;
+    }
+    LOS_IntRestore(intSave);
+}
+
+static void LogLevelApply(void)
+{
+    for (LogModule *m = LogLevelTable.modules; m != NULL; m = m->next) {
+        m->level = LogLevelResolve(m->tag);
+    }
+}
+
+static void LogLevelSave(const LogLevelSaved *saved)
+{
+    nvs_handle_t handle;
+    if (nvs_open(LOG_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_set_blob(handle, LOG_NVS_KEY, saved, sizeof(*saved)) == ESP_OK) {
+        (void)nvs_commit(handle);
+    }
+    nvs_close(handle);
+}
+
+int LogLevelSet(const char *tag, uint8_t level, bool persist)
+{
+    LogLevelSaved snapshot;
+    LogLevelEntry *entry = NULL;
+    UINT32 intSave;
+    if ((tag == NULL) || (level > LOG_DEBUG_LEVEL) || (strlen(tag) >= LOG_TAG_MAX_LEN)) {
+        return -1;
+    }
+    intSave = LOS_IntLock();
+    if (strcmp(tag, LOG_TAG_ALL) == 0) {
+        // 全局设置覆盖所有单独设置
+        LogLevelTable.saved.defaultLevel = level;
+        LogLevelTable.saved.entryNum = 0;
+    } else {
+        entry = LogLevelFind(tag);
+        if (entry == NULL) {
+            if (LogLevelTable.saved.entryNum >= LOG_LEVEL_OVERRIDE_MAX) {
+                LOS_IntRestore(intSave);
+                return -1;
+            }
+            entry = &LogLevelTable.saved.entry[LogLevelTable.saved.entryNum++];
+            (void)strcpy_s(entry->tag, sizeof(entry->tag), tag);
+        }
+        entry->level = level;
+    }
+    LogLevelApply();
+    snapshot = LogLevelTable.saved;
+    LOS_IntRestore(intSave);
+    if (persist) {
+        LogLevelSave(&snapshot);
+    }
+    return 0;
+}
+
+uint8_t LogLevelGet(const char *tag)
+{
+    uint8_t level;
+    UINT32 intSave = LOS_IntLock();
+    level = ((tag == NULL) || (strcmp(tag, LOG_TAG_ALL) == 0)) ? LogLevelTable.saved.defaultLevel
+                                                              : LogLevelResolve(tag);
+    LOS_IntRestore(intSave);
+    return level;
+}
+
+static void LogLevelLoad(void)
+{
+    LogLevelSaved saved;
+    size_t size = sizeof(saved);
+    nvs_handle_t handle;
+    UINT32 intSave;
+    if (nvs_open(LOG_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    if ((nvs_get_blob(handle, LOG_NVS_KEY, &saved, &size) != ESP_OK) || (size != sizeof(saved)) ||
+        (saved.version != LOG_LEVEL_VERSION) || (saved.defaultLevel > LOG_DEBUG_LEVEL) ||
+        (saved.entryNum > LOG_LEVEL_OVERRIDE_MAX)) {
+        nvs_close(handle);
+        return;
+    }
+    nvs_close(handle);
+    for (uint8_t i = 0; i < saved.entryNum; i++) {
+        saved.entry[i].tag[LOG_TAG_MAX_LEN - 1] = '\0';
+        if (saved.entry[i].level > LOG_DEBUG_LEVEL) {
+            saved.entry[i].level = saved.defaultLevel;
+        }
+    }
+    intSave = LOS_IntLock();
+    LogLevelTable.saved = saved;
+    LogLevelApply();
+    LOS_IntRestore(intSave);
+}
+
+#if (LOSCFG_USE_SHELL == 1)
+static void LogLevelShow(void)
+{
+    LogLevelSaved saved;
+    LogModule *m = NULL;
+    UINT32 intSave = LOS_IntLock();
+    saved = LogLevelTable.saved;
+    LOS_IntRestore(intSave);
+    printf("%-12s %u\r\n", LOG_TAG_ALL, saved.defaultLevel);
+    for (m = LogLevelTable.modules; m != NULL; m = m->next) {
+        printf("%-12s %u\r\n", m->tag, m->level);
+    }
+    // 已设置但尚未有模块注册的标签
+    for (uint8_t i = 0; i < saved.entryNum; i++) {
+        for (m = LogLevelTable.modules; m != NULL; m = m->next) {
+            if (strncmp(m->tag, saved.entry[i].tag, LOG_TAG_MAX_LEN) == 0) {
+                break;
+            }
+        }
+        if (m == NULL) {
+            printf("%-12s %u (unused)\r\n", saved.entry[i].tag, saved.entry[i].level);
+        }
+    }
+}
+
+static UINT32 LogLevelShellCmd(UINT32 argc, const CHAR **argv)
+{
+    char *end = NULL;
+    unsigned long level;
+    if (argc == 0) {
+        LogLevelShow();
+        return LOS_OK;
+    }
+    if (argc == 2) { // 2: loglevel <tag|*> <level>
+        level = strtoul(argv[1], &end, 0);
+        if ((end != argv[1]) && (*end == '\0') && (level <= LOG_DEBUG_LEVEL) &&
+            (LogLevelSet(argv[0], (uint8_t)level, true) == 0)) {
+            return LOS_OK;
+        }
+    }
+    printf("usage: loglevel [<tag>|* <%u-%u>]\r\n", LOG_EMG_LEVEL, LOG_DEBUG_LEVEL);
+    return LOS_NOK;
+}
+#endif
+
+void LogLevelInit(void)
+{
+    static uint8_t inited = 0;
+    if (inited) {
+        return;
+    }
+    inited = 1;
+    LogLevelLoad();
+#if (LOSCFG_USE_SHELL == 1)
+    (void)osCmdReg(CMD_TYPE_EX, "loglevel", XARGS, (CmdCallBackFunc)LogLevelShellCmd);
+#endif
+}
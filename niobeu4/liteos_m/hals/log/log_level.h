@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __LOG_LEVEL_H__
+#define __LOG_LEVEL_H__
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "los_debug.h"
+#include "log_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 运行时按模块过滤日志. 级别沿用 los_debug.h 的 LOG_EMG_LEVEL..LOG_DEBUG_LEVEL, 数值越大越详细.
+ * 判断在宏展开处完成, 级别不满足时既不求值参数也不格式化.
+ * 级别可在 shell 中用 loglevel 命令调整并保存到 NVS, 启动后由 LogLevelInit 恢复.
+ * 未单独设置的模块使用全局默认级别, 初始为编译期的 PRINT_LEVEL.
+ * HAL_LOG 的格式串须为字面量, 二进制输出模式下只记录其地址 (见 log_bin.h).
+ */
+#define LOG_TAG_MAX_LEN 12
+#define LOG_LEVEL_OVERRIDE_MAX 16
+#define LOG_LEVEL_DEFAULT PRINT_LEVEL
+
+typedef struct LogModule {
+    const char *tag;
+    volatile uint8_t level;
+    uint8_t registered;
+    struct LogModule *next;
+} LogModule;
+
+#define LOG_MODULE_DEFINE(name, tagStr) \
+    static LogModule name = { .tag = (tagStr), .level = LOG_LEVEL_DEFAULT, .registered = 0, .next = NULL }
+
+void LogModuleRegister(LogModule *module);
+
+static inline uint8_t LogModuleLevel(LogModule *module)
+{
+    if (!module->registered) {
+        LogModuleRegister(module);
+    }
+    return module->level;
+}
+
+#define LOG_ENABLED(module, lvl) ((lvl) <= LogModuleLevel(&(module)))
+
+#define HAL_LOG(module, lvl, fmt, ...)                \
+    do {                                              \
+        if (LOG_ENABLED(module, lvl)) {               \
+            LogBinPrintf(fmt, ##__VA_ARGS__);         \
+        }                                             \
+    } while (0)
+
+#define HAL_LOGE(module, fmt, ...) HAL_LOG(module, LOG_ERR_LEVEL, fmt, ##__VA_ARGS__)
+#define HAL_LOGW(module, fmt, ...) HAL_LOG(module, LOG_WARN_LEVEL, fmt, ##__VA_ARGS__)
+#define HAL_LOGI(module, fmt, ...) HAL_LOG(module, LOG_INFO_LEVEL, fmt, ##__VA_ARGS__)
+#define HAL_LOGD(module, fmt, ...) HAL_LOG(module, LOG_DEBUG_LEVEL, fmt, ##__VA_ARGS__)
+
+/**
+ * @brief 设置模块级别, tag 为 "*" 时设置全部模块及之后注册模块的默认级别
+ *
+ * @param persist 是否保存到 NVS
+ * @return 0 成功, -1 参数非法或表已满
+ */
+int LogLevelSet(const char *tag, uint8_t level, bool persist);
+
+/**
+ * @brief 查询模块级别, 模块未注册时返回其生效的默认级别
+ */
+uint8_t LogLevelGet(const char *tag);
+
+/**
+ * @brief 从 NVS 读取保存的级别并注册 loglevel 命令, 在 NVS 初始化之后调用
+ */
+void LogLevelInit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
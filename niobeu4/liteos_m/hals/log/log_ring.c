@@ -0,0 +1,432 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "securec.h"
+#include "los_event.h"
+#include "los_interrupt.h"
+#include "los_arch_interrupt.h"
+#include "los_task.h"
+#include "los_tick.h"
+#include "hal/uart_ll.h"
+#if (LOSCFG_USE_SHELL == 1)
+#include "shcmd.h"
+#endif
+#include "crash_log.h"
+#include "log_bin.h"
+#include "log_ring.h"
+
+#define LOG_RING_MASK (LOG_RING_SLOT_NUM - 1)
+#define LOG_RING_EVENT_DATA 0x1U
+#define LOG_RING_TX_WAIT_TICKS 1
+#define LOG_DROP_MSG_LEN 48
+#define LOG_TIME_MSG_LEN 16
+#define LOG_MS_PER_SECOND 1000
+#define LOG_REC_TEXT 0
+#define LOG_REC_BIN 1
+
+/*
+ * 有界多生产者单消费者队列: 每个槽位的 seq 等于 pos 表示空闲, 等于 pos + 1 表示已写入.
+ * 生产者用 CAS 预留 head, 直接格式化到槽位后发布 seq; 消费者按 tail 顺序取出.
+ */
+typedef struct {
+    volatile uint32_t seq;
+    uint32_t timeMs;
+    uint16_t len;
+    uint8_t type;                   // LOG_REC_TEXT / LOG_REC_BIN
+    char data[LOG_RING_SLOT_SIZE];
+} LogRecord_t;
+
+typedef struct {
+    LogRecord_t slot[LOG_RING_SLOT_NUM];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t draining;              // 消费者互斥: 当前消费者的令牌, 0 表示空闲
+    uint32_t drainToken;
+    bool lineStart;                 // 上一条文本以换行结尾, 下一条需加时间戳
+    volatile uint32_t started;
+    volatile uint32_t outputMode;
+    uint32_t reportedDrops;
+    char text[LOG_RING_SLOT_SIZE * 2];  // 输出任务格式化二进制记录用, 受 draining 保护
+    char stealText[LOG_RING_SLOT_SIZE * 2];  // 接管者用, 被接管的消费者可能仍在使用 text
+    EVENT_CB_S event;
+    LogRingStats stats;
+} LogRing_t;
+
+static LogRing_t LogRing = { .lineStart = true };
+
+static void LogUartWrite(const char *data, uint32_t len, bool sleep)
+{
+    uint32_t fill;
+    while (len > 0) {
+        fill = uart_ll_get_txfifo_len(&UART0);
+        if (fill == 0) {
+            if (sleep) {
+                LOS_TaskDelay(LOG_RING_TX_WAIT_TICKS);
+            }
+            continue;
+        }
+        if (fill > len) {
+            fill = len;
+        }
+        uart_ll_write_txfifo(&UART0, (const uint8_t *)data, fill);
+        data += fill;
+        len -= fill;
+    }
+}
+
+static void LogRingReportDrops(bool sleep)
+{
+    char msg[LOG_DROP_MSG_LEN];
+    uint32_t dropped = __atomic_load_n(&LogRing.stats.dropped, __ATOMIC_RELAXED);
+    int len;
+    if (dropped == LogRing.reportedDrops) {
+        return;
+    }
+    len = snprintf_s(msg, sizeof(msg), sizeof(msg) - 1, "[log] %u records dropped\n",
+                     dropped - LogRing.reportedDrops);
+    LogRing.reportedDrops = dropped;
+    if (len > 0) {
+        LogUartWrite(msg, (uint32_t)len, sleep);
+    }
+}
+
+static void LogRingWriteFrame(const LogRecord_t *rec, bool sleep)
+{
+    uint8_t hdr[LOG_BIN_FRAME_HDR_LEN];
+    uint8_t sum = 0;
+    uint32_t i;
+    hdr[0] = LOG_BIN_MAGIC0;
+    hdr[1] = LOG_BIN_MAGIC1;
+    hdr[2] = (uint8_t)rec->len;                 // 2..3: 记录长度, 小端
+    hdr[3] = (uint8_t)(rec->len >> 8);          // 8: 取高字节
+    (void)memcpy_s(&hdr[4], sizeof(hdr) - 4, &rec->timeMs, sizeof(rec->timeMs)); // 4: 时间戳偏移
+    for (i = 2; i < sizeof(hdr); i++) {         // 2: 校验从长度字段开始
+        sum += hdr[i];
+    }
+    for (i = 0; i < rec->len; i++) {
+        sum += (uint8_t)rec->data[i];
+    }
+    LogUartWrite((const char *)hdr, sizeof(hdr), sleep);
+    LogUartWrite(rec->data, rec->len, sleep);
+    LogUartWrite((const char *)&sum, 1, sleep);
+}
+
+// 文本输出: 行首加 "[秒.毫秒] " 时间戳, printf 分多次输出的同一行只加一次
+static void LogRingWriteText(const LogRecord_t *rec, const char *text, uint32_t len, bool toUart, bool sleep)
+{
+    char stamp[LOG_TIME_MSG_LEN];
+    int stampLen;
+    if (len == 0) {
+        return;
+    }
+    if (LogRing.lineStart) {
+        stampLen = snprintf_s(stamp, sizeof(stamp), sizeof(stamp) - 1, "[%u.%03u] ",
+                              rec->timeMs / LOG_MS_PER_SECOND, rec->timeMs % LOG_MS_PER_SECOND);
+        if (stampLen > 0) {
+            if (toUart) {
+                LogUartWrite(stamp, (uint32_t)stampLen, sleep);
+            }
+            CrashLogAppend(stamp, (uint32_t)stampLen);
+        }
+    }
+    if (toUart) {
+        LogUartWrite(text, len, sleep);
+    }
+    CrashLogAppend(text, len);
+    LogRing.lineStart = (text[len - 1] == '\n');
+}
+
+static void LogRingOutput(const LogRecord_t *rec, char *text, uint32_t size, bool sleep)
+{
+    uint32_t addr;
+    uint32_t len;
+    if (rec->type == LOG_REC_TEXT) {
+        LogRingWriteText(rec, rec->data, rec->len, true, sleep);
+        return;
+    }
+    if (rec->len < LOG_BIN_HDR_LEN) {
+        return;
+    }
+    // 由输出任务完成延迟格式化; 二进制输出模式下文本只用于崩溃日志
+    (void)memcpy_s(&addr, sizeof(addr), rec->data, sizeof(addr));
+    len = LogBinFormat(text, size, (const char *)(uintptr_t)addr, (const uint8_t *)rec->data + LOG_BIN_HDR_LEN,
+                       rec->len - LOG_BIN_HDR_LEN);
+    if (LogRing.outputMode == LOG_RING_OUTPUT_BINARY) {
+        LogRingWriteFrame(rec, sleep);
+    }
+    LogRingWriteText(rec, text, len, LogRing.outputMode != LOG_RING_OUTPUT_BINARY, sleep);
+}
+
+/*
+ * 取出并输出队列中的记录. steal 为 true 时不等待当前消费者, 直接接管 (只用于不能等待的上下文),
+ * 被接管的消费者恢复运行后发现令牌或 tail 已变化即退出, 至多重复输出一条记录.
+ *
+ * @return false 其他消费者正在输出, 未取出任何记录
+ */
+static bool LogRingDrain(bool sleep, bool steal)
+{
+    uint32_t idle = 0;
+    uint32_t token = __atomic_add_fetch(&LogRing.drainToken, 1, __ATOMIC_RELAXED);
+    uint32_t pos;
+    LogRecord_t *rec = NULL;
+    if (token == 0) {
+        token = __atomic_add_fetch(&LogRing.drainToken, 1, __ATOMIC_RELAXED);
+    }
+    if (steal) {
+        __atomic_store_n(&LogRing.draining, token, __ATOMIC_SEQ_CST);
+    } else if (!__atomic_compare_exchange_n(&LogRing.draining, &idle, token, false, __ATOMIC_ACQUIRE,
+                                            __ATOMIC_RELAXED)) {
+        return false;
+    }
+    for (;;) {
+        pos = __atomic_load_n(&LogRing.tail, __ATOMIC_ACQUIRE);
+        rec = &LogRing.slot[pos & LOG_RING_MASK];
+        if ((__atomic_load_n(&LogRing.draining, __ATOMIC_ACQUIRE) != token) ||
+            (__atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE) != pos + 1)) {
+            break;
+        }
+        if (steal) {
+            LogRingOutput(rec, LogRing.stealText, sizeof(LogRing.stealText), sleep);
+        } else {
+            LogRingOutput(rec, LogRing.text, sizeof(LogRing.text), sleep);
+        }
+        if (!__atomic_compare_exchange_n(&LogRing.tail, &pos, pos + 1, false, __ATOMIC_ACQ_REL,
+                                         __ATOMIC_RELAXED)) {
+            return true;            // 已被接管, 该记录由接管者释放
+        }
+        __atomic_store_n(&rec->seq, pos + LOG_RING_SLOT_NUM, __ATOMIC_RELEASE);
+    }
+    if (__atomic_load_n(&LogRing.draining, __ATOMIC_ACQUIRE) == token) {
+        LogRingReportDrops(sleep);
+    }
+    (void)__atomic_compare_exchange_n(&LogRing.draining, &token, 0, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    return true;
+}
+
+static void LogRingTask(void)
+{
+    for (;;) {
+        (void)LOS_EventRead(&LogRing.event, LOG_RING_EVENT_DATA, LOS_WAITMODE_OR | LOS_WAITMODE_CLR,
+                            LOS_WAIT_FOREVER);
+        (void)LogRingDrain(true, false);
+    }
+}
+
+static void LogRingUpdateHighWater(uint32_t pos)
+{
+    uint32_t used = pos + 1 - __atomic_load_n(&LogRing.tail, __ATOMIC_RELAXED);
+    if (used > LogRing.stats.highWater) {
+        LogRing.stats.highWater = used;
+    }
+}
+
+#if (LOSCFG_USE_SHELL == 1)
+static UINT32 LogModeShellCmd(UINT32 argc, const CHAR **argv)
+{
+    if (argc == 0) {
+        printf("%s\r\n", (LogRing.outputMode == LOG_RING_OUTPUT_BINARY) ? "binary" : "text");
+        return LOS_OK;
+    }
+    if ((argc == 1) && (strcmp(argv[0], "text") == 0)) {
+        LogRingSetOutputMode(LOG_RING_OUTPUT_TEXT);
+        return LOS_OK;
+    }
+    if ((argc == 1) && (strcmp(argv[0], "binary") == 0)) {
+        LogRingSetOutputMode(LOG_RING_OUTPUT_BINARY);
+        return LOS_OK;
+    }
+    printf("usage: logmode [text|binary]\r\n");
+    return LOS_NOK;
+}
+#endif
+
+int LogRingInit(void)
+{
+    UINT32 taskId;
+    TSK_INIT_PARAM_S task = { 0 };
+    uint32_t i;
+    if (LogRing.started) {
+        return 0;
+    }
+    for (i = 0; i < LOG_RING_SLOT_NUM; i++) {
+        LogRing.slot[i].seq = i;
+    }
+    if (LOS_EventInit(&LogRing.event) != LOS_OK) {
+        return -1;
+    }
+    task.pfnTaskEntry = (TSK_ENTRY_FUNC)LogRingTask;
+    task.uwStackSize = LOG_RING_TASK_STACK_SIZE;
+    task.pcName = "log";
+    task.usTaskPrio = LOG_RING_TASK_PRIO;
+    if (LOS_TaskCreate(&taskId, &task) != LOS_OK) {
+        (void)LOS_EventDestroy(&LogRing.event);
+        return -1;
+    }
+    LogRing.started = 1;
+#if (LOSCFG_USE_SHELL == 1)
+    (void)osCmdReg(CMD_TYPE_EX, "logmode", XARGS, (CmdCallBackFunc)LogModeShellCmd);
+#endif
+    return 0;
+}
+
+// 预留一个槽位, 队列满时计数并返回 NULL
+static LogRecord_t *LogRingReserve(uint32_t *pos)
+{
+    int32_t diff;
+    LogRecord_t *rec = NULL;
+    *pos = __atomic_load_n(&LogRing.head, __ATOMIC_RELAXED);
+    for (;;) {
+        rec = &LogRing.slot[*pos & LOG_RING_MASK];
+        diff = (int32_t)(__atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE) - *pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&LogRing.head, pos, *pos + 1, true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                return rec;
+            }
+        } else if (diff < 0) {
+            // 队列满: 丢弃并计数, 由输出任务补一行提示
+            __atomic_fetch_add(&LogRing.stats.dropped, 1, __ATOMIC_RELAXED);
+            return NULL;
+        } else {
+            *pos = __atomic_load_n(&LogRing.head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void LogRingCommit(LogRecord_t *rec, uint32_t pos, uint8_t type, uint32_t len)
+{
+    rec->len = (uint16_t)len;
+    rec->type = type;
+    rec->timeMs = LOS_Tick2MS((UINT32)LOS_TickCountGet());
+    __atomic_store_n(&rec->seq, pos + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&LogRing.stats.written, 1, __ATOMIC_RELAXED);
+    LogRingUpdateHighWater(pos);
+    (void)LOS_EventWrite(&LogRing.event, LOG_RING_EVENT_DATA);
+}
+
+int LogRingVprintf(const char *fmt, va_list ap)
+{
+    uint32_t pos;
+    int len;
+    LogRecord_t *rec = NULL;
+    if (!LogRing.started) {
+        return -1;
+    }
+    rec = LogRingReserve(&pos);
+    if (rec == NULL) {
+        return 0;
+    }
+    len = vsnprintf_s(rec->data, LOG_RING_SLOT_SIZE, LOG_RING_SLOT_SIZE - 1, fmt, ap);
+    if (len < 0) {
+        len = (int)strnlen(rec->data, LOG_RING_SLOT_SIZE - 1);
+        if (len > 0) {
+            rec->data[len - 1] = '\n';
+            __atomic_fetch_add(&LogRing.stats.truncated, 1, __ATOMIC_RELAXED);
+        }
+    }
+    LogRingCommit(rec, pos, LOG_REC_TEXT, (uint32_t)len);
+    return 0;
+}
+
+int LogRingWriteBin(const char *fmt, uint8_t level, uint8_t module, va_list ap)
+{
+    uint32_t pos;
+    LogRecord_t *rec = NULL;
+    if (!LogRing.started) {
+        return -1;
+    }
+    rec = LogRingReserve(&pos);
+    if (rec != NULL) {
+        LogRingCommit(rec, pos, LOG_REC_BIN,
+                      LogBinEncode((uint8_t *)rec->data, LOG_RING_SLOT_SIZE, fmt, level, module, ap));
+    }
+    return 0;
+}
+
+int LogRingWriteBinValues(const char *fmt, uint8_t level, uint8_t module, const uint32_t *values, uint32_t count)
+{
+    uint32_t pos;
+    LogRecord_t *rec = NULL;
+    if (!LogRing.started) {
+        return -1;
+    }
+    rec = LogRingReserve(&pos);
+    if (rec != NULL) {
+        LogRingCommit(rec, pos, LOG_REC_BIN,
+                      LogBinEncodeValues((uint8_t *)rec->data, LOG_RING_SLOT_SIZE, fmt, level, module, values, count));
+    }
+    return 0;
+}
+
+int LogBinPrintf(const char *fmt, ...)
+{
+    va_list ap;
+    char buf[LOG_RING_SLOT_SIZE];
+    int len;
+    int ret;
+    va_start(ap, fmt);
+    // 文本模式仍在调用者上下文格式化, 避免 %s 被截断为 LOG_BIN_STR_MAX
+    if (LogRing.outputMode == LOG_RING_OUTPUT_BINARY) {
+        ret = LogRingWriteBin(fmt, LOG_BIN_LEVEL_NONE, LOG_BIN_MODULE_NONE, ap);
+    } else {
+        ret = LogRingVprintf(fmt, ap);
+    }
+    if (ret != 0) {
+        // 输出任务未启动时直接格式化输出
+        len = vsnprintf_s(buf, sizeof(buf), sizeof(buf) - 1, fmt, ap);
+        if (len > 0) {
+            LogUartWrite(buf, (uint32_t)len, false);
+        }
+    }
+    va_end(ap);
+    return 0;
+}
+
+void LogRingSetOutputMode(uint32_t mode)
+{
+    LogRing.outputMode = mode;
+}
+
+uint32_t LogRingGetOutputMode(void)
+{
+    return LogRing.outputMode;
+}
+
+void LogRingFlush(void)
+{
+    if (!LogRing.started) {
+        return;
+    }
+    // 等待输出任务写完当前记录; 中断中, 关中断或锁调度时无法等待, 直接接管
+    while (!LogRingDrain(false, false)) {
+        if (OS_INT_ACTIVE || ArchIntLocked() || (LOS_TaskDelay(1) != LOS_OK)) {
+            (void)LogRingDrain(false, true);
+            return;
+        }
+    }
+}
+
+void LogRingGetStats(LogRingStats *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    stats->written = __atomic_load_n(&LogRing.stats.written, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&LogRing.stats.dropped, __ATOMIC_RELAXED);
+    stats->truncated = __atomic_load_n(&LogRing.stats.truncated, __ATOMIC_RELAXED);
+    stats->highWater = LogRing.stats.highWater;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __LOG_RING_H__
+#define __LOG_RING_H__
+#include <stdarg.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_RING_SLOT_NUM 32            // 必须为 2 的幂
+#define LOG_RING_SLOT_SIZE 192          // 单条记录的文本上限, 超出部分截断
+#define LOG_RING_TASK_PRIO 28
+#define LOG_RING_TASK_STACK_SIZE 0x800
+#define LOG_RING_OUTPUT_TEXT 0          // 二进制记录由输出任务格式化为文本
+#define LOG_RING_OUTPUT_BINARY 1        // 二进制记录按帧输出, 由主机 log_decode.py 解析
+
+typedef struct {
+    uint32_t written;                   // 成功入队的记录数
+    uint32_t dropped;                   // 队列满时丢弃的记录数
+    uint32_t truncated;                 // 超长被截断的记录数
+    uint32_t highWater;                 // 队列中同时存在的最大记录数
+} LogRingStats;
+
+/**
+ * @brief 创建日志输出任务, 之后的打印只做一次格式化入队, 由输出任务写 UART0
+ *
+ * @return 0 成功, 其余失败 (失败时继续使用同步输出)
+ */
+int LogRingInit(void);
+
+/**
+ * @brief 格式化一条日志并入队, 可在任务与中断上下文调用, 不会阻塞
+ *
+ * @return 0 已入队或因队列满被丢弃, -1 输出任务未启动 (此时 ap 未被使用)
+ */
+int LogRingVprintf(const char *fmt, va_list ap);
+
+/**
+ * @brief 二进制日志: 只记录格式串地址与原始参数, 不在调用者上下文格式化
+ *
+ * 格式串须位于镜像的只读数据中, 编码规则见 log_bin.h
+ *
+ * @return 0 已入队或被丢弃, -1 输出任务未启动 (此时 ap 未被使用)
+ */
+int LogRingWriteBin(const char *fmt, uint8_t level, uint8_t module, va_list ap);
+int LogRingWriteBinValues(const char *fmt, uint8_t level, uint8_t module, const uint32_t *values, uint32_t count);
+
+/**
+ * @brief HAL_LOG 的输出: 二进制输出模式下写二进制记录, 否则同 printf
+ */
+int LogBinPrintf(const char *fmt, ...);
+
+/**
+ * @brief 切换输出模式, 也可在 shell 中用 logmode 命令切换
+ */
+void LogRingSetOutputMode(uint32_t mode);
+uint32_t LogRingGetOutputMode(void);
+
+/**
+ * @brief 在调用者上下文中把队列中的日志同步写出, 用于复位或异常前
+ *
+ * 输出任务正在写时等待其结束; 在中断中, 关中断或锁调度时直接接管输出.
+ */
+void LogRingFlush(void);
+
+void LogRingGetStats(LogRingStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include "los_config.h"
+#include "los_interrupt.h"
+#include "los_memory.h"
+#include "soc/soc_memory_layout.h"
+#include "dma_buf.h"
+
+#define DMA_BUF_WORD_MASK 0x3
+
+/*
+ * LOS_MemInit 把本池挂入多内存池链表 (LOSCFG_MEM_MUL_POOL), 加上系统堆共 2 个, 不超过 OS_SYS_MEM_NUM.
+ * LOS_MemAlloc/LOS_MemAllocAlign/LOS_MemFree 在链接时被 --wrap 接管到系统堆, 本池须调用原始实现.
+ */
+#if (LOSCFG_MEM_MUL_POOL != 1) || (OS_SYS_MEM_NUM < 2)
+#error "DMA buffer pool needs LOSCFG_MEM_MUL_POOL and room for a second pool in OS_SYS_MEM_NUM"
+#endif
+
+VOID *__real_LOS_MemAllocAlign(VOID *pool, UINT32 size, UINT32 boundary);
+UINT32 __real_LOS_MemFree(VOID *pool, VOID *ptr);
+
+/* .bss 位于片内 DRAM, ESP32 的 DMA 可直接访问 */
+static uint8_t DmaPoolMem[LOSCFG_DMA_POOL_SIZE] __attribute__((aligned(DMA_BUF_ALIGN)));
+static uint8_t DmaPoolReady;
+
+static void *DmaPoolGet(void)
+{
+    UINT32 intSave;
+    if (!DmaPoolReady) {
+        intSave = LOS_IntLock();
+        if (!DmaPoolReady && (LOS_MemInit(DmaPoolMem, sizeof(DmaPoolMem)) == LOS_OK)) {
+            DmaPoolReady = 1;
+        }
+        LOS_IntRestore(intSave);
+    }
+    return DmaPoolReady ? DmaPoolMem : NULL;
+}
+
+void *DmaBufAlloc(uint32_t size)
+{
+    void *pool = DmaPoolGet();
+    if ((pool == NULL) || (size == 0) || (size > sizeof(DmaPoolMem))) {
+        return NULL;
+    }
+    size = (size + DMA_BUF_ALIGN - 1) & ~(DMA_BUF_ALIGN - 1);
+    return __real_LOS_MemAllocAlign(pool, size, DMA_BUF_ALIGN);
+}
+
+void DmaBufFree(void *buf)
+{
+    uint8_t *p = (uint8_t *)buf;
+    if (buf == NULL) {
+        return;
+    }
+    if ((p < DmaPoolMem) || (p >= DmaPoolMem + sizeof(DmaPoolMem))) {
+        printf("DmaBufFree: %p is not from the DMA pool\r\n", buf);
+        return;
+    }
+    if (__real_LOS_MemFree(DmaPoolMem, buf) != LOS_OK) {
+        printf("DmaBufFree: %p is not an allocated block\r\n", buf);
+    }
+}
+
+bool DmaBufCapable(const void *buf, uint32_t len)
+{
+    return (buf != NULL) && esp_ptr_dma_capable(buf) && (((uintptr_t)buf & DMA_BUF_WORD_MASK) == 0) &&
+           ((len & DMA_BUF_WORD_MASK) == 0);
+}
+
+int DmaBufGetStats(DmaBufStats *stats)
+{
+    LOS_MEM_POOL_STATUS status;
+    void *pool = DmaPoolGet();
+    if ((stats == NULL) || (pool == NULL) || (LOS_MemInfoGet(pool, &status) != LOS_OK)) {
+        return -1;
+    }
+    stats->poolSize = sizeof(DmaPoolMem);
+    stats->freeSize = status.totalFreeSize;
+    stats->maxFreeBlock = status.maxFreeNodeSize;
+    return 0;
+}
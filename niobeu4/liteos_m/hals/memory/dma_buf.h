@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __DMA_BUF_H__
+#define __DMA_BUF_H__
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 外设 DMA 缓冲专用内存池, 位于片内 DRAM, 以 LiteOS 多内存池方式独立于系统堆管理,
+ * 大块传输不受系统堆碎片影响. 由此申请的缓冲可直接交给 SPI DMA, 无需中转拷贝.
+ */
+#define DMA_BUF_ALIGN 16
+
+typedef struct {
+    uint32_t poolSize;
+    uint32_t freeSize;
+    uint32_t maxFreeBlock;
+} DmaBufStats;
+
+/**
+ * @brief 申请 DMA 缓冲, 首地址与长度均按 DMA_BUF_ALIGN 对齐
+ *
+ * @return 缓冲地址, 内存池不足时返回 NULL
+ */
+void *DmaBufAlloc(uint32_t size);
+
+/**
+ * @brief 释放 DMA 缓冲, NULL 被忽略; 不属于 DMA 内存池的地址打印错误后忽略, 不会交给其他堆释放
+ */
+void DmaBufFree(void *buf);
+
+/**
+ * @brief 判断缓冲能否直接用于 DMA: 位于 DMA 可访问内存且按字对齐, len 非 0 时还要求长度按字对齐
+ */
+bool DmaBufCapable(const void *buf, uint32_t len);
+
+int DmaBufGetStats(DmaBufStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * newlib 的 malloc 系列仍由 ESP-IDF 的 heap_caps 实现 (-unewlib_include_heap_impl), 这里只通过
+ * 链接选项 --wrap 接管分配失败: 调用 MemReclaim 释放缓存后重试一次, 仍失败时返回 NULL.
+ * free 不经过这里, 也不改变内存块的布局.
+ */
+#include <reent.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mem_reclaim.h"
+
+void *__real_malloc(size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real__malloc_r(struct _reent *r, size_t size);
+void *__real__realloc_r(struct _reent *r, void *ptr, size_t size);
+void *__real__calloc_r(struct _reent *r, size_t num, size_t size);
+
+// 申请 0 字节时返回 NULL 不是内存不足
+static int LibcHeapRetry(void *ptr, size_t size)
+{
+    return (ptr == NULL) && (size != 0) && (MemReclaim((uint32_t)size) > 0);
+}
+
+// 溢出时返回 0, 不触发回收
+static size_t LibcHeapCallocSize(size_t num, size_t size)
+{
+    return ((size != 0) && (num > (SIZE_MAX / size))) ? 0 : (num * size);
+}
+
+void *__wrap_malloc(size_t size)
+{
+    void *ptr = __real_malloc(size);
+    if (LibcHeapRetry(ptr, size)) {
+        ptr = __real_malloc(size);
+    }
+    return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    // 失败时原内存块保持不变, 可以直接重试
+    void *newPtr = __real_realloc(ptr, size);
+    if (LibcHeapRetry(newPtr, size)) {
+        newPtr = __real_realloc(ptr, size);
+    }
+    return newPtr;
+}
+
+void *__wrap_calloc(size_t num, size_t size)
+{
+    void *ptr = __real_calloc(num, size);
+    if (LibcHeapRetry(ptr, LibcHeapCallocSize(num, size))) {
+        ptr = __real_calloc(num, size);
+    }
+    return ptr;
+}
+
+void *__wrap__malloc_r(struct _reent *r, size_t size)
+{
+    void *ptr = __real__malloc_r(r, size);
+    if (LibcHeapRetry(ptr, size)) {
+        ptr = __real__malloc_r(r, size);
+    }
+    return ptr;
+}
+
+void *__wrap__realloc_r(struct _reent *r, void *ptr, size_t size)
+{
+    void *newPtr = __real__realloc_r(r, ptr, size);
+    if (LibcHeapRetry(newPtr, size)) {
+        newPtr = __real__realloc_r(r, ptr, size);
+    }
+    return newPtr;
+}
+
+void *__wrap__calloc_r(struct _reent *r, size_t num, size_t size)
+{
+    void *ptr = __real__calloc_r(r, num, size);
+    if (LibcHeapRetry(ptr, LibcHeapCallocSize(num, size))) {
+        ptr = __real__calloc_r(r, num, size);
+    }
+    return ptr;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "los_interrupt.h"
+#include "mem_reclaim.h"
+
+typedef struct {
+    MemReclaimFunc func[MEM_RECLAIM_MAX];
+    uint8_t num;
+    uint8_t running;                    // 回收函数内部的分配失败不再递归回收
+} MemReclaim_t;
+
+static MemReclaim_t MemReclaimTable;
+
+int MemReclaimRegister(MemReclaimFunc func)
+{
+    UINT32 intSave;
+    if (func == NULL) {
+        return -1;
+    }
+    intSave = LOS_IntLock();
+    for (uint8_t i = 0; i < MemReclaimTable.num; i++) {
+        if (MemReclaimTable.func[i] == func) {
+            LOS_IntRestore(intSave);
+            return 0;
+        }
+    }
+    if (MemReclaimTable.num >= MEM_RECLAIM_MAX) {
+        LOS_IntRestore(intSave);
+        return -1;
+    }
+    MemReclaimTable.func[MemReclaimTable.num++] = func;
+    LOS_IntRestore(intSave);
+    return 0;
+}
+
+uint32_t MemReclaim(uint32_t need)
+{
+    MemReclaimFunc func[MEM_RECLAIM_MAX];
+    uint8_t num;
+    uint32_t freed = 0;
+    UINT32 intSave;
+    if (OS_INT_ACTIVE) {
+        return 0;
+    }
+    intSave = LOS_IntLock();
+    if (MemReclaimTable.running) {
+        LOS_IntRestore(intSave);
+        return 0;
+    }
+    MemReclaimTable.running = 1;
+    num = MemReclaimTable.num;
+    for (uint8_t i = 0; i < num; i++) {
+        func[i] = MemReclaimTable.func[i];
+    }
+    LOS_IntRestore(intSave);
+    for (uint8_t i = 0; (i < num) && (freed < need); i++) {
+        freed += func[i](need - freed);
+    }
+    MemReclaimTable.running = 0;
+    return freed;
+}
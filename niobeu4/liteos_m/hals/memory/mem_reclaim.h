@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __MEM_RECLAIM_H__
+#define __MEM_RECLAIM_H__
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 低内存回收: libc 堆 (heap_caps) 分配失败时依次调用各模块注册的回收函数释放缓存, 然后重试一次分配.
+ * 已注册的缓存都在 libc 堆中, 释放它们对 LiteOS 系统内存池没有帮助, 因此 LOS_MemAlloc 失败不触发回收.
+ * 回收函数运行在分配者的任务上下文中, 同步释放并返回释放的字节数; 不能等待可能被分配者
+ * 持有的锁 (只能尝试加锁, 失败时返回 0), 也不应再申请内存.
+ * 中断中的分配失败不触发回收.
+ */
+#define MEM_RECLAIM_MAX 8
+
+/**
+ * @brief 回收函数
+ *
+ * @param need 本次分配所需的字节数
+ * @return 估计释放的字节数
+ */
+typedef uint32_t (*MemReclaimFunc)(uint32_t need);
+
+/**
+ * @brief 注册回收函数, 重复注册同一函数时忽略
+ *
+ * @return 0 成功, -1 参数非法或表已满
+ */
+int MemReclaimRegister(MemReclaimFunc func);
+
+/**
+ * @brief 调用回收函数直到释放量达到 need 或全部调用完
+ *
+ * @return 估计释放的总字节数, 为 0 时无需重试分配
+ */
+uint32_t MemReclaim(uint32_t need);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
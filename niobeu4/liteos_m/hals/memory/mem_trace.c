@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "los_interrupt.h"
+#include "los_task.h"
+#include "los_tick.h"
+#include "ohos_init.h"
+#if (LOSCFG_USE_SHELL == 1)
+#include "shcmd.h"
+#endif
+#include "dma_buf.h"
+#include "mem_trace.h"
+
+#define MEM_TRACE_OP_FREE 0x80
+#define MEM_TRACE_MOD_MASK 0x7F
+#define MEM_TRACE_LIVE_MASK (MEM_TRACE_LIVE_MAX - 1)
+#define MEM_TRACE_LIVE_LIMIT (MEM_TRACE_LIVE_MAX * 3 / 4)
+#define MEM_TRACE_PERCENT 100
+
+int MemTraceGetFragInfo(void *pool, MemFragInfo *info)
+{
+    LOS_MEM_POOL_STATUS status;
+    if ((pool == NULL) || (info == NULL) || (LOS_MemInfoGet(pool, &status) != LOS_OK)) {
+        return -1;
+    }
+    info->totalFree = status.totalFreeSize;
+    info->maxFreeBlock = status.maxFreeNodeSize;
+    info->freeNodes = status.freeNodeNum;
+    info->fragPercent = (status.totalFreeSize == 0) ? 0 :
+        (MEM_TRACE_PERCENT - (uint32_t)((uint64_t)status.maxFreeNodeSize * MEM_TRACE_PERCENT / status.totalFreeSize));
+    return 0;
+}
+
+#if (LOSCFG_MEM_TRACE == 1)
+typedef struct {
+    uintptr_t ptr;
+    uintptr_t caller;
+    uint32_t size;
+    uint16_t tick;                      // 系统 tick 低 16 位
+    uint8_t task;
+    uint8_t info;                       // bit7: 释放, bit0-6: 模块
+} MemTraceRecord;
+
+typedef struct {
+    void *ptr;
+    uint32_t size;
+    uint8_t task;
+    uint8_t module;
+    uint16_t reserved;
+} MemTraceLive;
+
+typedef struct {
+    MemTraceRecord ring[MEM_TRACE_RING_SIZE];
+    uint32_t ringPos;
+    MemTraceLive live[MEM_TRACE_LIVE_MAX];
+    uint32_t liveNum;
+    uint32_t untracked;                 // 哈希表满未能统计的分配
+    uint32_t fails;
+    MemTraceUsage task[MEM_TRACE_TASK_MAX];
+    MemTraceUsage module[MEM_TRACE_MOD_MAX];
+} MemTrace_t;
+
+static MemTrace_t MemTrace;
+
+static uint8_t MemTraceTaskId(void)
+{
+    UINT32 taskId;
+    if (OS_INT_ACTIVE) {
+        return MEM_TRACE_TASK_MAX - 1;
+    }
+    taskId = LOS_CurTaskIDGet();
+    return (taskId < (MEM_TRACE_TASK_MAX - 1)) ? (uint8_t)taskId : (MEM_TRACE_TASK_MAX - 1);
+}
+
+static uint32_t MemTraceHash(const void *ptr)
+{
+    return ((((uintptr_t)ptr >> 3) * 2654435761U) >> 16) & MEM_TRACE_LIVE_MASK; // 3: 8 字节对齐, 16: 取高位
+}
+
+static void MemTraceUsageAdd(MemTraceUsage *usage, uint32_t size)
+{
+    usage->allocs++;
+    usage->curBytes += size;
+    if (usage->curBytes > usage->peakBytes) {
+        usage->peakBytes = usage->curBytes;
+    }
+}
+
+// 调用者持有中断锁
+static void MemTraceRecordAdd(const void *ptr, uint32_t size, uint8_t task, uint8_t info, uintptr_t caller)
+{
+    MemTraceRecord *rec = &MemTrace.ring[MemTrace.ringPos++ % MEM_TRACE_RING_SIZE];
+    rec->ptr = (uintptr_t)ptr;
+    rec->caller = caller;
+    rec->size = size;
+    rec->tick = (uint16_t)LOS_TickCountGet();
+    rec->task = task;
+    rec->info = info;
+}
+
+void MemTraceAlloc(void *ptr, uint32_t size, uint8_t module, uintptr_t caller)
+{
+    uint8_t task = MemTraceTaskId();
+    uint32_t i;
+    UINT32 intSave;
+    if (module >= MEM_TRACE_MOD_MAX) {
+        module = MEM_TRACE_MOD_MAX - 1;
+    }
+    intSave = LOS_IntLock();
+    MemTraceRecordAdd(ptr, size, task, module, caller);
+    if (ptr == NULL) {
+        MemTrace.fails++;
+        LOS_IntRestore(intSave);
+        return;
+    }
+    if (MemTrace.liveNum >= MEM_TRACE_LIVE_LIMIT) {
+        MemTrace.untracked++;
+        LOS_IntRestore(intSave);
+        return;
+    }
+    for (i = MemTraceHash(ptr); MemTrace.live[i].ptr != NULL; i = (i + 1) & MEM_TRACE_LIVE_MASK) {
+    }
+    MemTrace.live[i].ptr = ptr;
+    MemTrace.live[i].size = size;
+    MemTrace.live[i].task = task;
+    MemTrace.live[i].module = module;
+    MemTrace.liveNum++;
+    MemTraceUsageAdd(&MemTrace.task[task], size);
+    MemTraceUsageAdd(&MemTrace.module[module], size);
+    LOS_IntRestore(intSave);
+}
+
+// 调用者持有中断锁, 线性探测表的删除需要把后续元素前移
+static void MemTraceLiveRemove(uint32_t i)
+{
+    uint32_t j = i;
+    uint32_t k;
+    for (;;) {
+        j = (j + 1) & MEM_TRACE_LIVE_MASK;
+        if (MemTrace.live[j].ptr == NULL) {
+            break;
+        }
+        k = MemTraceHash(MemTrace.live[j].ptr);
+        if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j))) {
+            continue;
+        }
+        MemTrace.live[i] = MemTrace.live[j];
+        i = j;
+    }
+    MemTrace.live[i].ptr = NULL;
+    MemTrace.liveNum--;
+}
+
+void MemTraceFree(void *ptr, uintptr_t caller)
+{
+    uint32_t size = 0;
+    uint8_t module = MEM_TRACE_MOD_MASK;
+    UINT32 intSave;
+    if (ptr == NULL) {
+        return;
+    }
+    intSave = LOS_IntLock();
+    for (uint32_t i = MemTraceHash(ptr); MemTrace.live[i].ptr != NULL; i = (i + 1) & MEM_TRACE_LIVE_MASK) {
+        MemTraceLive *live = &MemTrace.live[i];
+        if (live->ptr != ptr) {
+            continue;
+        }
+        size = live->size;
+        module = live->module;
+        MemTrace.task[live->task].curBytes -= size;
+        MemTrace.module[module].curBytes -= size;
+        MemTraceLiveRemove(i);
+        break;
+    }
+    MemTraceRecordAdd(ptr, size, MemTraceTaskId(), MEM_TRACE_OP_FREE | module, caller);
+    LOS_IntRestore(intSave);
+}
+
+void *MemTraceLosAlloc(void *pool, uint32_t size, uint8_t module)
+{
+    void *ptr = LOS_MemAlloc(pool, size);
+    MemTraceAlloc(ptr, size, module, MEM_TRACE_CALLER());
+    return ptr;
+}
+
+void MemTraceLosFree(void *pool, void *ptr)
+{
+    MemTraceFree(ptr, MEM_TRACE_CALLER());
+    (void)LOS_MemFree(pool, ptr);
+}
+
+int MemTraceGetTaskUsage(uint32_t taskId, MemTraceUsage *usage)
+{
+    UINT32 intSave;
+    if ((taskId >= MEM_TRACE_TASK_MAX) || (usage == NULL)) {
+        return -1;
+    }
+    intSave = LOS_IntLock();
+    *usage = MemTrace.task[taskId];
+    LOS_IntRestore(intSave);
+    return 0;
+}
+
+int MemTraceGetModuleUsage(uint32_t module, MemTraceUsage *usage)
+{
+    UINT32 intSave;
+    if ((module >= MEM_TRACE_MOD_MAX) || (usage == NULL)) {
+        return -1;
+    }
+    intSave = LOS_IntLock();
+    *usage = MemTrace.module[module];
+    LOS_IntRestore(intSave);
+    return 0;
+}
+
+#if (LOSCFG_USE_SHELL == 1)
+// Xtensa 返回地址的高 2 位为窗口增量, 还原为可用于 addr2line 的地址
+static uintptr_t MemTracePc(uintptr_t caller)
+{
+    return (caller == 0) ? 0 : ((caller & 0x3FFFFFFF) | 0x40000000);
+}
+
+static void MemTraceShowLog(void)
+{
+    MemTraceRecord rec;
+    uint32_t pos;
+    UINT32 intSave = LOS_IntLock();
+    pos = MemTrace.ringPos;
+    LOS_IntRestore(intSave);
+    printf("%5s %4s %3s %5s %10s %6s %10s\r\n", "tick", "op", "mod", "task", "ptr", "size", "caller");
+    for (uint32_t n = (pos > MEM_TRACE_RING_SIZE) ? (pos - MEM_TRACE_RING_SIZE) : 0; n < pos; n++) {
+        intSave = LOS_IntLock();
+        rec = MemTrace.ring[n % MEM_TRACE_RING_SIZE];
+        LOS_IntRestore(intSave);
+        printf("%5u %4s %3u %5u 0x%08x %6u 0x%08x\r\n", rec.tick, (rec.info & MEM_TRACE_OP_FREE) ? "free" : "alloc",
+               rec.info & MEM_TRACE_MOD_MASK, rec.task, rec.ptr, rec.size, MemTracePc(rec.caller));
+    }
+}
+
+static void MemTraceShowUsage(void)
+{
+    MemTraceUsage usage;
+    MemFragInfo frag;
+    DmaBufStats dma;
+    TSK_INFO_S taskInfo;
+    const char *name = NULL;
+    if (MemTraceGetFragInfo(OS_SYS_MEM_ADDR, &frag) == 0) {
+        printf("heap free %u, largest %u, nodes %u, frag %u%%\r\n", frag.totalFree, frag.maxFreeBlock,
+               frag.freeNodes, frag.fragPercent);
+    }
+    if (DmaBufGetStats(&dma) == 0) {
+        printf("dma pool %u, free %u, largest %u\r\n", dma.poolSize, dma.freeSize, dma.maxFreeBlock);
+    }
+    printf("live %u, untracked %u, fails %u\r\n", MemTrace.liveNum, MemTrace.untracked, MemTrace.fails);
+    printf("%-16s %8s %8s %8s\r\n", "task", "cur", "peak", "allocs");
+    for (uint32_t i = 0; i < MEM_TRACE_TASK_MAX; i++) {
+        if ((MemTraceGetTaskUsage(i, &usage) != 0) || (usage.allocs == 0)) {
+            continue;
+        }
+        name = "isr/other";
+        if ((i < MEM_TRACE_TASK_MAX - 1) && (LOS_TaskInfoGet(i, &taskInfo) == LOS_OK)) {
+            name = taskInfo.acName;
+        }
+        printf("%-16s %8u %8u %8u\r\n", name, usage.curBytes, usage.peakBytes, usage.allocs);
+    }
+    printf("%-16s %8s %8s %8s\r\n", "module", "cur", "peak", "allocs");
+    for (uint32_t i = 0; i < MEM_TRACE_MOD_MAX; i++) {
+        if ((MemTraceGetModuleUsage(i, &usage) == 0) && (usage.allocs > 0)) {
+            printf("%-16u %8u %8u %8u\r\n", i, usage.curBytes, usage.peakBytes, usage.allocs);
+        }
+    }
+}
+
+static UINT32 MemTraceShellCmd(UINT32 argc, const CHAR **argv)
+{
+    if (argc == 0) {
+        MemTraceShowUsage();
+        return LOS_OK;
+    }
+    if ((argc == 1) && (strcmp(argv[0], "log") == 0)) {
+        MemTraceShowLog();
+        return LOS_OK;
+    }
+    printf("usage: memtrace [log]\r\n");
+    return LOS_NOK;
+}
+
+static void MemTraceShellInit(void)
+{
+    (void)osCmdReg(CMD_TYPE_EX, "memtrace", XARGS, (CmdCallBackFunc)MemTraceShellCmd);
+}
+SYS_RUN(MemTraceShellInit);
+#endif
+#endif
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __MEM_TRACE_H__
+#define __MEM_TRACE_H__
+#include <stdint.h>
+#include "los_config.h"
+#include "los_memory.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 堆分配跟踪: 每次分配/释放记录调用地址, 大小与任务到环形缓冲, 并按任务和模块统计当前与峰值用量.
+ * 存活分配保存在定长哈希表中, 表满时只记入环形缓冲, 不参与统计.
+ * shell 命令 memtrace 输出统计与系统堆碎片率, memtrace log 输出最近的分配记录.
+ */
+#define MEM_TRACE_RING_SIZE 64
+#define MEM_TRACE_LIVE_MAX 128
+#define MEM_TRACE_TASK_MAX (LOSCFG_BASE_CORE_TSK_LIMIT + 1)     // 最后一项为中断与未知任务
+
+/* 模块号: OhosMalloc 的 MemType 直接作为模块号, 之后为直接调用 LOS_MemAlloc 的模块 */
+#define MEM_TRACE_MOD_OHOS_MAX 16
+#define MEM_TRACE_MOD_WIFI 16
+#define MEM_TRACE_MOD_MAX 17
+
+typedef struct {
+    uint32_t curBytes;
+    uint32_t peakBytes;
+    uint32_t allocs;
+} MemTraceUsage;
+
+typedef struct {
+    uint32_t totalFree;
+    uint32_t maxFreeBlock;
+    uint32_t freeNodes;
+    uint32_t fragPercent;               // 100 - 最大空闲块 / 总空闲
+} MemFragInfo;
+
+/**
+ * @brief 查询内存池碎片情况
+ *
+ * @return 0 成功, -1 失败
+ */
+int MemTraceGetFragInfo(void *pool, MemFragInfo *info);
+
+#if (LOSCFG_MEM_TRACE == 1)
+/**
+ * @brief 记录一次分配, ptr 为 NULL 时记录为失败
+ */
+void MemTraceAlloc(void *ptr, uint32_t size, uint8_t module, uintptr_t caller);
+
+/**
+ * @brief 记录一次释放
+ */
+void MemTraceFree(void *ptr, uintptr_t caller);
+
+/**
+ * @brief 带跟踪的 LOS_MemAlloc/LOS_MemFree, 供直接使用系统堆的模块调用
+ */
+void *MemTraceLosAlloc(void *pool, uint32_t size, uint8_t module);
+void MemTraceLosFree(void *pool, void *ptr);
+
+int MemTraceGetTaskUsage(uint32_t taskId, MemTraceUsage *usage);
+int MemTraceGetModuleUsage(uint32_t module, MemTraceUsage *usage);
+#else
+#define MemTraceAlloc(ptr, size, module, caller)
+#define MemTraceFree(ptr, caller)
+#define MemTraceLosAlloc(pool, size, module) LOS_MemAlloc(pool, size)
+#define MemTraceLosFree(pool, ptr) LOS_MemFree(pool, ptr)
+#endif
+
+#define MEM_TRACE_CALLER() ((uintptr_t)__builtin_return_address(0))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
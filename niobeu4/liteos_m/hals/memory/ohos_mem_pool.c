@@ -13,18 +13,259 @@
  * limitations under the License.
  */
 
+#include <stdbool.h>
+#include <stdio.h>
+#include "los_interrupt.h"
 #include "los_memory.h"
+#include "ohos_init.h"
+#if (LOSCFG_USE_SHELL == 1)
+#include "shcmd.h"
+#endif
 #include "ohos_mem_pool.h"
+#include "ohos_mem_slab.h"
+#include "mem_trace.h"
+
+#define OHOS_SLAB_ALIGN 8
+
+/*
+ * 系统堆分配的头部, 8 字节保持原有对齐. OhosMalloc 返回的指针不在 slab 池内即带有此头部,
+ * OhosFree 只按地址区分两者.
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t reserved[3];
+    uint32_t size;
+} OhosMemHead;
+
+typedef struct {
+    uint16_t blkSize;
+    uint16_t blkNum;
+    uint8_t *base;
+    uint8_t *owner;                     // 每块所属的统计项
+    void *freeList;
+    OhosSlabStats stats;
+} OhosSlabClass;
+
+typedef struct {
+    OhosSlabClass slab[OHOS_SLAB_CLASS_NUM];
+    OhosMemTypeStats type[OHOS_MEM_TYPE_STATS_MAX];
+    uint8_t inited;
+} OhosMemPool_t;
+
+#define OHOS_SLAB_DEFINE(size, num) \
+    static uint8_t OhosSlabPool##size[(size) * (num)] __attribute__((aligned(OHOS_SLAB_ALIGN))); \
+    static uint8_t OhosSlabOwner##size[num]
+
+/* 块大小覆盖消息缓冲, samgr 请求与 Wi-Fi 扫描记录等常见对象, 按大小升序 */
+OHOS_SLAB_DEFINE(32, 64);
+OHOS_SLAB_DEFINE(64, 48);
+OHOS_SLAB_DEFINE(128, 24);
+OHOS_SLAB_DEFINE(256, 12);
+
+static OhosMemPool_t OhosMemPool = {
+    .slab = {
+        { .blkSize = 32, .blkNum = 64, .base = OhosSlabPool32, .owner = OhosSlabOwner32 },
+        { .blkSize = 64, .blkNum = 48, .base = OhosSlabPool64, .owner = OhosSlabOwner64 },
+        { .blkSize = 128, .blkNum = 24, .base = OhosSlabPool128, .owner = OhosSlabOwner128 },
+        { .blkSize = 256, .blkNum = 12, .base = OhosSlabPool256, .owner = OhosSlabOwner256 },
+    },
+};
+
+// 调用者持有中断锁
+static void OhosSlabInit(void)
+{
+    for (uint32_t i = 0; i < OHOS_SLAB_CLASS_NUM; i++) {
+        OhosSlabClass *c = &OhosMemPool.slab[i];
+        c->freeList = NULL;
+        for (int32_t b = c->blkNum - 1; b >= 0; b--) {
+            void **blk = (void **)(c->base + (uint32_t)b * c->blkSize);
+            *blk = c->freeList;
+            c->freeList = blk;
+        }
+        c->stats.blkSize = c->blkSize;
+        c->stats.blkNum = c->blkNum;
+    }
+    OhosMemPool.inited = 1;
+}
+
+static uint8_t OhosMemTypeIndex(MemType type)
+{
+    return ((uint32_t)type < OHOS_MEM_TYPE_STATS_MAX) ? (uint8_t)type : (OHOS_MEM_TYPE_STATS_MAX - 1);
+}
+
+static void OhosMemStatsAlloc(OhosMemTypeStats *stats, uint32_t bytes, bool slab)
+{
+    stats->allocs++;
+    stats->curBytes += bytes;
+    if (stats->curBytes > stats->peakBytes) {
+        stats->peakBytes = stats->curBytes;
+    }
+    if (slab) {
+        stats->slabAllocs++;
+    }
+}
+
+static void *OhosSlabAlloc(uint8_t index, uint32_t size)
+{
+    bool overflow = false;
+    for (uint32_t i = 0; i < OHOS_SLAB_CLASS_NUM; i++) {
+        OhosSlabClass *c = &OhosMemPool.slab[i];
+        if (size > c->blkSize) {
+            continue;
+        }
+        if (c->freeList == NULL) {
+            // 对应大小的池已满时借用更大的块
+            if (!overflow) {
+                c->stats.overflows++;
+                overflow = true;
+            }
+            continue;
+        }
+        void **blk = (void **)c->freeList;
+        c->freeList = *blk;
+        c->owner[((uint8_t *)blk - c->base) / c->blkSize] = index;
+        if (++c->stats.used > c->stats.peak) {
+            c->stats.peak = c->stats.used;
+        }
+        OhosMemStatsAlloc(&OhosMemPool.type[index], c->blkSize, true);
+        return blk;
+    }
+    return NULL;
+}
+
+static bool OhosSlabFree(void *ptr)
+{
+    for (uint32_t i = 0; i < OHOS_SLAB_CLASS_NUM; i++) {
+        OhosSlabClass *c = &OhosMemPool.slab[i];
+        uint8_t *p = (uint8_t *)ptr;
+        if ((p < c->base) || (p >= c->base + (uint32_t)c->blkSize * c->blkNum)) {
+            continue;
+        }
+        OhosMemTypeStats *stats = &OhosMemPool.type[c->owner[(p - c->base) / c->blkSize]];
+        stats->frees++;
+        stats->curBytes -= c->blkSize;
+        *(void **)ptr = c->freeList;
+        c->freeList = ptr;
+        c->stats.used--;
+        return true;
+    }
+    return false;
+}
+
+static void *OhosMemAlloc(MemType type, uint32 size)
+{
+    uint8_t index = OhosMemTypeIndex(type);
+    OhosMemHead *head = NULL;
+    void *ptr = NULL;
+    UINT32 intSave;
+    if (size == 0) {
+        return NULL;
+    }
+    intSave = LOS_IntLock();
+    if (!OhosMemPool.inited) {
+        OhosSlabInit();
+    }
+    ptr = OhosSlabAlloc(index, size);
+    LOS_IntRestore(intSave);
+    if (ptr != NULL) {
+        return ptr;
+    }
+    head = (OhosMemHead *)LOS_MemAlloc(OS_SYS_MEM_ADDR, size + sizeof(OhosMemHead));
+    intSave = LOS_IntLock();
+    if (head == NULL) {
+        OhosMemPool.type[index].fails++;
+        LOS_IntRestore(intSave);
+        return NULL;
+    }
+    head->type = index;
+    head->size = size;
+    OhosMemStatsAlloc(&OhosMemPool.type[index], size, false);
+    LOS_IntRestore(intSave);
+    return head + 1;
+}
 
 /**
  * @brief implement for ohos_mem_pool.h
  */
 void *OhosMalloc(MemType type, uint32 size)
 {
-    return LOS_MemAlloc(OS_SYS_MEM_ADDR, size);
+    void *ptr = OhosMemAlloc(type, size);
+    MemTraceAlloc(ptr, size, OhosMemTypeIndex(type), MEM_TRACE_CALLER());
+    return ptr;
 }
 
 void OhosFree(void *ptr)
 {
-    LOS_MemFree(OS_SYS_MEM_ADDR, ptr);
+    OhosMemHead *head = NULL;
+    UINT32 intSave;
+    if (ptr == NULL) {
+        return;
+    }
+    MemTraceFree(ptr, MEM_TRACE_CALLER());
+    intSave = LOS_IntLock();
+    if (OhosSlabFree(ptr)) {
+        LOS_IntRestore(intSave);
+        return;
+    }
+    head = (OhosMemHead *)ptr - 1;
+    OhosMemPool.type[head->type].frees++;
+    OhosMemPool.type[head->type].curBytes -= head->size;
+    LOS_IntRestore(intSave);
+    LOS_MemFree(OS_SYS_MEM_ADDR, head);
+}
+
+int OhosMemGetTypeStats(uint32_t type, OhosMemTypeStats *stats)
+{
+    UINT32 intSave;
+    if ((type >= OHOS_MEM_TYPE_STATS_MAX) || (stats == NULL)) {
+        return -1;
+    }
+    intSave = LOS_IntLock();
+    *stats = OhosMemPool.type[type];
+    LOS_IntRestore(intSave);
+    return 0;
+}
+
+int OhosMemGetSlabStats(uint32_t index, OhosSlabStats *stats)
+{
+    UINT32 intSave;
+    if ((index >= OHOS_SLAB_CLASS_NUM) || (stats == NULL)) {
+        return -1;
+    }
+    intSave = LOS_IntLock();
+    *stats = OhosMemPool.slab[index].stats;
+    stats->blkSize = OhosMemPool.slab[index].blkSize;
+    stats->blkNum = OhosMemPool.slab[index].blkNum;
+    LOS_IntRestore(intSave);
+    return 0;
+}
+
+#if (LOSCFG_USE_SHELL == 1)
+static UINT32 OhosMemShellCmd(UINT32 argc, const CHAR **argv)
+{
+    OhosMemTypeStats t;
+    OhosSlabStats s;
+    (void)argc;
+    (void)argv;
+    printf("%4s %8s %8s %8s %8s %8s %6s\r\n", "type", "cur", "peak", "allocs", "frees", "slab", "fails");
+    for (uint32_t i = 0; i < OHOS_MEM_TYPE_STATS_MAX; i++) {
+        if ((OhosMemGetTypeStats(i, &t) == 0) && (t.allocs > 0)) {
+            printf("%4u %8u %8u %8u %8u %8u %6u\r\n", i, t.curBytes, t.peakBytes, t.allocs, t.frees, t.slabAllocs,
+                   t.fails);
+        }
+    }
+    printf("%6s %6s %6s %6s %9s\r\n", "block", "total", "used", "peak", "overflow");
+    for (uint32_t i = 0; i < OHOS_SLAB_CLASS_NUM; i++) {
+        if (OhosMemGetSlabStats(i, &s) == 0) {
+            printf("%6u %6u %6u %6u %9u\r\n", s.blkSize, s.blkNum, s.used, s.peak, s.overflows);
+        }
+    }
+    return LOS_OK;
+}
+
+static void OhosMemShellInit(void)
+{
+    (void)osCmdReg(CMD_TYPE_EX, "mempool", 0, (CmdCallBackFunc)OhosMemShellCmd);
 }
+SYS_RUN(OhosMemShellInit);
+#endif
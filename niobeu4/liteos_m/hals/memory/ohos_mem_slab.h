@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __OHOS_MEM_SLAB_H__
+#define __OHOS_MEM_SLAB_H__
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * OhosMalloc 的小块请求按大小落入固定块池 (slab), 分配与释放均为 O(1), 不产生碎片;
+ * 超出最大块或对应池已满时回退到系统堆. 统计按 MemType 与块大小分别记录.
+ */
+#define OHOS_SLAB_CLASS_NUM 4
+#define OHOS_MEM_TYPE_STATS_MAX 16      // 超出的 MemType 计入最后一项
+
+typedef struct {
+    uint32_t curBytes;                  // 当前占用, 固定块按块大小计
+    uint32_t peakBytes;
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t slabAllocs;                // 其中由固定块池满足的次数
+    uint32_t fails;
+} OhosMemTypeStats;
+
+typedef struct {
+    uint16_t blkSize;
+    uint16_t blkNum;
+    uint16_t used;
+    uint16_t peak;
+    uint32_t overflows;                 // 池满回退到系统堆的次数
+} OhosSlabStats;
+
+int OhosMemGetTypeStats(uint32_t type, OhosMemTypeStats *stats);
+int OhosMemGetSlabStats(uint32_t index, OhosSlabStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
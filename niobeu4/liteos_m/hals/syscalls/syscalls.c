@@ -12,6 +12,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <errno.h>
 #include <unistd.h>
 #include "cmsis_os2.h"
 #include "los_compiler.h"
@@ -23,15 +24,16 @@
 #include "pthread.h"
 #include "samgr_lite.h"
 #include "stdio.h"
+#include "crash_log.h"
 
 #define DELAY_1S 1000
-#define DELAY_10S (DELAY_1S * 10)
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wattribute-alias"
 static int s_raise(int sig)
 {
     if (SIGABRT == sig) {
+        CrashLogCapture(CRASH_REASON_ABORT);
         LOS_TaskDelete(LOS_CurTaskIDGet());
         while (1) {
             LOS_Msleep(DELAY_1S);
@@ -96,15 +98,13 @@ int _kill_r(struct _reent *r, int pid, int sig)
     return LOS_TaskDelete(pid);
 }
 
+// malloc 由 heap_caps 实现, 不使用 sbrk 堆, 返回失败由调用者得到 NULL
 void *_sbrk_r(struct _reent *r, ptrdiff_t sz)
 {
     char *name;
     UINT32 taskId = LOS_CurTaskIDGet();
     name = LOS_TaskNameGet(taskId);
-    esp_rom_printf("\e[0;36msbrk.taskName=%s taskId=%d\e[0m\r\n", name ? name : "NULL", taskId);
-    LOS_TaskDelete(taskId);
-    LOS_TaskSuspend(taskId);
-    while (1) {
-        LOS_TaskDelay(DELAY_10S);
-    }
+    esp_rom_printf("\e[0;36msbrk.taskName=%s taskId=%d size=%d\e[0m\r\n", name ? name : "NULL", taskId, (int)sz);
+    r->_errno = ENOMEM;
+    return (void *)-1;
 }
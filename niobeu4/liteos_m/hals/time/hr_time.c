@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include "los_interrupt.h"
+#include "los_sem.h"
+#include "los_tick.h"
+#include "los_arch_interrupt.h"
+#include "los_arch_timer.h"
+#include "esp_intr_alloc.h"
+#include "soc/soc.h"
+#include "ohos_init.h"
+#include "hr_time.h"
+
+#define HR_NS_PER_SECOND 1000000000ULL
+#define HR_US_PER_SECOND 1000000ULL
+#define HR_TIMER_DIVIDER 2              // 与内核 T0 相同的计数频率 OS_SYS_CLOCK
+#define HR_TIMER_HI_SHIFT 32
+#define HR_SLOT_CYCLES (OS_SYS_CLOCK / HR_US_PER_SECOND * HR_TIMER_SLOT_US)
+#define HR_DELAY_SPIN_MAX_US 200        // 短于此值直接忙等, 省去信号量与中断开销
+
+typedef struct {
+    HrTimer *wheel[HR_TIMER_WHEEL_SIZE];
+    uint64_t curSlot;                   // 之前的槽均已处理
+    uint64_t offset;                    // T0 与 T1 计数值之差, 浅睡眠后 T0 被补齐, 每次设置比较值前重新测量
+    uint32_t activeNum;
+    uint8_t ready;
+} HrTime_t;
+
+static HrTime_t HrTime;
+static volatile Systick_t *const HrAlarm = (volatile Systick_t *)TIM1_GROUP0;
+
+static uint64_t HrCycleToNs(uint64_t cycle)
+{
+    return (cycle / OS_SYS_CLOCK) * HR_NS_PER_SECOND + (cycle % OS_SYS_CLOCK) * HR_NS_PER_SECOND / OS_SYS_CLOCK;
+}
+
+static uint64_t HrUsToCycle(uint32_t us)
+{
+    return (uint64_t)us * OS_SYS_CLOCK / HR_US_PER_SECOND;
+}
+
+uint64_t GetMonotonicNs(void)
+{
+    return HrCycleToNs(LOS_SysCycleGet());
+}
+
+uint64_t GetMonotonicUs(void)
+{
+    return LOS_SysCycleGet() / (OS_SYS_CLOCK / HR_US_PER_SECOND);
+}
+
+// 以下函数调用者持有中断锁
+static uint64_t HrAlarmRead(void)
+{
+    HrAlarm->UPDATE = 1;
+    return ((uint64_t)HrAlarm->VAL_HI << HR_TIMER_HI_SHIFT) | HrAlarm->VAL_LO;
+}
+
+static void HrWheelAdd(HrTimer *timer)
+{
+    uint64_t slot = timer->expire / HR_SLOT_CYCLES;
+    // 已过期的放入当前槽, 下一次处理时立即到期
+    timer->slot = (slot < HrTime.curSlot) ? HrTime.curSlot : slot;
+    timer->next = HrTime.wheel[timer->slot % HR_TIMER_WHEEL_SIZE];
+    HrTime.wheel[timer->slot % HR_TIMER_WHEEL_SIZE] = timer;
+    timer->active = 1;
+    HrTime.activeNum++;
+}
+
+static void HrWheelDel(HrTimer *timer)
+{
+    HrTimer **pp = &HrTime.wheel[timer->slot % HR_TIMER_WHEEL_SIZE];
+    while (*pp != NULL) {
+        if (*pp == timer) {
+            *pp = timer->next;
+            break;
+        }
+        pp = &(*pp)->next;
+    }
+    timer->next = NULL;
+    timer->active = 0;
+    HrTime.activeNum--;
+}
+
+static HrTimer *HrWheelPopExpired(uint32_t index, uint64_t now)
+{
+    HrTimer *timer = HrTime.wheel[index];
+    while ((timer != NULL) && (timer->expire > now)) {
+        timer = timer->next;
+    }
+    if (timer != NULL) {
+        HrWheelDel(timer);
+    }
+    return timer;
+}
+
+// 一圈之内找到第一个有本圈定时器的槽, 取其中最早的到期时刻; 都没有时再查找所有槽
+static uint64_t HrWheelNext(void)
+{
+    uint64_t next = UINT64_MAX;
+    HrTimer *timer = NULL;
+    for (uint32_t i = 0; (i < HR_TIMER_WHEEL_SIZE) && (next == UINT64_MAX); i++) {
+        uint64_t slot = HrTime.curSlot + i;
+        for (timer = HrTime.wheel[slot % HR_TIMER_WHEEL_SIZE]; timer != NULL; timer = timer->next) {
+            if ((timer->slot == slot) && (timer->expire < next)) {
+                next = timer->expire;
+            }
+        }
+    }
+    for (uint32_t i = 0; (i < HR_TIMER_WHEEL_SIZE) && (next == UINT64_MAX); i++) {
+        for (timer = HrTime.wheel[i]; timer != NULL; timer = timer->next) {
+            next = (timer->expire < next) ? timer->expire : next;
+        }
+    }
+    return next;
+}
+
+// 比较值已过时硬件立即触发
+static void HrAlarmProgram(void)
+{
+    uint64_t next = HrWheelNext();
+    uint64_t alarm;
+    if (next == UINT64_MAX) {
+        HrAlarm->CTRL &= ~TIM_CTRL_ALARM_EN;
+        return;
+    }
+    HrTime.offset = LOS_SysCycleGet() - HrAlarmRead();
+    alarm = next - HrTime.offset;
+    HrAlarm->ALARM_HI = (uint32_t)(alarm >> HR_TIMER_HI_SHIFT);
+    HrAlarm->ALARM_LO = (uint32_t)alarm;
+    HrAlarm->CTRL |= TIM_CTRL_ALARM_EN;
+}
+
+static void HrWheelExpire(void)
+{
+    UINT32 intSave = LOS_IntLock();
+    uint64_t now = LOS_SysCycleGet();
+    uint64_t nowSlot = now / HR_SLOT_CYCLES;
+    HrTimer *timer = NULL;
+    // 落后超过一圈时每个槽只需处理一次
+    if (nowSlot - HrTime.curSlot >= HR_TIMER_WHEEL_SIZE) {
+        HrTime.curSlot = nowSlot - HR_TIMER_WHEEL_SIZE + 1;
+    }
+    // 当前槽中尚未到期的定时器保留, curSlot 不越过当前槽
+    for (;; HrTime.curSlot++) {
+        while ((timer = HrWheelPopExpired(HrTime.curSlot % HR_TIMER_WHEEL_SIZE, now)) != NULL) {
+            if (timer->period != 0) {
+                timer->expire += timer->period;
+                // 回调耗时超过周期时跳过错过的周期
+                if (timer->expire <= now) {
+                    timer->expire = now + timer->period;
+                }
+                HrWheelAdd(timer);
+            }
+            LOS_IntRestore(intSave);
+            timer->func(timer->arg);
+            intSave = LOS_IntLock();
+        }
+        if (HrTime.curSlot == nowSlot) {
+            break;
+        }
+    }
+    HrAlarmProgram();
+    LOS_IntRestore(intSave);
+}
+
+static void HrAlarmIsr(void *arg)
+{
+    (void)arg;
+    *(volatile uint32_t *)TIM0_INT_CLEAR_GROUP0 = TIM1_INT_BIT;
+    HrWheelExpire();
+}
+
+void HrTimerInit(HrTimer *timer, HrTimerFunc func, void *arg)
+{
+    timer->next = NULL;
+    timer->expire = 0;
+    timer->slot = 0;
+    timer->period = 0;
+    timer->func = func;
+    timer->arg = arg;
+    timer->active = 0;
+}
+
+static int HrTimerArm(HrTimer *timer, uint64_t expire, uint64_t period)
+{
+    UINT32 intSave;
+    if ((timer == NULL) || (timer->func == NULL) || !HrTime.ready) {
+        return -1;
+    }
+    intSave = LOS_IntLock();
+    if (timer->active) {
+        HrWheelDel(timer);
+    }
+    timer->expire = expire;
+    timer->period = period;
+    HrWheelAdd(timer);
+    HrAlarmProgram();
+    LOS_IntRestore(intSave);
+    return 0;
+}
+
+int HrTimerStart(HrTimer *timer, uint32_t timeoutUs, uint32_t periodUs)
+{
+    return HrTimerArm(timer, LOS_SysCycleGet() + HrUsToCycle(timeoutUs), HrUsToCycle(periodUs));
+}
+
+void HrTimerStop(HrTimer *timer)
+{
+    UINT32 intSave;
+    if (timer == NULL) {
+        return;
+    }
+    intSave = LOS_IntLock();
+    if (timer->active) {
+        HrWheelDel(timer);
+        if (HrTime.ready) {
+            HrAlarmProgram();
+        }
+    }
+    LOS_IntRestore(intSave);
+}
+
+int HrTimerPending(void)
+{
+    return HrTime.activeNum != 0;
+}
+
+static void HrDelayWake(void *arg)
+{
+    (void)LOS_SemPost((UINT32)(uintptr_t)arg);
+}
+
+// 阻塞到 end, 锁调度时 LOS_SemPend 立即失败, 由调用者忙等
+static void HrDelaySleep(uint64_t end)
+{
+    HrTimer timer;
+    UINT32 sem;
+    if (LOS_BinarySemCreate(0, &sem) != LOS_OK) {
+        return;
+    }
+    HrTimerInit(&timer, HrDelayWake, (void *)(uintptr_t)sem);
+    if (HrTimerArm(&timer, end, 0) == 0) {
+        (void)LOS_SemPend(sem, LOS_WAIT_FOREVER);
+        HrTimerStop(&timer);
+    }
+    (void)LOS_SemDelete(sem);
+}
+
+// 中断中或关中断时不能挂起任务, 只忙等
+void DelayUs(uint32_t us)
+{
+    uint64_t end = LOS_SysCycleGet() + HrUsToCycle(us);
+    if ((us >= HR_DELAY_SPIN_MAX_US) && HrTime.ready && !OS_INT_ACTIVE && !ArchIntLocked()) {
+        HrDelaySleep(end);
+    }
+    while (LOS_SysCycleGet() < end) {
+    }
+}
+
+static void HrTimeStart(void)
+{
+    UINT32 intSave;
+    // 分频只能在计数器停止时修改
+    HrAlarm->CTRL = TIM_CTRL_INCREASE | (HR_TIMER_DIVIDER << TIM_CTRL_DIVIDER_SHIFT) | TIM_CTRL_LEVEL_INT_EN;
+    HrAlarm->LOAD_LO = 0;
+    HrAlarm->LOAD_HI = 0;
+    HrAlarm->LOAD_TRI = 1;
+    // 回调位于 flash, 不使用 IRAM 中断, 擦写 flash 期间到期的定时器延后执行
+    if (esp_intr_alloc(ETS_TG0_T1_LEVEL_INTR_SOURCE, 0, HrAlarmIsr, NULL, NULL) != ESP_OK) {
+        printf("hr_time: alarm interrupt alloc failed\r\n");
+        return;
+    }
+    intSave = LOS_IntLock();
+    HrAlarm->CTRL |= TIM_CTRL_EN;
+    // T1 与 T0 同频, 连续读取两者得到固定差值, 误差为几个计数周期
+    HrTime.offset = LOS_SysCycleGet() - HrAlarmRead();
+    HrTime.curSlot = LOS_SysCycleGet() / HR_SLOT_CYCLES;
+    *(volatile uint32_t *)TIM0_INT_ENABLE_GROUP0 |= TIM1_INT_BIT;
+    HrTime.ready = 1;
+    LOS_IntRestore(intSave);
+}
+SYS_RUN(HrTimeStart);
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __HR_TIME_H__
+#define __HR_TIME_H__
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 高精度时间: 以内核 64 位硬件计数器 (定时器组 0 T0, OS_SYS_CLOCK) 为基准的单调时间与微秒延时,
+ * 以及由定时器组 0 T1 比较中断驱动的高精度软件定时器, 用于节拍 (10ms) 以下的超时.
+ * 定时器按到期时间落入时间轮的槽中, 插入与删除不排序; 比较中断只在最近一个到期点触发.
+ */
+#define HR_TIMER_WHEEL_SIZE 64
+#define HR_TIMER_SLOT_US 100            // 每槽 100us, 一圈 6.4ms, 更远的定时器在对应槽中等待多圈
+
+typedef void (*HrTimerFunc)(void *arg);
+
+typedef struct HrTimer {
+    struct HrTimer *next;
+    uint64_t expire;                    // 到期时刻, 计数器周期
+    uint64_t slot;
+    uint64_t period;                    // 0 为单次
+    HrTimerFunc func;
+    void *arg;
+    uint8_t active;
+} HrTimer;
+
+/**
+ * @brief 自启动以来的单调时间, 可在中断中调用
+ */
+uint64_t GetMonotonicNs(void);
+uint64_t GetMonotonicUs(void);
+
+/**
+ * @brief 延时指定微秒, 任务中较长的延时由高精度定时器唤醒, 其余情况忙等
+ *
+ * 在关中断或锁调度的任务中调用时只忙等, 因此应避免长时间延时.
+ */
+void DelayUs(uint32_t us);
+
+/**
+ * @brief 初始化定时器对象, 对象由调用者持有, 停止前不能释放
+ */
+void HrTimerInit(HrTimer *timer, HrTimerFunc func, void *arg);
+
+/**
+ * @brief 启动或重启定时器, 回调在中断上下文中执行, 应尽量简短
+ *
+ * @param timeoutUs 首次到期的相对时间
+ * @param periodUs 周期, 0 为单次
+ * @return 0 成功, -1 参数错误或硬件未就绪
+ */
+int HrTimerStart(HrTimer *timer, uint32_t timeoutUs, uint32_t periodUs);
+
+/**
+ * @brief 停止定时器, 返回后回调不会再被调用 (已在执行中的除外)
+ */
+void HrTimerStop(HrTimer *timer);
+
+/**
+ * @brief 是否有已启动的定时器, 空闲浅睡眠时 T1 停止计数, 有定时器时不应进入
+ */
+int HrTimerPending(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
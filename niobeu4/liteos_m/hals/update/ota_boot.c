@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include "los_task.h"
+#include "nvs.h"
+#include "ohos_init.h"
+#include "ota_boot.h"
+
+#define OTA_NVS_NAMESPACE "ota"
+#define OTA_NVS_KEY "boot"
+#define OTA_BOOT_VERSION 1
+#define OTA_HEALTH_TASK_PRIO 30
+#define OTA_HEALTH_TASK_STACK 0x800
+
+typedef struct {
+    uint8_t version;
+    uint8_t status;
+    uint8_t attempts;
+    uint8_t reserved;
+    uint32_t newPart;
+    uint32_t oldPart;
+} OtaBootState;
+
+static OtaBootState OtaBoot;
+
+void panic_restart(void);
+
+static int OtaBootSave(void)
+{
+    nvs_handle_t handle;
+    esp_err_t err;
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return -1;
+    }
+    err = nvs_set_blob(handle, OTA_NVS_KEY, &OtaBoot, sizeof(OtaBoot));
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return (err == ESP_OK) ? 0 : -1;
+}
+
+static void OtaBootLoad(void)
+{
+    size_t size = sizeof(OtaBoot);
+    nvs_handle_t handle;
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    if ((nvs_get_blob(handle, OTA_NVS_KEY, &OtaBoot, &size) != ESP_OK) || (size != sizeof(OtaBoot)) ||
+        (OtaBoot.version != OTA_BOOT_VERSION)) {
+        OtaBoot.status = OTA_BOOT_IDLE;
+    }
+    nvs_close(handle);
+}
+
+int OtaBootSwitch(const OtaFlashPart *part)
+{
+    OtaFlashPart running;
+    if ((part == NULL) || (OtaFlashGetRunningPart(&running) != 0)) {
+        return -1;
+    }
+    // 先记录待确认状态再切换, 切换前掉电时记录中的新分区与实际运行分区不符, 下次启动即清除
+    OtaBoot.version = OTA_BOOT_VERSION;
+    OtaBoot.status = OTA_BOOT_PENDING;
+    OtaBoot.attempts = 0;
+    OtaBoot.newPart = part->id;
+    OtaBoot.oldPart = running.id;
+    if (OtaBootSave() != 0) {
+        return -1;
+    }
+    if (OtaFlashSetBootPart(part) != 0) {
+        OtaBoot.status = OTA_BOOT_IDLE;
+        (void)OtaBootSave();
+        return -1;
+    }
+    return 0;
+}
+
+void OtaBootConfirm(void)
+{
+    if (OtaBoot.status != OTA_BOOT_PENDING) {
+        return;
+    }
+    if (OtaFlashMarkValid() != 0) {
+        printf("ota: mark app valid failed\r\n");
+    }
+    OtaBoot.status = OTA_BOOT_CONFIRMED;
+    (void)OtaBootSave();
+    printf("ota: image confirmed\r\n");
+}
+
+static void OtaBootRollback(void)
+{
+    OtaFlashPart old;
+    printf("ota: rollback after %u boots\r\n", OtaBoot.attempts);
+    OtaBoot.status = OTA_BOOT_ROLLED_BACK;
+    (void)OtaBootSave();
+    // 优先由引导程序回退, 它同时把新镜像标记为无效; 不支持时改写启动分区
+    (void)OtaFlashRollback();
+    if ((OtaFlashFindPart(OtaBoot.oldPart, &old) != 0) || (OtaFlashSetBootPart(&old) != 0)) {
+        OtaBoot.status = OTA_BOOT_PENDING;
+        (void)OtaBootSave();
+        return;
+    }
+    panic_restart();
+}
+
+__attribute__((weak)) int OtaHealthCheck(void)
+{
+    return 0;
+}
+
+static void OtaHealthTask(void)
+{
+    LOS_Msleep(OTA_HEALTH_CHECK_MS);
+    if (OtaHealthCheck() == 0) {
+        OtaBootConfirm();
+    } else {
+        OtaBootRollback();
+    }
+}
+
+static void OtaBootCheck(void)
+{
+    OtaFlashPart running;
+    TSK_INIT_PARAM_S param = {0};
+    UINT32 taskId;
+    OtaBootLoad();
+    if ((OtaBoot.status != OTA_BOOT_PENDING) || (OtaFlashGetRunningPart(&running) != 0)) {
+        return;
+    }
+    if (running.id != OtaBoot.newPart) {
+        // 引导程序未能启动新镜像, 或切换前掉电
+        OtaBoot.status = (running.id == OtaBoot.oldPart) ? OTA_BOOT_ROLLED_BACK : OTA_BOOT_IDLE;
+        (void)OtaBootSave();
+        return;
+    }
+    if (++OtaBoot.attempts > OTA_BOOT_ATTEMPTS_MAX) {
+        OtaBootRollback();
+        return;
+    }
+    (void)OtaBootSave();
+    param.pfnTaskEntry = (TSK_ENTRY_FUNC)OtaHealthTask;
+    param.uwStackSize = OTA_HEALTH_TASK_STACK;
+    param.pcName = "ota_health";
+    param.usTaskPrio = OTA_HEALTH_TASK_PRIO;
+    if (LOS_TaskCreate(&taskId, &param) != LOS_OK) {
+        printf("ota: health check task create failed\r\n");
+    }
+}
+SYS_RUN(OtaBootCheck);
+
+OtaBootStatus OtaBootGetStatus(void)
+{
+    return (OtaBootStatus)OtaBoot.status;
+}
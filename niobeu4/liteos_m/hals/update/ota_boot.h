@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __OTA_BOOT_H__
+#define __OTA_BOOT_H__
+#include <stdint.h>
+#include "ota_flash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 启动分区切换与回退. 切换后新镜像处于待确认状态, 每次启动计数一次;
+ * 运行 OTA_HEALTH_CHECK_MS 后 OtaHealthCheck 返回 0 则确认, 否则或启动次数超过
+ * OTA_BOOT_ATTEMPTS_MAX 时切回原分区并重启. 状态保存在 NVS.
+ * 开启 CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE 时确认与回退交给引导程序, 新镜像未确认即复位也会回退.
+ */
+#define OTA_BOOT_ATTEMPTS_MAX 3
+#define OTA_HEALTH_CHECK_MS 30000
+
+typedef enum {
+    OTA_BOOT_IDLE = 0,
+    OTA_BOOT_PENDING,
+    OTA_BOOT_CONFIRMED,
+    OTA_BOOT_ROLLED_BACK,
+} OtaBootStatus;
+
+/**
+ * @brief 把 part 设为下次启动分区, 并记录当前分区用于回退
+ */
+int OtaBootSwitch(const OtaFlashPart *part);
+
+/**
+ * @brief 确认当前镜像可用, 取消回退
+ */
+void OtaBootConfirm(void);
+
+/**
+ * @brief 新镜像的健康检查, 板级可重新实现, 返回 0 表示正常
+ */
+int OtaHealthCheck(void);
+
+OtaBootStatus OtaBootGetStatus(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+"""Binary delta between two app images for delta OTA packages (ota_writer.h).
+
+Usage:
+  ota_delta.py old.bin new.bin patch.bin
+
+The patch is a stream of COPY/INSERT records applied in place on the device:
+COPY takes bytes from the running image, INSERT carries new bytes literally.
+Matches are exact, so an unchanged function that merely moved costs a few bytes
+of control data instead of a diff block. For compressed delta packages each
+INSERT carries an ota_lz.py LZ4 block whose matches may also reach into the
+copied parts of the new image. make_delta() checks its own output with
+apply_delta() before returning.
+"""
+
+import struct
+import sys
+
+from ota_lz import compress, decode_block, index
+
+OP_COPY = 1
+OP_INSERT = 2
+BLOCK = 32
+STEP = 4
+MIN_COPY = 24
+
+
+def leb128(value):
+    out = bytearray()
+    while True:
+        b = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def zigzag(value):
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def read_leb128(data, pos):
+    value = shift = 0
+    while True:
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value, pos
+
+
+def _index(old):
+    index = {}
+    for i in range(0, len(old) - BLOCK + 1, STEP):
+        index.setdefault(old[i:i + BLOCK], i)
+    return index
+
+
+def make_delta(old, new, window=None):
+    """Return the COPY/INSERT record stream that turns `old` into `new`.
+
+    With `window` the INSERT data is LZ4 compressed, matches at most `window` bytes back.
+    """
+    blocks = _index(old)
+    table = {}
+    indexed = 0
+    out = bytearray()
+    base = 0
+    pos = 0
+    lit = pos
+
+    def flush_insert(end):
+        nonlocal indexed
+        if end <= lit:
+            return
+        data = new[lit:end]
+        if window is not None:
+            index(new, indexed, lit, table)
+            data = compress(new, window, lit, end, table)
+            indexed = end
+        out.extend(bytes([OP_INSERT]) + leb128(end - lit) + data)
+
+    while pos + BLOCK <= len(new):
+        src = blocks.get(new[pos:pos + BLOCK])
+        if src is None:
+            pos += 1
+            continue
+        # grow the match backwards over pending literals
+        while pos > lit and src > 0 and old[src - 1] == new[pos - 1]:
+            src -= 1
+            pos -= 1
+        end = pos + BLOCK
+        while end < len(new) and src + end - pos < len(old) and old[src + end - pos] == new[end]:
+            end += 1
+        if end - pos < MIN_COPY:
+            pos += 1
+            continue
+        flush_insert(pos)
+        out.extend(bytes([OP_COPY]) + leb128(end - pos) + leb128(zigzag(src - base)))
+        base = src + end - pos
+        pos = lit = end
+    flush_insert(len(new))
+    patch = bytes(out)
+    if apply_delta(old, patch, window is not None) != new:
+        raise RuntimeError('delta self-check failed')
+    return patch
+
+
+def apply_delta(old, patch, lz=False):
+    """Reference decoder, mirrors OtaWriterPayload(); `lz` for LZ4 compressed INSERT data."""
+    new = bytearray()
+    base = pos = 0
+    while pos < len(patch):
+        op = patch[pos]
+        count, pos = read_leb128(patch, pos + 1)
+        if op == OP_COPY:
+            delta, pos = read_leb128(patch, pos)
+            base += (delta >> 1) ^ -(delta & 1)
+            if base < 0 or base + count > len(old):
+                raise ValueError('copy outside the base image')
+            new += old[base:base + count]
+            base += count
+        elif op == OP_INSERT and lz:
+            pos = decode_block(patch, pos, new, len(new) + count)
+        elif op == OP_INSERT:
+            new += patch[pos:pos + count]
+            pos += count
+        else:
+            raise ValueError('bad op %d at %d' % (op, pos - 1))
+    return bytes(new)
+
+
+def main():
+    if len(sys.argv) != 4:
+        raise SystemExit(__doc__)
+    with open(sys.argv[1], 'rb') as f:
+        old = f.read()
+    with open(sys.argv[2], 'rb') as f:
+        new = f.read()
+    patch = make_delta(old, new)
+    with open(sys.argv[3], 'wb') as f:
+        f.write(patch)
+    print('%d -> %d bytes (%.1f%% of the new image)' % (len(new), len(patch), 100.0 * len(patch) / max(len(new), 1)))
+
+
+if __name__ == '__main__':
+    main()
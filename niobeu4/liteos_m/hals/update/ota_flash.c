@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stddef.h>
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "sdkconfig.h"
+#include "ota_flash.h"
+
+static void OtaFlashPartFrom(const esp_partition_t *p, OtaFlashPart *part)
+{
+    part->id = p->address;
+    part->size = p->size;
+    part->handle = p;
+}
+
+int OtaFlashGetUpdatePart(OtaFlashPart *part)
+{
+    const esp_partition_t *p = esp_ota_get_next_update_partition(NULL);
+    if ((part == NULL) || (p == NULL)) {
+        return -1;
+    }
+    OtaFlashPartFrom(p, part);
+    return 0;
+}
+
+int OtaFlashGetRunningPart(OtaFlashPart *part)
+{
+    const esp_partition_t *p = esp_ota_get_running_partition();
+    if ((part == NULL) || (p == NULL)) {
+        return -1;
+    }
+    OtaFlashPartFrom(p, part);
+    return 0;
+}
+
+int OtaFlashFindPart(uint32_t id, OtaFlashPart *part)
+{
+    esp_partition_iterator_t it;
+    int ret = -1;
+    if (part == NULL) {
+        return -1;
+    }
+    it = esp_partition_find(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, NULL);
+    for (; it != NULL; it = esp_partition_next(it)) {
+        const esp_partition_t *p = esp_partition_get(it);
+        if (p->address == id) {
+            OtaFlashPartFrom(p, part);
+            ret = 0;
+            break;
+        }
+    }
+    esp_partition_iterator_release(it);
+    return ret;
+}
+
+int OtaFlashRead(const OtaFlashPart *part, uint32_t offset, void *buf, uint32_t len)
+{
+    return (esp_partition_read(part->handle, offset, buf, len) == ESP_OK) ? 0 : -1;
+}
+
+int OtaFlashWrite(const OtaFlashPart *part, uint32_t offset, const void *buf, uint32_t len)
+{
+    return (esp_partition_write(part->handle, offset, buf, len) == ESP_OK) ? 0 : -1;
+}
+
+int OtaFlashErase(const OtaFlashPart *part, uint32_t offset, uint32_t len)
+{
+    return (esp_partition_erase_range(part->handle, offset, len) == ESP_OK) ? 0 : -1;
+}
+
+int OtaFlashSetBootPart(const OtaFlashPart *part)
+{
+    // otadata 两个扇区交替写入并带序号与 CRC, 掉电时保留原启动分区
+    return (esp_ota_set_boot_partition(part->handle) == ESP_OK) ? 0 : -1;
+}
+
+int OtaFlashMarkValid(void)
+{
+#ifdef CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+    // 新镜像首次启动处于 PENDING_VERIFY, 未确认即复位时引导程序自动回退
+    return (esp_ota_mark_app_valid_cancel_rollback() == ESP_OK) ? 0 : -1;
+#else
+    return 0;
+#endif
+}
+
+int OtaFlashRollback(void)
+{
+#ifdef CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+    (void)esp_ota_mark_app_invalid_rollback_and_reboot();
+#endif
+    return -1;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __OTA_FLASH_H__
+#define __OTA_FLASH_H__
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * OTA 使用的 flash 分区接口. ota_flash.c 基于 ESP-IDF 的 app 分区与 otadata 实现,
+ * xts 构建使用 ota_flash_ram.c 的内存模拟分区, 升级流程可在无真实 flash 写入的情况下验证.
+ */
+#define OTA_FLASH_SECTOR_SIZE 4096
+
+typedef struct {
+    uint32_t id;                        // 分区标识, 用于跨复位记录
+    uint32_t size;
+    const void *handle;
+} OtaFlashPart;
+
+/**
+ * @brief 获取下一次升级写入的分区, 即当前未运行的 app 分区
+ */
+int OtaFlashGetUpdatePart(OtaFlashPart *part);
+
+/**
+ * @brief 获取当前运行的 app 分区
+ */
+int OtaFlashGetRunningPart(OtaFlashPart *part);
+
+/**
+ * @brief 按 id 查找 app 分区
+ */
+int OtaFlashFindPart(uint32_t id, OtaFlashPart *part);
+
+int OtaFlashRead(const OtaFlashPart *part, uint32_t offset, void *buf, uint32_t len);
+int OtaFlashWrite(const OtaFlashPart *part, uint32_t offset, const void *buf, uint32_t len);
+
+/**
+ * @brief 擦除分区, offset 与 len 需按 OTA_FLASH_SECTOR_SIZE 对齐
+ */
+int OtaFlashErase(const OtaFlashPart *part, uint32_t offset, uint32_t len);
+
+/**
+ * @brief 设置下次启动的分区, 启动信息的更新是原子的
+ */
+int OtaFlashSetBootPart(const OtaFlashPart *part);
+
+/**
+ * @brief 确认当前运行的镜像可用, 引导程序不再回退
+ */
+int OtaFlashMarkValid(void);
+
+/**
+ * @brief 由引导程序回退到上一个可用镜像并重启, 成功时不返回; 不支持时返回 -1
+ */
+int OtaFlashRollback(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
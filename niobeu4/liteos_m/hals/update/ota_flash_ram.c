@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include "securec.h"
+#include "ota_flash.h"
+
+#ifndef OTA_RAM_PART_SIZE
+#define OTA_RAM_PART_SIZE (32 * 1024)
+#endif
+#define OTA_RAM_PART_RUNNING 0
+#define OTA_RAM_PART_UPDATE 1
+#define OTA_RAM_ERASED 0xFF
+
+/* 模拟的升级分区; 运行分区默认只有标识没有内容, 定义 OTA_RAM_RUNNING_SIZE 时可读, 用于验证差分升级 */
+static uint8_t OtaRamPart[OTA_RAM_PART_SIZE];
+#ifdef OTA_RAM_RUNNING_SIZE
+static uint8_t OtaRamRunning[OTA_RAM_RUNNING_SIZE];
+#define OTA_RAM_RUNNING_DATA OtaRamRunning
+#else
+#define OTA_RAM_RUNNING_SIZE 0
+#define OTA_RAM_RUNNING_DATA NULL
+#endif
+static uint32_t OtaRamBootId = OTA_RAM_PART_RUNNING;
+
+static int OtaRamRange(const OtaFlashPart *part, uint32_t offset, uint32_t len)
+{
+    if ((part == NULL) || (part->handle == NULL) || (offset > part->size) || (len > (part->size - offset))) {
+        return -1;
+    }
+    return 0;
+}
+
+int OtaFlashGetUpdatePart(OtaFlashPart *part)
+{
+    return OtaFlashFindPart(OTA_RAM_PART_UPDATE, part);
+}
+
+int OtaFlashGetRunningPart(OtaFlashPart *part)
+{
+    return OtaFlashFindPart(OTA_RAM_PART_RUNNING, part);
+}
+
+int OtaFlashFindPart(uint32_t id, OtaFlashPart *part)
+{
+    if ((part == NULL) || (id > OTA_RAM_PART_UPDATE)) {
+        return -1;
+    }
+    part->id = id;
+    part->size = (id == OTA_RAM_PART_UPDATE) ? OTA_RAM_PART_SIZE : OTA_RAM_RUNNING_SIZE;
+    part->handle = (id == OTA_RAM_PART_UPDATE) ? OtaRamPart : OTA_RAM_RUNNING_DATA;
+    return 0;
+}
+
+int OtaFlashRead(const OtaFlashPart *part, uint32_t offset, void *buf, uint32_t len)
+{
+    if (OtaRamRange(part, offset, len) != 0) {
+        return -1;
+    }
+    return (memcpy_s(buf, len, (const uint8_t *)part->handle + offset, len) == EOK) ? 0 : -1;
+}
+
+int OtaFlashWrite(const OtaFlashPart *part, uint32_t offset, const void *buf, uint32_t len)
+{
+    const uint8_t *src = (const uint8_t *)buf;
+    if ((OtaRamRange(part, offset, len) != 0) || (part->id != OTA_RAM_PART_UPDATE)) {
+        return -1;
+    }
+    // 与 NOR flash 一致, 写入只能把位从 1 变为 0
+    for (uint32_t i = 0; i < len; i++) {
+        OtaRamPart[offset + i] &= src[i];
+    }
+    return 0;
+}
+
+int OtaFlashErase(const OtaFlashPart *part, uint32_t offset, uint32_t len)
+{
+    if ((OtaRamRange(part, offset, len) != 0) || (part->id != OTA_RAM_PART_UPDATE) ||
+        ((offset % OTA_FLASH_SECTOR_SIZE) != 0) || ((len % OTA_FLASH_SECTOR_SIZE) != 0)) {
+        return -1;
+    }
+    (void)memset_s(OtaRamPart + offset, len, OTA_RAM_ERASED, len);
+    return 0;
+}
+
+int OtaFlashSetBootPart(const OtaFlashPart *part)
+{
+    if ((part == NULL) || (part->id > OTA_RAM_PART_UPDATE)) {
+        return -1;
+    }
+    OtaRamBootId = part->id;
+    return 0;
+}
+
+int OtaFlashMarkValid(void)
+{
+    return 0;
+}
+
+int OtaFlashRollback(void)
+{
+    return -1;
+}
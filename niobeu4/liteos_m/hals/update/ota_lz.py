@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+"""LZ4 block compression with a bounded match window for OTA packages (ota_writer.h).
+
+Usage:
+  ota_lz.py [--write-kbps N] [--read-kbps N] [--read-us N] OHOS_Image.bin
+
+The output is a standard LZ4 block, so any LZ4 decoder can read it, but matches
+never reach further back than `window` bytes. The device copies matches from
+the image it has already written, so the window costs no RAM there. A smaller
+window trades compression for fewer reads back from flash.
+
+For each window size the report gives the compressed size and the decompress-to-flash
+throughput. flash_decode() decodes the way OtaLzPayload() does, with one sector
+buffer in RAM and older output read back from flash, and it counts the read-backs.
+The host decode rate is the measured speed of that decoder. The device rate is the
+image size divided by the modelled flash time: erase and program the whole image,
+plus every read-back. The defaults are typical SPI NOR figures for the ESP32
+module; pass rates measured on the board to pick the window for it.
+"""
+
+import argparse
+import time
+
+MIN_MATCH = 4
+LAST_LITERALS = 5   # LZ4 block rules: the last 5 bytes are literals
+MF_LIMIT = 12       # and no match starts in the last 12 bytes
+LEN_MASK = 15
+WINDOW_MAX = 0xFFFF
+WINDOWS = (1024, 4096, 16384, WINDOW_MAX)
+SECTOR = 4096       # OTA_FLASH_SECTOR_SIZE, the decoder's output buffer
+WRITE_KBPS = 75     # sector erase (45 ms) plus 16 page programs (0.5 ms) per 4 KB
+READ_KBPS = 4000
+READ_US = 15        # fixed cost of each OtaFlashRead()
+
+
+def _length(out, n):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+
+def _sequence(out, literals, match_len, offset):
+    lit = len(literals)
+    ml = match_len - MIN_MATCH if match_len else 0
+    out.append((min(lit, LEN_MASK) << 4) | min(ml, LEN_MASK))
+    if lit >= LEN_MASK:
+        _length(out, lit - LEN_MASK)
+    out += literals
+    if not match_len:
+        return
+    out += offset.to_bytes(2, 'little')
+    if ml >= LEN_MASK:
+        _length(out, ml - LEN_MASK)
+
+
+def index(data, start, end, table):
+    """Add the match candidates in data[start:end] to `table` for later compress() calls."""
+    for pos in range(start, min(end, len(data) - MIN_MATCH + 1)):
+        table[data[pos:pos + MIN_MATCH]] = pos
+
+
+def compress(data, window=WINDOW_MAX, start=0, end=None, table=None):
+    """Greedy LZ4 block compression of data[start:end], matches limited to `window` bytes back.
+
+    Matches may reach back into data[:start], which the decoder has already produced;
+    `table` carries the match candidates over from earlier calls (see index()).
+    """
+    if not 0 < window <= WINDOW_MAX:
+        raise ValueError('window must be 1..%d' % WINDOW_MAX)
+    out = bytearray()
+    table = {} if table is None else table
+    size = len(data) if end is None else end
+    anchor = pos = start
+    while pos < size - MF_LIMIT:
+        key = data[pos:pos + MIN_MATCH]
+        ref = table.get(key)
+        table[key] = pos
+        if ref is None or pos - ref > window:
+            pos += 1
+            continue
+        end = pos + MIN_MATCH
+        limit = size - LAST_LITERALS
+        while end < limit and data[end] == data[ref + end - pos]:
+            end += 1
+        _sequence(out, data[anchor:pos], end - pos, pos - ref)
+        pos = anchor = end
+    _sequence(out, data[anchor:size], 0, 0)
+    packed = bytes(out)
+    history = bytearray(data[:start])
+    if decode_block(packed, 0, history, size) != len(packed) or history != data[:size]:
+        raise RuntimeError('lz4 self-check failed')
+    return packed
+
+
+def _read_length(data, pos, n):
+    if n == LEN_MASK:
+        while True:
+            b = data[pos]
+            pos += 1
+            n += b
+            if b != 255:
+                break
+    return n, pos
+
+
+def decode_block(data, pos, out, size=None):
+    """Append the LZ4 block at data[pos:] to `out` and return the position after it.
+
+    Matches may reach into what `out` already held. Without `size` the block runs to
+    the end of `data`; with it the block ends with the literals that fill `out` to
+    `size` bytes, as a compressed delta INSERT does on the device.
+    """
+    while True:
+        token = data[pos]
+        lit, pos = _read_length(data, pos + 1, token >> 4)
+        out += data[pos:pos + lit]
+        pos += lit
+        if (size is None and pos >= len(data)) or len(out) == size:
+            return pos
+        if size is not None and len(out) > size:
+            raise ValueError('block overruns %d bytes' % size)
+        offset = int.from_bytes(data[pos:pos + 2], 'little')
+        ml, pos = _read_length(data, pos + 2, token & LEN_MASK)
+        if offset == 0 or offset > len(out):
+            raise ValueError('bad offset %d' % offset)
+        for _ in range(ml + MIN_MATCH):
+            out.append(out[-offset])
+        if size is not None and len(out) >= size:
+            raise ValueError('block overruns %d bytes' % size)
+
+
+def decompress(data):
+    """Reference decoder, mirrors OtaLzPayload()."""
+    out = bytearray()
+    decode_block(data, 0, out)
+    return bytes(out)
+
+
+def flash_decode(data):
+    """Decode like OtaLzPayload(), return (image, flash reads, bytes read back).
+
+    Output collects in a SECTOR buffer that is written out when full. A match source
+    still in the buffer is copied in RAM. An older source is read back from flash, in
+    pieces that stop at the buffer end, the match end, the offset and the flushed data.
+    """
+    flash = bytearray()
+    buf = bytearray()
+    reads = read_bytes = 0
+    pos = 0
+    while True:
+        token = data[pos]
+        lit, pos = _read_length(data, pos + 1, token >> 4)
+        buf += data[pos:pos + lit]
+        pos += lit
+        while len(buf) >= SECTOR:
+            flash += buf[:SECTOR]
+            del buf[:SECTOR]
+        if pos >= len(data):
+            return bytes(flash + buf), reads, read_bytes
+        offset = int.from_bytes(data[pos:pos + 2], 'little')
+        remain, pos = _read_length(data, pos + 2, token & LEN_MASK)
+        remain += MIN_MATCH
+        if offset == 0 or offset > len(flash) + len(buf):
+            raise ValueError('bad offset %d' % offset)
+        while remain:
+            src = len(flash) + len(buf) - offset
+            n = min(SECTOR - len(buf), remain, offset)
+            if src >= len(flash):
+                buf += buf[src - len(flash):src - len(flash) + n]
+            else:
+                n = min(n, len(flash) - src)
+                buf += flash[src:src + n]
+                reads += 1
+                read_bytes += n
+            remain -= n
+            if len(buf) == SECTOR:
+                flash += buf
+                buf = bytearray()
+
+
+def benchmark(data, window, args):
+    """Return the report line for one window size."""
+    packed = compress(data, window)
+    start = time.perf_counter()
+    image, reads, read_bytes = flash_decode(packed)
+    host = time.perf_counter() - start
+    if image != data:
+        raise RuntimeError('flash_decode self-check failed')
+    device = len(data) / (args.write_kbps * 1024.0) + read_bytes / (args.read_kbps * 1024.0) + \
+        reads * args.read_us / 1e6
+    return 'window %5d: %d -> %d bytes (%.1f%%), %d flash reads (%d bytes), host decode %.1f MB/s, ' \
+        'to flash %.1f KB/s (write only %.1f KB/s)' % (
+            window, len(data), len(packed), 100.0 * len(packed) / max(len(data), 1), reads, read_bytes,
+            len(data) / max(host, 1e-9) / 1e6, len(data) / max(device, 1e-9) / 1024, args.write_kbps)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--write-kbps', type=float, default=WRITE_KBPS,
+                        help='flash erase plus program rate in KB/s (default %(default)s)')
+    parser.add_argument('--read-kbps', type=float, default=READ_KBPS,
+                        help='flash read rate in KB/s (default %(default)s)')
+    parser.add_argument('--read-us', type=float, default=READ_US,
+                        help='fixed cost of one flash read in us (default %(default)s)')
+    parser.add_argument('image', help='app image (.bin)')
+    args = parser.parse_args()
+    with open(args.image, 'rb') as f:
+        data = f.read()
+    for window in WINDOWS:
+        print(benchmark(data, window, args))
+
+
+if __name__ == '__main__':
+    main()
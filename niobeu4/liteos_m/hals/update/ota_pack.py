@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Build signed OTA packages for the update HAL (ota_writer.h).
+
+Usage:
+  ota_pack.py sign --key ota_key.pem OHOS_Image.bin ota.bin
+  ota_pack.py sign --key ota_key.pem --base old/OHOS_Image.bin OHOS_Image.bin ota.bin
+  ota_pack.py sign --key ota_key.pem --lz4 [--window 4096] OHOS_Image.bin ota.bin
+  ota_pack.py sign --key ota_key.pem --base old/OHOS_Image.bin --lz4 OHOS_Image.bin ota.bin
+  ota_pack.py pubkey --key ota_key.pem > ota_pubkey.h
+
+The package is an OtaImageHeader followed by the payload: the app image, or with
+--base an OtaDeltaHeader and the ota_delta.py patch against the image the device
+is running, or with --lz4 an OtaLzHeader and the ota_lz.py compressed image.
+With both, the OtaDeltaHeader is followed by an OtaLzHeader for the same image
+and every INSERT record of the patch carries an LZ4 block.
+The ECDSA P-256 signature covers the header fields before `sigLen` and, for a
+full image, the whole payload. For delta and LZ4 packages it covers the header
+fields and the OtaDeltaHeader/OtaLzHeader only: that header carries the SHA-256
+of the image the device reconstructs, so the device checks the signature as soon
+as the header arrives and compares the image hash at the end. Nothing about the
+compressed stream has to be hashed, which lets an interrupted download resume
+after a reset.
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+
+from cryptography.hazmat.primitives import hashes, serialization
+from cryptography.hazmat.primitives.asymmetric import ec
+
+from ota_delta import make_delta
+from ota_lz import WINDOW_MAX, compress
+
+MAGIC = 0x544F564F
+VERSION = 1
+SIG_MAX_LEN = 72
+SIGNED_FMT = '<IHHI'
+DELTA_FMT = '<II'
+FLAG_DELTA = 0x1
+FLAG_LZ4 = 0x2
+LZ_FMT = '<II'
+BYTES_PER_LINE = 12
+
+PUBKEY_HEADER = '''/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __OTA_PUBKEY_H__
+#define __OTA_PUBKEY_H__
+#include <stdint.h>
+
+/*
+ * 升级包签名公钥 (ECDSA P-256, SubjectPublicKeyInfo DER), 由 ota_pack.py pubkey 生成.
+ */
+static const uint8_t OtaPubKey[] = {
+'''
+
+
+def load_key(path):
+    with open(path, 'rb') as f:
+        key = serialization.load_pem_private_key(f.read(), password=None)
+    if not isinstance(key, ec.EllipticCurvePrivateKey) or key.curve.name != 'secp256r1':
+        raise SystemExit('%s: expected an ECDSA P-256 private key' % path)
+    return key
+
+
+def pack_header(payload_len, sig, flags=0):
+    signed = struct.pack(SIGNED_FMT, MAGIC, VERSION, flags, payload_len)
+    return signed + struct.pack('<I', len(sig)) + sig.ljust(SIG_MAX_LEN, b'\0')
+
+
+def delta_payload(base, image, window=None):
+    """Return (signed prefix, payload), with LZ4 compressed INSERT data if `window` is given."""
+    header = struct.pack(DELTA_FMT, len(base), len(image)) + hashlib.sha256(base).digest() + \
+        hashlib.sha256(image).digest()
+    if window is not None:
+        header += struct.pack(LZ_FMT, len(image), window) + hashlib.sha256(image).digest()
+    return header, header + make_delta(base, image, window)
+
+
+def lz_payload(image, window):
+    """Return (signed prefix, payload)."""
+    header = struct.pack(LZ_FMT, len(image), window) + hashlib.sha256(image).digest()
+    return header, header + compress(image, window)
+
+
+def build(key, image, base=None, lz4=False, window=WINDOW_MAX):
+    """Return the signed package for `image`, as a delta against `base` and/or LZ4 compressed."""
+    flags = 0
+    payload = signed_payload = image
+    if base is not None:
+        signed_payload, payload = delta_payload(base, image, window if lz4 else None)
+        flags = FLAG_DELTA | (FLAG_LZ4 if lz4 else 0)
+    elif lz4:
+        signed_payload, payload = lz_payload(image, window)
+        flags = FLAG_LZ4
+    signed = struct.pack(SIGNED_FMT, MAGIC, VERSION, flags, len(payload))
+    sig = key.sign(signed + signed_payload, ec.ECDSA(hashes.SHA256()))
+    return pack_header(len(payload), sig, flags) + payload
+
+
+def sign(args):
+    key = load_key(args.key)
+    with open(args.image, 'rb') as f:
+        image = f.read()
+    base = None
+    if args.base:
+        with open(args.base, 'rb') as f:
+            base = f.read()
+    package = build(key, image, base, args.lz4, args.window)
+    with open(args.output, 'wb') as f:
+        f.write(package)
+
+
+def pubkey(args):
+    der = load_key(args.key).public_key().public_bytes(serialization.Encoding.DER,
+                                                       serialization.PublicFormat.SubjectPublicKeyInfo)
+    out = [PUBKEY_HEADER]
+    for i in range(0, len(der), BYTES_PER_LINE):
+        out.append('    ' + ' '.join('0x%02x,' % b for b in der[i:i + BYTES_PER_LINE]) + '\n')
+    out.append('};\n\n#endif\n')
+    sys.stdout.write(''.join(out))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    p = sub.add_parser('sign', help='wrap an app image into a signed package')
+    p.add_argument('--key', required=True, help='PEM private key')
+    p.add_argument('--base', help='image running on the device, builds a delta package against it')
+    p.add_argument('--lz4', action='store_true', help='compress the image, or with --base the delta')
+    p.add_argument('--window', type=int, default=WINDOW_MAX, help='LZ4 match window in bytes (default %(default)s)')
+    p.add_argument('image', help='app image (.bin)')
+    p.add_argument('output', help='package to write')
+    p.set_defaults(func=sign)
+    p = sub.add_parser('pubkey', help='print ota_pubkey.h for the key')
+    p.add_argument('--key', required=True, help='PEM private key')
+    p.set_defaults(func=pubkey)
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __OTA_PUBKEY_H__
+#define __OTA_PUBKEY_H__
+#include <stdint.h>
+
+/*
+ * 升级包签名公钥 (ECDSA P-256, SubjectPublicKeyInfo DER).
+ * 当前为开发密钥, 量产前用 "ota_pack.py pubkey --key <私钥>" 重新生成本文件.
+ */
+static const uint8_t OtaPubKey[] = {
+    0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02,
+    0x01, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07, 0x03,
+    0x42, 0x00, 0x04, 0x4c, 0x45, 0xc3, 0x89, 0x61, 0x46, 0x79, 0xca, 0xb9,
+    0x45, 0xa9, 0x89, 0x50, 0xf7, 0xb4, 0x93, 0x24, 0xc6, 0x25, 0x58, 0xd7,
+    0x04, 0x7f, 0x40, 0xaa, 0xa3, 0x62, 0xf2, 0x1d, 0xda, 0x41, 0xcb, 0x98,
+    0xb5, 0xba, 0xd7, 0x1a, 0x9e, 0xab, 0x2a, 0x5b, 0xd5, 0x19, 0x50, 0xfc,
+    0x3c, 0x2c, 0x71, 0x55, 0xed, 0xf7, 0x33, 0xf9, 0x6b, 0x2f, 0xd5, 0xb8,
+    0x88, 0x3d, 0x70, 0x79, 0x40, 0x83, 0x56,
+};
+
+#endif
@@ -0,0 +1,1207 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "securec.h"
+#include "los_mux.h"
+#include "mbedtls/pk.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/version.h"
+#include "nvs.h"
+#include "ohos_init.h"
+#include "ota_boot.h"
+#include "ota_flash.h"
+#include "ota_pubkey.h"
+#include "ota_writer.h"
+
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+#define OtaSha256Starts(ctx) mbedtls_sha256_starts(ctx, 0)
+#define OtaSha256Update mbedtls_sha256_update
+#define OtaSha256Finish mbedtls_sha256_finish
+#else
+#define OtaSha256Starts(ctx) mbedtls_sha256_starts_ret(ctx, 0)
+#define OtaSha256Update mbedtls_sha256_update_ret
+#define OtaSha256Finish mbedtls_sha256_finish_ret
+#endif
+
+#define OTA_NVS_NAMESPACE "ota"
+#define OTA_NVS_CKPT_KEY "ckpt"
+#define OTA_CKPT_VERSION 3
+#define OTA_DELTA_OP_NONE 0
+#define OTA_DELTA_CTRL_MAX 11           // 操作码与两个 32 位 LEB128
+#define OTA_LEB128_MAX 5
+#define OTA_LEB128_SHIFT 7
+#define OTA_LEB128_MORE 0x80
+#define OTA_LEB128_MASK 0x7F
+#define OTA_JOURNAL_MAGIC 0x4C4A564F    // "OVJL"
+#define OTA_JOURNAL_RECORD_BASE 128     // 日志头之后为块完成记录
+#define OTA_JOURNAL_ERASED 0xFFFFFFFFU
+#define OTA_JOURNAL_CHECK_SHIFT 16
+#define OTA_JOURNAL_INDEX_MASK 0xFFFFU
+#define OTA_CHUNK_MAX ((OTA_FLASH_SECTOR_SIZE - OTA_JOURNAL_RECORD_BASE) / sizeof(uint32_t))
+#define OTA_BITS_PER_BYTE 8
+#define OTA_LZ_TOKEN 0                  // LZ4 序列的解码阶段
+#define OTA_LZ_LIT_LEN 1
+#define OTA_LZ_LITERAL 2
+#define OTA_LZ_OFFSET 3
+#define OTA_LZ_MATCH_LEN 4
+#define OTA_LZ_MATCH 5
+#define OTA_LZ_LIT_SHIFT 4
+#define OTA_LZ_LEN_MASK 0xF
+#define OTA_LZ_LEN_EXT 0xFF
+#define OTA_LZ_MIN_MATCH 4
+#define OTA_LZ_OFFSET_LEN 2
+
+typedef struct {
+    uint8_t op;
+    uint8_t ctrlLen;
+    uint8_t ctrl[OTA_DELTA_CTRL_MAX];
+    uint32_t remain;                    // 当前操作剩余的输出字节
+    uint32_t basePos;                   // 运行分区中下一次复制的位置
+} OtaPatchState;
+
+typedef struct {
+    uint8_t phase;
+    uint8_t token;
+    uint8_t offLen;
+    uint8_t reserved;
+    uint32_t offset;
+    uint32_t remain;                    // 当前字面量或匹配剩余的字节
+} OtaLzState;
+
+/*
+ * 写入进度, 同时作为运行状态, 保存到 NVS 后可在复位后继续.
+ * 不保存摘要上下文 (其布局随 mbedTLS 版本与硬件加速而变), 恢复时从分区读回已写出的 output 字节重新计算.
+ */
+typedef struct {
+    uint8_t version;
+    uint8_t reserved[3];
+    uint32_t partId;
+    OtaImageHeader header;
+    OtaDeltaHeader delta;
+    OtaLzHeader lzHeader;
+    uint32_t received;
+    uint32_t output;                    // 已写入分区的镜像字节数
+    OtaPatchState patch;
+    OtaLzState lz;
+} OtaCheckpoint;
+
+/* 完整镜像的块日志, 位于升级分区最后一个扇区, 之后每完成一块追加一条记录 */
+typedef struct {
+    uint32_t magic;
+    uint32_t reserved;
+    OtaImageHeader header;
+} OtaJournalHead;
+
+typedef struct {
+    uint16_t index;
+    uint16_t fill;                      // 块内已连续写入的字节数
+    uint8_t used;
+} OtaChunkSlot;
+
+typedef struct {
+    OtaFlashPart part;
+    OtaFlashPart base;
+    OtaCheckpoint ck;
+    mbedtls_sha256_context inSha;       // 签名覆盖部分的摘要
+    mbedtls_sha256_context outSha;      // 镜像摘要, 用于校验差分与解压结果
+    uint32_t lastCkpt;
+    uint32_t bufLen;
+    uint8_t state;
+    uint8_t chunked;                    // 完整镜像按块乱序写入
+    uint16_t chunkNum;
+    uint16_t chunkDone;
+    uint32_t journalPos;
+    uint8_t bitmap[(OTA_CHUNK_MAX + OTA_BITS_PER_BYTE - 1) / OTA_BITS_PER_BYTE];
+    OtaChunkSlot slot[OTA_CHUNK_OPEN_MAX];
+    uint8_t buf[OTA_FLASH_SECTOR_SIZE]; // 按扇区缓存待写入的镜像
+} OtaWriter_t;
+
+static OtaWriter_t OtaWriter;
+static UINT32 OtaWriterMux;             // 多路下载任务并行写入时串行化所有接口, 不随 OtaWriterBegin 清零
+
+static void OtaWriterLock(void)
+{
+    (void)LOS_MuxPend(OtaWriterMux, LOS_WAIT_FOREVER);
+}
+
+static void OtaWriterUnlock(void)
+{
+    (void)LOS_MuxPost(OtaWriterMux);
+}
+
+static void OtaWriterInit(void)
+{
+    if (LOS_MuxCreate(&OtaWriterMux) != LOS_OK) {
+        printf("ota writer: LOS_MuxCreate fail\r\n");
+    }
+}
+SYS_RUN(OtaWriterInit);
+
+static int OtaWriterFail(void)
+{
+    OtaWriter.state = OTA_WRITER_ERROR;
+    return -1;
+}
+
+static bool OtaWriterIsDelta(void)
+{
+    return (OtaWriter.ck.header.flags & OTA_IMAGE_FLAG_DELTA) != 0;
+}
+
+static bool OtaWriterIsLz(void)
+{
+    return (OtaWriter.ck.header.flags & OTA_IMAGE_FLAG_LZ4) != 0;
+}
+
+// 头部之后第 i 个负载头部字节, 压缩的差分包依次带有差分头部与压缩头部
+static uint8_t *OtaWriterPrefixExt(uint32_t i)
+{
+    if (OtaWriterIsDelta()) {
+        if (i < sizeof(OtaDeltaHeader)) {
+            return (uint8_t *)&OtaWriter.ck.delta + i;
+        }
+        i -= sizeof(OtaDeltaHeader);
+    }
+    return (uint8_t *)&OtaWriter.ck.lzHeader + i;
+}
+
+// 头部与差分, 压缩头部的总长度, 这部分可以读回
+static uint32_t OtaWriterPrefixLen(void)
+{
+    return sizeof(OtaImageHeader) + (OtaWriterIsDelta() ? sizeof(OtaDeltaHeader) : 0) +
+           (OtaWriterIsLz() ? sizeof(OtaLzHeader) : 0);
+}
+
+static uint32_t OtaWriterOutputSize(void)
+{
+    return OtaWriterIsDelta() ? OtaWriter.ck.delta.newSize : OtaWriter.ck.lzHeader.rawSize;
+}
+
+static void OtaCkptSave(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_set_blob(handle, OTA_NVS_CKPT_KEY, &OtaWriter.ck, sizeof(OtaWriter.ck)) == ESP_OK) {
+        (void)nvs_commit(handle);
+    }
+    nvs_close(handle);
+}
+
+static void OtaCkptClear(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_erase_key(handle, OTA_NVS_CKPT_KEY) == ESP_OK) {
+        (void)nvs_commit(handle);
+    }
+    nvs_close(handle);
+}
+
+static int OtaCkptLoad(OtaCheckpoint *ck)
+{
+    size_t size = sizeof(*ck);
+    nvs_handle_t handle;
+    esp_err_t err;
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return -1;
+    }
+    err = nvs_get_blob(handle, OTA_NVS_CKPT_KEY, ck, &size);
+    nvs_close(handle);
+    if ((err != ESP_OK) || (size != sizeof(*ck)) || (ck->version != OTA_CKPT_VERSION) ||
+        (ck->received < sizeof(OtaImageHeader))) {
+        return -1;
+    }
+    return 0;
+}
+
+static uint32_t OtaJournalBase(void)
+{
+    return OtaWriter.part.size - OTA_FLASH_SECTOR_SIZE;
+}
+
+static void OtaJournalClear(void)
+{
+    (void)OtaFlashErase(&OtaWriter.part, OtaJournalBase(), OTA_FLASH_SECTOR_SIZE);
+}
+
+static int OtaJournalStart(void)
+{
+    OtaJournalHead head = { .magic = OTA_JOURNAL_MAGIC, .reserved = 0, .header = OtaWriter.ck.header };
+    if ((OtaFlashErase(&OtaWriter.part, OtaJournalBase(), OTA_FLASH_SECTOR_SIZE) != 0) ||
+        (OtaFlashWrite(&OtaWriter.part, OtaJournalBase(), &head, sizeof(head)) != 0)) {
+        return -1;
+    }
+    OtaWriter.journalPos = OTA_JOURNAL_RECORD_BASE;
+    return 0;
+}
+
+// 记录中带索引的反码, 掉电写坏的记录在恢复时被忽略, 对应块重新下载
+static int OtaJournalAppend(uint16_t index)
+{
+    uint32_t record = index | ((uint32_t)(uint16_t)~index << OTA_JOURNAL_CHECK_SHIFT);
+    if ((OtaWriter.journalPos + sizeof(record)) > OTA_FLASH_SECTOR_SIZE) {
+        return -1;
+    }
+    if (OtaFlashWrite(&OtaWriter.part, OtaJournalBase() + OtaWriter.journalPos, &record, sizeof(record)) != 0) {
+        return -1;
+    }
+    OtaWriter.journalPos += sizeof(record);
+    return 0;
+}
+
+static bool OtaChunkIsDone(uint32_t index)
+{
+    return (OtaWriter.bitmap[index / OTA_BITS_PER_BYTE] & (1U << (index % OTA_BITS_PER_BYTE))) != 0;
+}
+
+static void OtaChunkSetDone(uint32_t index)
+{
+    if (!OtaChunkIsDone(index)) {
+        OtaWriter.bitmap[index / OTA_BITS_PER_BYTE] |= (uint8_t)(1U << (index % OTA_BITS_PER_BYTE));
+        OtaWriter.chunkDone++;
+    }
+}
+
+static uint32_t OtaChunkLen(uint32_t index)
+{
+    uint32_t start = index * OTA_FLASH_SECTOR_SIZE;
+    uint32_t left = OtaWriter.ck.header.payloadSize - start;
+    return (left < OTA_FLASH_SECTOR_SIZE) ? left : OTA_FLASH_SECTOR_SIZE;
+}
+
+static void OtaWriterShaStart(void)
+{
+    mbedtls_sha256_free(&OtaWriter.inSha);
+    mbedtls_sha256_free(&OtaWriter.outSha);
+    mbedtls_sha256_init(&OtaWriter.inSha);
+    mbedtls_sha256_init(&OtaWriter.outSha);
+    (void)OtaSha256Starts(&OtaWriter.inSha);
+    (void)OtaSha256Starts(&OtaWriter.outSha);
+}
+
+static void OtaWriterReset(void)
+{
+    OtaCheckpoint *ck = &OtaWriter.ck;
+    (void)memset_s(ck, sizeof(*ck), 0, sizeof(*ck));
+    ck->version = OTA_CKPT_VERSION;
+    ck->partId = OtaWriter.part.id;
+    OtaWriterShaStart();
+    OtaWriter.lastCkpt = 0;
+    OtaWriter.bufLen = 0;
+    OtaWriter.chunked = 0;
+    OtaWriter.chunkNum = 0;
+    OtaWriter.chunkDone = 0;
+    (void)memset_s(OtaWriter.bitmap, sizeof(OtaWriter.bitmap), 0, sizeof(OtaWriter.bitmap));
+    (void)memset_s(OtaWriter.slot, sizeof(OtaWriter.slot), 0, sizeof(OtaWriter.slot));
+    OtaWriter.state = OTA_WRITER_HEADER;
+}
+
+static int OtaWriterHeaderCheck(const OtaImageHeader *header)
+{
+    uint32_t ext = ((header->flags & OTA_IMAGE_FLAG_DELTA) != 0) ? sizeof(OtaDeltaHeader) : 0;
+    ext += ((header->flags & OTA_IMAGE_FLAG_LZ4) != 0) ? sizeof(OtaLzHeader) : 0;
+    if ((header->magic != OTA_IMAGE_MAGIC) || (header->version != OTA_IMAGE_VERSION) ||
+        ((header->flags & ~(OTA_IMAGE_FLAG_DELTA | OTA_IMAGE_FLAG_LZ4)) != 0) || (header->payloadSize == 0) ||
+        (header->sigLen == 0) || (header->sigLen > OTA_SIG_MAX_LEN)) {
+        return -1;
+    }
+    if (header->flags != 0) {
+        return (header->payloadSize < ext) ? -1 : 0;
+    }
+    // 最后一个扇区留给块日志
+    if ((OtaWriter.part.size <= OTA_FLASH_SECTOR_SIZE) || (header->payloadSize > OtaJournalBase()) ||
+        (((header->payloadSize + OTA_FLASH_SECTOR_SIZE - 1) / OTA_FLASH_SECTOR_SIZE) > OTA_CHUNK_MAX)) {
+        return -1;
+    }
+    return 0;
+}
+
+// 头部已确定, 进入负载阶段; 完整镜像改为按块写入
+static int OtaWriterPayloadStart(void)
+{
+    OtaImageHeader *header = &OtaWriter.ck.header;
+    if (OtaSha256Update(&OtaWriter.inSha, (const uint8_t *)header, OTA_IMAGE_SIGNED_LEN) != 0) {
+        return -1;
+    }
+    OtaWriter.state = OTA_WRITER_PAYLOAD;
+    if (header->flags != 0) {
+        return 0;
+    }
+    OtaWriter.chunked = 1;
+    OtaWriter.chunkNum = (uint16_t)((header->payloadSize + OTA_FLASH_SECTOR_SIZE - 1) / OTA_FLASH_SECTOR_SIZE);
+    return 0;
+}
+
+// 读取块日志恢复完整镜像的下载进度, 日志头即为升级包头部
+static int OtaJournalLoad(void)
+{
+    const OtaJournalHead *head = (const OtaJournalHead *)OtaWriter.buf;
+    const uint32_t *record = NULL;
+    uint32_t index;
+    if ((OtaWriter.part.size <= OTA_FLASH_SECTOR_SIZE) ||
+        (OtaFlashRead(&OtaWriter.part, OtaJournalBase(), OtaWriter.buf, OTA_FLASH_SECTOR_SIZE) != 0) ||
+        (head->magic != OTA_JOURNAL_MAGIC) || (head->header.flags != 0) ||
+        (OtaWriterHeaderCheck(&head->header) != 0)) {
+        return -1;
+    }
+    OtaWriterReset();
+    OtaWriter.ck.header = head->header;
+    OtaWriter.ck.received = sizeof(OtaImageHeader);
+    if (OtaWriterPayloadStart() != 0) {
+        return -1;
+    }
+    OtaWriter.journalPos = OTA_FLASH_SECTOR_SIZE;
+    for (uint32_t pos = OTA_JOURNAL_RECORD_BASE; pos < OTA_FLASH_SECTOR_SIZE; pos += sizeof(*record)) {
+        record = (const uint32_t *)(OtaWriter.buf + pos);
+        if (*record == OTA_JOURNAL_ERASED) {
+            OtaWriter.journalPos = pos;
+            break;
+        }
+        index = *record & OTA_JOURNAL_INDEX_MASK;
+        if (((*record >> OTA_JOURNAL_CHECK_SHIFT) == (~index & OTA_JOURNAL_INDEX_MASK)) &&
+            (index < OtaWriter.chunkNum)) {
+            OtaChunkSetDone(index);
+        }
+    }
+    return 0;
+}
+
+// 从断点恢复差分或压缩包: 签名已在进度保存前校验, 镜像摘要由分区中已写出的数据重新计算
+static int OtaWriterResume(void)
+{
+    uint32_t n;
+    OtaWriterShaStart();
+    for (uint32_t pos = 0; pos < OtaWriter.ck.output; pos += n) {
+        n = ((OtaWriter.ck.output - pos) < OTA_FLASH_SECTOR_SIZE) ? (OtaWriter.ck.output - pos) : OTA_FLASH_SECTOR_SIZE;
+        if ((OtaFlashRead(&OtaWriter.part, pos, OtaWriter.buf, n) != 0) ||
+            (OtaSha256Update(&OtaWriter.outSha, OtaWriter.buf, n) != 0)) {
+            return -1;
+        }
+    }
+    OtaWriter.lastCkpt = OtaWriter.ck.output;
+    OtaWriter.state = OTA_WRITER_PAYLOAD;
+    return 0;
+}
+
+static int OtaWriterBeginLocked(void)
+{
+    // 摘要上下文可能持有硬件加速单元, 清零前先释放
+    mbedtls_sha256_free(&OtaWriter.inSha);
+    mbedtls_sha256_free(&OtaWriter.outSha);
+    (void)memset_s(&OtaWriter, sizeof(OtaWriter), 0, sizeof(OtaWriter));
+    if (OtaFlashGetUpdatePart(&OtaWriter.part) != 0) {
+        return OtaWriterFail();
+    }
+    if ((OtaCkptLoad(&OtaWriter.ck) == 0) && (OtaWriter.ck.partId == OtaWriter.part.id) &&
+        (OtaWriter.ck.received >= OtaWriterPrefixLen()) &&
+        (!OtaWriterIsDelta() || (OtaFlashGetRunningPart(&OtaWriter.base) == 0)) && (OtaWriterResume() == 0)) {
+        return 0;
+    }
+    if (OtaJournalLoad() == 0) {
+        return 0;
+    }
+    OtaWriterReset();
+    return 0;
+}
+
+static uint32_t OtaWriterGetMissingLocked(OtaRange *ranges, uint32_t max)
+{
+    const OtaCheckpoint *ck = &OtaWriter.ck;
+    uint32_t count = 0;
+    uint32_t lastEnd = 0;
+    uint32_t start;
+    uint32_t end;
+    if (!OtaWriter.chunked) {
+        if ((ck->received >= sizeof(OtaImageHeader)) &&
+            (ck->received >= (sizeof(OtaImageHeader) + ck->header.payloadSize))) {
+            return 0;
+        }
+        if ((ranges != NULL) && (max > 0)) {
+            ranges[0].offset = ck->received;
+            ranges[0].len = (ck->received < sizeof(OtaImageHeader)) ? 0 :
+                            ((sizeof(OtaImageHeader) + ck->header.payloadSize) - ck->received);
+        }
+        return 1;
+    }
+    for (uint32_t i = 0; i < OtaWriter.chunkNum; i++) {
+        if (OtaChunkIsDone(i)) {
+            continue;
+        }
+        start = sizeof(OtaImageHeader) + (i * OTA_FLASH_SECTOR_SIZE);
+        end = start + OtaChunkLen(i);
+        for (uint32_t j = 0; j < OTA_CHUNK_OPEN_MAX; j++) {
+            if (OtaWriter.slot[j].used && (OtaWriter.slot[j].index == i)) {
+                start += OtaWriter.slot[j].fill;
+            }
+        }
+        // 与上一个缺失区间相连时合并
+        if ((count > 0) && (lastEnd == start)) {
+            if ((ranges != NULL) && (count <= max)) {
+                ranges[count - 1].len += end - start;
+            }
+            lastEnd = end;
+            continue;
+        }
+        if ((ranges != NULL) && (count < max)) {
+            ranges[count].offset = start;
+            ranges[count].len = end - start;
+        }
+        lastEnd = end;
+        count++;
+    }
+    return count;
+}
+
+static uint32_t OtaWriterGetResumeOffsetLocked(void)
+{
+    OtaRange range;
+    if (OtaWriterGetMissingLocked(&range, 1) == 0) {
+        return sizeof(OtaImageHeader) + OtaWriter.ck.header.payloadSize;
+    }
+    return range.offset;
+}
+
+// 写出缓存的镜像, 扇区在写入前擦除
+static int OtaWriterFlush(void)
+{
+    uint32_t erase = (OtaWriter.bufLen + OTA_FLASH_SECTOR_SIZE - 1) & ~(OTA_FLASH_SECTOR_SIZE - 1);
+    if (OtaWriter.bufLen == 0) {
+        return 0;
+    }
+    if ((OtaFlashErase(&OtaWriter.part, OtaWriter.ck.output, erase) != 0) ||
+        (OtaFlashWrite(&OtaWriter.part, OtaWriter.ck.output, OtaWriter.buf, OtaWriter.bufLen) != 0)) {
+        return -1;
+    }
+    OtaWriter.ck.output += OtaWriter.bufLen;
+    OtaWriter.bufLen = 0;
+    return 0;
+}
+
+// 镜像数据已追加到缓存, 写满一个扇区时写出, 并按间隔保存进度
+static int OtaWriterOutputDone(uint32_t n)
+{
+    (void)OtaSha256Update(&OtaWriter.outSha, OtaWriter.buf + OtaWriter.bufLen, n);
+    OtaWriter.bufLen += n;
+    if (OtaWriter.bufLen < OTA_FLASH_SECTOR_SIZE) {
+        return 0;
+    }
+    if (OtaWriterFlush() != 0) {
+        return -1;
+    }
+    if ((OtaWriter.ck.output - OtaWriter.lastCkpt) >= OTA_CKPT_INTERVAL) {
+        OtaCkptSave();
+        OtaWriter.lastCkpt = OtaWriter.ck.output;
+    }
+    return 0;
+}
+
+static int OtaWriterHeaderDone(void)
+{
+    if ((OtaWriterHeaderCheck(&OtaWriter.ck.header) != 0) || (OtaWriterPayloadStart() != 0)) {
+        return -1;
+    }
+    if (!OtaWriter.chunked) {
+        return 0;
+    }
+    // 完整镜像的进度记在块日志中, 旧的差分进度作废
+    OtaCkptClear();
+    return OtaJournalStart();
+}
+
+static int OtaWriterVerify(const uint8_t *hash)
+{
+    mbedtls_pk_context pk;
+    int ret;
+    mbedtls_pk_init(&pk);
+    ret = mbedtls_pk_parse_public_key(&pk, OtaPubKey, sizeof(OtaPubKey));
+    if (ret == 0) {
+        ret = mbedtls_pk_verify(&pk, MBEDTLS_MD_SHA256, hash, OTA_SHA256_LEN, OtaWriter.ck.header.sig,
+                                OtaWriter.ck.header.sigLen);
+    }
+    mbedtls_pk_free(&pk);
+    return (ret == 0) ? 0 : -1;
+}
+
+/*
+ * 差分与压缩包的签名只覆盖头部与负载头部, 负载头部中带有解出镜像的摘要, 完成时比较该摘要即可.
+ * 负载头部收齐时即校验签名, 伪造的包在写入分区之前被拒绝.
+ */
+static int OtaWriterPrefixVerify(void)
+{
+    uint8_t hash[OTA_SHA256_LEN];
+    if (OtaSha256Finish(&OtaWriter.inSha, hash) != 0) {
+        return -1;
+    }
+    return OtaWriterVerify(hash);
+}
+
+// 差分只能应用在生成时的基准镜像上, 先校验运行分区
+static int OtaWriterDeltaDone(void)
+{
+    const OtaDeltaHeader *delta = &OtaWriter.ck.delta;
+    mbedtls_sha256_context sha;
+    uint8_t hash[OTA_SHA256_LEN];
+    uint32_t n;
+    int ret = 0;
+    if ((delta->newSize == 0) || (delta->newSize > OtaWriter.part.size) ||
+        (OtaFlashGetRunningPart(&OtaWriter.base) != 0) || (delta->baseSize > OtaWriter.base.size)) {
+        return -1;
+    }
+    mbedtls_sha256_init(&sha);
+    (void)OtaSha256Starts(&sha);
+    for (uint32_t pos = 0; (ret == 0) && (pos < delta->baseSize); pos += n) {
+        n = ((delta->baseSize - pos) < OTA_FLASH_SECTOR_SIZE) ? (delta->baseSize - pos) : OTA_FLASH_SECTOR_SIZE;
+        ret = OtaFlashRead(&OtaWriter.base, pos, OtaWriter.buf, n);
+        if (ret == 0) {
+            ret = OtaSha256Update(&sha, OtaWriter.buf, n);
+        }
+    }
+    if (ret == 0) {
+        ret = OtaSha256Finish(&sha, hash);
+    }
+    mbedtls_sha256_free(&sha);
+    if ((ret != 0) || (memcmp(hash, delta->baseHash, OTA_SHA256_LEN) != 0)) {
+        return -1;
+    }
+    OtaWriter.ck.patch.op = OTA_DELTA_OP_NONE;
+    return 0;
+}
+
+// 压缩的差分包中压缩头部描述的是同一个镜像, 须与差分头部一致
+static int OtaWriterLzDone(void)
+{
+    const OtaLzHeader *lz = &OtaWriter.ck.lzHeader;
+    const OtaDeltaHeader *delta = &OtaWriter.ck.delta;
+    if ((lz->rawSize == 0) || (lz->rawSize > OtaWriter.part.size) || (lz->window == 0) ||
+        (lz->window > OTA_LZ_WINDOW_MAX)) {
+        return -1;
+    }
+    if (OtaWriterIsDelta() &&
+        ((lz->rawSize != delta->newSize) || (memcmp(lz->rawHash, delta->newHash, OTA_SHA256_LEN) != 0))) {
+        return -1;
+    }
+    OtaWriter.ck.lz.phase = OTA_LZ_TOKEN;
+    return 0;
+}
+
+// 解码 LEB128, 返回 1 完整, 0 需要更多数据, -1 非法
+static int OtaLeb128(const OtaPatchState *patch, uint8_t *pos, uint32_t *value)
+{
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < OTA_LEB128_MAX; i++) {
+        if ((*pos + i) >= patch->ctrlLen) {
+            return 0;
+        }
+        uint8_t b = patch->ctrl[*pos + i];
+        v |= (uint32_t)(b & OTA_LEB128_MASK) << (i * OTA_LEB128_SHIFT);
+        if ((b & OTA_LEB128_MORE) == 0) {
+            *pos += i + 1;
+            *value = v;
+            return 1;
+        }
+    }
+    return -1;
+}
+
+static int OtaPatchDecode(OtaPatchState *patch)
+{
+    uint8_t pos = 1;
+    uint32_t count = 0;
+    uint32_t zigzag = 0;
+    int ret;
+    if ((patch->ctrl[0] != OTA_DELTA_OP_COPY) && (patch->ctrl[0] != OTA_DELTA_OP_INSERT)) {
+        return -1;
+    }
+    ret = OtaLeb128(patch, &pos, &count);
+    if ((ret > 0) && (patch->ctrl[0] == OTA_DELTA_OP_COPY)) {
+        ret = OtaLeb128(patch, &pos, &zigzag);
+    }
+    if (ret <= 0) {
+        return ((ret == 0) && (patch->ctrlLen >= OTA_DELTA_CTRL_MAX)) ? -1 : ret;
+    }
+    patch->basePos += (zigzag >> 1) ^ (0U - (zigzag & 1));
+    patch->op = (count > 0) ? patch->ctrl[0] : OTA_DELTA_OP_NONE;
+    patch->remain = count;
+    patch->ctrlLen = 0;
+    return 1;
+}
+
+static int OtaWriterCopyBase(void)
+{
+    OtaPatchState *patch = &OtaWriter.ck.patch;
+    uint32_t n = OTA_FLASH_SECTOR_SIZE - OtaWriter.bufLen;
+    n = (patch->remain < n) ? patch->remain : n;
+    if ((patch->basePos > OtaWriter.ck.delta.baseSize) || (n > (OtaWriter.ck.delta.baseSize - patch->basePos)) ||
+        ((OtaWriter.ck.output + OtaWriter.bufLen + n) > OtaWriterOutputSize())) {
+        return -1;
+    }
+    if (OtaFlashRead(&OtaWriter.base, patch->basePos, OtaWriter.buf + OtaWriter.bufLen, n) != 0) {
+        return -1;
+    }
+    patch->basePos += n;
+    patch->remain -= n;
+    if (patch->remain == 0) {
+        patch->op = OTA_DELTA_OP_NONE;
+    }
+    return OtaWriterOutputDone(n);
+}
+
+// 负载中的原样数据写入镜像, 返回消耗的输入字节数
+static int OtaWriterLiteral(const uint8_t *buf, uint32_t len, uint32_t *remain)
+{
+    uint32_t n = OTA_FLASH_SECTOR_SIZE - OtaWriter.bufLen;
+    n = (*remain < n) ? *remain : n;
+    n = (len < n) ? len : n;
+    if ((OtaWriter.ck.output + OtaWriter.bufLen + n) > OtaWriterOutputSize()) {
+        return -1;
+    }
+    (void)memcpy_s(OtaWriter.buf + OtaWriter.bufLen, OTA_FLASH_SECTOR_SIZE - OtaWriter.bufLen, buf, n);
+    OtaWriter.ck.received += n;
+    *remain -= n;
+    return (OtaWriterOutputDone(n) == 0) ? (int)n : -1;
+}
+
+static int OtaWriterInsert(const uint8_t *buf, uint32_t len)
+{
+    OtaPatchState *patch = &OtaWriter.ck.patch;
+    int ret = OtaWriterLiteral(buf, len, &patch->remain);
+    if (patch->remain == 0) {
+        patch->op = OTA_DELTA_OP_NONE;
+    }
+    return ret;
+}
+
+// 压缩的差分包中 INSERT 的输出不超过记录长度
+static uint32_t OtaLzLimit(uint32_t n)
+{
+    return (OtaWriterIsDelta() && (OtaWriter.ck.patch.remain < n)) ? OtaWriter.ck.patch.remain : n;
+}
+
+// 匹配源为已解出的镜像, 在扇区缓存中或已写入分区, 因此窗口不占用额外内存
+static int OtaLzMatch(void)
+{
+    OtaLzState *lz = &OtaWriter.ck.lz;
+    uint32_t total = OtaWriter.ck.output + OtaWriter.bufLen;
+    uint32_t src = total - lz->offset;
+    uint32_t n = OtaLzLimit(OTA_FLASH_SECTOR_SIZE - OtaWriter.bufLen);
+    n = (lz->remain < n) ? lz->remain : n;
+    n = (lz->offset < n) ? lz->offset : n;
+    if ((total + n) > OtaWriterOutputSize()) {
+        return -1;
+    }
+    if (src >= OtaWriter.ck.output) {
+        (void)memcpy_s(OtaWriter.buf + OtaWriter.bufLen, OTA_FLASH_SECTOR_SIZE - OtaWriter.bufLen,
+                       OtaWriter.buf + (src - OtaWriter.ck.output), n);
+    } else {
+        n = ((OtaWriter.ck.output - src) < n) ? (OtaWriter.ck.output - src) : n;
+        if (OtaFlashRead(&OtaWriter.part, src, OtaWriter.buf + OtaWriter.bufLen, n) != 0) {
+            return -1;
+        }
+    }
+    lz->remain -= n;
+    if (lz->remain == 0) {
+        lz->phase = OTA_LZ_TOKEN;
+    }
+    if (OtaWriterIsDelta()) {
+        OtaWriter.ck.patch.remain -= n;
+    }
+    return OtaWriterOutputDone(n);
+}
+
+// 处理 LZ4 序列中的控制字节: 标记, 扩展长度与偏移
+static int OtaLzControl(uint8_t b)
+{
+    OtaLzState *lz = &OtaWriter.ck.lz;
+    switch (lz->phase) {
+        case OTA_LZ_TOKEN:
+            lz->token = b;
+            lz->remain = b >> OTA_LZ_LIT_SHIFT;
+            lz->phase = (lz->remain == OTA_LZ_LEN_MASK) ? OTA_LZ_LIT_LEN : OTA_LZ_LITERAL;
+            break;
+        case OTA_LZ_LIT_LEN:
+        case OTA_LZ_MATCH_LEN:
+            lz->remain += b;
+            if (b != OTA_LZ_LEN_EXT) {
+                lz->phase = (lz->phase == OTA_LZ_LIT_LEN) ? OTA_LZ_LITERAL : OTA_LZ_MATCH;
+            }
+            break;
+        case OTA_LZ_OFFSET:
+            lz->offset |= (uint32_t)b << (lz->offLen * OTA_BITS_PER_BYTE);
+            if (++lz->offLen < OTA_LZ_OFFSET_LEN) {
+                break;
+            }
+            if ((lz->offset == 0) || (lz->offset > OtaWriter.ck.lzHeader.window) ||
+                (lz->offset > (OtaWriter.ck.output + OtaWriter.bufLen))) {
+                return -1;
+            }
+            lz->remain = lz->token & OTA_LZ_LEN_MASK;
+            lz->phase = (lz->remain == OTA_LZ_LEN_MASK) ? OTA_LZ_MATCH_LEN : OTA_LZ_MATCH;
+            break;
+        default:
+            return -1;
+    }
+    if (lz->remain > OtaWriterOutputSize()) {
+        return -1;
+    }
+    if (lz->phase == OTA_LZ_MATCH) {
+        lz->remain += OTA_LZ_MIN_MATCH;
+    }
+    if ((lz->phase == OTA_LZ_LITERAL) && (lz->remain == 0)) {
+        lz->phase = OTA_LZ_OFFSET;
+        lz->offLen = 0;
+        lz->offset = 0;
+    }
+    return 0;
+}
+
+// 解码 LZ4 序列, 返回消耗的输入字节数; 压缩的差分包中在 INSERT 输出满记录长度时返回
+static int OtaLzPayload(const uint8_t *buf, uint32_t len)
+{
+    OtaLzState *lz = &OtaWriter.ck.lz;
+    uint32_t used = 0;
+    int ret;
+    while (((len > 0) || (lz->phase == OTA_LZ_MATCH)) && (!OtaWriterIsDelta() || (OtaWriter.ck.patch.remain > 0))) {
+        if (lz->phase == OTA_LZ_MATCH) {
+            ret = OtaLzMatch();
+        } else if (lz->phase == OTA_LZ_LITERAL) {
+            ret = OtaWriterLiteral(buf, OtaLzLimit(len), &lz->remain);
+            if (ret > 0) {
+                buf += ret;
+                len -= (uint32_t)ret;
+                used += (uint32_t)ret;
+                OtaWriter.ck.patch.remain -= OtaWriterIsDelta() ? (uint32_t)ret : 0;
+                ret = 0;
+            }
+            if (lz->remain == 0) {
+                lz->phase = OTA_LZ_OFFSET;
+                lz->offLen = 0;
+                lz->offset = 0;
+            }
+        } else {
+            OtaWriter.ck.received++;
+            ret = OtaLzControl(*buf);
+            buf++;
+            len--;
+            used++;
+        }
+        if (ret < 0) {
+            return -1;
+        }
+    }
+    return (int)used;
+}
+
+/*
+ * 压缩的差分包中 INSERT 的数据是一个 LZ4 块, 匹配可以引用此前解出的整个新镜像, 包括 COPY 的部分.
+ * 块以只有字面量的序列结束, 输出满记录长度时须恰好位于该序列之后.
+ */
+static int OtaWriterInsertLz(const uint8_t *buf, uint32_t len)
+{
+    OtaLzState *lz = &OtaWriter.ck.lz;
+    int ret = OtaLzPayload(buf, len);
+    if ((ret < 0) || (OtaWriter.ck.patch.remain > 0)) {
+        return ret;
+    }
+    if ((lz->phase != OTA_LZ_OFFSET) || (lz->offLen != 0)) {
+        return -1;
+    }
+    OtaWriter.ck.patch.op = OTA_DELTA_OP_NONE;
+    lz->phase = OTA_LZ_TOKEN;
+    return ret;
+}
+
+// 处理头部之后的顺序负载, 差分的 COPY 与压缩的匹配不消耗输入, 在解出后立即执行
+static int OtaWriterPayload(const uint8_t *buf, uint32_t len)
+{
+    OtaCheckpoint *ck = &OtaWriter.ck;
+    uint32_t prefix = OtaWriterPrefixLen();
+    uint32_t n;
+    int ret;
+    if (len > ((sizeof(OtaImageHeader) + ck->header.payloadSize) - ck->received)) {
+        return -1;
+    }
+    if (ck->received < prefix) {
+        n = ((prefix - ck->received) < len) ? (prefix - ck->received) : len;
+        (void)OtaSha256Update(&OtaWriter.inSha, buf, n);
+        for (uint32_t i = 0; i < n; i++) {
+            *OtaWriterPrefixExt(ck->received++ - sizeof(OtaImageHeader)) = *buf++;
+        }
+        len -= n;
+        if ((ck->received == prefix) && ((OtaWriterPrefixVerify() != 0) ||
+            (OtaWriterIsDelta() && (OtaWriterDeltaDone() != 0)) || (OtaWriterIsLz() && (OtaWriterLzDone() != 0)))) {
+            return -1;
+        }
+    }
+    if (ck->received < prefix) {
+        return 0;
+    }
+    if (!OtaWriterIsDelta()) {
+        return (OtaLzPayload(buf, len) < 0) ? -1 : 0;
+    }
+    while ((len > 0) || (ck->patch.op == OTA_DELTA_OP_COPY)) {
+        switch (ck->patch.op) {
+            case OTA_DELTA_OP_NONE:
+                ck->patch.ctrl[ck->patch.ctrlLen++] = *buf;
+                ck->received++;
+                buf++;
+                len--;
+                ret = OtaPatchDecode(&ck->patch);
+                break;
+            case OTA_DELTA_OP_COPY:
+                ret = OtaWriterCopyBase();
+                break;
+            default:
+                ret = OtaWriterIsLz() ? OtaWriterInsertLz(buf, len) : OtaWriterInsert(buf, len);
+                if (ret > 0) {
+                    buf += ret;
+                    len -= (uint32_t)ret;
+                }
+                break;
+        }
+        if (ret < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static OtaChunkSlot *OtaChunkFindSlot(uint32_t index)
+{
+    for (uint32_t i = 0; i < OTA_CHUNK_OPEN_MAX; i++) {
+        if (OtaWriter.slot[i].used && (OtaWriter.slot[i].index == index)) {
+            return &OtaWriter.slot[i];
+        }
+    }
+    return NULL;
+}
+
+static OtaChunkSlot *OtaChunkOpen(uint32_t index)
+{
+    OtaChunkSlot *slot = NULL;
+    for (uint32_t i = 0; i < OTA_CHUNK_OPEN_MAX; i++) {
+        if (!OtaWriter.slot[i].used) {
+            slot = &OtaWriter.slot[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        return NULL;
+    }
+    if (OtaFlashErase(&OtaWriter.part, index * OTA_FLASH_SECTOR_SIZE, OTA_FLASH_SECTOR_SIZE) != 0) {
+        (void)OtaWriterFail();
+        return NULL;
+    }
+    slot->index = (uint16_t)index;
+    slot->fill = 0;
+    slot->used = 1;
+    return slot;
+}
+
+// 完整镜像直接写入分区, 块内须从块首连续写入, 块之间顺序任意, 已完成的块重发时跳过
+static int OtaChunkWrite(uint32_t pos, const uint8_t *buf, uint32_t len)
+{
+    OtaChunkSlot *slot = NULL;
+    uint32_t index;
+    uint32_t inner;
+    uint32_t skip;
+    uint32_t n;
+    if ((pos > OtaWriter.ck.header.payloadSize) || (len > (OtaWriter.ck.header.payloadSize - pos))) {
+        return -1;
+    }
+    while (len > 0) {
+        index = pos / OTA_FLASH_SECTOR_SIZE;
+        inner = pos % OTA_FLASH_SECTOR_SIZE;
+        n = OtaChunkLen(index) - inner;
+        n = (len < n) ? len : n;
+        if (!OtaChunkIsDone(index)) {
+            slot = OtaChunkFindSlot(index);
+            if ((slot == NULL) && (inner == 0)) {
+                slot = OtaChunkOpen(index);
+            }
+            if ((slot == NULL) || (inner > slot->fill)) {
+                return -1;
+            }
+            skip = slot->fill - inner;
+            if ((skip < n) && (OtaFlashWrite(&OtaWriter.part, pos + skip, buf + skip, n - skip) != 0)) {
+                return OtaWriterFail();
+            }
+            slot->fill = (uint16_t)((skip < n) ? (inner + n) : slot->fill);
+            if (slot->fill == OtaChunkLen(index)) {
+                if (OtaJournalAppend((uint16_t)index) != 0) {
+                    return OtaWriterFail();
+                }
+                OtaChunkSetDone(index);
+                slot->used = 0;
+            }
+        }
+        pos += n;
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// 块内已写入的部分才能读回
+static bool OtaChunkWritten(uint32_t pos, uint32_t len)
+{
+    const OtaChunkSlot *slot = NULL;
+    for (uint32_t i = pos / OTA_FLASH_SECTOR_SIZE; (i * OTA_FLASH_SECTOR_SIZE) < (pos + len); i++) {
+        if (OtaChunkIsDone(i)) {
+            continue;
+        }
+        slot = OtaChunkFindSlot(i);
+        if ((slot == NULL) || ((pos + len) > ((i * OTA_FLASH_SECTOR_SIZE) + slot->fill))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 恢复进度后重发的数据与已保存的头部比较, 一致时才能跳过
+static bool OtaWriterPrefixMatch(uint32_t offset, const uint8_t *buf, uint32_t len)
+{
+    uint32_t end = OtaWriterPrefixLen();
+    uint8_t b;
+    end = (OtaWriter.ck.received < end) ? OtaWriter.ck.received : end;
+    for (uint32_t i = offset; (i < end) && ((i - offset) < len); i++) {
+        b = (i < sizeof(OtaImageHeader)) ? ((const uint8_t *)&OtaWriter.ck.header)[i] :
+                                           *OtaWriterPrefixExt(i - sizeof(OtaImageHeader));
+        if (b != buf[i - offset]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int OtaWriterWriteLocked(uint32_t offset, const uint8_t *buf, uint32_t len)
+{
+    OtaCheckpoint *ck = &OtaWriter.ck;
+    uint32_t n;
+    if ((buf == NULL) || (len == 0)) {
+        return -1;
+    }
+    if ((OtaWriter.state != OTA_WRITER_HEADER) && (OtaWriter.state != OTA_WRITER_PAYLOAD)) {
+        return OtaWriterFail();
+    }
+    if (offset < ck->received) {
+        if (OtaWriterPrefixMatch(offset, buf, len)) {
+            n = ck->received - offset;
+            if (n >= len) {
+                return 0;
+            }
+            offset += n;
+            buf += n;
+            len -= n;
+        } else if (offset == 0) {
+            // 换了升级包, 丢弃旧进度
+            OtaCkptClear();
+            if (OtaWriter.chunked) {
+                OtaJournalClear();
+            }
+            OtaWriterReset();
+        } else {
+            return OtaWriterFail();
+        }
+    }
+    if (OtaWriter.chunked) {
+        return OtaChunkWrite(offset - sizeof(OtaImageHeader), buf, len);
+    }
+    if (offset != ck->received) {
+        return OtaWriterFail();
+    }
+    if (ck->received < sizeof(OtaImageHeader)) {
+        n = sizeof(OtaImageHeader) - ck->received;
+        n = (len < n) ? len : n;
+        (void)memcpy_s((uint8_t *)&ck->header + ck->received, n, buf, n);
+        ck->received += n;
+        buf += n;
+        len -= n;
+        if ((ck->received == sizeof(OtaImageHeader)) && (OtaWriterHeaderDone() != 0)) {
+            return OtaWriterFail();
+        }
+    }
+    if (len == 0) {
+        return 0;
+    }
+    if (OtaWriter.chunked) {
+        return OtaChunkWrite(0, buf, len);
+    }
+    return (OtaWriterPayload(buf, len) == 0) ? 0 : OtaWriterFail();
+}
+
+static int OtaWriterReadLocked(uint32_t offset, uint8_t *buf, uint32_t len)
+{
+    uint32_t readable = OtaWriterPrefixLen();
+    readable = (OtaWriter.ck.received < readable) ? OtaWriter.ck.received : readable;
+    if (OtaWriter.chunked) {
+        readable = sizeof(OtaImageHeader) + OtaWriter.ck.header.payloadSize;
+    }
+    if ((buf == NULL) || (len == 0) || (offset > readable) || (len > (readable - offset))) {
+        return -1;
+    }
+    while ((len > 0) && (offset < OtaWriterPrefixLen())) {
+        *buf++ = (offset < sizeof(OtaImageHeader)) ? ((const uint8_t *)&OtaWriter.ck.header)[offset] :
+                                                     *OtaWriterPrefixExt(offset - sizeof(OtaImageHeader));
+        offset++;
+        len--;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    offset -= sizeof(OtaImageHeader);
+    if (!OtaChunkWritten(offset, len)) {
+        return -1;
+    }
+    return OtaFlashRead(&OtaWriter.part, offset, buf, len);
+}
+
+// 乱序写入的镜像无法边收边算摘要, 收齐后从分区读回计算
+static int OtaChunkDigest(uint8_t *hash)
+{
+    uint32_t size = OtaWriter.ck.header.payloadSize;
+    uint32_t n;
+    for (uint32_t pos = 0; pos < size; pos += n) {
+        n = ((size - pos) < OTA_FLASH_SECTOR_SIZE) ? (size - pos) : OTA_FLASH_SECTOR_SIZE;
+        if ((OtaFlashRead(&OtaWriter.part, pos, OtaWriter.buf, n) != 0) ||
+            (OtaSha256Update(&OtaWriter.inSha, OtaWriter.buf, n) != 0)) {
+            return -1;
+        }
+    }
+    return OtaSha256Finish(&OtaWriter.inSha, hash);
+}
+
+static int OtaWriterFinishChunked(void)
+{
+    uint8_t hash[OTA_SHA256_LEN];
+    if (OtaWriter.chunkDone != OtaWriter.chunkNum) {
+        return OtaWriterFail();
+    }
+    OtaJournalClear();
+    if ((OtaChunkDigest(hash) != 0) || (OtaWriterVerify(hash) != 0)) {
+        return OtaWriterFail();
+    }
+    OtaWriter.state = OTA_WRITER_VERIFIED;
+    return 0;
+}
+
+static int OtaWriterFinishLocked(void)
+{
+    OtaCheckpoint *ck = &OtaWriter.ck;
+    uint8_t hash[OTA_SHA256_LEN];
+    if (OtaWriter.state != OTA_WRITER_PAYLOAD) {
+        return OtaWriterFail();
+    }
+    if (OtaWriter.chunked) {
+        return OtaWriterFinishChunked();
+    }
+    // 压缩流以只有字面量的序列结束
+    if ((ck->received != (sizeof(OtaImageHeader) + ck->header.payloadSize)) ||
+        (OtaWriterIsDelta() ? ((ck->patch.op != OTA_DELTA_OP_NONE) || (ck->patch.ctrlLen != 0)) :
+                              ((ck->lz.phase != OTA_LZ_OFFSET) || (ck->lz.offLen != 0))) ||
+        ((ck->output + OtaWriter.bufLen) != OtaWriterOutputSize())) {
+        return OtaWriterFail();
+    }
+    // 数据已收齐, 无论校验结果如何都不再需要进度
+    OtaCkptClear();
+    // 签名已在负载头部收齐时校验, 这里只比较解出镜像的摘要
+    if ((OtaWriterFlush() != 0) || (OtaSha256Finish(&OtaWriter.outSha, hash) != 0) ||
+        (memcmp(hash, OtaWriterIsDelta() ? ck->delta.newHash : ck->lzHeader.rawHash, OTA_SHA256_LEN) != 0)) {
+        return OtaWriterFail();
+    }
+    OtaWriter.state = OTA_WRITER_VERIFIED;
+    return 0;
+}
+
+static int OtaWriterActivateLocked(void)
+{
+    if (OtaWriter.state != OTA_WRITER_VERIFIED) {
+        return -1;
+    }
+    return OtaBootSwitch(&OtaWriter.part);
+}
+
+int OtaWriterBegin(void)
+{
+    int ret;
+    OtaWriterLock();
+    ret = OtaWriterBeginLocked();
+    OtaWriterUnlock();
+    return ret;
+}
+
+uint32_t OtaWriterGetMissing(OtaRange *ranges, uint32_t max)
+{
+    uint32_t ret;
+    OtaWriterLock();
+    ret = OtaWriterGetMissingLocked(ranges, max);
+    OtaWriterUnlock();
+    return ret;
+}
+
+uint32_t OtaWriterGetResumeOffset(void)
+{
+    uint32_t ret;
+    OtaWriterLock();
+    ret = OtaWriterGetResumeOffsetLocked();
+    OtaWriterUnlock();
+    return ret;
+}
+
+int OtaWriterWrite(uint32_t offset, const uint8_t *buf, uint32_t len)
+{
+    int ret;
+    OtaWriterLock();
+    ret = OtaWriterWriteLocked(offset, buf, len);
+    OtaWriterUnlock();
+    return ret;
+}
+
+int OtaWriterRead(uint32_t offset, uint8_t *buf, uint32_t len)
+{
+    int ret;
+    OtaWriterLock();
+    ret = OtaWriterReadLocked(offset, buf, len);
+    OtaWriterUnlock();
+    return ret;
+}
+
+int OtaWriterFinish(void)
+{
+    int ret;
+    OtaWriterLock();
+    ret = OtaWriterFinishLocked();
+    OtaWriterUnlock();
+    return ret;
+}
+
+int OtaWriterActivate(void)
+{
+    int ret;
+    OtaWriterLock();
+    ret = OtaWriterActivateLocked();
+    OtaWriterUnlock();
+    return ret;
+}
+
+OtaWriterState OtaWriterGetState(void)
+{
+    return (OtaWriterState)OtaWriter.state;
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __OTA_WRITER_H__
+#define __OTA_WRITER_H__
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 升级包写入: 包由 OtaImageHeader 与负载组成, 负载解出的镜像写入未运行的 app 分区.
+ * 签名为 ECDSA P-256 (DER), 由 ota_pack.py 生成. 完整镜像的签名覆盖头部中 sigLen 之前的字段与整个负载;
+ * 差分与压缩包的签名覆盖这些字段与 OtaDeltaHeader/OtaLzHeader, 其中带有解出镜像的摘要,
+ * 负载头部收齐时即校验签名, 写完后再比较镜像摘要.
+ *
+ * 完整镜像在头部之后按 OTA_FLASH_SECTOR_SIZE 分块, 块之间可以乱序写入, 便于多路分段下载.
+ * 各接口内部加锁串行执行, 可由多个下载任务并行调用.
+ * 每完成一块在升级分区最后一个扇区的日志中追加一条记录, 复位后由 OtaWriterBegin 恢复,
+ * 未完成的块重新下载, OtaWriterGetMissing 给出仍缺失的区间. 收齐后读回分区计算摘要并校验签名.
+ *
+ * 负载为完整镜像, 或带 OTA_IMAGE_FLAG_DELTA 时为相对当前运行镜像的差分:
+ * OtaDeltaHeader 之后是连续的操作记录, 每条为 1 字节操作码与 LEB128 编码的参数,
+ *   OTA_DELTA_OP_COPY   len, delta  从运行分区 (上次 COPY 结束位置 + delta) 处复制 len 字节, delta 为 zigzag 编码
+ *   OTA_DELTA_OP_INSERT len, 数据   写入随后的 len 字节
+ * 带 OTA_IMAGE_FLAG_LZ4 时负载为 OtaLzHeader 与完整镜像的 LZ4 块格式压缩流, 匹配距离不超过 window.
+ * 匹配从已解出的镜像 (扇区缓存或已写入的分区) 中复制, 窗口不占用额外内存.
+ * 两个标志同时存在时为压缩的差分: OtaDeltaHeader 之后是描述同一镜像的 OtaLzHeader,
+ * 每条 INSERT 的数据是一个解出 len 字节的 LZ4 块, 匹配可以引用此前解出的整个新镜像.
+ *
+ * 差分与压缩包须按顺序写入, 接收过程中同步计算摘要, 所需内存只有一个扇区缓存,
+ * 每写出 OTA_CKPT_INTERVAL 字节保存一次进度, 复位后从分区读回已写出的镜像重新计算摘要, 从断点继续.
+ */
+#define OTA_IMAGE_MAGIC 0x544F564F      // "OVOT"
+#define OTA_IMAGE_VERSION 1
+#define OTA_SIG_MAX_LEN 72
+#define OTA_IMAGE_FLAG_DELTA 0x1
+#define OTA_IMAGE_FLAG_LZ4 0x2
+#define OTA_LZ_WINDOW_MAX 0xFFFF        // LZ4 偏移为 16 位
+#define OTA_SHA256_LEN 32
+#define OTA_DELTA_OP_COPY 1
+#define OTA_DELTA_OP_INSERT 2
+#define OTA_CKPT_INTERVAL (64 * 1024)
+#define OTA_CHUNK_OPEN_MAX 8            // 同时写入中的块数, 即并行下载的路数
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint32_t payloadSize;               // 头部之后的字节数
+    uint32_t sigLen;
+    uint8_t sig[OTA_SIG_MAX_LEN];
+} OtaImageHeader;
+
+#define OTA_IMAGE_SIGNED_LEN offsetof(OtaImageHeader, sigLen)
+
+typedef struct {
+    uint32_t baseSize;                  // 差分基于运行分区的前 baseSize 字节
+    uint32_t newSize;
+    uint8_t baseHash[OTA_SHA256_LEN];
+    uint8_t newHash[OTA_SHA256_LEN];
+} OtaDeltaHeader;
+
+typedef struct {
+    uint32_t rawSize;
+    uint32_t window;                    // 压缩时使用的最大匹配距离
+    uint8_t rawHash[OTA_SHA256_LEN];
+} OtaLzHeader;
+
+typedef struct {
+    uint32_t offset;                    // 包内偏移
+    uint32_t len;                       // 0 表示直到包尾, 头部尚未收齐时长度未知
+} OtaRange;
+
+typedef enum {
+    OTA_WRITER_IDLE = 0,
+    OTA_WRITER_HEADER,
+    OTA_WRITER_PAYLOAD,
+    OTA_WRITER_VERIFIED,
+    OTA_WRITER_ERROR,
+} OtaWriterState;
+
+/**
+ * @brief 开始一次升级, 选定目标分区; 存在同一分区的未完成进度时恢复该进度
+ *
+ * @return 0 成功, -1 没有可用的升级分区
+ */
+int OtaWriterBegin(void);
+
+/**
+ * @brief 写入升级包数据, offset 为包内偏移
+ *
+ * 头部须最先写入. 完整镜像的块内数据须从块首连续写入, 块之间顺序任意; 差分包须整体按顺序写入.
+ * 已完成的数据重发时被跳过, 其中的头部与保存的不一致时按新包从头开始.
+ *
+ * @return 0 成功, -1 失败; 头部非法, 差分数据错误或写 flash 失败后之后的写入均失败,
+ *         完整镜像的块不连续或同时写入的块过多时仅拒绝本次写入
+ */
+int OtaWriterWrite(uint32_t offset, const uint8_t *buf, uint32_t len);
+
+/**
+ * @brief 查询仍缺失的包内区间, 相邻的缺失块合并为一个区间
+ *
+ * @param ranges 输出区间, 可为 NULL
+ * @param max ranges 的容量
+ * @return 缺失区间总数, 可能大于 max; 0 表示已收齐
+ */
+uint32_t OtaWriterGetMissing(OtaRange *ranges, uint32_t max);
+
+/**
+ * @brief 按顺序下载时应继续发送的包内偏移, 即第一个缺失区间的起点
+ */
+uint32_t OtaWriterGetResumeOffset(void);
+
+/**
+ * @brief 读取已写入的升级包数据, offset 为包内偏移; 差分包只能读取头部
+ */
+int OtaWriterRead(uint32_t offset, uint8_t *buf, uint32_t len);
+
+/**
+ * @brief 写出缓存并校验摘要与签名
+ *
+ * @return 0 校验通过, -1 数据不完整或校验失败
+ */
+int OtaWriterFinish(void);
+
+/**
+ * @brief 校验通过后把目标分区设为下次启动分区, 并进入待确认状态
+ */
+int OtaWriterActivate(void);
+
+OtaWriterState OtaWriterGetState(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -18,12 +18,18 @@
 #include <string.h>
 #include "hal_hota_board.h"
 #include "hota_partition.h"
+#include "ota_flash.h"
+#include "ota_writer.h"
 
-#define NOT_SUPPORT 4096
 #define PATH_SEPARATE_LEN 2
+#ifndef ABILITY_PKG_SEARCH
+#define ABILITY_PKG_SEARCH 0x1
+#endif
+#ifndef ABILITY_PKG_DLOAD
+#define ABILITY_PKG_DLOAD 0x2
+#endif
 
 typedef struct {
-    uint8_t index;
     uint8_t init;
     UpdateMetaData metaData;
     ComponentTableInfo componentTableInfo;
@@ -42,8 +48,11 @@ int HotaHalInit(void)
     if (UpdateInfo.init != 0) {
         return OHOS_FAILURE;
     }
-    UpdateInfo.init = 1;
     memset_s(&UpdateInfo, sizeof(UpdateInfo), 0, sizeof(UpdateInfo));
+    if (OtaWriterBegin() != 0) {
+        return OHOS_FAILURE;
+    }
+    UpdateInfo.init = 1;
     UpdateInfo.componentTableInfo.componentName = "OpenValley";
     UpdateInfo.componentTableInfo.imgPath = "/";
     return OHOS_SUCCESS;
@@ -65,20 +74,29 @@ int HotaHalDeInit(void)
 }
 
 /**
- * @brief Release OTA module resource.
+ * @brief Get the A/B index of the running image.
  *
  * @return OHOS_SUCCESS: Success,
  *         Others: Failure.
  */
 int HotaHalGetUpdateIndex(unsigned int *index)
 {
-    if (index == NULL) {
+    OtaFlashPart running;
+    OtaFlashPart update;
+    if ((index == NULL) || (OtaFlashGetRunningPart(&running) != 0) || (OtaFlashGetUpdatePart(&update) != 0)) {
         return OHOS_FAILURE;
     }
-    *index = UpdateInfo.index;
+    // 当前运行的是地址较低的 app 分区时为 0, 否则为 1; 激活新镜像后复位前不变
+    *index = (running.id < update.id) ? 0 : 1;
     return OHOS_SUCCESS;
 }
 
+// 只有 A/B 镜像分区由 OtaWriter 写入未运行的 app 分区, 其余分区本板没有对应的存储
+static int HotaHalIsImagePartition(int partition)
+{
+    return (partition == PARTITION_KERNEL_A) || (partition == PARTITION_KERNEL_B);
+}
+
 /**
  * @brief Write image to partition.
  *
@@ -92,10 +110,10 @@ int HotaHalGetUpdateIndex(unsigned int *index)
  */
 int HotaHalWrite(int partition, unsigned char *buffer, unsigned int offset, unsigned int bufLen)
 {
-    if ((buffer == NULL) || (offset == 0) || (bufLen == 0)) {
+    if ((buffer == NULL) || (bufLen == 0) || (UpdateInfo.init == 0) || !HotaHalIsImagePartition(partition)) {
         return OHOS_FAILURE;
     }
-    return OHOS_SUCCESS;
+    return (OtaWriterWrite(offset, buffer, bufLen) == 0) ? OHOS_SUCCESS : OHOS_FAILURE;
 }
 
 /**
@@ -111,10 +129,10 @@ int HotaHalWrite(int partition, unsigned char *buffer, unsigned int offset, unsi
  */
 int HotaHalRead(int partition, unsigned int offset, unsigned int bufLen, unsigned char *buffer)
 {
-    if ((buffer == NULL) || (offset == 0) || (bufLen == 0)) {
+    if ((buffer == NULL) || (bufLen == 0) || (UpdateInfo.init == 0) || !HotaHalIsImagePartition(partition)) {
         return OHOS_FAILURE;
     }
-    return OHOS_SUCCESS;
+    return (OtaWriterRead(offset, buffer, bufLen) == 0) ? OHOS_SUCCESS : OHOS_FAILURE;
 }
 
 /**
@@ -125,7 +143,12 @@ int HotaHalRead(int partition, unsigned int offset, unsigned int bufLen, unsigne
  */
 int HotaHalSetBootSettings(void)
 {
-    UpdateInfo.index ^= 1;
+    if ((OtaWriterGetState() != OTA_WRITER_VERIFIED) && (OtaWriterFinish() != 0)) {
+        return OHOS_FAILURE;
+    }
+    if (OtaWriterActivate() != 0) {
+        return OHOS_FAILURE;
+    }
     return OHOS_SUCCESS;
 }
 
@@ -187,7 +210,7 @@ unsigned char *HotaHalGetPubKey(unsigned int *length)
  */
 int HotaHalGetUpdateAbility(void)
 {
-    return NOT_SUPPORT;
+    return ABILITY_PKG_SEARCH | ABILITY_PKG_DLOAD;
 }
 
 /**
@@ -23,6 +23,7 @@
 #include "hcs_macro.h"
 #include "hdf_config_macro.h"
 #include "driver/gpio.h"
+#include "hr_time.h"
 
 #define HDF_GPIO_DEBUG
 #define HDF_LOG_TAG "ESP32U4_HDF_GPIO"
@@ -72,7 +73,7 @@ struct GpioSourceValue all_gpio_config[GPIO_NUM_MAX]; // 单个GPIO配置，最
 #define DIR_PARAM_OFFSET 1
 #define ESP_INTR_FLAG_DEFAULT 0
 
-static unsigned int lastTickCount = 0;
+static uint64_t g_lastEdgeUs[GPIO_NUM_MAX]; // 各引脚上次边沿时刻
 static struct GpioCntlr g_EspGpioCntlr;
 
 static int32_t Esp32u4GpioWrite(struct GpioCntlr *cntlr, uint16_t local, uint16_t val)
@@ -106,14 +107,14 @@ static int32_t Esp32u4GpioGetDir(struct GpioCntlr *cntlr, uint16_t local, uint16
     return 0;
 }
 
-#define SHAKE_COUNT 10
+#define GPIO_DEBOUNCE_US 100000
 static void gpio_interrupt_callback_func(VOID *arg)
 {
-    unsigned int tickCount = osKernelGetTickCount();
-    unsigned int count = tickCount - lastTickCount;
-    lastTickCount = tickCount;
-    if (count > SHAKE_COUNT) { // 消抖
-        uint16_t *gpio_num = (uint16_t *)arg;
+    uint16_t *gpio_num = (uint16_t *)arg;
+    uint64_t nowUs = GetMonotonicUs();
+    uint64_t elapsedUs = nowUs - g_lastEdgeUs[*gpio_num];
+    g_lastEdgeUs[*gpio_num] = nowUs;
+    if (elapsedUs > GPIO_DEBOUNCE_US) { // 消抖
         GpioCntlrIrqCallback(&g_EspGpioCntlr, *gpio_num); // 调用用户注册的回调函数
     }
     return;
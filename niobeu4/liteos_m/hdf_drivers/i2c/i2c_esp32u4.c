@@ -87,14 +87,17 @@ static uint32_t GetI2cDeviceResource(struct RealI2cResource *i2cResource, const
     return result;
 }
 #define TICKS_SECOND 1000
+/* 命令链表放在栈上, 每次传输不再从系统堆申请, 出错返回时也不会泄漏 */
+#define I2C_CMD_LINK_SIZE I2C_LINK_RECOMMENDED_SIZE(1)
 unsigned int DeviceI2cWrite(int id, unsigned char addr, const unsigned char *data, unsigned int dataLen, int ack)
 {
     unsigned int ret;
     i2c_cmd_handle_t cmd;
+    uint8_t link[I2C_CMD_LINK_SIZE];
     if (dataLen < 1) {
         return 0;
     }
-    cmd = i2c_cmd_link_create();
+    cmd = i2c_cmd_link_create_static(link, sizeof(link));
     if ((ret = i2c_master_start(cmd)) != 0) {
         HDF_LOGE("DeviceI2cWrite i2c_master_start failed ret = %x", ret);
         return ret;
@@ -117,7 +120,7 @@ unsigned int DeviceI2cWrite(int id, unsigned char addr, const unsigned char *dat
         HDF_LOGE("DeviceI2cWrite i2c_master_cmd_begin failed ret = %d", ret);
         return ret;
     }
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
     return ret;
 }
 
@@ -125,10 +128,11 @@ unsigned int DeviceI2cRead(int id, unsigned char addr, const unsigned char *data
 {
     unsigned int ret;
     i2c_cmd_handle_t cmd;
+    uint8_t link[I2C_CMD_LINK_SIZE];
     if (dataLen < 1) {
         return 0;
     }
-    cmd = i2c_cmd_link_create();
+    cmd = i2c_cmd_link_create_static(link, sizeof(link));
     if ((ret = i2c_master_start(cmd)) != 0) {
         HDF_LOGE("DeviceI2cRead i2c_master_start failed ret = %x", ret);
         return ret;
@@ -160,7 +164,7 @@ unsigned int DeviceI2cRead(int id, unsigned char addr, const unsigned char *data
         HDF_LOGE("DeviceI2cRead i2c_master_cmd_begin failed ret = %x", ret);
         return ret;
     }
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
     return ret;
 }
 #define MODE2 2
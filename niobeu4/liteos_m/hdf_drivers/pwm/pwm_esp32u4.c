@@ -21,6 +21,7 @@
 #include "pwm_if.h"
 #include "pwm_core.h"
 #include "hdf_log.h"
+#include "log_level.h"
 #include "driver/mcpwm.h"
 #include "driver/ledc.h"
 
@@ -38,6 +39,8 @@
         (signal_port) = (pwm_num) % UNIT_MAX_OUTPUT; \
     } while (0)
 
+LOG_MODULE_DEFINE(PwmLog, "pwm");
+
 typedef struct _PwmDeviceConfig {
     int channel;
     int pwm_timer;
@@ -292,26 +295,26 @@ static int32_t PwmDevSetConfig(struct PwmDev *pwm, struct PwmConfig *config)
         if (pwmDevice->ledc_timer_config.freq_hz != PERIOD2FREQUENCY(config->period)) { // 周期有频率变化
             pwmDevice->ledc_timer_config.freq_hz = PERIOD2FREQUENCY(config->period);
             ledc_timer_config(&pwmDevice->ledc_timer_config); // 重新配置周期
-            printf("\r\n------->config freq_hz = %d [period = %d]\r\n",
-                   pwmDevice->ledc_timer_config.freq_hz, config->period);
-            printf("speed_mode = %d\r\n", pwmDevice->ledc_timer_config.speed_mode);
-            printf("timer_num = %d\r\n", pwmDevice->ledc_timer_config.timer_num);
-            printf("clk_cfg = %d\r\n", pwmDevice->ledc_timer_config.clk_cfg);
-            printf("duty_resolution = %d\r\n", pwmDevice->ledc_timer_config.duty_resolution);
+            HAL_LOGD(PwmLog, "\r\n------->config freq_hz = %d [period = %d]\r\n",
+                     pwmDevice->ledc_timer_config.freq_hz, config->period);
+            HAL_LOGD(PwmLog, "speed_mode = %d\r\n", pwmDevice->ledc_timer_config.speed_mode);
+            HAL_LOGD(PwmLog, "timer_num = %d\r\n", pwmDevice->ledc_timer_config.timer_num);
+            HAL_LOGD(PwmLog, "clk_cfg = %d\r\n", pwmDevice->ledc_timer_config.clk_cfg);
+            HAL_LOGD(PwmLog, "duty_resolution = %d\r\n", pwmDevice->ledc_timer_config.duty_resolution);
         }
         if (pwmDevice->ledc_channel_config.duty != GET_ESP_DUTY_CYCLE_PERCENT(config->duty, config->period)) {
             pwmDevice->ledc_channel_config.duty = GET_ESP_DUTY_CYCLE_PERCENT(config->duty, config->period);
-            printf("\r\n------->config ledc_duty = %d [duty=%d <--> period=%d]\r\n",
-                   pwmDevice->ledc_channel_config.duty, config->duty, config->period);
-            printf("gpio_num = %d\r\n", pwmDevice->ledc_channel_config.gpio_num);
-            printf("speed_mode = %d\r\n", pwmDevice->ledc_channel_config.speed_mode);
-            printf("channel = %d\r\n", pwmDevice->ledc_channel_config.channel);
-            printf("timer_sel = %d\r\n", pwmDevice->ledc_channel_config.timer_sel);
-            printf("hpoint = %d\r\n", pwmDevice->ledc_channel_config.hpoint);
+            HAL_LOGD(PwmLog, "\r\n------->config ledc_duty = %d [duty=%d <--> period=%d]\r\n",
+                     pwmDevice->ledc_channel_config.duty, config->duty, config->period);
+            HAL_LOGD(PwmLog, "gpio_num = %d\r\n", pwmDevice->ledc_channel_config.gpio_num);
+            HAL_LOGD(PwmLog, "speed_mode = %d\r\n", pwmDevice->ledc_channel_config.speed_mode);
+            HAL_LOGD(PwmLog, "channel = %d\r\n", pwmDevice->ledc_channel_config.channel);
+            HAL_LOGD(PwmLog, "timer_sel = %d\r\n", pwmDevice->ledc_channel_config.timer_sel);
+            HAL_LOGD(PwmLog, "hpoint = %d\r\n", pwmDevice->ledc_channel_config.hpoint);
         }
     } else if (config->status == PWM_DISABLE_STATUS) { // 失能PWM
         ledc_stop(pwmDevice->ledc_timer_config.speed_mode, pwmDevice->channel, config->polarity);
-        printf("------->pwm output stop, set level = %d\r\n", config->polarity);
+        HAL_LOGD(PwmLog, "------->pwm output stop, set level = %d\r\n", config->polarity);
     }
     return HDF_SUCCESS;
 }
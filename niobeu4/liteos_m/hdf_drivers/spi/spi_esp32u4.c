@@ -26,6 +26,8 @@
 #endif
 #include "hdf_log.h"
 #include "osal_mem.h"
+#include "securec.h"
+#include "dma_buf.h"
 #include "gpio_types.h"
 #include "driver/spi_common.h"
 #include "driver/spi_master.h"
@@ -301,9 +303,48 @@ static int32_t SpiDevSetCfg(struct SpiCntlr *spiCntlr, struct SpiCfg *spiCfg)
     return HDF_SUCCESS;
 }
 
-static int32_t SpiDevTransfer(struct SpiCntlr *spiCntlr, struct SpiMsg *spiMsg, uint32_t count)
+/*
+ * DMA 方式下, 不能直接用于 DMA 的缓冲先中转到 DMA 内存池, 避免驱动在系统堆中申请同样大小的中转缓冲;
+ * 调用者用 DmaBufAlloc 申请的缓冲不做拷贝. 内存池只按单方向的 max_transfer_size 配置, 发送优先;
+ * 全双工大块传输时接收中转申请失败, 保持调用者的缓冲, 由 IDF 驱动自行在堆中中转.
+ */
+static esp_err_t SpiDevTransferMsg(SpiDeviceSt *dev, const struct SpiMsg *msg)
 {
+    spi_transaction_t t = {0};
+    uint8_t *txBounce = NULL;
+    uint8_t *rxBounce = NULL;
     esp_err_t err;
+    t.length = msg->len << '\x3';
+    t.rx_buffer = msg->rbuf;
+    t.tx_buffer = msg->wbuf;
+    if (dev->dma_chn != 0) {
+        if ((msg->wbuf != NULL) && !DmaBufCapable(msg->wbuf, 0)) {
+            txBounce = (uint8_t *)DmaBufAlloc(msg->len);
+            if (txBounce != NULL) {
+                (void)memcpy_s(txBounce, msg->len, msg->wbuf, msg->len);
+                t.tx_buffer = txBounce;
+            }
+        }
+        if ((msg->rbuf != NULL) && !DmaBufCapable(msg->rbuf, msg->len)) {
+            rxBounce = (uint8_t *)DmaBufAlloc(msg->len);
+            if (rxBounce != NULL) {
+                t.rx_buffer = rxBounce;
+            }
+        }
+    }
+    err = spi_device_polling_transmit(dev->spi_handle, &t);
+    if (rxBounce != NULL) {
+        if (err == ESP_OK) {
+            (void)memcpy_s(msg->rbuf, msg->len, rxBounce, msg->len);
+        }
+        DmaBufFree(rxBounce);
+    }
+    DmaBufFree(txBounce);
+    return err;
+}
+
+static int32_t SpiDevTransfer(struct SpiCntlr *spiCntlr, struct SpiMsg *spiMsg, uint32_t count)
+{
     SpiDeviceSt *dev;
     if (spiCntlr == NULL) {
         return HDF_ERR_INVALID_PARAM;
@@ -314,15 +355,10 @@ static int32_t SpiDevTransfer(struct SpiCntlr *spiCntlr, struct SpiMsg *spiMsg,
     }
     for (size_t i = 0; i < count; i++) {
         struct SpiMsg *msg = &spiMsg[i];
-        spi_transaction_t t = {0};
         if ((msg->wbuf == NULL) && (msg->rbuf == NULL)) {
             continue;
         }
-        t.length = msg->len << '\x3';
-        t.rx_buffer = msg->rbuf;
-        t.tx_buffer = msg->wbuf;
-        err = spi_device_polling_transmit(dev->spi_handle, &t);
-        if (err != ESP_OK) {
+        if (SpiDevTransferMsg(dev, msg) != ESP_OK) {
             return HDF_ERR_DEVICE_BUSY;
         }
     }
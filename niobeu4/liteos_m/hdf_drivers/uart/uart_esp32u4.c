@@ -25,6 +25,7 @@
 #include "hcs_macro.h"
 #include "hdf_config_macro.h"
 #include "hdf_log.h"
+#include "log_level.h"
 
 #ifdef GPIO_NUM_MAX
 #undef GPIO_NUM_MAX
@@ -45,6 +46,8 @@
 #define OH2ESP_STOPBITS(oh_stop_bits) (1 + (oh_stop_bits))
 #define ESP2OH_STOPBITS(esp_stop_bits) ((esp_stop_bits)-1)
 
+LOG_MODULE_DEFINE(UartLog, "uart");
+
 #define PLATFORM_CONFIG HCS_NODE(HCS_ROOT, platform)
 #define PLATFORM_UART_CONFIG HCS_NODE(HCS_NODE(HCS_ROOT, platform), uart_config)
 #define HDF_GPIO_FIND_SOURCE(node, uartHost, device)                                                 \
@@ -67,14 +70,16 @@
             uart_config->parity = GetParityFromStr(cur_uart_attr.parity);                            \
             uart_config->stop_bits = GetStopBitsFromStr(cur_uart_attr.stop_bits);                    \
             uart_config->hw_flowcontrol = GetHwFlowControlFromStr(cur_uart_attr.hw_flowcontrol);     \
-            HDF_LOGE("----- UART%d Config -----", uart_config->uart_port);                           \
-            HDF_LOGE("baudrate = %d", uart_config->baudrate);                                        \
-            HDF_LOGE("Uart_Pin = [%d,%d,%d,%d]", uart_config->uart_pin[0], uart_config->uart_pin[1], \
-                     uart_config->uart_pin[2], uart_config->uart_pin[3]);                            \
-            HDF_LOGE("data_bits = %s[%d]", cur_uart_attr.data_bits, uart_config->data_bits);         \
-            HDF_LOGE("parity = %s[%d]", cur_uart_attr.parity, uart_config->parity);                  \
-            HDF_LOGE("stop_bits = %s[%d]", cur_uart_attr.stop_bits, uart_config->stop_bits);         \
-            HDF_LOGE("hw_flowcontrol = %s[%d]", cur_uart_attr.hw_flowcontrol,                        \
+            HAL_LOGD(UartLog, "----- UART%d Config -----\r\n", uart_config->uart_port);              \
+            HAL_LOGD(UartLog, "baudrate = %d\r\n", uart_config->baudrate);                           \
+            HAL_LOGD(UartLog, "Uart_Pin = [%d,%d,%d,%d]\r\n", uart_config->uart_pin[0],              \
+                     uart_config->uart_pin[1], uart_config->uart_pin[2], uart_config->uart_pin[3]);  \
+            HAL_LOGD(UartLog, "data_bits = %s[%d]\r\n", cur_uart_attr.data_bits,                     \
+                     uart_config->data_bits);                                                        \
+            HAL_LOGD(UartLog, "parity = %s[%d]\r\n", cur_uart_attr.parity, uart_config->parity);     \
+            HAL_LOGD(UartLog, "stop_bits = %s[%d]\r\n", cur_uart_attr.stop_bits,                     \
+                     uart_config->stop_bits);                                                        \
+            HAL_LOGD(UartLog, "hw_flowcontrol = %s[%d]\r\n", cur_uart_attr.hw_flowcontrol,           \
                      uart_config->hw_flowcontrol);                                                   \
             uart_config->block_time = 0;                                                             \
             (uartHost)->priv = uart_config;                                                          \
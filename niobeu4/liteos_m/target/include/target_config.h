@@ -43,11 +43,11 @@ void TaskCreateExtensionHook(VOID *);
 /*=============================================================================
                                         System clock module configuration
 =============================================================================*/
-#define OS_SYS_CLOCK (100UL)                          // 160000000
-#define LOSCFG_BASE_CORE_TICK_PER_SECOND OS_SYS_CLOCK // (100UL)
+#define OS_SYS_CLOCK (40000000UL)                     // 定时器组 0 计数频率, APB 80MHz 2 分频
+#define LOSCFG_BASE_CORE_TICK_PER_SECOND (100UL)
 #define LOSCFG_BASE_CORE_TICK_HW_TIME 0
 #define LOSCFG_BASE_CORE_TICK_WTIMER 1
-#define LOSCFG_BASE_CORE_TICK_RESPONSE_MAX OS_SYS_CLOCK // 1600000
+#define LOSCFG_BASE_CORE_TICK_RESPONSE_MAX (OS_SYS_CLOCK * 10) // 无事件时最长 10s 唤醒一次
 
 /*=============================================================================
                                         Hardware interrupt module configuration
@@ -55,6 +55,9 @@ void TaskCreateExtensionHook(VOID *);
 #define LOSCFG_PLATFORM_HWI 1
 #define OS_TICK_INT_NUM 6
 #define LOSCFG_PLATFORM_HWI_LIMIT 32
+#ifndef LOSCFG_IRQ_PROFILE
+#define LOSCFG_IRQ_PROFILE 0            // 中断耗时统计 (shell irqprof), 由 Kconfig IRQ_PROFILE 打开, 关闭时不产生任何代码
+#endif
 /*=============================================================================
                                        Task module configuration
 =============================================================================*/
@@ -101,6 +104,10 @@ void TaskCreateExtensionHook(VOID *);
 #define LOSCFG_MEM_FREE_BY_TASKID 0
 #define LOSCFG_BASE_MEM_NODE_INTEGRITY_CHECK 1
 #define LOSCFG_MEM_LEAKCHECK 0
+#define LOSCFG_MEM_TRACE 1
+/* 外设 DMA 内存池, 容纳 hdf.hcs 中 SPI 的 max_transfer_size 的单方向中转缓冲;
+ * 全双工传输收发都需中转时, 放不下的接收缓冲由 IDF 的 SPI 驱动在堆中中转 */
+#define LOSCFG_DMA_POOL_SIZE 0x9000UL
 #define LOSCFG_MEMORY_BESTFIT 1
 #define LOSCFG_KERNEL_MEM_SLAB 0
 /*=============================================================================
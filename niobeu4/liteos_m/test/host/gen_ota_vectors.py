@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+"""Generate the OTA packages test_ota.c writes into the simulated flash.
+
+Usage:
+  gen_ota_vectors.py OUT_DIR
+
+Packages are built with hals/update/ota_pack.py itself, signed with a fixed
+test key, so the C test checks the device side against the real packer:
+  ota_pubkey.der   SubjectPublicKeyInfo of the test key
+  ota_image.bin    the app image, larger than OTA_CKPT_INTERVAL and compressible
+  ota_full.bin     full image package
+  ota_lz.bin       LZ4 package
+  ota_base.bin     an older image, the running partition for the delta packages
+  ota_delta.bin    delta package from ota_base.bin to ota_image.bin
+  ota_delta_lz.bin the same delta with LZ4 compressed INSERT data
+"""
+
+import os
+import random
+import sys
+
+from cryptography.hazmat.primitives import serialization
+from cryptography.hazmat.primitives.asymmetric import ec
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '../../hals/update'))
+
+sys.dont_write_bytecode = True
+import ota_pack  # noqa: E402
+
+TEST_KEY = 0x4f56_4f54_5445_5354_4b45_59
+IMAGE_SIZE = 100 * 1024 + 123
+WORDS = [b'\x00' * 16, b'\xff' * 8, b'OpenHarmony', b'LiteOS-M', b'\x37\x13\x00\x00', b'esp32']
+
+
+def make_image():
+    # 字典词与随机字节混合, 压缩率接近真实固件, 匹配覆盖窗口内外
+    rng = random.Random(0x0A7A)
+    out = bytearray()
+    while len(out) < IMAGE_SIZE:
+        if rng.random() < 0.3:
+            out += bytes(rng.randrange(256) for _ in range(rng.randrange(1, 24)))
+        else:
+            out += rng.choice(WORDS)
+    return bytes(out[:IMAGE_SIZE])
+
+
+def make_base(image):
+    # 旧版本: 大段相同但位置错开, 之间有新版本删去或新增的内容
+    rng = random.Random(0xBA5E)
+    out = bytearray()
+    pos = 0
+    while pos < len(image):
+        n = rng.randrange(2048, 8192)
+        out += image[pos:pos + n]
+        pos += n
+        if rng.random() < 0.5:
+            pos += rng.randrange(64, 1024)
+        else:
+            out += bytes(rng.randrange(256) for _ in range(rng.randrange(16, 256)))
+    return bytes(out)
+
+
+def main():
+    out = sys.argv[1]
+    key = ec.derive_private_key(TEST_KEY, ec.SECP256R1())
+    image = make_image()
+    base = make_base(image)
+    files = {
+        'ota_pubkey.der': key.public_key().public_bytes(serialization.Encoding.DER,
+                                                        serialization.PublicFormat.SubjectPublicKeyInfo),
+        'ota_image.bin': image,
+        'ota_full.bin': ota_pack.build(key, image),
+        'ota_lz.bin': ota_pack.build(key, image, lz4=True),
+        'ota_base.bin': base,
+        'ota_delta.bin': ota_pack.build(key, image, base),
+        'ota_delta_lz.bin': ota_pack.build(key, image, base, lz4=True),
+    }
+    os.makedirs(out, exist_ok=True)
+    for name, data in files.items():
+        with open(os.path.join(out, name), 'wb') as f:
+            f.write(data)
+
+
+if __name__ == '__main__':
+    main()
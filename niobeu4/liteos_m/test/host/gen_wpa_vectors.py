@@ -0,0 +1,200 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+"""Generate wpa_vectors.h, the EAPOL-Key frames test_wpa.c feeds to the supplicant.
+
+Usage:
+  gen_wpa_vectors.py > wpa_vectors.h
+
+This is an independent authenticator written from IEEE 802.11-2016 12.7:
+PRF-SHA1 key expansion, HMAC-SHA1/HMAC-MD5 MICs, AES key wrap (RFC 3394) and
+RC4 key data encryption. Each scenario lists the frames the AP sends and the
+exact frames the station must answer with, so the C test checks PTK derivation,
+the MIC and key data handling byte for byte. SNonce comes from the host
+esp_fill_random stub, which fills buf[i] = RANDOM_SEED ^ i.
+
+Needs the `cryptography` package for AES key wrap.
+"""
+
+import hashlib
+import hmac
+import struct
+
+from cryptography.hazmat.primitives.keywrap import aes_key_wrap
+
+RANDOM_SEED = 0x5A
+SSID = b'niobe-test'
+PASSPHRASE = b'correct horse battery'
+AA = bytes.fromhex('020000000100')
+SPA = bytes.fromhex('020000000200')
+ANONCE = bytes(range(0x10, 0x30))
+SNONCE = bytes(RANDOM_SEED ^ i for i in range(32))
+GTK_CCMP = bytes(range(0x40, 0x50))
+GTK_CCMP_NEW = bytes(range(0x50, 0x60))
+IGTK = bytes(range(0x60, 0x70))
+GTK_TKIP = bytes(range(0x80, 0xa0))
+KEY_IV = bytes(range(0xc0, 0xd0))
+
+RSN_IE = bytes.fromhex('30140100000fac040100000fac040100000fac028000')
+WPA_IE = bytes.fromhex('dd160050f20101000050f20201000050f20201000050f202')
+
+VER_MD5 = 1
+VER_SHA1 = 2
+PAIRWISE = 0x0008
+INSTALL = 0x0040
+ACK = 0x0080
+MIC = 0x0100
+SECURE = 0x0200
+ENCR = 0x1000
+DESC_RSN = 2
+DESC_WPA = 254
+
+
+def prf(key, label, data, nbytes):
+    out = b''
+    i = 0
+    while len(out) < nbytes:
+        out += hmac.new(key, label + b'\x00' + data + bytes([i]), hashlib.sha1).digest()
+        i += 1
+    return out[:nbytes]
+
+
+def derive_ptk(pmk, tk_len):
+    data = min(AA, SPA) + max(AA, SPA) + min(ANONCE, SNONCE) + max(ANONCE, SNONCE)
+    return prf(pmk, b'Pairwise key expansion', data, 32 + tk_len)
+
+
+def rc4(key, data, skip=256):
+    s = list(range(256))
+    j = 0
+    for i in range(256):
+        j = (j + s[i] + key[i % len(key)]) & 0xff
+        s[i], s[j] = s[j], s[i]
+    i = j = 0
+    out = bytearray()
+    for k in range(skip + len(data)):
+        i = (i + 1) & 0xff
+        j = (j + s[i]) & 0xff
+        s[i], s[j] = s[j], s[i]
+        if k >= skip:
+            out.append(data[k - skip] ^ s[(s[i] + s[j]) & 0xff])
+    return bytes(out)
+
+
+def eapol_key(desc, info, key_len, replay, nonce=b'', iv=b'', rsc=b'', data=b'', kck=None):
+    body = bytearray(95)
+    body[0] = desc
+    struct.pack_into('>HHQ', body, 1, info, key_len, replay)
+    body[13:13 + len(nonce)] = nonce
+    body[45:45 + len(iv)] = iv
+    body[61:61 + len(rsc)] = rsc
+    struct.pack_into('>H', body, 93, len(data))
+    frame = bytearray(struct.pack('>BBH', 1, 3, len(body) + len(data))) + body + data
+    if kck is not None:
+        digest = hashlib.md5 if (info & 7) == VER_MD5 else hashlib.sha1
+        frame[81:97] = hmac.new(kck, bytes(frame), digest).digest()[:16]
+    return bytes(frame)
+
+
+def eth(frame):
+    return AA + SPA + b'\x88\x8e' + frame
+
+
+def wrap_kde(kek, kdes):
+    data = kdes
+    if len(data) % 8 or len(data) < 16:
+        data += b'\xdd' + b'\x00' * ((8 - (len(data) + 1) % 8) % 8)
+    while len(data) < 16:
+        data += b'\x00' * 8
+    return aes_key_wrap(kek, data)
+
+
+def gtk_kde(idx, gtk):
+    return bytes([0xdd, 6 + len(gtk)]) + b'\x00\x0f\xac\x01' + bytes([idx, 0]) + gtk
+
+
+def igtk_kde(kid, ipn, igtk):
+    return bytes([0xdd, 28]) + b'\x00\x0f\xac\x09' + struct.pack('<H', kid) + ipn + igtk
+
+
+def ccmp_scenario(pmk):
+    ptk = derive_ptk(pmk, 16)
+    kck, kek = ptk[:16], ptk[16:32]
+    v = {'PTK': ptk}
+    v['MSG1'] = eapol_key(DESC_RSN, VER_SHA1 | PAIRWISE | ACK, 16, 1, ANONCE)
+    v['MSG2'] = eth(eapol_key(DESC_RSN, VER_SHA1 | PAIRWISE | MIC, 0, 1, SNONCE, data=RSN_IE, kck=kck))
+    kdes = RSN_IE + gtk_kde(1, GTK_CCMP) + igtk_kde(4, bytes(6), IGTK)
+    info3 = VER_SHA1 | PAIRWISE | INSTALL | ACK | MIC | SECURE | ENCR
+    data3 = wrap_kde(kek, kdes)
+    v['MSG3'] = eapol_key(DESC_RSN, info3, 16, 2, ANONCE, data=data3, kck=kck)
+    v['MSG4'] = eth(eapol_key(DESC_RSN, VER_SHA1 | PAIRWISE | MIC | SECURE, 0, 2, kck=kck))
+    # AP 未收到 message 4, 以新的重放计数重传 message 3
+    v['MSG3_RETRY'] = eapol_key(DESC_RSN, info3, 16, 3, ANONCE, data=data3, kck=kck)
+    v['MSG4_RETRY'] = eth(eapol_key(DESC_RSN, VER_SHA1 | PAIRWISE | MIC | SECURE, 0, 3, kck=kck))
+    # 组密钥更新: 新 GTK 索引 2, 随后原样重放同一 GTK
+    ginfo = VER_SHA1 | ACK | MIC | SECURE | ENCR
+    gdata = wrap_kde(kek, gtk_kde(2, GTK_CCMP_NEW) + igtk_kde(4, bytes([1, 0, 0, 0, 0, 0]), IGTK))
+    v['GROUP1'] = eapol_key(DESC_RSN, ginfo, 16, 4, rsc=bytes(8), data=gdata, kck=kck)
+    v['GROUP2'] = eth(eapol_key(DESC_RSN, VER_SHA1 | MIC | SECURE, 0, 4, kck=kck))
+    v['GROUP1_REPEAT'] = eapol_key(DESC_RSN, ginfo, 16, 5, rsc=bytes(8), data=gdata, kck=kck)
+    v['GROUP2_REPEAT'] = eth(eapol_key(DESC_RSN, VER_SHA1 | MIC | SECURE, 0, 5, kck=kck))
+    # 不带 MIC 位的组密钥消息, 内容由攻击者任意构造
+    v['GROUP1_NOMIC'] = eapol_key(DESC_RSN, VER_SHA1 | ACK | SECURE | ENCR, 16, 6, data=gdata)
+    return v
+
+
+def tkip_scenario(pmk):
+    ptk = derive_ptk(pmk, 32)
+    kck, kek = ptk[:16], ptk[16:32]
+    v = {'PTK': ptk}
+    v['MSG1'] = eapol_key(DESC_WPA, VER_MD5 | PAIRWISE | ACK, 32, 1, ANONCE)
+    v['MSG2'] = eth(eapol_key(DESC_WPA, VER_MD5 | PAIRWISE | MIC, 32, 1, SNONCE, data=WPA_IE, kck=kck))
+    v['MSG3'] = eapol_key(DESC_WPA, VER_MD5 | PAIRWISE | INSTALL | ACK | MIC, 32, 2, ANONCE, data=WPA_IE, kck=kck)
+    v['MSG4'] = eth(eapol_key(DESC_WPA, VER_MD5 | PAIRWISE | MIC, 0, 2, kck=kck))
+    ginfo = VER_MD5 | ACK | MIC | SECURE | (1 << 4)
+    gdata = rc4(KEY_IV + kek, GTK_TKIP)
+    v['GROUP1'] = eapol_key(DESC_WPA, ginfo, 32, 3, iv=KEY_IV, rsc=bytes(8), data=gdata, kck=kck)
+    v['GROUP2'] = eth(eapol_key(DESC_WPA, VER_MD5 | MIC | SECURE | (1 << 4), 0, 3, kck=kck))
+    # 驱动收到的 TKIP GTK 交换了 Tx/Rx MIC 密钥
+    v['GTK_INSTALLED'] = GTK_TKIP[:16] + GTK_TKIP[24:32] + GTK_TKIP[16:24]
+    return v
+
+
+def emit(name, data):
+    lines = ['static const uint8_t %s[] = {' % name]
+    for i in range(0, len(data), 12):
+        lines.append('    ' + ' '.join('0x%02x,' % b for b in data[i:i + 12]))
+    lines.append('};')
+    return '\n'.join(lines)
+
+
+def main():
+    pmk = hashlib.pbkdf2_hmac('sha1', PASSPHRASE, SSID, 4096, 32)
+    out = ['/* Generated by gen_wpa_vectors.py, do not edit. */',
+           '#ifndef WPA_VECTORS_H', '#define WPA_VECTORS_H', '',
+           '#include <stdint.h>', '',
+           '#define VEC_RANDOM_SEED 0x%02X' % RANDOM_SEED, '',
+           emit('VEC_PMK', pmk), emit('VEC_AA', AA), emit('VEC_SPA', SPA),
+           emit('VEC_RSN_IE', RSN_IE), emit('VEC_GTK_CCMP', GTK_CCMP), emit('VEC_GTK_CCMP_NEW', GTK_CCMP_NEW),
+           emit('VEC_IGTK', IGTK)]
+    for prefix, scenario in (('VEC_CCMP_', ccmp_scenario(pmk)), ('VEC_TKIP_', tkip_scenario(pmk))):
+        for name, data in scenario.items():
+            out.append(emit(prefix + name, data))
+    out += ['', '#endif /* WPA_VECTORS_H */', '']
+    print('\n'.join(out))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机单元测试的断言与计数, 每个测试程序 main 末尾返回 HostTestResult() */
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <string.h>
+
+static int HostTestFailed = 0;
+static int HostTestChecked = 0;
+
+#define TEST_CHECK(cond) do { \
+    HostTestChecked++; \
+    if (!(cond)) { \
+        HostTestFailed++; \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define TEST_CHECK_MEM(a, b, len) TEST_CHECK(memcmp((a), (b), (len)) == 0)
+
+static inline int HostTestResult(const char *name)
+{
+    printf("%s: %d checks, %d failed\n", name, HostTestChecked, HostTestFailed);
+    return (HostTestFailed == 0) ? 0 : 1;
+}
+
+#endif /* HOST_TEST_H */
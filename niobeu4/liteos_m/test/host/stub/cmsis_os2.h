@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: CMSIS-RTOS2 软件定时器, 只记录启停状态, 由测试调用 HostTimerFire 触发 */
+#ifndef HOST_STUB_CMSIS_OS2_H
+#define HOST_STUB_CMSIS_OS2_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define HOST_TIMER_MAX 8
+
+typedef void *osTimerId_t;
+typedef void (*osTimerFunc_t)(void *argument);
+typedef int32_t osStatus_t;
+
+typedef enum {
+    osTimerOnce = 0,
+    osTimerPeriodic = 1,
+} osTimerType_t;
+
+typedef struct {
+    const char *name;
+} osTimerAttr_t;
+
+typedef struct {
+    osTimerFunc_t func;
+    void *arg;
+    osTimerType_t type;
+    bool running;
+    uint32_t ticks;
+    uint32_t starts;
+} HostTimer;
+
+#define osOK 0
+#define osError (-1)
+
+static HostTimer HostTimers[HOST_TIMER_MAX];
+static int HostTimerNum = 0;
+
+static inline osTimerId_t osTimerNew(osTimerFunc_t func, osTimerType_t type, void *argument,
+                                     const osTimerAttr_t *attr)
+{
+    HostTimer *t = NULL;
+    if (HostTimerNum >= HOST_TIMER_MAX) {
+        return NULL;
+    }
+    t = &HostTimers[HostTimerNum++];
+    t->func = func;
+    t->arg = argument;
+    t->type = type;
+    return t;
+}
+
+static inline osStatus_t osTimerStart(osTimerId_t id, uint32_t ticks)
+{
+    HostTimer *t = (HostTimer *)id;
+    t->running = true;
+    t->ticks = ticks;
+    t->starts++;
+    return osOK;
+}
+
+static inline osStatus_t osTimerStop(osTimerId_t id)
+{
+    ((HostTimer *)id)->running = false;
+    return osOK;
+}
+
+static inline uint32_t osTimerIsRunning(osTimerId_t id)
+{
+    return ((HostTimer *)id)->running ? 1 : 0;
+}
+
+// 模拟定时器到期, 未运行时不回调
+static inline void HostTimerFire(osTimerId_t id)
+{
+    HostTimer *t = (HostTimer *)id;
+    if ((t == NULL) || !t->running) {
+        return;
+    }
+    if (t->type == osTimerOnce) {
+        t->running = false;
+    }
+    t->func(t->arg);
+}
+
+#endif /* HOST_STUB_CMSIS_OS2_H */
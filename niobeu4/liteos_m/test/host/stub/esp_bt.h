@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: ESP-IDF 蓝牙公共类型 (esp_bt_defs.h) */
+#ifndef HOST_STUB_ESP_BT_H
+#define HOST_STUB_ESP_BT_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#define ESP_BD_ADDR_LEN 6
+#define ESP_UUID_LEN_16 2
+#define ESP_UUID_LEN_32 4
+#define ESP_UUID_LEN_128 16
+
+typedef uint8_t esp_bd_addr_t[ESP_BD_ADDR_LEN];
+
+typedef struct {
+    uint16_t len;
+    union {
+        uint16_t uuid16;
+        uint32_t uuid32;
+        uint8_t uuid128[ESP_UUID_LEN_128];
+    } uuid;
+} esp_bt_uuid_t;
+
+typedef uint8_t esp_ble_addr_type_t;
+typedef uint8_t esp_bt_dev_type_t;
+
+#endif /* HOST_STUB_ESP_BT_H */
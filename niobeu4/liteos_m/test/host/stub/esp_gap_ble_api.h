@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: ESP-IDF BLE GAP 接口中 HAL 用到的类型与事件 */
+#ifndef HOST_STUB_ESP_GAP_BLE_API_H
+#define HOST_STUB_ESP_GAP_BLE_API_H
+
+#include <stdint.h>
+#include "esp_bt.h"
+
+#define ESP_BLE_ADV_DATA_LEN_MAX 31
+#define ESP_BLE_SCAN_RSP_DATA_LEN_MAX 31
+
+typedef enum {
+    ESP_GAP_BLE_ADV_DATA_SET_COMPLETE_EVT = 0,
+    ESP_GAP_BLE_SCAN_RSP_DATA_SET_COMPLETE_EVT,
+    ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT,
+    ESP_GAP_BLE_SCAN_RESULT_EVT,
+    ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT = 20,
+} esp_gap_ble_cb_event_t;
+
+typedef enum {
+    ESP_GAP_SEARCH_INQ_RES_EVT = 0,
+    ESP_GAP_SEARCH_INQ_CMPL_EVT = 1,
+} esp_gap_search_evt_t;
+
+typedef enum {
+    ESP_BLE_EVT_CONN_ADV = 0x00,
+    ESP_BLE_EVT_CONN_DIR_ADV = 0x01,
+    ESP_BLE_EVT_DISC_ADV = 0x02,
+    ESP_BLE_EVT_NON_CONN_ADV = 0x03,
+    ESP_BLE_EVT_SCAN_RSP = 0x04,
+} esp_ble_evt_type_t;
+
+typedef struct {
+    uint8_t scan_type;
+    uint8_t own_addr_type;
+    uint8_t scan_filter_policy;
+    uint16_t scan_interval;
+    uint16_t scan_window;
+    uint8_t scan_duplicate;
+} esp_ble_scan_params_t;
+
+typedef struct {
+    esp_bd_addr_t bda;
+    uint16_t min_int;
+    uint16_t max_int;
+    uint16_t latency;
+    uint16_t timeout;
+} esp_ble_conn_update_params_t;
+
+typedef struct {
+    uint8_t set_scan_rsp;
+    uint8_t include_name;
+    uint8_t include_txpower;
+    int min_interval;
+    int max_interval;
+    int appearance;
+    uint16_t manufacturer_len;
+    uint8_t *p_manufacturer_data;
+    uint16_t service_data_len;
+    uint8_t *p_service_data;
+    uint16_t service_uuid_len;
+    uint8_t *p_service_uuid;
+    uint8_t flag;
+} esp_ble_adv_data_t;
+
+typedef struct {
+    uint16_t adv_int_min;
+    uint16_t adv_int_max;
+    uint8_t adv_type;
+    uint8_t own_addr_type;
+    esp_bd_addr_t peer_addr;
+    uint8_t peer_addr_type;
+    uint8_t channel_map;
+    uint8_t adv_filter_policy;
+} esp_ble_adv_params_t;
+
+typedef union {
+    struct ble_scan_result_evt_param {
+        esp_gap_search_evt_t search_evt;
+        esp_bd_addr_t bda;
+        esp_bt_dev_type_t dev_type;
+        esp_ble_addr_type_t ble_addr_type;
+        esp_ble_evt_type_t ble_evt_type;
+        int rssi;
+        uint8_t ble_adv[ESP_BLE_ADV_DATA_LEN_MAX + ESP_BLE_SCAN_RSP_DATA_LEN_MAX];
+        int flag;
+        int num_resps;
+        uint8_t adv_data_len;
+        uint8_t scan_rsp_len;
+        uint32_t num_dis;
+    } scan_rst;
+    struct ble_update_conn_params_evt_param {
+        int status;
+        esp_bd_addr_t bda;
+        uint16_t min_int;
+        uint16_t max_int;
+        uint16_t latency;
+        uint16_t conn_int;
+        uint16_t timeout;
+    } update_conn_params;
+} esp_ble_gap_cb_param_t;
+
+esp_err_t esp_ble_gap_update_conn_params(esp_ble_conn_update_params_t *params);
+esp_err_t esp_ble_gap_set_pkt_data_len(esp_bd_addr_t remote_device, uint16_t tx_data_length);
+
+#endif /* HOST_STUB_ESP_GAP_BLE_API_H */
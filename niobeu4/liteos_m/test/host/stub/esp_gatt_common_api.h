@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: ESP-IDF GATT 公共接口, 由测试实现 */
+#ifndef HOST_STUB_ESP_GATT_COMMON_API_H
+#define HOST_STUB_ESP_GATT_COMMON_API_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+int esp_ble_get_cur_sendable_packets_num(uint16_t connid);
+
+#endif /* HOST_STUB_ESP_GATT_COMMON_API_H */
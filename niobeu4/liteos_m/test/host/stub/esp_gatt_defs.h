@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: ESP-IDF GATT 公共类型 */
+#ifndef HOST_STUB_ESP_GATT_DEFS_H
+#define HOST_STUB_ESP_GATT_DEFS_H
+
+#include <stdint.h>
+#include "esp_bt.h"
+
+#define ESP_GATT_IF_NONE 0xff
+#define ESP_GATT_MAX_ATTR_LEN 600
+
+typedef uint8_t esp_gatt_if_t;
+
+typedef enum {
+    ESP_GATT_OK = 0x0,
+    ESP_GATT_INVALID_HANDLE = 0x01,
+    ESP_GATT_INVALID_OFFSET = 0x07,
+    ESP_GATT_INSUF_RESOURCE = 0x11,
+    ESP_GATT_ERROR = 0x85,
+    ESP_GATT_CONGESTED = 0x8f,
+} esp_gatt_status_t;
+
+typedef enum {
+    ESP_GATT_AUTH_REQ_NONE = 0,
+    ESP_GATT_AUTH_REQ_NO_MITM = 1,
+    ESP_GATT_AUTH_REQ_MITM = 2,
+} esp_gatt_auth_req_t;
+
+typedef enum {
+    ESP_GATT_WRITE_TYPE_NO_RSP = 1,
+    ESP_GATT_WRITE_TYPE_RSP,
+} esp_gatt_write_type_t;
+
+typedef enum {
+    ESP_GATT_DB_PRIMARY_SERVICE,
+    ESP_GATT_DB_SECONDARY_SERVICE,
+    ESP_GATT_DB_CHARACTERISTIC,
+    ESP_GATT_DB_DESCRIPTOR,
+    ESP_GATT_DB_INCLUDED_SERVICE,
+    ESP_GATT_DB_ALL,
+} esp_gatt_db_attr_type_t;
+
+typedef struct {
+    uint16_t attr_max_len;
+    uint16_t attr_len;
+    uint8_t *attr_value;
+} esp_attr_value_t;
+
+typedef struct {
+    uint8_t auto_rsp;
+} esp_attr_control_t;
+
+typedef struct {
+    uint16_t handle;
+    uint16_t offset;
+    uint16_t len;
+    uint8_t auth_req;
+    uint8_t value[ESP_GATT_MAX_ATTR_LEN];
+} esp_gatt_value_t;
+
+typedef union {
+    esp_gatt_value_t attr_value;
+    uint16_t handle;
+} esp_gatt_rsp_t;
+
+typedef struct {
+    esp_bt_uuid_t uuid;
+    uint8_t inst_id;
+} esp_gatt_id_t;
+
+typedef struct {
+    esp_gatt_id_t id;
+    uint8_t is_primary;
+} esp_gatt_srvc_id_t;
+
+typedef struct {
+    uint16_t char_handle;
+    uint8_t properties;
+    esp_bt_uuid_t uuid;
+} esp_gattc_char_elem_t;
+
+typedef struct {
+    uint16_t handle;
+    esp_bt_uuid_t uuid;
+} esp_gattc_descr_elem_t;
+
+#endif /* HOST_STUB_ESP_GATT_DEFS_H */
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: ESP-IDF GATT 客户端接口中 HAL 用到的事件与参数, 写函数由测试实现 */
+#ifndef HOST_STUB_ESP_GATTC_API_H
+#define HOST_STUB_ESP_GATTC_API_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_gatt_defs.h"
+
+typedef enum {
+    ESP_GATTC_REG_EVT = 0,
+    ESP_GATTC_OPEN_EVT = 2,
+    ESP_GATTC_WRITE_CHAR_EVT = 4,
+    ESP_GATTC_CLOSE_EVT = 5,
+    ESP_GATTC_PREP_WRITE_EVT = 11,
+    ESP_GATTC_EXEC_EVT = 12,
+    ESP_GATTC_CFG_MTU_EVT = 18,
+    ESP_GATTC_CONGEST_EVT = 24,
+    ESP_GATTC_DISCONNECT_EVT = 41,
+} esp_gattc_cb_event_t;
+
+typedef union {
+    struct gattc_open_evt_param {
+        esp_gatt_status_t status;
+        uint16_t conn_id;
+        esp_bd_addr_t remote_bda;
+        uint16_t mtu;
+    } open;
+    struct gattc_close_evt_param {
+        esp_gatt_status_t status;
+        uint16_t conn_id;
+        esp_bd_addr_t remote_bda;
+        int reason;
+    } close;
+    struct gattc_disconnect_evt_param {
+        int reason;
+        uint16_t conn_id;
+        esp_bd_addr_t remote_bda;
+    } disconnect;
+    struct gattc_cfg_mtu_evt_param {
+        esp_gatt_status_t status;
+        uint16_t conn_id;
+        uint16_t mtu;
+    } cfg_mtu;
+    struct gattc_congest_evt_param {
+        uint16_t conn_id;
+        bool congested;
+    } congest;
+    struct gattc_write_evt_param {
+        esp_gatt_status_t status;
+        uint16_t conn_id;
+        uint16_t handle;
+        uint16_t offset;
+    } write;
+    struct gattc_exec_cmpl_evt_param {
+        esp_gatt_status_t status;
+        uint16_t conn_id;
+    } exec_cmpl;
+} esp_ble_gattc_cb_param_t;
+
+esp_err_t esp_ble_gattc_write_char(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t handle, uint16_t value_len,
+                                   uint8_t *value, esp_gatt_write_type_t write_type, esp_gatt_auth_req_t auth_req);
+esp_err_t esp_ble_gattc_prepare_write(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t handle, uint16_t offset,
+                                      uint16_t value_len, uint8_t *value, esp_gatt_auth_req_t auth_req);
+esp_err_t esp_ble_gattc_execute_write(esp_gatt_if_t gattc_if, uint16_t conn_id, bool is_execute);
+
+#endif /* HOST_STUB_ESP_GATTC_API_H */
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: 随机数由各测试提供, 以便生成可复现的向量 */
+#ifndef HOST_STUB_ESP_SYSTEM_H
+#define HOST_STUB_ESP_SYSTEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+void esp_fill_random(void *buf, size_t len);
+
+#endif /* HOST_STUB_ESP_SYSTEM_H */
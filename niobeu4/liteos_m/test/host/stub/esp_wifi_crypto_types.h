@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: 驱动密码学函数表, 函数指针类型统一为 void *, 测试不经由该表调用 */
+#ifndef HOST_STUB_ESP_WIFI_CRYPTO_TYPES_H
+#define HOST_STUB_ESP_WIFI_CRYPTO_TYPES_H
+
+#include <stdint.h>
+
+#define ESP_WIFI_CRYPTO_VERSION 0x00000001
+
+typedef void *esp_aes_wrap_t;
+typedef void *esp_aes_unwrap_t;
+typedef void *esp_hmac_sha256_vector_t;
+typedef void *esp_sha256_prf_t;
+typedef void *esp_hmac_md5_t;
+typedef void *esp_hmac_md5_vector_t;
+typedef void *esp_hmac_sha1_t;
+typedef void *esp_hmac_sha1_vector_t;
+typedef void *esp_sha1_prf_t;
+typedef void *esp_sha1_vector_t;
+typedef void *esp_pbkdf2_sha1_t;
+typedef void *esp_rc4_skip_t;
+typedef void *esp_md5_vector_t;
+typedef void *esp_aes_encrypt_t;
+typedef void *esp_aes_encrypt_init_t;
+typedef void *esp_aes_encrypt_deinit_t;
+typedef void *esp_aes_decrypt_t;
+typedef void *esp_aes_decrypt_init_t;
+typedef void *esp_aes_decrypt_deinit_t;
+typedef void *esp_aes_128_encrypt_t;
+typedef void *esp_aes_128_decrypt_t;
+typedef void *esp_omac1_aes_128_t;
+
+typedef struct {
+    uint32_t size;
+    uint32_t version;
+    esp_aes_wrap_t aes_wrap;
+    esp_aes_unwrap_t aes_unwrap;
+    esp_hmac_sha256_vector_t hmac_sha256_vector;
+    esp_sha256_prf_t sha256_prf;
+    esp_hmac_md5_t hmac_md5;
+    esp_hmac_md5_vector_t hamc_md5_vector;
+    esp_hmac_sha1_t hmac_sha1;
+    esp_hmac_sha1_vector_t hmac_sha1_vector;
+    esp_sha1_prf_t sha1_prf;
+    esp_sha1_vector_t sha1_vector;
+    esp_pbkdf2_sha1_t pbkdf2_sha1;
+    esp_rc4_skip_t rc4_skip;
+    esp_md5_vector_t md5_vector;
+    esp_aes_encrypt_t aes_encrypt;
+    esp_aes_encrypt_init_t aes_encrypt_init;
+    esp_aes_encrypt_deinit_t aes_encrypt_deinit;
+    esp_aes_decrypt_t aes_decrypt;
+    esp_aes_decrypt_init_t aes_decrypt_init;
+    esp_aes_decrypt_deinit_t aes_decrypt_deinit;
+    esp_aes_128_encrypt_t aes_128_encrypt;
+    esp_aes_128_decrypt_t aes_128_decrypt;
+    esp_omac1_aes_128_t omac1_aes_128;
+    void *ccmp_decrypt;
+    void *ccmp_encrypt;
+} wpa_crypto_funcs_t;
+
+#endif /* HOST_STUB_ESP_WIFI_CRYPTO_TYPES_H */
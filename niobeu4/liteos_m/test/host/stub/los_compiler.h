@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: LiteOS-M 基本类型 */
+#ifndef HOST_STUB_LOS_COMPILER_H
+#define HOST_STUB_LOS_COMPILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef void VOID;
+typedef char CHAR;
+typedef unsigned char UINT8;
+typedef unsigned short UINT16;
+typedef unsigned int UINT32;
+typedef unsigned long long UINT64;
+typedef int INT32;
+typedef long long INT64;
+typedef unsigned int BOOL;
+typedef uintptr_t UINTPTR;
+
+#ifndef TRUE
+#define TRUE 1U
+#define FALSE 0U
+#endif
+#define STATIC static
+#define INLINE static inline
+#define LOS_OK 0U
+#define LOS_NOK 1U
+
+#endif /* HOST_STUB_LOS_COMPILER_H */
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: LiteOS-M 互斥锁, 测试单线程运行, 加解锁只计数 */
+#ifndef HOST_STUB_LOS_MUX_H
+#define HOST_STUB_LOS_MUX_H
+
+#include "los_compiler.h"
+
+#define LOS_WAIT_FOREVER 0xFFFFFFFFU
+#define LOS_NO_WAIT 0U
+
+static UINT32 HostMuxNum = 0;
+static UINT32 HostMuxDepth[8];
+
+static inline UINT32 LOS_MuxCreate(UINT32 *muxHandle)
+{
+    if (HostMuxNum >= (sizeof(HostMuxDepth) / sizeof(HostMuxDepth[0]))) {
+        return LOS_NOK;
+    }
+    *muxHandle = HostMuxNum++;
+    return LOS_OK;
+}
+
+static inline UINT32 LOS_MuxPend(UINT32 muxHandle, UINT32 timeout)
+{
+    HostMuxDepth[muxHandle]++;
+    return LOS_OK;
+}
+
+static inline UINT32 LOS_MuxPost(UINT32 muxHandle)
+{
+    HostMuxDepth[muxHandle]--;
+    return LOS_OK;
+}
+
+#endif /* HOST_STUB_LOS_MUX_H */
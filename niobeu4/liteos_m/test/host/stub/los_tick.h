@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: LiteOS-M 系统节拍, 由测试推进 HostTick */
+#ifndef HOST_STUB_LOS_TICK_H
+#define HOST_STUB_LOS_TICK_H
+
+#include "los_compiler.h"
+
+#ifndef LOSCFG_BASE_CORE_TICK_PER_SECOND
+#define LOSCFG_BASE_CORE_TICK_PER_SECOND (100UL)
+#endif
+
+static UINT64 HostTick = 0;
+
+static inline UINT64 LOS_TickCountGet(void)
+{
+    return HostTick;
+}
+
+#endif /* HOST_STUB_LOS_TICK_H */
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: mbedTLS AES 接口, 以 OpenSSL 底层 AES 实现 */
+#ifndef HOST_STUB_MBEDTLS_AES_H
+#define HOST_STUB_MBEDTLS_AES_H
+
+#include <string.h>
+#include <openssl/aes.h>
+
+#define MBEDTLS_AES_ENCRYPT 1
+#define MBEDTLS_AES_DECRYPT 0
+
+typedef struct {
+    AES_KEY enc;
+    AES_KEY dec;
+} mbedtls_aes_context;
+
+static inline void mbedtls_aes_init(mbedtls_aes_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+static inline void mbedtls_aes_free(mbedtls_aes_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+static inline int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key, unsigned int keybits)
+{
+    return AES_set_encrypt_key(key, (int)keybits, &ctx->enc);
+}
+
+static inline int mbedtls_aes_setkey_dec(mbedtls_aes_context *ctx, const unsigned char *key, unsigned int keybits)
+{
+    return AES_set_decrypt_key(key, (int)keybits, &ctx->dec);
+}
+
+static inline int mbedtls_aes_crypt_ecb(mbedtls_aes_context *ctx, int mode, const unsigned char input[16],
+                                        unsigned char output[16])
+{
+    if (mode == MBEDTLS_AES_ENCRYPT) {
+        AES_encrypt(input, output, &ctx->enc);
+    } else {
+        AES_decrypt(input, output, &ctx->dec);
+    }
+    return 0;
+}
+
+static inline int mbedtls_aes_crypt_cbc(mbedtls_aes_context *ctx, int mode, size_t length, unsigned char iv[16],
+                                        const unsigned char *input, unsigned char *output)
+{
+    if (length % AES_BLOCK_SIZE) {
+        return -1;
+    }
+    AES_cbc_encrypt(input, output, length, (mode == MBEDTLS_AES_ENCRYPT) ? &ctx->enc : &ctx->dec, iv,
+                    (mode == MBEDTLS_AES_ENCRYPT) ? AES_ENCRYPT : AES_DECRYPT);
+    return 0;
+}
+
+#endif /* HOST_STUB_MBEDTLS_AES_H */
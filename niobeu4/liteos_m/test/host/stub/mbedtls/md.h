@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: mbedTLS md 接口, 以 OpenSSL 一次性计算实现 */
+#ifndef HOST_STUB_MBEDTLS_MD_H
+#define HOST_STUB_MBEDTLS_MD_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#define MBEDTLS_MD_MAX_KEY 128
+
+typedef enum {
+    MBEDTLS_MD_NONE = 0,
+    MBEDTLS_MD_MD5,
+    MBEDTLS_MD_SHA1,
+    MBEDTLS_MD_SHA256,
+} mbedtls_md_type_t;
+
+typedef struct {
+    mbedtls_md_type_t type;
+} mbedtls_md_info_t;
+
+typedef struct {
+    const mbedtls_md_info_t *info;
+    int hmac;
+    unsigned char key[MBEDTLS_MD_MAX_KEY];
+    size_t keyLen;
+    unsigned char *buf;
+    size_t len;
+} mbedtls_md_context_t;
+
+static inline const mbedtls_md_info_t *mbedtls_md_info_from_type(mbedtls_md_type_t type)
+{
+    static const mbedtls_md_info_t infos[] = { { MBEDTLS_MD_NONE }, { MBEDTLS_MD_MD5 }, { MBEDTLS_MD_SHA1 },
+                                               { MBEDTLS_MD_SHA256 } };
+    return ((type > MBEDTLS_MD_NONE) && (type <= MBEDTLS_MD_SHA256)) ? &infos[type] : NULL;
+}
+
+static inline const EVP_MD *HostStubEvp(const mbedtls_md_info_t *info)
+{
+    switch (info->type) {
+        case MBEDTLS_MD_MD5:
+            return EVP_md5();
+        case MBEDTLS_MD_SHA1:
+            return EVP_sha1();
+        default:
+            return EVP_sha256();
+    }
+}
+
+static inline void mbedtls_md_init(mbedtls_md_context_t *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+static inline void mbedtls_md_free(mbedtls_md_context_t *ctx)
+{
+    free(ctx->buf);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+static inline int mbedtls_md_setup(mbedtls_md_context_t *ctx, const mbedtls_md_info_t *info, int hmac)
+{
+    ctx->info = info;
+    ctx->hmac = hmac;
+    return (info != NULL) ? 0 : -1;
+}
+
+static inline int mbedtls_md_starts(mbedtls_md_context_t *ctx)
+{
+    ctx->len = 0;
+    return 0;
+}
+
+static inline int mbedtls_md_hmac_starts(mbedtls_md_context_t *ctx, const unsigned char *key, size_t keyLen)
+{
+    if (keyLen > MBEDTLS_MD_MAX_KEY) {
+        return -1;
+    }
+    memcpy(ctx->key, key, keyLen);
+    ctx->keyLen = keyLen;
+    ctx->len = 0;
+    return 0;
+}
+
+static inline int mbedtls_md_update(mbedtls_md_context_t *ctx, const unsigned char *input, size_t len)
+{
+    unsigned char *buf = realloc(ctx->buf, ctx->len + len + 1);
+    if (buf == NULL) {
+        return -1;
+    }
+    memcpy(buf + ctx->len, input, len);
+    ctx->buf = buf;
+    ctx->len += len;
+    return 0;
+}
+
+static inline int mbedtls_md_hmac_update(mbedtls_md_context_t *ctx, const unsigned char *input, size_t len)
+{
+    return mbedtls_md_update(ctx, input, len);
+}
+
+static inline int mbedtls_md_finish(mbedtls_md_context_t *ctx, unsigned char *output)
+{
+    return (EVP_Digest(ctx->buf, ctx->len, output, NULL, HostStubEvp(ctx->info), NULL) == 1) ? 0 : -1;
+}
+
+static inline int mbedtls_md_hmac_finish(mbedtls_md_context_t *ctx, unsigned char *output)
+{
+    return (HMAC(HostStubEvp(ctx->info), ctx->key, (int)ctx->keyLen, ctx->buf, ctx->len, output, NULL) != NULL) ?
+           0 : -1;
+}
+
+#endif /* HOST_STUB_MBEDTLS_MD_H */
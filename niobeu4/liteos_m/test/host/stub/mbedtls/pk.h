@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * 主机测试桩: mbedTLS pk 接口, 只支持 ECDSA 公钥验签, 以 OpenSSL 实现.
+ * 测试设置 HostPkKey 后以其代替调用者传入的公钥, 便于使用测试密钥签名的包.
+ */
+#ifndef HOST_STUB_MBEDTLS_PK_H
+#define HOST_STUB_MBEDTLS_PK_H
+
+#include <stddef.h>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include "mbedtls/md.h"
+
+typedef struct {
+    EVP_PKEY *key;
+} mbedtls_pk_context;
+
+static const unsigned char *HostPkKey = NULL;
+static size_t HostPkKeyLen = 0;
+
+static inline void mbedtls_pk_init(mbedtls_pk_context *ctx)
+{
+    ctx->key = NULL;
+}
+
+static inline void mbedtls_pk_free(mbedtls_pk_context *ctx)
+{
+    EVP_PKEY_free(ctx->key);
+    ctx->key = NULL;
+}
+
+static inline int mbedtls_pk_parse_public_key(mbedtls_pk_context *ctx, const unsigned char *key, size_t len)
+{
+    const unsigned char *p = (HostPkKey != NULL) ? HostPkKey : key;
+    ctx->key = d2i_PUBKEY(NULL, &p, (long)((HostPkKey != NULL) ? HostPkKeyLen : len));
+    return (ctx->key != NULL) ? 0 : -1;
+}
+
+static inline int mbedtls_pk_verify(mbedtls_pk_context *ctx, mbedtls_md_type_t md, const unsigned char *hash,
+                                    size_t hashLen, const unsigned char *sig, size_t sigLen)
+{
+    EVP_PKEY_CTX *pctx = EVP_PKEY_CTX_new(ctx->key, NULL);
+    int ok = (pctx != NULL) && (md == MBEDTLS_MD_SHA256) && (EVP_PKEY_verify_init(pctx) == 1) &&
+             (EVP_PKEY_CTX_set_signature_md(pctx, EVP_sha256()) == 1) &&
+             (EVP_PKEY_verify(pctx, sig, sigLen, hash, hashLen) == 1);
+    EVP_PKEY_CTX_free(pctx);
+    return ok ? 0 : -1;
+}
+
+#endif /* HOST_STUB_MBEDTLS_PK_H */
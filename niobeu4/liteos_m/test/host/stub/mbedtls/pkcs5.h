@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: mbedTLS PBKDF2, 以 OpenSSL 实现 */
+#ifndef HOST_STUB_MBEDTLS_PKCS5_H
+#define HOST_STUB_MBEDTLS_PKCS5_H
+
+#include <openssl/evp.h>
+#include "mbedtls/md.h"
+
+static inline int mbedtls_pkcs5_pbkdf2_hmac(mbedtls_md_context_t *ctx, const unsigned char *password, size_t plen,
+                                            const unsigned char *salt, size_t slen, unsigned int iterations,
+                                            uint32_t keyLength, unsigned char *output)
+{
+    return (PKCS5_PBKDF2_HMAC((const char *)password, (int)plen, salt, (int)slen, (int)iterations,
+                              HostStubEvp(ctx->info), (int)keyLength, output) == 1) ? 0 : -1;
+}
+
+#endif /* HOST_STUB_MBEDTLS_PKCS5_H */
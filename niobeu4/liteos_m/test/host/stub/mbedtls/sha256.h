@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: mbedTLS 2.x SHA-256 接口, 以 OpenSSL 实现 */
+#ifndef HOST_STUB_MBEDTLS_SHA256_H
+#define HOST_STUB_MBEDTLS_SHA256_H
+
+#include <string.h>
+#include <openssl/sha.h>
+
+typedef struct {
+    SHA256_CTX ctx;
+} mbedtls_sha256_context;
+
+static inline void mbedtls_sha256_init(mbedtls_sha256_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+static inline void mbedtls_sha256_free(mbedtls_sha256_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+static inline int mbedtls_sha256_starts_ret(mbedtls_sha256_context *ctx, int is224)
+{
+    return ((is224 == 0) && (SHA256_Init(&ctx->ctx) == 1)) ? 0 : -1;
+}
+
+static inline int mbedtls_sha256_update_ret(mbedtls_sha256_context *ctx, const unsigned char *input, size_t len)
+{
+    return (SHA256_Update(&ctx->ctx, input, len) == 1) ? 0 : -1;
+}
+
+static inline int mbedtls_sha256_finish_ret(mbedtls_sha256_context *ctx, unsigned char *output)
+{
+    return (SHA256_Final(output, &ctx->ctx) == 1) ? 0 : -1;
+}
+
+#endif /* HOST_STUB_MBEDTLS_SHA256_H */
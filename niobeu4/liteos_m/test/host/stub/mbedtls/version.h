@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: 按 ESP-IDF 4.4 自带的 mbedTLS 2.28 编译 */
+#ifndef HOST_STUB_MBEDTLS_VERSION_H
+#define HOST_STUB_MBEDTLS_VERSION_H
+
+#define MBEDTLS_VERSION_NUMBER 0x021C0000
+
+#endif /* HOST_STUB_MBEDTLS_VERSION_H */
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: NVS 以内存表实现, 测试用 HostNvsReset 模拟擦除 */
+#ifndef HOST_STUB_NVS_H
+#define HOST_STUB_NVS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "esp_err.h"
+
+#define ESP_ERR_NVS_NOT_FOUND 0x1102
+#define ESP_ERR_NVS_INVALID_LENGTH 0x110c
+#define HOST_NVS_ENTRY_MAX 8
+#define HOST_NVS_KEY_MAX 32
+#define HOST_NVS_BLOB_MAX 1024
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+typedef struct {
+    char ns[HOST_NVS_KEY_MAX];
+    char key[HOST_NVS_KEY_MAX];
+    uint8_t data[HOST_NVS_BLOB_MAX];
+    size_t len;
+    int used;
+} HostNvsEntry;
+
+static HostNvsEntry HostNvs[HOST_NVS_ENTRY_MAX];
+static char HostNvsOpenNs[HOST_NVS_ENTRY_MAX][HOST_NVS_KEY_MAX];
+
+static inline void HostNvsReset(void)
+{
+    memset(HostNvs, 0, sizeof(HostNvs));
+}
+
+static inline HostNvsEntry *HostNvsFind(nvs_handle_t handle, const char *key)
+{
+    for (int i = 0; i < HOST_NVS_ENTRY_MAX; i++) {
+        if (HostNvs[i].used && (strcmp(HostNvs[i].ns, HostNvsOpenNs[handle]) == 0) &&
+            (strcmp(HostNvs[i].key, key) == 0)) {
+            return &HostNvs[i];
+        }
+    }
+    return NULL;
+}
+
+static inline esp_err_t nvs_open(const char *ns, nvs_open_mode_t mode, nvs_handle_t *handle)
+{
+    for (nvs_handle_t i = 0; i < HOST_NVS_ENTRY_MAX; i++) {
+        if (HostNvsOpenNs[i][0] == '\0') {
+            strncpy(HostNvsOpenNs[i], ns, HOST_NVS_KEY_MAX - 1);
+            *handle = i;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+static inline void nvs_close(nvs_handle_t handle)
+{
+    HostNvsOpenNs[handle][0] = '\0';
+}
+
+static inline esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_OK;
+}
+
+static inline esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out, size_t *len)
+{
+    HostNvsEntry *e = HostNvsFind(handle, key);
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out == NULL) {
+        *len = e->len;
+        return ESP_OK;
+    }
+    if (*len < e->len) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out, e->data, e->len);
+    *len = e->len;
+    return ESP_OK;
+}
+
+static inline esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t len)
+{
+    HostNvsEntry *e = HostNvsFind(handle, key);
+    for (int i = 0; (e == NULL) && (i < HOST_NVS_ENTRY_MAX); i++) {
+        if (!HostNvs[i].used) {
+            e = &HostNvs[i];
+            strncpy(e->ns, HostNvsOpenNs[handle], HOST_NVS_KEY_MAX - 1);
+            strncpy(e->key, key, HOST_NVS_KEY_MAX - 1);
+            e->used = 1;
+        }
+    }
+    if ((e == NULL) || (len > HOST_NVS_BLOB_MAX)) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(e->data, value, len);
+    e->len = len;
+    return ESP_OK;
+}
+
+static inline esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    HostNvsEntry *e = HostNvsFind(handle, key);
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    memset(e, 0, sizeof(*e));
+    return ESP_OK;
+}
+
+#endif /* HOST_STUB_NVS_H */
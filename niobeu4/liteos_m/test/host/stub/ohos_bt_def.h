@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: OpenHarmony 蓝牙公共定义中 HAL 用到的部分 */
+#ifndef HOST_STUB_OHOS_BT_DEF_H
+#define HOST_STUB_OHOS_BT_DEF_H
+
+#define OHOS_BD_ADDR_LEN 6
+
+typedef struct {
+    unsigned char addr[OHOS_BD_ADDR_LEN];
+} BdAddr;
+
+typedef struct {
+    unsigned char uuidLen;
+    char *uuid;
+} BtUuid;
+
+typedef enum {
+    OHOS_GATT_SUCCESS = 0,
+    OHOS_GATT_FAILURE,
+} GattStatus;
+
+typedef enum {
+    OHOS_GATT_PERMISSION_READ = 0x01,
+    OHOS_GATT_PERMISSION_WRITE = 0x10,
+} GattAttributePermission;
+
+#endif /* HOST_STUB_OHOS_BT_DEF_H */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 主机测试桩: securec 的最小实现 */
+#ifndef HOST_STUB_SECUREC_H
+#define HOST_STUB_SECUREC_H
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define EOK 0
+
+static inline int memcpy_s(void *dest, size_t destMax, const void *src, size_t count)
+{
+    if ((dest == NULL) || (src == NULL) || (count > destMax)) {
+        return -1;
+    }
+    memmove(dest, src, count);
+    return EOK;
+}
+
+static inline int memmove_s(void *dest, size_t destMax, const void *src, size_t count)
+{
+    return memcpy_s(dest, destMax, src, count);
+}
+
+static inline int memset_s(void *dest, size_t destMax, int c, size_t count)
+{
+    if ((dest == NULL) || (count > destMax)) {
+        return -1;
+    }
+    memset(dest, c, count);
+    return EOK;
+}
+
+static inline int strcpy_s(char *dest, size_t destMax, const char *src)
+{
+    size_t len = strlen(src);
+    if (len >= destMax) {
+        return -1;
+    }
+    memcpy(dest, src, len + 1);
+    return EOK;
+}
+
+static inline int vsnprintf_s(char *dest, size_t destMax, size_t count, const char *format, va_list args)
+{
+    int ret = vsnprintf(dest, (count < destMax) ? count + 1 : destMax, format, args);
+    return ((ret < 0) || ((size_t)ret >= destMax)) ? -1 : ret;
+}
+
+static inline int snprintf_s(char *dest, size_t destMax, size_t count, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int ret = vsnprintf_s(dest, destMax, count, format, args);
+    va_end(args);
+    return ret;
+}
+
+#endif /* HOST_STUB_SECUREC_H */
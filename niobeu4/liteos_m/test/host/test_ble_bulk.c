@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * ble_gattc_bulk.c 的批量写测试. 桩协议栈按固定连接间隔发送控制器缓冲中的包,
+ * 事件经队列在发送函数返回后投递, 以模拟时间计算批量写吞吐并校验对端收到的数据.
+ */
+#include "../../hals/drivers/bluetooth_lite/ble_gattc_bulk.c"
+#include "host_test.h"
+
+#define GATTC_IF 3
+#define CONN_ID 0
+#define CHAR_HANDLE 0x2a
+#define CONN_INTERVAL_MS 10         // 每个连接事件推进的模拟时间
+#define PACKETS_PER_EVENT 4         // 每个连接事件可发送的包数
+#define LINK_BUF_MAX 16
+#define EVENT_QUEUE_MAX 64
+#define STREAM_LEN 16384
+#define SIM_LIMIT_MS 60000
+
+typedef struct {
+    esp_gattc_cb_event_t event;
+    esp_ble_gattc_cb_param_t param;
+} MockEvent;
+
+typedef struct {
+    uint16_t linkBuf;               // 控制器发送缓冲包数
+    uint16_t congestHigh;           // 缓冲占用达到该值时上报拥塞
+    uint16_t congestLow;            // 拥塞后占用降到该值时解除
+    int prepFailAt;                 // 第几个 prepare 写返回失败, 0 表示不失败
+} MockLink;
+
+static MockLink Link;
+static MockEvent Events[EVENT_QUEUE_MAX];
+static int EventHead;
+static int EventTail;
+static uint16_t Fifo[LINK_BUF_MAX];
+static int FifoNum;
+static bool Congested;
+static uint32_t SimMs;
+static uint8_t Tx[STREAM_LEN];
+static uint8_t Rx[STREAM_LEN];
+static uint32_t RxLen;
+static uint8_t Prep[BLE_GATT_ATTR_VALUE_MAX];
+static uint32_t PrepLen;
+static int PrepCount;
+static int ExecCount;
+static bool ExecCommit;
+static int RspWrites;
+static int Forwarded;           // 转发给应用的写完成事件数
+static bool Done;
+static int DoneCount;
+static int DoneStatus;
+static BleGattcBulkResult DoneResult;
+
+void BleConnMgrAttach(uint16_t connId, const uint8_t *addr)
+{
+}
+
+void BleConnMgrDetach(uint16_t connId)
+{
+}
+
+static void PostEvent(esp_gattc_cb_event_t event, const esp_ble_gattc_cb_param_t *param)
+{
+    Events[EventTail].event = event;
+    Events[EventTail].param = *param;
+    EventTail = (EventTail + 1) % EVENT_QUEUE_MAX;
+}
+
+static void PostWrite(esp_gattc_cb_event_t event, esp_gatt_status_t status)
+{
+    esp_ble_gattc_cb_param_t param = { .write = { .status = status, .conn_id = CONN_ID, .handle = CHAR_HANDLE } };
+    PostEvent(event, &param);
+}
+
+static void DeliverEvents(void)
+{
+    while (EventHead != EventTail) {
+        MockEvent *e = &Events[EventHead];
+        EventHead = (EventHead + 1) % EVENT_QUEUE_MAX;
+        BleGattcBulkGattcHandler(e->event, GATTC_IF, &e->param);
+    }
+}
+
+int esp_ble_get_cur_sendable_packets_num(uint16_t connid)
+{
+    return Link.linkBuf - FifoNum;
+}
+
+esp_err_t esp_ble_gattc_write_char(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t handle, uint16_t value_len,
+                                   uint8_t *value, esp_gatt_write_type_t write_type, esp_gatt_auth_req_t auth_req)
+{
+    if (write_type == ESP_GATT_WRITE_TYPE_RSP) {
+        (void)memcpy(Rx, value, value_len);
+        RxLen = value_len;
+        RspWrites++;
+        PostWrite(ESP_GATTC_WRITE_CHAR_EVT, ESP_GATT_OK);
+        return ESP_OK;
+    }
+    if ((FifoNum >= Link.linkBuf) || (RxLen + value_len > STREAM_LEN)) {
+        return ESP_FAIL;
+    }
+    // 包进入控制器缓冲即按序落到对端, 完成事件在实际发送时上报
+    (void)memcpy(Rx + RxLen, value, value_len);
+    RxLen += value_len;
+    Fifo[FifoNum++] = value_len;
+    if (!Congested && (FifoNum >= Link.congestHigh)) {
+        esp_ble_gattc_cb_param_t param = { .congest = { .conn_id = CONN_ID, .congested = true } };
+        Congested = true;
+        PostEvent(ESP_GATTC_CONGEST_EVT, &param);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gattc_prepare_write(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t handle, uint16_t offset,
+                                      uint16_t value_len, uint8_t *value, esp_gatt_auth_req_t auth_req)
+{
+    PrepCount++;
+    if (PrepCount == Link.prepFailAt) {
+        PostWrite(ESP_GATTC_PREP_WRITE_EVT, ESP_GATT_INSUF_RESOURCE);
+        return ESP_OK;
+    }
+    // 对端按偏移保存, 偏移不连续时拒绝
+    if ((offset != PrepLen) || (offset + value_len > sizeof(Prep))) {
+        PostWrite(ESP_GATTC_PREP_WRITE_EVT, ESP_GATT_INVALID_OFFSET);
+        return ESP_OK;
+    }
+    (void)memcpy(Prep + offset, value, value_len);
+    PrepLen += value_len;
+    PostWrite(ESP_GATTC_PREP_WRITE_EVT, ESP_GATT_OK);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gattc_execute_write(esp_gatt_if_t gattc_if, uint16_t conn_id, bool is_execute)
+{
+    esp_ble_gattc_cb_param_t param = { .exec_cmpl = { .status = ESP_GATT_OK, .conn_id = CONN_ID } };
+    ExecCount++;
+    ExecCommit = is_execute;
+    if (is_execute) {
+        (void)memcpy(Rx, Prep, PrepLen);
+        RxLen = PrepLen;
+    }
+    PrepLen = 0;
+    PostEvent(ESP_GATTC_EXEC_EVT, &param);
+    return ESP_OK;
+}
+
+// 一个连接事件: 发送缓冲头部的若干包并上报完成
+static void ConnEvent(void)
+{
+    int n = (FifoNum < PACKETS_PER_EVENT) ? FifoNum : PACKETS_PER_EVENT;
+    for (int i = 0; i < n; i++) {
+        PostWrite(ESP_GATTC_WRITE_CHAR_EVT, ESP_GATT_OK);
+    }
+    FifoNum -= n;
+    (void)memmove(Fifo, Fifo + n, FifoNum * sizeof(Fifo[0]));
+    if (Congested && (FifoNum <= Link.congestLow)) {
+        esp_ble_gattc_cb_param_t param = { .congest = { .conn_id = CONN_ID, .congested = false } };
+        Congested = false;
+        PostEvent(ESP_GATTC_CONGEST_EVT, &param);
+    }
+}
+
+static void OnDone(uint16_t connId, int status, const BleGattcBulkResult *result)
+{
+    Done = true;
+    DoneCount++;
+    DoneStatus = status;
+    DoneResult = *result;
+}
+
+static void AppCallback(GattcBleCallbackEvent event, GattInterfaceType gattcIf, BleGattcParam *param)
+{
+    esp_gattc_cb_event_t e = (esp_gattc_cb_event_t)event;
+    if ((e == ESP_GATTC_WRITE_CHAR_EVT) || (e == ESP_GATTC_PREP_WRITE_EVT) || (e == ESP_GATTC_EXEC_EVT)) {
+        Forwarded++;
+    }
+}
+
+static void Open(uint16_t mtu)
+{
+    esp_ble_gattc_cb_param_t param = { .open = { .status = ESP_GATT_OK, .conn_id = CONN_ID } };
+    BleGattcBulkGattcHandler(ESP_GATTC_OPEN_EVT, GATTC_IF, &param);
+    param.cfg_mtu.status = ESP_GATT_OK;
+    param.cfg_mtu.conn_id = CONN_ID;
+    param.cfg_mtu.mtu = mtu;
+    BleGattcBulkGattcHandler(ESP_GATTC_CFG_MTU_EVT, GATTC_IF, &param);
+}
+
+static void Close(void)
+{
+    esp_ble_gattc_cb_param_t param = { .disconnect = { .conn_id = CONN_ID } };
+    BleGattcBulkGattcHandler(ESP_GATTC_DISCONNECT_EVT, GATTC_IF, &param);
+}
+
+static void Reset(const MockLink *link)
+{
+    Link = *link;
+    EventHead = EventTail = 0;
+    FifoNum = 0;
+    Congested = false;
+    RxLen = PrepLen = 0;
+    PrepCount = ExecCount = RspWrites = 0;
+    Done = false;
+    (void)memset(Rx, 0, sizeof(Rx));
+}
+
+static BtError Write(uint32_t len, bool reliable)
+{
+    GattcWriteChar writeChar = { .gattc_if = GATTC_IF, .conn_id = CONN_ID, .handle = CHAR_HANDLE };
+    return BleGattcWriteBulk(writeChar, Tx, len, OHOS_GATT_AUTH_REQ_NONE, reliable, OnDone);
+}
+
+// 推进模拟时间直到批量写完成, 单次重试定时器视为在下一个连接事件前到期
+static void RunLink(void)
+{
+    DeliverEvents();
+    while (!Done && (SimMs < SIM_LIMIT_MS)) {
+        SimMs += CONN_INTERVAL_MS;
+        HostTick = SimMs * LOSCFG_BASE_CORE_TICK_PER_SECOND / MS_PER_SECOND;
+        ConnEvent();
+        DeliverEvents();
+        HostTimerFire(BleGattcBulk.timer);
+        DeliverEvents();
+    }
+}
+
+// 以 MTU 为参数流式写入 STREAM_LEN 字节, 返回吞吐 (字节/秒)
+static uint32_t StreamAt(uint16_t mtu, const MockLink *link)
+{
+    uint16_t payload = mtu - BLE_ATT_WRITE_HDR_LEN;
+    uint32_t capacity = payload * PACKETS_PER_EVENT * MS_PER_SECOND / CONN_INTERVAL_MS;
+    uint32_t rate = 0;
+
+    Reset(link);
+    Open(mtu);
+    TEST_CHECK(Write(STREAM_LEN, false) == BT_SUCCESS);
+    TEST_CHECK(BleGattcBulkPending(CONN_ID) > 0);
+    TEST_CHECK(Write(STREAM_LEN, false) == BT_ERROR);
+    RunLink();
+    TEST_CHECK(Done && (DoneStatus == ESP_GATT_OK) && (DoneResult.written == STREAM_LEN));
+    TEST_CHECK(DoneResult.packets == (STREAM_LEN + payload - 1) / payload);
+    TEST_CHECK((RxLen == STREAM_LEN) && (memcmp(Rx, Tx, STREAM_LEN) == 0));
+    TEST_CHECK(BleGattcBulkPending(CONN_ID) == 0);
+    if (DoneResult.elapsedMs > 0) {
+        rate = (uint32_t)((uint64_t)DoneResult.written * MS_PER_SECOND / DoneResult.elapsedMs);
+    }
+    printf("stream mtu %u buf %u: %u bytes in %u ms, %u B/s (link %u B/s), congested %u\n", mtu, link->linkBuf,
+           DoneResult.written, DoneResult.elapsedMs, rate, capacity, DoneResult.congestCount);
+    // 流水发送应使链路基本饱和
+    TEST_CHECK(rate >= capacity * 9 / 10);
+    Close();
+    return rate;
+}
+
+static void TestStream(void)
+{
+    const MockLink wide = { .linkBuf = LINK_BUF_MAX, .congestHigh = LINK_BUF_MAX, .congestLow = 0 };
+    // 缓冲小于在途上限, 既会拥塞也会因无可用缓冲转入定时重试
+    const MockLink narrow = { .linkBuf = 6, .congestHigh = 6, .congestLow = 2 };
+    HostTimer *timer = (HostTimer *)BleGattcBulk.timer;
+    uint32_t starts;
+
+    TEST_CHECK((timer != NULL) && (timer->type == osTimerOnce));
+    uint32_t slow = StreamAt(BLE_GATT_MTU_DEFAULT, &wide);
+    uint32_t fast = StreamAt(247, &wide);
+    TEST_CHECK(fast > slow * 10);
+    TEST_CHECK(DoneResult.congestCount == 0);
+
+    starts = timer->starts;
+    (void)StreamAt(247, &narrow);
+    TEST_CHECK(DoneResult.congestCount > 0);
+    TEST_CHECK(timer->starts > starts);
+    TEST_CHECK(Forwarded == 0);
+}
+
+static void TestReliable(void)
+{
+    const MockLink link = { .linkBuf = LINK_BUF_MAX, .congestHigh = LINK_BUF_MAX };
+    const MockLink prepFail = { .linkBuf = LINK_BUF_MAX, .congestHigh = LINK_BUF_MAX, .prepFailAt = 3 };
+    uint16_t payload = BLE_GATT_MTU_DEFAULT - BLE_ATT_PREP_WRITE_HDR_LEN;
+
+    // 单包使用带响应写
+    Reset(&link);
+    Open(BLE_GATT_MTU_DEFAULT);
+    TEST_CHECK(Write(BLE_GATT_MTU_DEFAULT - BLE_ATT_WRITE_HDR_LEN, true) == BT_SUCCESS);
+    RunLink();
+    TEST_CHECK(Done && (DoneStatus == ESP_GATT_OK) && (RspWrites == 1) && (PrepCount == 0));
+    TEST_CHECK(memcmp(Rx, Tx, RxLen) == 0);
+
+    // 超过一包使用 prepare/execute, 对端按偏移重组
+    Reset(&link);
+    TEST_CHECK(Write(BLE_GATT_ATTR_VALUE_MAX, true) == BT_SUCCESS);
+    RunLink();
+    TEST_CHECK(Done && (DoneStatus == ESP_GATT_OK) && (DoneResult.written == BLE_GATT_ATTR_VALUE_MAX));
+    TEST_CHECK(PrepCount == (BLE_GATT_ATTR_VALUE_MAX + payload - 1) / payload);
+    TEST_CHECK((ExecCount == 1) && ExecCommit);
+    TEST_CHECK((RxLen == BLE_GATT_ATTR_VALUE_MAX) && (memcmp(Rx, Tx, RxLen) == 0));
+    TEST_CHECK(Write(BLE_GATT_ATTR_VALUE_MAX + 1, true) == BT_PARAMINPUT_ERROR);
+
+    // prepare 失败时取消队列, 对端不落盘
+    Reset(&prepFail);
+    TEST_CHECK(Write(BLE_GATT_ATTR_VALUE_MAX, true) == BT_SUCCESS);
+    RunLink();
+    TEST_CHECK(Done && (DoneStatus == ESP_GATT_INSUF_RESOURCE) && (DoneResult.written == 0));
+    TEST_CHECK((PrepCount == 3) && (ExecCount == 1) && !ExecCommit && (RxLen == 0));
+    Close();
+    TEST_CHECK(Forwarded == 0);
+}
+
+static void TestDisconnect(void)
+{
+    const MockLink link = { .linkBuf = LINK_BUF_MAX, .congestHigh = LINK_BUF_MAX };
+    Reset(&link);
+    DoneCount = 0;
+    Open(BLE_GATT_MTU_DEFAULT);
+    TEST_CHECK(Write(STREAM_LEN, false) == BT_SUCCESS);
+    ConnEvent();
+    DeliverEvents();
+    Close();
+    TEST_CHECK(Done && (DoneStatus == ESP_GATT_ERROR) && (DoneResult.written < STREAM_LEN));
+    // 断开后控制器缓冲中剩余包的完成事件不属于批量写, 转发给应用
+    ConnEvent();
+    DeliverEvents();
+    TEST_CHECK((DoneCount == 1) && (Forwarded > 0));
+    TEST_CHECK(Write(STREAM_LEN, false) == BT_ERROR);
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < STREAM_LEN; i++) {
+        Tx[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    BleGattcBulkSetCallback(AppCallback);
+    TestStream();
+    TestReliable();
+    TestDisconnect();
+    return HostTestResult("test_ble_bulk");
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * ble_conn_mgr.c 的配置切换策略测试. 控制器操作集以 BleConnMgrSetOps 替换为桩,
+ * 由测试设定各连接的发送积压与当前时间, 直接调用 BleConnMgrPoll 评估.
+ */
+#include "../../hals/drivers/bluetooth_lite/ble_conn_mgr.c"
+#include "host_test.h"
+
+#define CONN_BULK 1
+#define CONN_DIRECT 2
+#define CONN_ID_MAX 4
+#define BURST_MS 3000
+#define QUIET_MS 5000
+#define BURST_NUM 10
+
+static const uint8_t AddrBulk[OHOS_BD_ADDR_LEN] = { 0xC0, 0, 0, 0, 0, CONN_BULK };
+static const uint8_t AddrDirect[OHOS_BD_ADDR_LEN] = { 0xC0, 0, 0, 0, 0, CONN_DIRECT };
+static uint32_t Queued[CONN_ID_MAX];
+static uint32_t Now = 100000;
+static int UpdateRet;
+static int Updates;
+static uint32_t LastUpdateMs;
+static uint32_t MinUpdateGapMs = 0xFFFFFFFFU;
+static BleConnProfile LastProfile;
+static uint8_t LastAddr[OHOS_BD_ADDR_LEN];
+static uint16_t LastTxOctets;
+static uint8_t LastPhy;
+
+uint32_t BleGattsTxQueuedBytes(uint16_t connId)
+{
+    return 0;
+}
+
+uint32_t BleGattcBulkPending(uint16_t connId)
+{
+    return 0;
+}
+
+esp_err_t esp_ble_gap_update_conn_params(esp_ble_conn_update_params_t *params)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t esp_ble_gap_set_pkt_data_len(esp_bd_addr_t remote_device, uint16_t tx_data_length)
+{
+    return ESP_FAIL;
+}
+
+static int MockUpdate(const uint8_t *addr, const BleConnProfile *profile)
+{
+    if (UpdateRet != 0) {
+        return UpdateRet;
+    }
+    if ((Updates > 0) && ((Now - LastUpdateMs) < MinUpdateGapMs)) {
+        MinUpdateGapMs = Now - LastUpdateMs;
+    }
+    Updates++;
+    LastUpdateMs = Now;
+    LastProfile = *profile;
+    (void)memcpy(LastAddr, addr, OHOS_BD_ADDR_LEN);
+    return 0;
+}
+
+static int MockSetDataLen(const uint8_t *addr, uint16_t txOctets)
+{
+    LastTxOctets = txOctets;
+    return 0;
+}
+
+static int MockSetPhy(const uint8_t *addr, uint8_t phy)
+{
+    LastPhy = phy;
+    return 0;
+}
+
+static uint32_t MockQueued(uint16_t connId)
+{
+    return (connId < CONN_ID_MAX) ? Queued[connId] : 0;
+}
+
+static uint32_t MockNow(void)
+{
+    return Now;
+}
+
+static const BleConnOps MockOps = {
+    .updateParams = MockUpdate,
+    .setDataLen = MockSetDataLen,
+    .setPhy = MockSetPhy,
+    .queuedBytes = MockQueued,
+    .nowMs = MockNow,
+};
+
+static BleConnState State(uint16_t connId)
+{
+    BleConnState state = {0};
+    (void)BleConnMgrGetState(connId, &state);
+    return state;
+}
+
+static void Advance(uint32_t ms)
+{
+    Now += ms;
+    BleConnMgrPoll();
+}
+
+static void TestAttach(void)
+{
+    HostTimer *timer = (HostTimer *)BleConnMgr.timer;
+    // 互斥锁与定时器在 SYS_RUN 中创建, 连接建立时只启动定时器
+    TEST_CHECK((timer != NULL) && !timer->running);
+    BleConnMgrSetOps(&MockOps);
+    BleConnMgrAttach(CONN_BULK, AddrBulk);
+    BleConnMgrAttach(CONN_DIRECT, AddrDirect);
+    TEST_CHECK(timer->running && (timer->type == osTimerPeriodic));
+    TEST_CHECK(timer->ticks == (BLE_CONN_MGR_POLL_MS * LOSCFG_BASE_CORE_TICK_PER_SECOND / MS_PER_SECOND));
+    TEST_CHECK(State(CONN_BULK).profile == BLE_CONN_PROFILE_NONE);
+
+    // 默认不自动切换
+    Queued[CONN_BULK] = BLE_CONN_MGR_BULK_THRESHOLD * 2;
+    HostTimerFire(timer);
+    TEST_CHECK(Updates == 0);
+}
+
+static void TestAutoSwitch(void)
+{
+    BleConnPolicy policy = {
+        .autoSwitch = true,
+        .bulkThreshold = BLE_CONN_MGR_BULK_THRESHOLD,
+        .idleTimeoutMs = BLE_CONN_MGR_IDLE_TIMEOUT_MS,
+    };
+    BleConnState state;
+    TEST_CHECK(BleConnMgrSetPolicy(&policy) == BT_SUCCESS);
+    Advance(0);
+    state = State(CONN_BULK);
+    TEST_CHECK((Updates == 1) && (state.profile == BLE_CONN_PROFILE_BULK) && (state.switchCount == 1));
+    TEST_CHECK(memcmp(LastAddr, AddrBulk, OHOS_BD_ADDR_LEN) == 0);
+    TEST_CHECK((LastProfile.maxInterval == 12) && (LastProfile.latency == 0));
+    TEST_CHECK((LastTxOctets == 251) && (LastPhy == BLE_CONN_PHY_2M));
+    // 未使用队列的连接积压恒为 0, 不被调整
+    TEST_CHECK(State(CONN_DIRECT).switchCount == 0);
+
+    // 积压降到门限以下, 持续空闲满 idleTimeoutMs 后才回到空闲配置
+    Queued[CONN_BULK] = 100;
+    Advance(500);
+    Queued[CONN_BULK] = 0;
+    Advance(BLE_CONN_MGR_IDLE_TIMEOUT_MS - 100);
+    TEST_CHECK(State(CONN_BULK).profile == BLE_CONN_PROFILE_BULK);
+    Advance(100);
+    state = State(CONN_BULK);
+    TEST_CHECK((Updates == 2) && (state.profile == BLE_CONN_PROFILE_IDLE));
+    TEST_CHECK((LastProfile.minInterval == 320) && (LastProfile.latency == 4));
+
+    // 同一连接两次更新之间至少间隔 BLE_CONN_MGR_MIN_UPDATE_MS
+    Queued[CONN_BULK] = BLE_CONN_MGR_BULK_THRESHOLD;
+    Advance(BLE_CONN_MGR_MIN_UPDATE_MS / 2);
+    TEST_CHECK(State(CONN_BULK).profile == BLE_CONN_PROFILE_IDLE);
+    Advance(BLE_CONN_MGR_MIN_UPDATE_MS / 2);
+    TEST_CHECK((Updates == 3) && (State(CONN_BULK).profile == BLE_CONN_PROFILE_BULK));
+    Queued[CONN_BULK] = 0;
+}
+
+// 突发与静默交替的发送流量: 每个周期恰好切换两次, 且更新间隔不低于下限
+static void TestBurstTraffic(void)
+{
+    int start = Updates;
+    uint32_t bulkMs = 0;
+    Advance(BLE_CONN_MGR_IDLE_TIMEOUT_MS + BLE_CONN_MGR_MIN_UPDATE_MS);
+    TEST_CHECK(State(CONN_BULK).profile == BLE_CONN_PROFILE_IDLE);
+    start = Updates;
+    for (int burst = 0; burst < BURST_NUM; burst++) {
+        for (uint32_t t = 0; t < (BURST_MS + QUIET_MS); t += BLE_CONN_MGR_POLL_MS) {
+            // 突发期间积压在门限上下波动
+            Queued[CONN_BULK] = (t < BURST_MS) ? ((t % 300 == 0) ? 200 : 2048) : 0;
+            Advance(BLE_CONN_MGR_POLL_MS);
+            bulkMs += (State(CONN_BULK).profile == BLE_CONN_PROFILE_BULK) ? BLE_CONN_MGR_POLL_MS : 0;
+        }
+    }
+    TEST_CHECK((Updates - start) == (2 * BURST_NUM));
+    TEST_CHECK(MinUpdateGapMs >= BLE_CONN_MGR_MIN_UPDATE_MS);
+    // 大吞吐配置只覆盖突发与其后的空闲超时
+    TEST_CHECK(bulkMs <= (uint32_t)BURST_NUM * (BURST_MS + BLE_CONN_MGR_IDLE_TIMEOUT_MS));
+    TEST_CHECK(bulkMs >= (uint32_t)BURST_NUM * BURST_MS);
+    printf("burst traffic: %d switches, bulk profile %u ms of %u ms\n", Updates - start, bulkMs,
+           BURST_NUM * (BURST_MS + QUIET_MS));
+}
+
+static void TestRequestAndReport(void)
+{
+    BleConnProfile bad = { .minInterval = 20, .maxInterval = 10 };
+    BleConnState state;
+    UpdateRet = -1;
+    TEST_CHECK(BleConnMgrRequest(CONN_BULK, BLE_CONN_PROFILE_BULK) == BT_ERROR);
+    TEST_CHECK(State(CONN_BULK).rejectCount == 1);
+    UpdateRet = 0;
+    // 手动请求不受最小更新间隔限制
+    TEST_CHECK(BleConnMgrRequest(CONN_DIRECT, BLE_CONN_PROFILE_BULK) == BT_SUCCESS);
+    TEST_CHECK(BleConnMgrRequest(CONN_DIRECT, BLE_CONN_PROFILE_IDLE) == BT_SUCCESS);
+    TEST_CHECK(BleConnMgrRequest(3, BLE_CONN_PROFILE_IDLE) == BT_PARAMINPUT_ERROR);
+
+    BleConnMgrOnParamsUpdated(AddrDirect, 0, 400, 4);
+    BleConnMgrOnParamsUpdated(AddrBulk, 1, 0, 0);
+    state = State(CONN_DIRECT);
+    TEST_CHECK((state.interval == 400) && (state.latency == 4) && (state.switchCount == 2));
+    TEST_CHECK(State(CONN_BULK).rejectCount == 2);
+
+    TEST_CHECK(BleConnMgrSetProfile(BLE_CONN_PROFILE_IDLE, &bad) == BT_PARAMINPUT_ERROR);
+    TEST_CHECK(BleConnMgrSetProfile(BLE_CONN_PROFILE_NUM, &LastProfile) == BT_PARAMINPUT_ERROR);
+    TEST_CHECK(BleConnMgrGetState(3, &state) == BT_PARAMINPUT_ERROR);
+}
+
+static void TestDetach(void)
+{
+    HostTimer *timer = (HostTimer *)BleConnMgr.timer;
+    BleConnMgrDetach(CONN_BULK);
+    TEST_CHECK(timer->running);
+    BleConnMgrDetach(CONN_DIRECT);
+    TEST_CHECK(!timer->running);
+    BleConnMgrSetOps(NULL);
+    TEST_CHECK(BleConnMgr.ops == &DefaultOps);
+}
+
+int main(void)
+{
+    TestAttach();
+    TestAutoSwitch();
+    TestBurstTraffic();
+    TestRequestAndReport();
+    TestDetach();
+    return HostTestResult("test_ble_conn");
+}
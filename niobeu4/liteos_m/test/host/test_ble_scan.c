@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * ble_scan_filter.c 的过滤, 去重与批量上报测试. 以合成的扫描结果流驱动 GAP 事件入口,
+ * 检查交给应用的结果与统计计数.
+ */
+#include "../../hals/drivers/bluetooth_lite/ble_scan_filter.c"
+#include "host_test.h"
+
+#define DEV_NUM 40
+#define ADV_PER_DEV 10
+#define UUID_HRS 0x180D
+#define MANU_APPLE 0x004C
+#define TICK_MS (MS_PER_SECOND / LOSCFG_BASE_CORE_TICK_PER_SECOND)
+
+static int GapScanResults;
+static int GapOtherEvents;
+static int BatchCalls;
+static unsigned int BatchTotal;
+static BleScanReport LastBatch[BLE_SCAN_BATCH_MAX];
+static unsigned int LastBatchNum;
+static uint16_t ParamsInterval;
+
+void BleConnMgrOnParamsUpdated(const uint8_t *addr, int status, uint16_t interval, uint16_t latency)
+{
+    ParamsInterval = (status == 0) ? interval : 0;
+}
+
+static void GapCb(GapBleCallbackEvent event, BleGapParam *param)
+{
+    if (event == OHOS_GAP_BLE_SCAN_RESULT_EVT) {
+        GapScanResults++;
+    } else {
+        GapOtherEvents++;
+    }
+}
+
+static void BatchCb(const BleScanReport *reports, unsigned int num)
+{
+    BatchCalls++;
+    BatchTotal += num;
+    LastBatchNum = num;
+    (void)memcpy(LastBatch, reports, num * sizeof(*reports));
+}
+
+// 设备 i: 4 的倍数广播心率服务 UUID, 5 的倍数带厂商数据, 其余只有名称
+static void Adv(uint32_t dev, int rssi, uint8_t version)
+{
+    esp_ble_gap_cb_param_t p;
+    uint8_t *d = p.scan_rst.ble_adv;
+    uint8_t len = 0;
+    (void)memset(&p, 0, sizeof(p));
+    p.scan_rst.search_evt = ESP_GAP_SEARCH_INQ_RES_EVT;
+    p.scan_rst.bda[0] = 0xC0;
+    p.scan_rst.bda[4] = (uint8_t)(dev >> 8);
+    p.scan_rst.bda[5] = (uint8_t)dev;
+    p.scan_rst.ble_evt_type = ESP_BLE_EVT_CONN_ADV;
+    p.scan_rst.rssi = rssi;
+    d[len++] = 2;
+    d[len++] = OHOS_BLE_AD_TYPE_FLAG;
+    d[len++] = OHOS_BLE_ADV_FLAG_GEN_DISC;
+    if ((dev % 4) == 0) {
+        d[len++] = 3;
+        d[len++] = OHOS_BLE_AD_TYPE_16SRV_CMPL;
+        d[len++] = UUID_HRS & 0xFF;
+        d[len++] = UUID_HRS >> 8;
+    }
+    if ((dev % 5) == 0) {
+        d[len++] = 4;
+        d[len++] = OHOS_BLE_AD_MANUFACTURER_SPECIFIC_TYPE;
+        d[len++] = MANU_APPLE & 0xFF;
+        d[len++] = MANU_APPLE >> 8;
+        d[len++] = version;
+    }
+    d[len++] = 4;
+    d[len++] = OHOS_BLE_AD_TYPE_NAME_CMPL;
+    d[len++] = 'd';
+    d[len++] = (uint8_t)('0' + (dev / 10) % 10);
+    d[len++] = (uint8_t)('0' + dev % 10);
+    // 版本号放在扫描响应里, 改变它即改变广播内容
+    d[len++] = 2;
+    d[len++] = OHOS_BLE_AD_TYPE_TX_PWR;
+    d[len++] = version;
+    p.scan_rst.adv_data_len = (uint8_t)(len - 3);
+    p.scan_rst.scan_rsp_len = 3;
+    BleScanFilterGapHandler(ESP_GAP_BLE_SCAN_RESULT_EVT, &p);
+}
+
+static void ScanComplete(void)
+{
+    esp_ble_gap_cb_param_t p;
+    (void)memset(&p, 0, sizeof(p));
+    p.scan_rst.search_evt = ESP_GAP_SEARCH_INQ_CMPL_EVT;
+    BleScanFilterGapHandler(ESP_GAP_BLE_SCAN_RESULT_EVT, &p);
+}
+
+static void ResetCounters(void)
+{
+    GapScanResults = 0;
+    GapOtherEvents = 0;
+    BatchCalls = 0;
+    BatchTotal = 0;
+    LastBatchNum = 0;
+}
+
+static void TestPassThrough(void)
+{
+    esp_ble_gap_cb_param_t p;
+    ResetCounters();
+    TEST_CHECK(BleSetScanFilter(NULL, NULL) == BT_SUCCESS);
+    for (uint32_t i = 0; i < 3; i++) {
+        Adv(1, -50, 0);
+    }
+    TEST_CHECK(GapScanResults == 3);
+    // 连接参数更新事件同时交给连接管理与应用
+    (void)memset(&p, 0, sizeof(p));
+    p.update_conn_params.conn_int = 24;
+    BleScanFilterGapHandler(ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT, &p);
+    TEST_CHECK((ParamsInterval == 24) && (GapOtherEvents == 1));
+}
+
+static void TestFilterStream(void)
+{
+    BleScanFilter filter = {0};
+    BleScanFilterStats stats;
+    uint32_t matched = 0;
+    filter.uuidNum = 1;
+    filter.uuid16[0] = UUID_HRS;
+    filter.manuNum = 1;
+    filter.manuId[0] = MANU_APPLE;
+    filter.minRssi = BLE_SCAN_RSSI_NO_LIMIT;
+    filter.rssiDelta = 8;
+    filter.reportWindowMs = 1000;
+    ResetCounters();
+    TEST_CHECK(BleSetScanFilter(&filter, NULL) == BT_SUCCESS);
+    // 每个设备的广播在 RSSI 门限内抖动, 内容不变
+    for (uint32_t round = 0; round < ADV_PER_DEV; round++) {
+        for (uint32_t dev = 0; dev < DEV_NUM; dev++) {
+            Adv(dev, -60 + (int)(round % 3), 0);
+        }
+        HostTick++;
+    }
+    for (uint32_t dev = 0; dev < DEV_NUM; dev++) {
+        matched += (((dev % 4) == 0) || ((dev % 5) == 0)) ? 1 : 0;
+    }
+    BleGetScanFilterStats(&stats);
+    TEST_CHECK(stats.received == (DEV_NUM * ADV_PER_DEV));
+    TEST_CHECK(stats.filtered == ((DEV_NUM - matched) * ADV_PER_DEV));
+    TEST_CHECK(stats.delivered == matched);
+    TEST_CHECK(stats.suppressed == (matched * (ADV_PER_DEV - 1)));
+    TEST_CHECK(GapScanResults == (int)matched);
+
+    // 内容变化, RSSI 变化超过 rssiDelta, 超过重报窗口时各上报一次
+    Adv(0, -60, 1);
+    Adv(0, -60, 1);
+    TEST_CHECK(GapScanResults == (int)matched + 1);
+    Adv(0, -70, 1);
+    Adv(0, -66, 1);
+    TEST_CHECK(GapScanResults == (int)matched + 2);
+    HostTick += filter.reportWindowMs / TICK_MS;
+    Adv(0, -70, 1);
+    TEST_CHECK(GapScanResults == (int)matched + 3);
+
+    // RSSI 门限
+    filter.minRssi = -55;
+    TEST_CHECK(BleSetScanFilter(&filter, NULL) == BT_SUCCESS);
+    ResetCounters();
+    Adv(4, -60, 0);
+    Adv(8, -50, 0);
+    BleGetScanFilterStats(&stats);
+    TEST_CHECK((GapScanResults == 1) && (stats.filtered == 1));
+
+    // 清空去重缓存后重新上报
+    BleScanFilterReset();
+    Adv(8, -50, 0);
+    TEST_CHECK(GapScanResults == 2);
+}
+
+static void TestDedupEviction(void)
+{
+    BleScanFilter filter = {0};
+    filter.minRssi = BLE_SCAN_RSSI_NO_LIMIT;
+    ResetCounters();
+    TEST_CHECK(BleSetScanFilter(&filter, NULL) == BT_SUCCESS);
+    for (uint32_t dev = 0; dev <= BLE_SCAN_DEDUP_MAX; dev++) {
+        Adv(dev, -40, 0);
+        HostTick++;
+    }
+    TEST_CHECK(GapScanResults == (BLE_SCAN_DEDUP_MAX + 1));
+    // 最久未见的设备 0 被淘汰, 再次出现时重新上报; 最近的设备仍被抑制
+    Adv(0, -40, 0);
+    Adv(BLE_SCAN_DEDUP_MAX, -40, 0);
+    TEST_CHECK(GapScanResults == (BLE_SCAN_DEDUP_MAX + 2));
+}
+
+static void TestBatch(void)
+{
+    BleScanFilter filter = {0};
+    HostTimer *timer = (HostTimer *)BleScanCtx.timer;
+    filter.minRssi = BLE_SCAN_RSSI_NO_LIMIT;
+    filter.batchNum = 4;
+    filter.batchTimeoutMs = 50;
+    TEST_CHECK(BleSetScanFilter(&filter, BatchCb) == BT_SUCCESS);
+    ResetCounters();
+    for (uint32_t dev = 0; dev < 10; dev++) {
+        Adv(dev, -40, 0);
+    }
+    TEST_CHECK((BatchCalls == 2) && (BatchTotal == 8) && (GapScanResults == 0));
+    TEST_CHECK((LastBatchNum == 4) && (LastBatch[0].addr[5] == 4) && (LastBatch[3].addr[5] == 7));
+    TEST_CHECK((LastBatch[0].advLen + LastBatch[0].scanRspLen) > 0);
+    // 未攒满的批次在超时后上报
+    TEST_CHECK((timer != NULL) && timer->running && (timer->ticks == (filter.batchTimeoutMs / TICK_MS)));
+    HostTimerFire(timer);
+    TEST_CHECK((BatchCalls == 3) && (LastBatchNum == 2) && (LastBatch[1].addr[5] == 9));
+    // 扫描结束时立即上报
+    Adv(10, -40, 0);
+    ScanComplete();
+    TEST_CHECK((BatchCalls == 4) && (LastBatchNum == 1) && (LastBatch[0].addr[5] == 10));
+    ScanComplete();
+    TEST_CHECK(BatchCalls == 4);
+
+    filter.batchNum = BLE_SCAN_BATCH_MAX + 1;
+    TEST_CHECK(BleSetScanFilter(&filter, BatchCb) == BT_PARAMINPUT_ERROR);
+    TEST_CHECK(BleSetScanFilter(NULL, NULL) == BT_SUCCESS);
+}
+
+int main(void)
+{
+    BleScanFilterSetGapCallback(GapCb);
+    TestPassThrough();
+    TestFilterStream();
+    TestDedupEviction();
+    TestBatch();
+    return HostTestResult("test_ble_scan");
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * log_bin.c 的编码与格式化测试. 能用 printf 表达的格式以主机 snprintf 为参照;
+ * 每条记录同时封成串口帧写入 OUT_DIR/log_capture.bin, 与格式串表 log_formats.bin,
+ * 期望输出 log_expected.txt 一起交给 test_log_decode.py 校验主机解码器.
+ */
+#include "../../hals/log/log_bin.c"
+#include "host_test.h"
+
+#include <stdint.h>
+
+#define REC_MAX 192
+#define TEXT_MAX 256
+#define LONG_STR "0123456789abcdefghijklmnopqrstuvwxyz"
+#define HILOG_LEVEL_INFO 4
+#define HILOG_MODULE 1
+#define FRAME_TIME_MS 12345
+
+static const char *OutDir = "out";
+static FILE *Capture;
+static FILE *Formats;
+static FILE *Expected;
+static uint8_t Rec[REC_MAX];
+static char Want[TEXT_MAX];
+static char Got[TEXT_MAX];
+
+static uint32_t Encode(uint8_t *rec, uint32_t size, const char *fmt, ...)
+{
+    va_list ap;
+    uint32_t len;
+    va_start(ap, fmt);
+    len = LogBinEncode(rec, size, fmt, LOG_BIN_LEVEL_NONE, LOG_BIN_MODULE_NONE, ap);
+    va_end(ap);
+    return len;
+}
+
+static FILE *OpenOut(const char *name)
+{
+    char path[TEXT_MAX];
+    (void)snprintf(path, sizeof(path), "%s/%s", OutDir, name);
+    return fopen(path, "wb");
+}
+
+// 与 log_ring.c 相同的串口帧: A5 5A len(2) timeMs(4) 记录 sum(1)
+static void WriteFrame(const uint8_t *rec, uint32_t len, uint32_t timeMs)
+{
+    uint8_t hdr[LOG_BIN_FRAME_HDR_LEN] = { LOG_BIN_MAGIC0, LOG_BIN_MAGIC1, (uint8_t)len, (uint8_t)(len >> 8) };
+    uint8_t sum = 0;
+    (void)memcpy(hdr + 4, &timeMs, sizeof(timeMs));     // 4: timeMs 偏移
+    for (uint32_t i = 2; i < sizeof(hdr); i++) {          // 2: 跳过帧头
+        sum += hdr[i];
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        sum += rec[i];
+    }
+    (void)fwrite(hdr, 1, sizeof(hdr), Capture);
+    (void)fwrite(rec, 1, len, Capture);
+    (void)fwrite(&sum, 1, 1, Capture);
+}
+
+static void WriteFormat(const char *fmt)
+{
+    uint32_t addr = (uint32_t)(uintptr_t)fmt;
+    uint16_t len = (uint16_t)strlen(fmt);
+    (void)fwrite(&addr, 1, sizeof(addr), Formats);
+    (void)fwrite(&len, 1, sizeof(len), Formats);
+    (void)fwrite(fmt, 1, len, Formats);
+}
+
+// 串口上夹在帧之间的普通文本
+static void WriteText(const char *text)
+{
+    (void)fputs(text, Capture);
+    (void)fputs(text, Expected);
+}
+
+static void CheckRecord(uint32_t len, const char *fmt, const char *want)
+{
+    TEST_CHECK(len >= LOG_BIN_HDR_LEN);
+    if (len < LOG_BIN_HDR_LEN) {
+        return;
+    }
+    (void)LogBinFormat(Got, sizeof(Got), fmt, Rec + LOG_BIN_HDR_LEN, len - LOG_BIN_HDR_LEN);
+    TEST_CHECK(strcmp(Got, want) == 0);
+    if (strcmp(Got, want) != 0) {
+        printf("  fmt \"%s\"\n  got  \"%s\"\n  want \"%s\"\n", fmt, Got, want);
+    }
+    WriteFormat(fmt);
+    WriteFrame(Rec, len, 0);
+    (void)fputs(want, Expected);
+}
+
+#define CHECK_PRINTF(fmt, ...) do { \
+    (void)snprintf(Want, sizeof(Want), fmt, __VA_ARGS__); \
+    CheckRecord(Encode(Rec, sizeof(Rec), fmt, __VA_ARGS__), fmt, Want); \
+} while (0)
+
+static void TestPrintf(void)
+{
+    CHECK_PRINTF("int %d|%5d|%-5d|%05d|%+d|%x|%#X|%o|%u|%c\n", -42, 7, 7, 7, 7, 0xbeef, 0xbeef, 8, 3000000000U, 'Z');
+    CHECK_PRINTF("wide %lld %llx %jd %llu\n", -1234567890123LL, 0x123456789abcLL, (intmax_t)-5, ~0ULL);
+    CHECK_PRINTF("float %.3f %e %g %8.2f %-8.1f|\n", 3.14159, 1e-5, 2.5, -1.5, 0.25);
+    CHECK_PRINTF("str %s|%10s|%-6s|%.2s|%s\n", "abc", "right", "left", "trunc", "温度 25℃");
+    CHECK_PRINTF("100%% done %d%%\n", 99);
+    // '*' 宽度/精度, 包括负宽度 (左对齐) 与负精度 (等同未指定)
+    CHECK_PRINTF("star %*d|%-*d|%.*f|%*.*s|\n", 6, 42, 6, 42, 2, 3.14159, 8, 3, "abcdef");
+    CHECK_PRINTF("star %*d|%.*d|%.*s|%0*x|\n", -6, 42, -1, 7, -1, "all", 8, 0xabc);
+    CHECK_PRINTF("star %*lld|%*.*e|%-*c|\n", 12, -5LL, 12, 2, 12345.678, 3, 'q');
+}
+
+static void TestLimits(void)
+{
+    const char *longFmt = "name=%s end\n";
+    const char *cutFmt = "a=%d b=%lld c=%d\n";
+    const char *starFmt = "w=%d x=%*d\n";
+    uint32_t len;
+
+    // %s 最多保存 LOG_BIN_STR_MAX 字节
+    (void)snprintf(Want, sizeof(Want), "name=%.*s end\n", LOG_BIN_STR_MAX, LONG_STR);
+    CheckRecord(Encode(Rec, sizeof(Rec), longFmt, LONG_STR), longFmt, Want);
+
+    // 空间不足时截断到最后一个完整参数, 余下的格式串原样输出
+    len = Encode(Rec, LOG_BIN_HDR_LEN + LOG_BIN_INT_LEN + LOG_BIN_WIDE_LEN, cutFmt, 1, 2LL, 3);
+    TEST_CHECK(len == LOG_BIN_HDR_LEN + LOG_BIN_INT_LEN + LOG_BIN_WIDE_LEN);
+    CheckRecord(len, cutFmt, "a=1 b=2 c=%d\n");
+
+    // '*' 值已写入而参数放不下时, 连同 '*' 值一起回退
+    len = Encode(Rec, LOG_BIN_HDR_LEN + LOG_BIN_INT_LEN * 2, starFmt, 1, 5, 9);
+    TEST_CHECK(len == LOG_BIN_HDR_LEN + LOG_BIN_INT_LEN);
+    CheckRecord(len, starFmt, "w=1 x=%*d\n");
+
+    TEST_CHECK(Encode(Rec, LOG_BIN_HDR_LEN - 1, cutFmt, 1, 2LL, 3) == 0);
+}
+
+// HiLog 记录的参数是 32 位值数组, 64 位参数占两个值, 低位在前
+static void TestHilogValues(void)
+{
+    static const char *fmt = "w=%{public}*d %{private}x ll=%lld d=%.*f\n";
+    const char *prefixed = "12.345 I/1: w=   9 ab ll=-2 d=3.14\n";
+    int64_t ll = -2;
+    double d = 3.14159;
+    uint32_t values[8] = { 4, 9, 0xab };    // 8: 各参数所占值个数之和
+    uint32_t len;
+
+    (void)memcpy(&values[3], &ll, sizeof(ll));
+    values[5] = 2;
+    (void)memcpy(&values[6], &d, sizeof(d));
+    len = LogBinEncodeValues(Rec, sizeof(Rec), fmt, HILOG_LEVEL_INFO, HILOG_MODULE, values, 8);
+    TEST_CHECK((Rec[4] == HILOG_LEVEL_INFO) && (Rec[5] == HILOG_MODULE));
+    (void)LogBinFormat(Got, sizeof(Got), fmt, Rec + LOG_BIN_HDR_LEN, len - LOG_BIN_HDR_LEN);
+    TEST_CHECK(strcmp(Got, strchr(prefixed, ':') + 2) == 0);
+    WriteFormat(fmt);
+    WriteFrame(Rec, len, FRAME_TIME_MS);
+    (void)fputs(prefixed, Expected);
+
+    // 值不足时在最后一个完整参数处截断, '*' 值不单独留下
+    len = LogBinEncodeValues(Rec, sizeof(Rec), fmt, HILOG_LEVEL_INFO, HILOG_MODULE, values, 1);
+    TEST_CHECK(len == LOG_BIN_HDR_LEN);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        OutDir = argv[1];
+    }
+    Capture = OpenOut("log_capture.bin");
+    Formats = OpenOut("log_formats.bin");
+    Expected = OpenOut("log_expected.txt");
+    if ((Capture == NULL) || (Formats == NULL) || (Expected == NULL)) {
+        printf("cannot write to %s\n", OutDir);
+        return 1;
+    }
+    WriteText("boot: 传感器就绪 ✓\n");
+    TestPrintf();
+    WriteText("中文文本夹在帧之间\n");
+    TestLimits();
+    TestHilogValues();
+    WriteText("end ✓");
+    (void)fclose(Capture);
+    (void)fclose(Formats);
+    (void)fclose(Expected);
+    return HostTestResult("test_log_bin");
+}
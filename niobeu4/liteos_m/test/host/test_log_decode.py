@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+"""Check hals/log/log_decode.py against the frames test_log_bin wrote.
+
+Usage:
+  test_log_decode.py OUT_DIR
+
+log_capture.bin is a UART capture with binary frames between UTF-8 text,
+log_formats.bin maps the format addresses in the records to their strings and
+log_expected.txt is what LogBinFormat printed on the device side. The capture
+is fed to the decoder in chunks of several sizes, so frames and multi-byte
+characters are split at every possible offset.
+"""
+
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '../../hals/log'))
+import log_decode  # noqa: E402
+
+CHUNK_SIZES = (1, 2, 3, 5, 7, 13, 64, 1 << 16)
+
+
+class TableStrings:
+    """Format strings by address, standing in for log_decode.ElfStrings."""
+
+    def __init__(self, data):
+        self.table = {}
+        pos = 0
+        while pos < len(data):
+            addr, length = struct.unpack_from('<IH', data, pos)
+            pos += 6
+            self.table[addr] = data[pos:pos + length].decode('utf-8')
+            pos += length
+
+    def string(self, addr):
+        return self.table.get(addr)
+
+
+def decode(strings, capture, size):
+    out = []
+    decoder = log_decode.StreamDecoder(strings, out.append)
+    for pos in range(0, len(capture), size):
+        decoder.feed(capture[pos:pos + size])
+    decoder.feed(b'', True)
+    return ''.join(out)
+
+
+def main():
+    out_dir = sys.argv[1] if len(sys.argv) > 1 else 'out'
+
+    def read(name):
+        with open(os.path.join(out_dir, name), 'rb') as f:
+            return f.read()
+
+    strings = TableStrings(read('log_formats.bin'))
+    capture = read('log_capture.bin')
+    expected = read('log_expected.txt').decode('utf-8')
+    checked = failed = 0
+    for size in CHUNK_SIZES:
+        got = decode(strings, capture, size)
+        checked += 1
+        if got != expected:
+            failed += 1
+            print('chunk size %d: decoded text differs' % size)
+            for want_line, got_line in zip(expected.splitlines(), got.splitlines()):
+                if want_line != got_line:
+                    print('  want %r\n  got  %r' % (want_line, got_line))
+                    break
+    # 被帧打断的多字节字符不会与帧后的字节拼接
+    got = decode(strings, b'\xe6\xb8' + capture[capture.index(b'\xa5\x5a'):], 1)
+    checked += 1
+    if not got.startswith('�'):
+        failed += 1
+        print('split character before a frame was not replaced: %r' % got[:8])
+    # 校验和恰为 MAGIC[0] 的帧后紧跟文本
+    rec = struct.pack('<IBBH', next(iter(strings.table)), log_decode.LEVEL_NONE, log_decode.MODULE_NONE, 0)
+    rec += bytes(64)
+    for time_ms in range(256):
+        body = struct.pack('<HI', len(rec), time_ms) + rec
+        if sum(body) & 0xFF == 0xA5:
+            break
+    frame = log_decode.MAGIC + body + b'\xa5'
+    for size in CHUNK_SIZES:
+        got = decode(strings, frame + 'ok ✓'.encode(), size)
+        checked += 1
+        if not got.endswith('ok ✓') or '�' in got:
+            failed += 1
+            print('chunk size %d: text after a frame summing to 0xa5 is wrong: %r' % (size, got[-8:]))
+    print('test_log_decode: %d checks, %d failed' % (checked, failed))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * ota_writer.c 的写入, 断点恢复与校验测试. 升级包由 gen_ota_vectors.py 调用 ota_pack.py 生成,
+ * 以测试密钥签名; 分区为 ota_flash_ram.c 的内存模拟 flash, NVS 为内存表, 两者在模拟复位时保留.
+ */
+#define OTA_RAM_PART_SIZE (160 * 1024)
+#define OTA_RAM_RUNNING_SIZE (128 * 1024)
+#include "../../hals/update/ota_flash_ram.c"
+#include "../../hals/update/ota_writer.c"
+#include "host_test.h"
+
+#include <stdlib.h>
+
+#define HDR_LEN sizeof(OtaImageHeader)
+#define PIECE_LEN 1000
+#define RANGE_MAX 64
+
+typedef struct {
+    uint8_t *data;
+    uint32_t len;
+} Blob_t;
+
+static const char *OutDir = "out";
+static Blob_t Image;
+static Blob_t FullPkg;
+static Blob_t LzPkg;
+static Blob_t Base;
+static Blob_t DeltaPkg;
+static Blob_t DeltaLzPkg;
+static Blob_t PubKey;
+static int BootSwitched;
+
+int OtaBootSwitch(const OtaFlashPart *part)
+{
+    BootSwitched++;
+    return (part->id == OTA_RAM_PART_UPDATE) ? 0 : -1;
+}
+
+static Blob_t Load(const char *name)
+{
+    char path[256];
+    Blob_t b = { NULL, 0 };
+    FILE *f = NULL;
+    long len;
+    (void)snprintf(path, sizeof(path), "%s/%s", OutDir, name);
+    f = fopen(path, "rb");
+    if (f == NULL) {
+        printf("missing %s, run gen_ota_vectors.py\n", path);
+        exit(1);
+    }
+    (void)fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    (void)fseek(f, 0, SEEK_SET);
+    b.data = malloc((size_t)len);
+    b.len = (uint32_t)len;
+    if ((b.data == NULL) || (fread(b.data, 1, (size_t)len, f) != (size_t)len)) {
+        exit(1);
+    }
+    (void)fclose(f);
+    return b;
+}
+
+// 按 PIECE_LEN 分段顺序写入 [from, to)
+static int WritePieces(const Blob_t *pkg, uint32_t from, uint32_t to)
+{
+    uint32_t n;
+    for (uint32_t pos = from; pos < to; pos += n) {
+        n = ((to - pos) < PIECE_LEN) ? (to - pos) : PIECE_LEN;
+        if (OtaWriterWrite(pos, pkg->data + pos, n) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int WriteChunk(const Blob_t *pkg, uint32_t index)
+{
+    uint32_t pos = HDR_LEN + (index * OTA_FLASH_SECTOR_SIZE);
+    uint32_t end = ((pkg->len - pos) < OTA_FLASH_SECTOR_SIZE) ? pkg->len : (pos + OTA_FLASH_SECTOR_SIZE);
+    return WritePieces(pkg, pos, end);
+}
+
+static void TestFullChunked(void)
+{
+    uint32_t chunks = (FullPkg.len - HDR_LEN + OTA_FLASH_SECTOR_SIZE - 1) / OTA_FLASH_SECTOR_SIZE;
+    OtaRange ranges[RANGE_MAX];
+    uint32_t count;
+    int ok = 1;
+    HostNvsReset();
+    TEST_CHECK(OtaWriterBegin() == 0);
+    TEST_CHECK(OtaWriterGetState() == OTA_WRITER_HEADER);
+    TEST_CHECK(OtaWriterWrite(0, FullPkg.data, HDR_LEN) == 0);
+    TEST_CHECK(OtaWriterGetState() == OTA_WRITER_PAYLOAD);
+    TEST_CHECK((OtaWriterGetMissing(ranges, RANGE_MAX) == 1) && (ranges[0].offset == HDR_LEN) &&
+               (ranges[0].len == (FullPkg.len - HDR_LEN)));
+
+    // 奇数块倒序写入, 块 0 只写一半后复位
+    for (uint32_t i = chunks - 1; i > 0; i--) {
+        if ((i % 2) == 1) {
+            ok &= (WriteChunk(&FullPkg, i) == 0);
+        }
+    }
+    TEST_CHECK(ok);
+    TEST_CHECK(OtaWriterWrite(HDR_LEN, FullPkg.data + HDR_LEN, OTA_FLASH_SECTOR_SIZE / 2) == 0);
+    // 块内不连续的写入被拒绝, 但不影响之后的写入
+    TEST_CHECK(OtaWriterWrite(HDR_LEN + (2 * OTA_FLASH_SECTOR_SIZE) + 1, FullPkg.data, 1) == -1);
+    TEST_CHECK(OtaWriterGetState() == OTA_WRITER_PAYLOAD);
+
+    TEST_CHECK(OtaWriterBegin() == 0);
+    TEST_CHECK(OtaWriterGetState() == OTA_WRITER_PAYLOAD);
+    count = OtaWriterGetMissing(ranges, RANGE_MAX);
+    TEST_CHECK(count == ((chunks + 1) / 2));
+    TEST_CHECK((ranges[0].offset == HDR_LEN) && (ranges[0].len == OTA_FLASH_SECTOR_SIZE));
+    TEST_CHECK(ranges[1].offset == (HDR_LEN + (2 * OTA_FLASH_SECTOR_SIZE)));
+    TEST_CHECK(OtaWriterFinish() == -1);
+
+    TEST_CHECK(OtaWriterBegin() == 0);
+    // 已完成的块重发时跳过
+    TEST_CHECK(WriteChunk(&FullPkg, 1) == 0);
+    for (uint32_t i = 0; i < chunks; i += 2) {
+        ok &= (WriteChunk(&FullPkg, i) == 0);
+    }
+    TEST_CHECK(ok);
+    TEST_CHECK(OtaWriterGetMissing(NULL, 0) == 0);
+    TEST_CHECK(OtaWriterFinish() == 0);
+    TEST_CHECK(OtaWriterGetState() == OTA_WRITER_VERIFIED);
+    TEST_CHECK_MEM(OtaRamPart, Image.data, Image.len);
+    BootSwitched = 0;
+    TEST_CHECK((OtaWriterActivate() == 0) && (BootSwitched == 1));
+}
+
+static void TestLzResume(void)
+{
+    uint32_t stop = (LzPkg.len * 3) / 4;
+    uint32_t resume;
+    HostNvsReset();
+    (void)memset_s(OtaRamPart, sizeof(OtaRamPart), 0, sizeof(OtaRamPart));
+    TEST_CHECK(OtaWriterBegin() == 0);
+    TEST_CHECK(WritePieces(&LzPkg, 0, stop) == 0);
+    TEST_CHECK(OtaWriter.ck.output >= OTA_CKPT_INTERVAL);
+
+    // 复位后从 NVS 中的进度继续, 已写出部分的摘要从分区重新计算
+    TEST_CHECK(OtaWriterBegin() == 0);
+    TEST_CHECK(OtaWriterGetState() == OTA_WRITER_PAYLOAD);
+    resume = OtaWriterGetResumeOffset();
+    TEST_CHECK((resume > (HDR_LEN + sizeof(OtaLzHeader))) && (resume <= stop));
+    TEST_CHECK(OtaWriter.ck.output >= OTA_CKPT_INTERVAL);
+    // 重发的负载头部与保存的一致, 被跳过
+    TEST_CHECK(OtaWriterWrite(0, LzPkg.data, HDR_LEN + sizeof(OtaLzHeader)) == 0);
+    TEST_CHECK(WritePieces(&LzPkg, resume, LzPkg.len) == 0);
+    TEST_CHECK(OtaWriterGetMissing(NULL, 0) == 0);
+    TEST_CHECK(OtaWriterFinish() == 0);
+    TEST_CHECK(OtaWriterGetState() == OTA_WRITER_VERIFIED);
+    TEST_CHECK_MEM(OtaRamPart, Image.data, Image.len);
+
+    // 完成后进度已清除, 再次开始为新的升级
+    TEST_CHECK(OtaWriterBegin() == 0);
+    TEST_CHECK(OtaWriterGetState() == OTA_WRITER_HEADER);
+}
+
+static void TestBadSignature(void)
+{
+    uint8_t *bad = malloc(LzPkg.len);
+    uint32_t prefix = HDR_LEN + sizeof(OtaLzHeader);
+    memcpy(bad, LzPkg.data, LzPkg.len);
+    // 篡改负载头部中的镜像摘要, 收齐负载头部时即拒绝, 分区不被写入
+    bad[HDR_LEN + offsetof(OtaLzHeader, rawHash)] ^= 1;
+    HostNvsReset();
+    (void)memset_s(OtaRamPart, sizeof(OtaRamPart), 0, sizeof(OtaRamPart));
+    TEST_CHECK(OtaWriterBegin() == 0);
+    TEST_CHECK(OtaWriterWrite(0, bad, prefix - 1) == 0);
+    TEST_CHECK(OtaWriterWrite(prefix - 1, bad + prefix - 1, 1) == -1);
+    TEST_CHECK(OtaWriterGetState() == OTA_WRITER_ERROR);
+    TEST_CHECK(OtaWriterWrite(prefix, bad + prefix, PIECE_LEN) == -1);
+    TEST_CHECK(OtaRamPart[0] == 0);
+    TEST_CHECK(OtaWriterActivate() == -1);
+    free(bad);
+}
+
+static void TestCorruptPayload(void)
+{
+    uint8_t *bad = malloc(FullPkg.len);
+    Blob_t lz = { bad, LzPkg.len };
+    // LZ4 块以字面量结束, 改动最后一个字节只影响解出镜像的摘要
+    memcpy(bad, LzPkg.data, LzPkg.len);
+    bad[LzPkg.len - 1] ^= 1;
+    HostNvsReset();
+    TEST_CHECK(OtaWriterBegin() == 0);
+    TEST_CHECK(WritePieces(&lz, 0, lz.len) == 0);
+    TEST_CHECK(OtaWriterFinish() == -1);
+    TEST_CHECK(OtaWriterGetState() == OTA_WRITER_ERROR);
+
+    // 完整镜像的签名覆盖整个负载
+    memcpy(bad, FullPkg.data, FullPkg.len);
+    bad[FullPkg.len / 2] ^= 1;
+    TEST_CHECK(OtaWriterBegin() == 0);
+    TEST_CHECK(OtaWriterWrite(0, bad, FullPkg.len) == 0);
+    TEST_CHECK(OtaWriterFinish() == -1);
+    TEST_CHECK(OtaWriterActivate() == -1);
+    free(bad);
+}
+
+// 运行分区为 gen_ota_vectors.py 生成的旧镜像, 差分在设备侧应用后须得到新镜像
+static void TestDelta(const Blob_t *pkg)
+{
+    HostNvsReset();
+    (void)memset_s(OtaRamPart, sizeof(OtaRamPart), 0, sizeof(OtaRamPart));
+    TEST_CHECK(OtaWriterBegin() == 0);
+    TEST_CHECK(WritePieces(pkg, 0, pkg->len) == 0);
+    TEST_CHECK(OtaWriterGetMissing(NULL, 0) == 0);
+    TEST_CHECK(OtaWriterFinish() == 0);
+    TEST_CHECK(OtaWriterGetState() == OTA_WRITER_VERIFIED);
+    TEST_CHECK_MEM(OtaRamPart, Image.data, Image.len);
+}
+
+static void TestDeltaLzResume(void)
+{
+    uint32_t prefix = HDR_LEN + sizeof(OtaDeltaHeader) + sizeof(OtaLzHeader);
+    uint32_t stop = (DeltaLzPkg.len * 3) / 4;
+    uint32_t resume;
+    TEST_CHECK(DeltaLzPkg.len < DeltaPkg.len);
+    HostNvsReset();
+    (void)memset_s(OtaRamPart, sizeof(OtaRamPart), 0, sizeof(OtaRamPart));
+    TEST_CHECK(OtaWriterBegin() == 0);
+    TEST_CHECK(WritePieces(&DeltaLzPkg, 0, stop) == 0);
+    TEST_CHECK(OtaWriter.ck.output >= OTA_CKPT_INTERVAL);
+
+    TEST_CHECK(OtaWriterBegin() == 0);
+    resume = OtaWriterGetResumeOffset();
+    TEST_CHECK((resume > prefix) && (resume <= stop));
+    // 两个负载头部都可以读回, 重发时与保存的一致
+    TEST_CHECK(OtaWriterWrite(0, DeltaLzPkg.data, prefix) == 0);
+    TEST_CHECK(WritePieces(&DeltaLzPkg, resume, DeltaLzPkg.len) == 0);
+    TEST_CHECK(OtaWriterFinish() == 0);
+    TEST_CHECK_MEM(OtaRamPart, Image.data, Image.len);
+}
+
+static void TestDeltaWrongBase(void)
+{
+    uint32_t prefix = HDR_LEN + sizeof(OtaDeltaHeader) + sizeof(OtaLzHeader);
+    // 运行分区与差分的基准镜像不同, 收齐负载头部时即拒绝
+    OtaRamRunning[Base.len / 2] ^= 1;
+    HostNvsReset();
+    TEST_CHECK(OtaWriterBegin() == 0);
+    TEST_CHECK(OtaWriterWrite(0, DeltaLzPkg.data, prefix) == -1);
+    TEST_CHECK(OtaWriterGetState() == OTA_WRITER_ERROR);
+    OtaRamRunning[Base.len / 2] ^= 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        OutDir = argv[1];
+    }
+    Image = Load("ota_image.bin");
+    FullPkg = Load("ota_full.bin");
+    LzPkg = Load("ota_lz.bin");
+    Base = Load("ota_base.bin");
+    DeltaPkg = Load("ota_delta.bin");
+    DeltaLzPkg = Load("ota_delta_lz.bin");
+    PubKey = Load("ota_pubkey.der");
+    HostPkKey = PubKey.data;
+    HostPkKeyLen = PubKey.len;
+    TestFullChunked();
+    TestLzResume();
+    TestBadSignature();
+    TestCorruptPayload();
+    (void)memcpy_s(OtaRamRunning, sizeof(OtaRamRunning), Base.data, Base.len);
+    TestDelta(&DeltaPkg);
+    TestDelta(&DeltaLzPkg);
+    TestDeltaLzResume();
+    TestDeltaWrongBase();
+    return HostTestResult("test_ota");
+}
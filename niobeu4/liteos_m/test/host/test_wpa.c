@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2022 Hunan OpenValley Digital Industry Development Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * esp_wifi_wpa.c 的 4-way/组密钥握手测试. 帧由 gen_wpa_vectors.py 以独立实现生成,
+ * 驱动接口在此打桩, 记录发送的帧与安装的密钥.
+ */
+#include "../../hals/drivers/wifi_lite/esp_wifi_wpa.c"
+#include "host_test.h"
+#include "wpa_vectors.h"
+
+#define TX_MAX 512
+#define KEY_LOG_MAX 8
+
+typedef struct {
+    int alg;
+    int idx;
+    int setTx;
+    size_t len;
+    uint8_t key[GTK_MAX_LEN];
+} KeyLog_t;
+
+static struct wpa_funcs *Cb;
+static bool ProfIsWpa;
+static uint8_t ProfAuthmode = WIFI_AUTH_WPA2_PSK;
+static uint8_t ProfCipher = WIFI_CIPHER_TYPE_CCMP;
+static uint8_t AppIeType;
+static uint8_t AppIe[ASSOC_IE_MAX];
+static uint16_t AppIeLen;
+static uint8_t Tx[TX_MAX];
+static size_t TxLen;
+static KeyLog_t Keys[KEY_LOG_MAX];
+static int KeyNum;
+static WpaIgtk_t Igtk;
+static int IgtkNum;
+static int AuthDone;
+static int Deauth;
+
+void esp_fill_random(void *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        ((uint8_t *)buf)[i] = (uint8_t)(VEC_RANDOM_SEED ^ i);
+    }
+}
+
+esp_err_t esp_wifi_get_mac(wifi_interface_t ifx, uint8_t mac[6])
+{
+    (void)memcpy(mac, VEC_SPA, sizeof(VEC_SPA));
+    return ESP_OK;
+}
+
+int esp_wifi_register_wpa_cb_internal(struct wpa_funcs *cb)
+{
+    Cb = cb;
+    return 0;
+}
+
+int esp_wifi_unregister_wpa_cb_internal(void)
+{
+    free(Cb);
+    Cb = NULL;
+    return 0;
+}
+
+uint8_t *esp_wifi_sta_get_prof_pmk_internal(void)
+{
+    return (uint8_t *)VEC_PMK;
+}
+
+/* SAE 不在本测试范围, esp_wifi_sae.c 依赖的 ECP 也不在主机桩中 */
+uint8_t *WpaSaeBuildMsg(const uint8_t *ownAddr, const uint8_t *bssid, uint32_t type, size_t *len)
+{
+    return NULL;
+}
+
+int WpaSaeParseMsg(const uint8_t *buf, size_t len, uint32_t type, uint16_t status)
+{
+    return -1;
+}
+
+int WpaSaeGetPmk(uint8_t *pmk, uint8_t *pmkid)
+{
+    return -1;
+}
+
+void WpaSaeClear(void)
+{
+}
+
+uint8_t esp_wifi_sta_get_prof_authmode_internal(void)
+{
+    return ProfAuthmode;
+}
+
+bool esp_wifi_sta_prof_is_wpa_internal(void)
+{
+    return ProfIsWpa;
+}
+
+uint8_t esp_wifi_sta_get_pairwise_cipher_internal(void)
+{
+    return ProfCipher;
+}
+
+uint8_t esp_wifi_sta_get_group_cipher_internal(void)
+{
+    return ProfCipher;
+}
+
+uint8_t *esp_wifi_sta_get_ie(uint8_t *bssid, int elemId)
+{
+    return (elemId == IE_RSN) ? (uint8_t *)VEC_RSN_IE : NULL;
+}
+
+int esp_wifi_set_appie_internal(uint8_t type, uint8_t *ie, uint16_t len, uint8_t flag)
+{
+    AppIeType = type;
+    AppIeLen = len;
+    (void)memcpy(AppIe, ie, len);
+    return 0;
+}
+
+int esp_wifi_set_sta_key_internal(int alg, uint8_t *addr, int key_idx, int set_tx, uint8_t *seq, size_t seq_len,
+                                  uint8_t *key, size_t key_len, int key_entry_valid)
+{
+    if ((KeyNum >= KEY_LOG_MAX) || (key_len > GTK_MAX_LEN)) {
+        return -1;
+    }
+    Keys[KeyNum].alg = alg;
+    Keys[KeyNum].idx = key_idx;
+    Keys[KeyNum].setTx = set_tx;
+    Keys[KeyNum].len = key_len;
+    (void)memcpy(Keys[KeyNum].key, key, key_len);
+    KeyNum++;
+    return 0;
+}
+
+int esp_wifi_set_igtk_internal(uint8_t ifx, const WpaIgtk_t *igtk)
+{
+    Igtk = *igtk;
+    IgtkNum++;
+    return 0;
+}
+
+int esp_wifi_auth_done_internal(void)
+{
+    AuthDone++;
+    return 0;
+}
+
+int esp_wifi_deauthenticate_internal(uint8_t reason_code)
+{
+    Deauth++;
+    return 0;
+}
+
+esp_err_t esp_wifi_internal_tx(wifi_interface_t ifx, void *buffer, uint16_t len)
+{
+    TxLen = (len <= TX_MAX) ? len : 0;
+    (void)memcpy(Tx, buffer, TxLen);
+    return ESP_OK;
+}
+
+static int Rx(const uint8_t *frame, size_t len)
+{
+    uint8_t buf[TX_MAX];
+    (void)memcpy(buf, frame, len);
+    TxLen = 0;
+    return Cb->wpa_sta_rx_eapol((uint8_t *)VEC_AA, buf, (uint32_t)len);
+}
+
+#define RX(v) Rx((v), sizeof(v))
+#define CHECK_TX(v) do { \
+    TEST_CHECK(TxLen == sizeof(v)); \
+    TEST_CHECK_MEM(Tx, (v), sizeof(v)); \
+} while (0)
+
+static void Connect(void)
+{
+    KeyNum = 0;
+    IgtkNum = 0;
+    AuthDone = 0;
+    Deauth = 0;
+    TEST_CHECK(esp_supplicant_init() == 0);
+    TEST_CHECK(Cb->wpa_sta_init());
+    Cb->wpa_sta_connect((uint8_t *)VEC_AA);
+}
+
+static void Disconnect(void)
+{
+    Cb->wpa_sta_disconnected_cb(0);
+    TEST_CHECK(Cb->wpa_sta_deinit());
+    (void)esp_supplicant_deinit();
+}
+
+/* IEEE 802.11i H.3 PRF 测试向量 */
+static void TestPrf(void)
+{
+    static const uint8_t key[20] = {
+        0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+        0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+    };
+    static const uint8_t expect[] = {
+        0xbc, 0xd4, 0xc6, 0x50, 0xb3, 0x0b, 0x96, 0x84, 0x95, 0x18, 0x29, 0xe0, 0xd7, 0x5f, 0x9d, 0x54,
+        0xb8, 0x62, 0x17, 0x5e, 0xd9, 0xf0, 0x06, 0x06, 0xe1, 0x7d, 0x8d, 0xa3, 0x54, 0x02, 0xff, 0xee,
+        0x75, 0xdf, 0x78, 0xc3, 0xd3, 0x1e, 0x0f, 0x88, 0x9f, 0x01, 0x21, 0x20, 0xc0, 0x86, 0x2b, 0xeb,
+        0x67, 0x75, 0x3e, 0x74, 0x39, 0xae, 0x24, 0x2e, 0xdb, 0x83, 0x73, 0x69, 0x83, 0x56, 0xcf, 0x5a,
+    };
+    uint8_t out[sizeof(expect)];
+    TEST_CHECK(WpaSha1Prf(key, sizeof(key), "prefix", (const uint8_t *)"Hi There", 8, out, sizeof(out)) == 0);
+    TEST_CHECK_MEM(out, expect, sizeof(expect));
+}
+
+typedef struct {
+    const char *passphrase;
+    const char *salt;
+    int iterations;
+    const char *hex;
+} Pbkdf2Vector_t;
+
+static size_t FromHex(const char *hex, uint8_t *out, size_t size)
+{
+    size_t n = 0;
+    for (; (hex[0] != '\0') && (hex[1] != '\0') && (n < size); hex += 2) {
+        unsigned int b = 0;
+        (void)sscanf(hex, "%2x", &b);
+        out[n++] = (uint8_t)b;
+    }
+    return n;
+}
+
+/* RFC 6070 PBKDF2-HMAC-SHA1 与 IEEE 802.11-2016 J.4 口令到 PSK 的测试向量 */
+static void TestPbkdf2(void)
+{
+    static const Pbkdf2Vector_t vectors[] = {
+        { "password", "salt", 1, "0c60c80f961f0e71f3a9b524af6012062fe037a6" },
+        { "password", "salt", 2, "ea6c014dc72d6f8ccd1ed92ace1d41f0d8de8957" },
+        { "password", "salt", 4096, "4b007901b765489abead49d926f721d065a429c1" },
+        { "passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096,
+          "3d2eec4fe41c849b80c8d83662c0e44a8b291a964cf2f07038" },
+        { "password", "IEEE", 4096, "f42c6fc52df0ebef9ebb4b90b38a5f902e83fe1b135a70e23aed762e9710a12e" },
+        { "ThisIsAPassword", "ThisIsASSID", 4096,
+          "0dc0d6eb90555ed6419756b9a15ec3e3209b63df707dd508d14581f8982721af" },
+        { "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", "ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ", 4096,
+          "becb93866bb8c3832cb777c2f559807c8c59afcb6eae734885001300a981cc62" },
+        /* 超过一个 SHA1 分组的口令, 快速实现拒绝, 由 mbedTLS 派生 */
+        { "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx", "niobe-test", 4096,
+          "5b885198895c41c5bbe712b83eab8b74ff0163c978c3b27fc30388d14a9d61e0" },
+    };
+    uint8_t expect[WPA_PMK_LEN];
+    uint8_t out[WPA_PMK_LEN];
+    uint8_t cached[WPA_PMK_LEN];
+
+    WpaPmkCacheFlush();
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        const Pbkdf2Vector_t *v = &vectors[i];
+        size_t saltLen = strlen(v->salt);
+        size_t len = FromHex(v->hex, expect, sizeof(expect));
+        bool fast = strlen(v->passphrase) <= 64;     // 64: SHA1 分组长度
+        (void)memset(out, 0, sizeof(out));
+        TEST_CHECK(WpaPbkdf2Sha1(v->passphrase, v->salt, saltLen, v->iterations, out, len) == 0);
+        TEST_CHECK_MEM(out, expect, len);
+        (void)memset(out, 0, sizeof(out));
+        TEST_CHECK((WpaFastPbkdf2Sha1(v->passphrase, (const uint8_t *)v->salt, saltLen, v->iterations, out, len) == 0)
+                   == fast);
+        TEST_CHECK(!fast || (memcmp(out, expect, len) == 0));
+        /* 只有 4096 轮, 32 字节的 PMK 进入缓存 */
+        TEST_CHECK((WpaPmkCacheGet((const uint8_t *)v->salt, saltLen, v->passphrase, cached) == 0) ==
+                   ((v->iterations == WPA_PBKDF2_ITERATIONS) && (len == WPA_PMK_LEN)));
+    }
+    TEST_CHECK_MEM(cached, expect, WPA_PMK_LEN);
+    WpaPmkCacheFlush();
+    TEST_CHECK(WpaPmkCacheGet((const uint8_t *)"IEEE", 4, "password", cached) != 0);
+}
+
+static void TestCcmp(void)
+{
+    ProfIsWpa = false;
+    ProfAuthmode = WIFI_AUTH_WPA2_PSK;
+    ProfCipher = WIFI_CIPHER_TYPE_CCMP;
+    Connect();
+    TEST_CHECK(AppIeType == WIFI_APPIE_RSN);
+    TEST_CHECK((AppIeLen == sizeof(VEC_RSN_IE)) && (memcmp(AppIe, VEC_RSN_IE, AppIeLen) == 0));
+
+    TEST_CHECK(RX(VEC_CCMP_MSG1) == 0);
+    CHECK_TX(VEC_CCMP_MSG2);
+    TEST_CHECK(Cb->wpa_sta_in_4way_handshake());
+
+    TEST_CHECK(RX(VEC_CCMP_MSG3) == 0);
+    CHECK_TX(VEC_CCMP_MSG4);
+    TEST_CHECK(KeyNum == 2);
+    TEST_CHECK((Keys[0].alg == WPA_ALG_CCMP) && Keys[0].setTx && (Keys[0].len == PTK_TK_LEN));
+    TEST_CHECK_MEM(Keys[0].key, VEC_CCMP_PTK + PTK_KCK_LEN + PTK_KEK_LEN, PTK_TK_LEN);
+    TEST_CHECK((Keys[1].idx == 1) && (Keys[1].len == sizeof(VEC_GTK_CCMP)));
+    TEST_CHECK_MEM(Keys[1].key, VEC_GTK_CCMP, sizeof(VEC_GTK_CCMP));
+    TEST_CHECK((IgtkNum == 1) && (Igtk.keyId[0] == 4));
+    TEST_CHECK_MEM(Igtk.igtk, VEC_IGTK, sizeof(VEC_IGTK));
+    TEST_CHECK(AuthDone == 1);
+    TEST_CHECK(!Cb->wpa_sta_in_4way_handshake());
+
+    /* 重传的 message 3: 回复 message 4, 不重装 PTK/GTK/IGTK */
+    TEST_CHECK(RX(VEC_CCMP_MSG3_RETRY) == 0);
+    CHECK_TX(VEC_CCMP_MSG4_RETRY);
+    TEST_CHECK((KeyNum == 2) && (IgtkNum == 1) && (AuthDone == 1));
+
+    /* 组密钥更新安装新 GTK; IGTK 只有 IPN 变化, 不重装 */
+    TEST_CHECK(RX(VEC_CCMP_GROUP1) == 0);
+    CHECK_TX(VEC_CCMP_GROUP2);
+    TEST_CHECK((KeyNum == 3) && (Keys[2].idx == 2));
+    TEST_CHECK_MEM(Keys[2].key, VEC_GTK_CCMP_NEW, sizeof(VEC_GTK_CCMP_NEW));
+    TEST_CHECK(IgtkNum == 1);
+
+    /* 重复的组密钥消息: 仍回复, 不重装 */
+    TEST_CHECK(RX(VEC_CCMP_GROUP1_REPEAT) == 0);
+    CHECK_TX(VEC_CCMP_GROUP2_REPEAT);
+    TEST_CHECK(KeyNum == 3);
+
+    /* 不带 MIC 的组密钥消息与旧的重放计数均被丢弃 */
+    TEST_CHECK(RX(VEC_CCMP_GROUP1_NOMIC) != 0);
+    TEST_CHECK((TxLen == 0) && (KeyNum == 3));
+    TEST_CHECK(RX(VEC_CCMP_MSG3) != 0);
+    TEST_CHECK((TxLen == 0) && (KeyNum == 3) && (Deauth == 0));
+    Disconnect();
+}
+
+static void TestTkip(void)
+{
+    ProfIsWpa = true;
+    ProfAuthmode = WIFI_AUTH_WPA_PSK;
+    ProfCipher = WIFI_CIPHER_TYPE_TKIP;
+    Connect();
+    TEST_CHECK(AppIeType == WIFI_APPIE_WPA);
+
+    TEST_CHECK(RX(VEC_TKIP_MSG1) == 0);
+    CHECK_TX(VEC_TKIP_MSG2);
+
+    TEST_CHECK(RX(VEC_TKIP_MSG3) == 0);
+    CHECK_TX(VEC_TKIP_MSG4);
+    TEST_CHECK((KeyNum == 1) && (Keys[0].alg == WPA_ALG_TKIP) && (Keys[0].len == PTK_TK_TKIP_LEN));
+    TEST_CHECK_MEM(Keys[0].key, VEC_TKIP_PTK + PTK_KCK_LEN + PTK_KEK_LEN, PTK_TK_TKIP_LEN);
+    TEST_CHECK((AuthDone == 0) && Cb->wpa_sta_in_4way_handshake());
+
+    TEST_CHECK(RX(VEC_TKIP_GROUP1) == 0);
+    CHECK_TX(VEC_TKIP_GROUP2);
+    TEST_CHECK((KeyNum == 2) && (Keys[1].alg == WPA_ALG_TKIP) && (Keys[1].idx == 1));
+    TEST_CHECK((Keys[1].len == sizeof(VEC_TKIP_GTK_INSTALLED)) &&
+               (memcmp(Keys[1].key, VEC_TKIP_GTK_INSTALLED, Keys[1].len) == 0));
+    TEST_CHECK(AuthDone == 1);
+    Disconnect();
+}
+
+int main(void)
+{
+    TestPrf();
+    TestPbkdf2();
+    TestCcmp();
+    TestTkip();
+    return HostTestResult("test_wpa");
+}
@@ -0,0 +1,289 @@
+/* Generated by gen_wpa_vectors.py, do not edit. */
+#ifndef WPA_VECTORS_H
+#define WPA_VECTORS_H
+
+#include <stdint.h>
+
+#define VEC_RANDOM_SEED 0x5A
+
+static const uint8_t VEC_PMK[] = {
+    0x38, 0x46, 0xde, 0xb6, 0x34, 0xdf, 0x9a, 0xe1, 0x76, 0x3f, 0xe7, 0x4c,
+    0xf4, 0x98, 0x96, 0x65, 0xef, 0xe3, 0xaa, 0x64, 0xf6, 0xfe, 0xaa, 0xa1,
+    0xb5, 0x25, 0xd1, 0xd6, 0xe7, 0xe8, 0x37, 0xe1,
+};
+static const uint8_t VEC_AA[] = {
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00,
+};
+static const uint8_t VEC_SPA[] = {
+    0x02, 0x00, 0x00, 0x00, 0x02, 0x00,
+};
+static const uint8_t VEC_RSN_IE[] = {
+    0x30, 0x14, 0x01, 0x00, 0x00, 0x0f, 0xac, 0x04, 0x01, 0x00, 0x00, 0x0f,
+    0xac, 0x04, 0x01, 0x00, 0x00, 0x0f, 0xac, 0x02, 0x80, 0x00,
+};
+static const uint8_t VEC_GTK_CCMP[] = {
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b,
+    0x4c, 0x4d, 0x4e, 0x4f,
+};
+static const uint8_t VEC_GTK_CCMP_NEW[] = {
+    0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x5b,
+    0x5c, 0x5d, 0x5e, 0x5f,
+};
+static const uint8_t VEC_IGTK[] = {
+    0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b,
+    0x6c, 0x6d, 0x6e, 0x6f,
+};
+static const uint8_t VEC_CCMP_PTK[] = {
+    0xcb, 0x5a, 0x6b, 0x96, 0xf1, 0x11, 0xfb, 0xa2, 0x02, 0x58, 0x0e, 0x96,
+    0x99, 0x87, 0x6e, 0x77, 0x19, 0x06, 0x0b, 0x5e, 0xb3, 0x4b, 0x2a, 0x89,
+    0xe2, 0x5f, 0x52, 0x09, 0xde, 0x3a, 0xb7, 0xd1, 0x42, 0xe7, 0x24, 0x0f,
+    0xf0, 0x1e, 0xbd, 0xa9, 0xb3, 0x2d, 0x79, 0x2e, 0x86, 0x1d, 0xe5, 0x60,
+};
+static const uint8_t VEC_CCMP_MSG1[] = {
+    0x01, 0x03, 0x00, 0x5f, 0x02, 0x00, 0x8a, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+    0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22,
+    0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e,
+    0x2f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00,
+};
+static const uint8_t VEC_CCMP_MSG2[] = {
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00,
+    0x88, 0x8e, 0x01, 0x03, 0x00, 0x75, 0x02, 0x01, 0x0a, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x5a, 0x5b, 0x58, 0x59, 0x5e,
+    0x5f, 0x5c, 0x5d, 0x52, 0x53, 0x50, 0x51, 0x56, 0x57, 0x54, 0x55, 0x4a,
+    0x4b, 0x48, 0x49, 0x4e, 0x4f, 0x4c, 0x4d, 0x42, 0x43, 0x40, 0x41, 0x46,
+    0x47, 0x44, 0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21,
+    0x78, 0x17, 0x5b, 0xbd, 0xf3, 0xc8, 0x41, 0x33, 0x05, 0x6f, 0x82, 0x6f,
+    0x86, 0x42, 0xd1, 0x00, 0x16, 0x30, 0x14, 0x01, 0x00, 0x00, 0x0f, 0xac,
+    0x04, 0x01, 0x00, 0x00, 0x0f, 0xac, 0x04, 0x01, 0x00, 0x00, 0x0f, 0xac,
+    0x02, 0x80, 0x00,
+};
+static const uint8_t VEC_CCMP_MSG3[] = {
+    0x01, 0x03, 0x00, 0xb7, 0x02, 0x13, 0xca, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x02, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+    0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22,
+    0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e,
+    0x2f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x88, 0x97, 0x54,
+    0x09, 0xe3, 0xf1, 0xe3, 0xe5, 0x1c, 0xd1, 0xb2, 0x26, 0xa5, 0xfa, 0xbe,
+    0xf5, 0x00, 0x58, 0x51, 0x49, 0x18, 0xa2, 0x7b, 0x1c, 0x2c, 0xdf, 0xe0,
+    0x50, 0xb5, 0xa2, 0x33, 0xe6, 0x8b, 0x90, 0x93, 0x36, 0x5a, 0x64, 0x28,
+    0x1f, 0x29, 0x0d, 0x6c, 0xb7, 0xd7, 0x3c, 0x20, 0xb6, 0x57, 0xe4, 0x64,
+    0x66, 0xa1, 0x7d, 0x37, 0x25, 0xff, 0xe9, 0xeb, 0x28, 0xf7, 0xde, 0x5c,
+    0x91, 0xb1, 0x68, 0xa0, 0xeb, 0x7b, 0x9f, 0x63, 0xbc, 0x33, 0xc9, 0x6d,
+    0x1e, 0xf0, 0x57, 0x9b, 0x38, 0x8f, 0xd6, 0x61, 0x31, 0x72, 0x7d, 0x02,
+    0x2b, 0x76, 0xa4, 0x0a, 0x36, 0xbe, 0x8f, 0x71, 0x02, 0x5f, 0x60, 0x7d,
+    0xe6, 0x11, 0x88, 0x49, 0xb2, 0xe8, 0x88,
+};
+static const uint8_t VEC_CCMP_MSG4[] = {
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00,
+    0x88, 0x8e, 0x01, 0x03, 0x00, 0x5f, 0x02, 0x03, 0x0a, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe1,
+    0x4c, 0x21, 0x4b, 0xf3, 0x96, 0x98, 0xef, 0x8e, 0x5a, 0x74, 0xab, 0xee,
+    0xfb, 0x61, 0x6a, 0x00, 0x00,
+};
+static const uint8_t VEC_CCMP_MSG3_RETRY[] = {
+    0x01, 0x03, 0x00, 0xb7, 0x02, 0x13, 0xca, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x03, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+    0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22,
+    0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e,
+    0x2f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4e, 0x2c, 0xfc,
+    0x3a, 0x03, 0xa2, 0x22, 0xd9, 0x75, 0x2b, 0x30, 0xd5, 0xb7, 0xbb, 0x4a,
+    0xc3, 0x00, 0x58, 0x51, 0x49, 0x18, 0xa2, 0x7b, 0x1c, 0x2c, 0xdf, 0xe0,
+    0x50, 0xb5, 0xa2, 0x33, 0xe6, 0x8b, 0x90, 0x93, 0x36, 0x5a, 0x64, 0x28,
+    0x1f, 0x29, 0x0d, 0x6c, 0xb7, 0xd7, 0x3c, 0x20, 0xb6, 0x57, 0xe4, 0x64,
+    0x66, 0xa1, 0x7d, 0x37, 0x25, 0xff, 0xe9, 0xeb, 0x28, 0xf7, 0xde, 0x5c,
+    0x91, 0xb1, 0x68, 0xa0, 0xeb, 0x7b, 0x9f, 0x63, 0xbc, 0x33, 0xc9, 0x6d,
+    0x1e, 0xf0, 0x57, 0x9b, 0x38, 0x8f, 0xd6, 0x61, 0x31, 0x72, 0x7d, 0x02,
+    0x2b, 0x76, 0xa4, 0x0a, 0x36, 0xbe, 0x8f, 0x71, 0x02, 0x5f, 0x60, 0x7d,
+    0xe6, 0x11, 0x88, 0x49, 0xb2, 0xe8, 0x88,
+};
+static const uint8_t VEC_CCMP_MSG4_RETRY[] = {
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00,
+    0x88, 0x8e, 0x01, 0x03, 0x00, 0x5f, 0x02, 0x03, 0x0a, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x99,
+    0x53, 0x0d, 0x0b, 0x4b, 0x89, 0x8e, 0xfa, 0xc2, 0xed, 0x4d, 0xea, 0xb8,
+    0x45, 0xe7, 0xe4, 0x00, 0x00,
+};
+static const uint8_t VEC_CCMP_GROUP1[] = {
+    0x01, 0x03, 0x00, 0x9f, 0x02, 0x13, 0x82, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf8, 0x4b, 0x37,
+    0x7d, 0x30, 0x67, 0xbd, 0x2e, 0x07, 0x92, 0xbe, 0x87, 0xb3, 0x78, 0xc5,
+    0xf2, 0x00, 0x40, 0x58, 0x73, 0x84, 0x5d, 0xd5, 0x60, 0x1d, 0x78, 0x2e,
+    0x62, 0x42, 0xce, 0x73, 0x06, 0x1a, 0x32, 0x9f, 0x2c, 0xcd, 0xd2, 0x9a,
+    0xce, 0x21, 0xbf, 0xa3, 0xda, 0x56, 0x6c, 0x85, 0x53, 0x59, 0xf7, 0x75,
+    0x50, 0x0d, 0x73, 0x5b, 0xe1, 0x98, 0x48, 0x81, 0x79, 0xb2, 0x04, 0xaf,
+    0xea, 0xea, 0xf3, 0xff, 0x67, 0xfc, 0xf3, 0x7e, 0x63, 0x71, 0x33, 0x19,
+    0xca, 0x8b, 0x9c, 0x61, 0x12, 0x54, 0xa8,
+};
+static const uint8_t VEC_CCMP_GROUP2[] = {
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00,
+    0x88, 0x8e, 0x01, 0x03, 0x00, 0x5f, 0x02, 0x03, 0x02, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x93,
+    0xda, 0xd5, 0xbb, 0x82, 0x65, 0x0e, 0x71, 0x5f, 0x9b, 0x66, 0x71, 0x6b,
+    0xba, 0xed, 0xa7, 0x00, 0x00,
+};
+static const uint8_t VEC_CCMP_GROUP1_REPEAT[] = {
+    0x01, 0x03, 0x00, 0x9f, 0x02, 0x13, 0x82, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7e, 0x9f, 0x2b,
+    0x3d, 0xe0, 0x8d, 0x48, 0x1b, 0x67, 0x51, 0xc7, 0x0b, 0xd9, 0x55, 0xc7,
+    0x47, 0x00, 0x40, 0x58, 0x73, 0x84, 0x5d, 0xd5, 0x60, 0x1d, 0x78, 0x2e,
+    0x62, 0x42, 0xce, 0x73, 0x06, 0x1a, 0x32, 0x9f, 0x2c, 0xcd, 0xd2, 0x9a,
+    0xce, 0x21, 0xbf, 0xa3, 0xda, 0x56, 0x6c, 0x85, 0x53, 0x59, 0xf7, 0x75,
+    0x50, 0x0d, 0x73, 0x5b, 0xe1, 0x98, 0x48, 0x81, 0x79, 0xb2, 0x04, 0xaf,
+    0xea, 0xea, 0xf3, 0xff, 0x67, 0xfc, 0xf3, 0x7e, 0x63, 0x71, 0x33, 0x19,
+    0xca, 0x8b, 0x9c, 0x61, 0x12, 0x54, 0xa8,
+};
+static const uint8_t VEC_CCMP_GROUP2_REPEAT[] = {
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00,
+    0x88, 0x8e, 0x01, 0x03, 0x00, 0x5f, 0x02, 0x03, 0x02, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5e,
+    0xaa, 0x2a, 0x95, 0xee, 0x88, 0xed, 0x62, 0xbe, 0x7e, 0xd6, 0xf3, 0x78,
+    0xd2, 0xe6, 0x56, 0x00, 0x00,
+};
+static const uint8_t VEC_CCMP_GROUP1_NOMIC[] = {
+    0x01, 0x03, 0x00, 0x9f, 0x02, 0x12, 0x82, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x40, 0x58, 0x73, 0x84, 0x5d, 0xd5, 0x60, 0x1d, 0x78, 0x2e,
+    0x62, 0x42, 0xce, 0x73, 0x06, 0x1a, 0x32, 0x9f, 0x2c, 0xcd, 0xd2, 0x9a,
+    0xce, 0x21, 0xbf, 0xa3, 0xda, 0x56, 0x6c, 0x85, 0x53, 0x59, 0xf7, 0x75,
+    0x50, 0x0d, 0x73, 0x5b, 0xe1, 0x98, 0x48, 0x81, 0x79, 0xb2, 0x04, 0xaf,
+    0xea, 0xea, 0xf3, 0xff, 0x67, 0xfc, 0xf3, 0x7e, 0x63, 0x71, 0x33, 0x19,
+    0xca, 0x8b, 0x9c, 0x61, 0x12, 0x54, 0xa8,
+};
+static const uint8_t VEC_TKIP_PTK[] = {
+    0xcb, 0x5a, 0x6b, 0x96, 0xf1, 0x11, 0xfb, 0xa2, 0x02, 0x58, 0x0e, 0x96,
+    0x99, 0x87, 0x6e, 0x77, 0x19, 0x06, 0x0b, 0x5e, 0xb3, 0x4b, 0x2a, 0x89,
+    0xe2, 0x5f, 0x52, 0x09, 0xde, 0x3a, 0xb7, 0xd1, 0x42, 0xe7, 0x24, 0x0f,
+    0xf0, 0x1e, 0xbd, 0xa9, 0xb3, 0x2d, 0x79, 0x2e, 0x86, 0x1d, 0xe5, 0x60,
+    0x8f, 0xbd, 0x48, 0x7d, 0xa8, 0x5d, 0xc2, 0x06, 0xfc, 0xb8, 0xb7, 0xc6,
+    0x48, 0x22, 0x10, 0xf8,
+};
+static const uint8_t VEC_TKIP_MSG1[] = {
+    0x01, 0x03, 0x00, 0x5f, 0xfe, 0x00, 0x89, 0x00, 0x20, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+    0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22,
+    0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e,
+    0x2f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00,
+};
+static const uint8_t VEC_TKIP_MSG2[] = {
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00,
+    0x88, 0x8e, 0x01, 0x03, 0x00, 0x77, 0xfe, 0x01, 0x09, 0x00, 0x20, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x5a, 0x5b, 0x58, 0x59, 0x5e,
+    0x5f, 0x5c, 0x5d, 0x52, 0x53, 0x50, 0x51, 0x56, 0x57, 0x54, 0x55, 0x4a,
+    0x4b, 0x48, 0x49, 0x4e, 0x4f, 0x4c, 0x4d, 0x42, 0x43, 0x40, 0x41, 0x46,
+    0x47, 0x44, 0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x76,
+    0x21, 0xa1, 0xc6, 0xc4, 0x61, 0xbf, 0x37, 0x00, 0x06, 0x69, 0x08, 0x50,
+    0x69, 0x1e, 0x17, 0x00, 0x18, 0xdd, 0x16, 0x00, 0x50, 0xf2, 0x01, 0x01,
+    0x00, 0x00, 0x50, 0xf2, 0x02, 0x01, 0x00, 0x00, 0x50, 0xf2, 0x02, 0x01,
+    0x00, 0x00, 0x50, 0xf2, 0x02,
+};
+static const uint8_t VEC_TKIP_MSG3[] = {
+    0x01, 0x03, 0x00, 0x77, 0xfe, 0x01, 0xc9, 0x00, 0x20, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x02, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+    0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22,
+    0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e,
+    0x2f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xba, 0x3e, 0x15,
+    0x7f, 0x5f, 0x84, 0x45, 0x27, 0x87, 0x8f, 0xf0, 0x26, 0x5d, 0xe9, 0x39,
+    0xee, 0x00, 0x18, 0xdd, 0x16, 0x00, 0x50, 0xf2, 0x01, 0x01, 0x00, 0x00,
+    0x50, 0xf2, 0x02, 0x01, 0x00, 0x00, 0x50, 0xf2, 0x02, 0x01, 0x00, 0x00,
+    0x50, 0xf2, 0x02,
+};
+static const uint8_t VEC_TKIP_MSG4[] = {
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00,
+    0x88, 0x8e, 0x01, 0x03, 0x00, 0x5f, 0xfe, 0x01, 0x09, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9f,
+    0x35, 0x3f, 0x52, 0x3b, 0xb4, 0x00, 0xbf, 0xa9, 0xa8, 0xe7, 0x0a, 0x44,
+    0x72, 0xb8, 0x30, 0x00, 0x00,
+};
+static const uint8_t VEC_TKIP_GROUP1[] = {
+    0x01, 0x03, 0x00, 0x7f, 0xfe, 0x03, 0x91, 0x00, 0x20, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca,
+    0xcb, 0xcc, 0xcd, 0xce, 0xcf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd5, 0x89, 0xfa,
+    0x3b, 0xef, 0xed, 0xda, 0x7d, 0x64, 0x75, 0x94, 0x91, 0x90, 0x22, 0xbe,
+    0xa1, 0x00, 0x20, 0x54, 0xa9, 0xec, 0xb9, 0x05, 0xa3, 0xf1, 0x39, 0x84,
+    0x83, 0xa8, 0x03, 0x72, 0x60, 0x9d, 0x9e, 0x84, 0x84, 0xeb, 0xa6, 0xdd,
+    0xfb, 0x8d, 0x44, 0x76, 0x3b, 0x00, 0x9d, 0x83, 0xdc, 0x23, 0xc6,
+};
+static const uint8_t VEC_TKIP_GROUP2[] = {
+    0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00,
+    0x88, 0x8e, 0x01, 0x03, 0x00, 0x5f, 0xfe, 0x03, 0x11, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05,
+    0xcd, 0x03, 0x76, 0x2f, 0xb4, 0x38, 0x07, 0xb3, 0x7c, 0x69, 0x1c, 0x23,
+    0x87, 0x14, 0x5f, 0x00, 0x00,
+};
+static const uint8_t VEC_TKIP_GTK_INSTALLED[] = {
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x8b,
+    0x8c, 0x8d, 0x8e, 0x8f, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f,
+    0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97,
+};
+
+#endif /* WPA_VECTORS_H */
+